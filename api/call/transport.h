@@ -36,6 +36,11 @@ struct PacketOptions {
   bool is_retransmit = false;
   bool included_in_feedback = false;
   bool included_in_allocation = false;
+  // Whether this packet may be sent together with the packets that follow it
+  // in a single batch, see rtc::PacketOptions. `last_packet_in_batch` marks
+  // the end of such a batch.
+  bool batchable = false;
+  bool last_packet_in_batch = false;
 };
 
 class Transport {
@@ -0,0 +1,57 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef API_LOCATION_H_
+#define API_LOCATION_H_
+
+#include <string>
+
+namespace webrtc {
+
+// Location provides basic info where an object was constructed, or was
+// significantly brought to life, e.g. the place a task was posted from.
+class Location {
+ public:
+  // Returns the location of the caller.
+  static constexpr Location Current(
+      const char* function_name = __builtin_FUNCTION(),
+      const char* file_name = __builtin_FILE(),
+      int line_number = __builtin_LINE()) {
+    return Location(function_name, file_name, line_number);
+  }
+
+  constexpr Location() = default;
+
+  const char* function_name() const { return function_name_; }
+  const char* file_name() const { return file_name_; }
+  int line_number() const { return line_number_; }
+
+  // Returns "function_name@file_name:line_number".
+  std::string ToString() const {
+    return std::string(function_name_) + "@" + file_name_ + ":" +
+           std::to_string(line_number_);
+  }
+
+ private:
+  constexpr Location(const char* function_name,
+                     const char* file_name,
+                     int line_number)
+      : function_name_(function_name),
+        file_name_(file_name),
+        line_number_(line_number) {}
+
+  const char* function_name_ = "Unknown";
+  const char* file_name_ = "Unknown";
+  int line_number_ = -1;
+};
+
+}  // namespace webrtc
+
+#endif  // API_LOCATION_H_
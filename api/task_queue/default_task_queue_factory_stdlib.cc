@@ -11,13 +11,23 @@
 
 #include "api/field_trials_view.h"
 #include "api/task_queue/task_queue_factory.h"
+#include "api/transport/field_trial_based_config.h"
+#include "rtc_base/memory/always_valid_pointer.h"
 #include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_queue_thread_pool.h"
 
 namespace webrtc {
 
 std::unique_ptr<TaskQueueFactory> CreateDefaultTaskQueueFactory(
-    const FieldTrialsView* field_trials) {
-  return CreateTaskQueueStdlibFactory();
+    const FieldTrialsView* field_trials_view) {
+  AlwaysValidPointer<const FieldTrialsView, FieldTrialBasedConfig> field_trials(
+      field_trials_view);
+  if (std::unique_ptr<TaskQueueFactory> thread_pool_factory =
+          CreateTaskQueueThreadPoolFactoryIfEnabled(*field_trials)) {
+    return thread_pool_factory;
+  }
+  return CreateTaskQueueStdlibFactory(
+      field_trials->IsEnabled("WebRTC-TaskQueue-CoalesceLowPrecision"));
 }
 
 }  // namespace webrtc
@@ -17,6 +17,7 @@
 #include "rtc_base/memory/always_valid_pointer.h"
 #include "rtc_base/task_queue_libevent.h"
 #include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_queue_thread_pool.h"
 
 namespace webrtc {
 
@@ -24,10 +25,15 @@ std::unique_ptr<TaskQueueFactory> CreateDefaultTaskQueueFactory(
     const FieldTrialsView* field_trials_view) {
   AlwaysValidPointer<const FieldTrialsView, FieldTrialBasedConfig> field_trials(
       field_trials_view);
+  if (std::unique_ptr<TaskQueueFactory> thread_pool_factory =
+          CreateTaskQueueThreadPoolFactoryIfEnabled(*field_trials)) {
+    return thread_pool_factory;
+  }
   if (field_trials->IsEnabled("WebRTC-TaskQueue-ReplaceLibeventWithStdlib")) {
     RTC_LOG(LS_INFO) << "WebRTC-TaskQueue-ReplaceLibeventWithStdlib: "
                      << "using TaskQueueStdlibFactory.";
-    return CreateTaskQueueStdlibFactory();
+    return CreateTaskQueueStdlibFactory(
+        field_trials->IsEnabled("WebRTC-TaskQueue-CoalesceLowPrecision"));
   }
 
   RTC_LOG(LS_INFO) << "WebRTC-TaskQueue-ReplaceLibeventWithStdlib: "
@@ -12,6 +12,7 @@
 
 #include "api/task_queue/task_queue_test.h"
 #include "test/gtest.h"
+#include "test/scoped_key_value_config.h"
 
 namespace webrtc {
 namespace {
@@ -20,5 +21,16 @@ INSTANTIATE_TEST_SUITE_P(Default,
                          TaskQueueTest,
                          ::testing::Values(CreateDefaultTaskQueueFactory));
 
+std::unique_ptr<TaskQueueFactory> CreateDefaultThreadPoolFactory(
+    const FieldTrialsView*) {
+  test::ScopedKeyValueConfig field_trials(
+      "WebRTC-TaskQueue-ThreadPool/Enabled,threads:2/");
+  return CreateDefaultTaskQueueFactory(&field_trials);
+}
+
+INSTANTIATE_TEST_SUITE_P(DefaultWithThreadPool,
+                         TaskQueueTest,
+                         ::testing::Values(CreateDefaultThreadPoolFactory));
+
 }  // namespace
 }  // namespace webrtc
@@ -12,6 +12,7 @@
 #include "absl/base/attributes.h"
 #include "absl/base/config.h"
 #include "absl/functional/any_invocable.h"
+#include "api/location.h"
 #include "api/units/time_delta.h"
 #include "rtc_base/checks.h"
 
@@ -21,6 +22,13 @@ namespace webrtc {
 namespace {
 
 ABSL_CONST_INIT thread_local TaskQueueBase* current = nullptr;
+ABSL_CONST_INIT thread_local const Location* posting_location = nullptr;
+
+const Location* SetPostingLocation(const Location* location) {
+  const Location* previous = posting_location;
+  posting_location = location;
+  return previous;
+}
 
 }  // namespace
 
@@ -28,6 +36,10 @@ TaskQueueBase* TaskQueueBase::Current() {
   return current;
 }
 
+const Location* TaskQueueBase::PostingLocation() {
+  return posting_location;
+}
+
 TaskQueueBase::CurrentTaskQueueSetter::CurrentTaskQueueSetter(
     TaskQueueBase* task_queue)
     : previous_(current) {
@@ -58,12 +70,21 @@ pthread_key_t GetQueuePtrTls() {
   return g_queue_ptr_tls;
 }
 
+// Posting locations are only tracked with thread_local support.
+const Location* SetPostingLocation(const Location* location) {
+  return nullptr;
+}
+
 }  // namespace
 
 TaskQueueBase* TaskQueueBase::Current() {
   return static_cast<TaskQueueBase*>(pthread_getspecific(GetQueuePtrTls()));
 }
 
+const Location* TaskQueueBase::PostingLocation() {
+  return nullptr;
+}
+
 TaskQueueBase::CurrentTaskQueueSetter::CurrentTaskQueueSetter(
     TaskQueueBase* task_queue)
     : previous_(TaskQueueBase::Current()) {
@@ -79,3 +100,31 @@ TaskQueueBase::CurrentTaskQueueSetter::~CurrentTaskQueueSetter() {
 #else
 #error Unsupported platform
 #endif
+
+namespace webrtc {
+
+void TaskQueueBase::PostTask(absl::AnyInvocable<void() &&> task,
+                             const Location& location) {
+  const Location* previous = SetPostingLocation(&location);
+  PostTask(std::move(task));
+  SetPostingLocation(previous);
+}
+
+void TaskQueueBase::PostDelayedTask(absl::AnyInvocable<void() &&> task,
+                                    TimeDelta delay,
+                                    const Location& location) {
+  const Location* previous = SetPostingLocation(&location);
+  PostDelayedTask(std::move(task), delay);
+  SetPostingLocation(previous);
+}
+
+void TaskQueueBase::PostDelayedHighPrecisionTask(
+    absl::AnyInvocable<void() &&> task,
+    TimeDelta delay,
+    const Location& location) {
+  const Location* previous = SetPostingLocation(&location);
+  PostDelayedHighPrecisionTask(std::move(task), delay);
+  SetPostingLocation(previous);
+}
+
+}  // namespace webrtc
@@ -14,6 +14,7 @@
 #include <utility>
 
 #include "absl/functional/any_invocable.h"
+#include "api/location.h"
 #include "api/units/time_delta.h"
 #include "rtc_base/system/rtc_export.h"
 #include "rtc_base/thread_annotations.h"
@@ -103,6 +104,18 @@ class RTC_LOCKABLE RTC_EXPORT TaskQueueBase {
   virtual void PostDelayedHighPrecisionTask(absl::AnyInvocable<void() &&> task,
                                             TimeDelta delay) = 0;
 
+  // As PostTask(), PostDelayedTask() and PostDelayedHighPrecisionTask(), but
+  // attribute the task to `location`, typically `Location::Current()`. The
+  // location is reported to the TaskQueueMetricsObserver of queues that are
+  // instrumented, see task_queue_metrics.h.
+  void PostTask(absl::AnyInvocable<void() &&> task, const Location& location);
+  void PostDelayedTask(absl::AnyInvocable<void() &&> task,
+                       TimeDelta delay,
+                       const Location& location);
+  void PostDelayedHighPrecisionTask(absl::AnyInvocable<void() &&> task,
+                                    TimeDelta delay,
+                                    const Location& location);
+
   // As specified by `precision`, calls either PostDelayedTask() or
   // PostDelayedHighPrecisionTask().
   void PostDelayedTaskWithPrecision(DelayPrecision precision,
@@ -140,6 +153,13 @@ class RTC_LOCKABLE RTC_EXPORT TaskQueueBase {
   // Users of the TaskQueue should call Delete instead of directly deleting
   // this object.
   virtual ~TaskQueueBase() = default;
+
+ private:
+  friend class TaskQueueTaskRecorder;
+
+  // Returns the location passed to the Post*Task() call that is in progress on
+  // the current thread, or null if there is none.
+  static const Location* PostingLocation();
 };
 
 struct TaskQueueDeleter {
@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "api/task_queue/task_queue_metrics.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "api/task_queue/task_queue_base.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+std::atomic<TaskQueueMetricsObserver*> g_observer(nullptr);
+
+}  // namespace
+
+void SetTaskQueueMetricsObserver(TaskQueueMetricsObserver* observer) {
+  g_observer.store(observer, std::memory_order_release);
+}
+
+TaskQueueTaskRecorder::TaskQueueTaskRecorder(absl::string_view queue_name)
+    : queue_name_(queue_name) {}
+
+void TaskQueueTaskRecorder::SetQueueName(absl::string_view queue_name) {
+  queue_name_ = std::string(queue_name);
+}
+
+absl::AnyInvocable<void() &&> TaskQueueTaskRecorder::Wrap(
+    absl::AnyInvocable<void() &&> task,
+    TimeDelta delay) {
+  if (g_observer.load(std::memory_order_relaxed) == nullptr) {
+    return task;
+  }
+  const Location* posting_location = TaskQueueBase::PostingLocation();
+  Location location = posting_location ? *posting_location : Location();
+  int64_t due_us = rtc::TimeMicros() + delay.us();
+  queued_tasks_.fetch_add(1, std::memory_order_relaxed);
+  return [this, task = std::move(task), location, due_us]() mutable {
+    TaskQueueTaskMetrics metrics;
+    metrics.queue_depth = queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+    int64_t start_us = rtc::TimeMicros();
+    std::move(task)();
+    int64_t end_us = rtc::TimeMicros();
+    TaskQueueMetricsObserver* observer =
+        g_observer.load(std::memory_order_acquire);
+    if (observer == nullptr) {
+      return;
+    }
+    metrics.queue_name = queue_name_;
+    metrics.location = location;
+    // Delayed tasks may run slightly before they are due.
+    metrics.queueing_delay =
+        TimeDelta::Micros(std::max<int64_t>(start_us - due_us, 0));
+    metrics.execution_time = TimeDelta::Micros(end_us - start_us);
+    observer->OnTaskRun(metrics);
+  };
+}
+
+}  // namespace webrtc
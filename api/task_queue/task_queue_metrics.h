@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef API_TASK_QUEUE_TASK_QUEUE_METRICS_H_
+#define API_TASK_QUEUE_TASK_QUEUE_METRICS_H_
+
+#include <atomic>
+#include <string>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "api/location.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace webrtc {
+
+// Opt-in instrumentation of task queues. While a TaskQueueMetricsObserver is
+// installed, the task queue implementations in WebRTC (rtc::Thread and the
+// task queues created by the default TaskQueueFactory) report every task
+// posted to them when it has run.
+
+struct TaskQueueTaskMetrics {
+  // Name the queue was created with.
+  absl::string_view queue_name;
+  // Where the task was posted from, if it was posted with one of the
+  // TaskQueueBase::Post*Task() overloads that take a location.
+  Location location;
+  // Time from when the task was due, i.e. when it was posted plus its delay,
+  // until it started to run.
+  TimeDelta queueing_delay = TimeDelta::Zero();
+  TimeDelta execution_time = TimeDelta::Zero();
+  // Number of tasks posted to the queue that had not started to run when the
+  // task started, including the task itself. Only tasks posted while an
+  // observer was installed are counted.
+  int queue_depth = 0;
+};
+
+class TaskQueueMetricsObserver {
+ public:
+  virtual ~TaskQueueMetricsObserver() = default;
+
+  // Called on the task queue after each task ran.
+  virtual void OnTaskRun(const TaskQueueTaskMetrics& metrics) = 0;
+};
+
+// Installs `observer`, or uninstalls the current one if null. Tasks posted
+// while an observer is installed are reported to the observer installed when
+// they finish, if any. Tasks that are running while an observer is uninstalled
+// may still report to it.
+RTC_EXPORT void SetTaskQueueMetricsObserver(
+    TaskQueueMetricsObserver* observer);
+
+// Used by TaskQueueBase implementations to report their tasks to the
+// installed TaskQueueMetricsObserver. Tasks it wrapped must not run after it
+// is destroyed.
+class RTC_EXPORT TaskQueueTaskRecorder {
+ public:
+  explicit TaskQueueTaskRecorder(absl::string_view queue_name);
+  TaskQueueTaskRecorder(const TaskQueueTaskRecorder&) = delete;
+  TaskQueueTaskRecorder& operator=(const TaskQueueTaskRecorder&) = delete;
+
+  // Must not be called while tasks of the queue run.
+  void SetQueueName(absl::string_view queue_name);
+
+  // To be called by Post*Task(), on the posting thread. Returns `task`
+  // unchanged if no observer is installed. Otherwise returns a task that runs
+  // `task` and reports it.
+  absl::AnyInvocable<void() &&> Wrap(absl::AnyInvocable<void() &&> task,
+                                     TimeDelta delay = TimeDelta::Zero());
+
+ private:
+  std::string queue_name_;
+  std::atomic<int> queued_tasks_{0};
+};
+
+}  // namespace webrtc
+
+#endif  // API_TASK_QUEUE_TASK_QUEUE_METRICS_H_
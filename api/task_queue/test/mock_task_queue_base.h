@@ -20,6 +20,9 @@ namespace webrtc {
 
 class MockTaskQueueBase : public TaskQueueBase {
  public:
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   MOCK_METHOD(void, Delete, (), (override));
   MOCK_METHOD(void, PostTask, (absl::AnyInvocable<void() &&>), (override));
   MOCK_METHOD(void,
@@ -49,6 +49,42 @@ uint32_t ReduceTransactionId(absl::string_view transaction_id) {
   return result;
 }
 
+// Verifies the MESSAGE-INTEGRITY (or MESSAGE-INTEGRITY-32) attribute of size
+// `mi_attr_size` at offset `mi_pos` of the message in `data`. The HMAC covers
+// the message up to the Message Integrity attribute, with the length in the
+// header adjusted as if Message Integrity was the last attribute, in case the
+// message has other attributes after it.
+//      0                   1                   2                   3
+//      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//     |0 0|     STUN Message Type     |         Message Length        |
+//     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// The adjusted length is hashed from a separate buffer, so that the message
+// does not have to be copied.
+bool VerifyMessageIntegrityAt(rtc::Hmac& hmac,
+                              const char* data,
+                              size_t mi_pos,
+                              size_t mi_attr_size) {
+  uint8_t adjusted_len[2];
+  rtc::SetBE16(adjusted_len,
+               static_cast<uint16_t>(mi_pos + kStunAttributeHeaderSize +
+                                     mi_attr_size - kStunHeaderSize));
+  hmac.Update(data, 2);
+  hmac.Update(adjusted_len, sizeof(adjusted_len));
+  hmac.Update(data + 4, mi_pos - 4);
+
+  char computed[kStunMessageIntegritySize];
+  size_t ret = hmac.Finish(computed, sizeof(computed));
+  RTC_DCHECK(ret == sizeof(computed));
+  if (ret != sizeof(computed)) {
+    return false;
+  }
+
+  // Comparing the calculated HMAC with the one present in the message.
+  return memcmp(data + mi_pos + kStunAttributeHeaderSize, computed,
+                mi_attr_size) == 0;
+}
+
 // Check the maximum length of a BYTE_STRING attribute against specifications.
 bool LengthValid(int type, int length) {
   // "Less than 509 bytes" is intended to indicate a maximum of 127
@@ -236,13 +272,37 @@ const StunUInt16ListAttribute* StunMessage::GetUnknownAttributes() const {
       GetAttribute(STUN_ATTR_UNKNOWN_ATTRIBUTES));
 }
 
+StunMessageIntegrityKey::StunMessageIntegrityKey(absl::string_view password)
+    : password_(password),
+      hmac_(rtc::HmacFactory::Create(rtc::DIGEST_SHA_1, password)) {}
+
+StunMessageIntegrityKey::~StunMessageIntegrityKey() = default;
+
+StunMessageIntegrityKey::StunMessageIntegrityKey(StunMessageIntegrityKey&&) =
+    default;
+StunMessageIntegrityKey& StunMessageIntegrityKey::operator=(
+    StunMessageIntegrityKey&&) = default;
+
+void StunMessageIntegrityKey::SetPassword(absl::string_view password) {
+  if (hmac_ && password == password_) {
+    return;
+  }
+  password_ = std::string(password);
+  hmac_ = rtc::HmacFactory::Create(rtc::DIGEST_SHA_1, password);
+}
+
 StunMessage::IntegrityStatus StunMessage::ValidateMessageIntegrity(
     const std::string& password) {
-  password_ = password;
+  return ValidateMessageIntegrity(StunMessageIntegrityKey(password));
+}
+
+StunMessage::IntegrityStatus StunMessage::ValidateMessageIntegrity(
+    const StunMessageIntegrityKey& key) {
+  password_ = key.password();
   if (GetByteString(STUN_ATTR_MESSAGE_INTEGRITY)) {
     if (ValidateMessageIntegrityOfType(
             STUN_ATTR_MESSAGE_INTEGRITY, kStunMessageIntegritySize,
-            buffer_.c_str(), buffer_.size(), password)) {
+            buffer_.c_str(), buffer_.size(), key)) {
       integrity_ = IntegrityStatus::kIntegrityOk;
     } else {
       integrity_ = IntegrityStatus::kIntegrityBad;
@@ -250,7 +310,7 @@ StunMessage::IntegrityStatus StunMessage::ValidateMessageIntegrity(
   } else if (GetByteString(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32)) {
     if (ValidateMessageIntegrityOfType(
             STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32, kStunMessageIntegrity32Size,
-            buffer_.c_str(), buffer_.size(), password)) {
+            buffer_.c_str(), buffer_.size(), key)) {
       integrity_ = IntegrityStatus::kIntegrityOk;
     } else {
       integrity_ = IntegrityStatus::kIntegrityBad;
@@ -266,7 +326,7 @@ bool StunMessage::ValidateMessageIntegrity(const char* data,
                                            const std::string& password) {
   return ValidateMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
                                         kStunMessageIntegritySize, data, size,
-                                        password);
+                                        StunMessageIntegrityKey(password));
 }
 
 bool StunMessage::ValidateMessageIntegrity32(const char* data,
@@ -274,16 +334,17 @@ bool StunMessage::ValidateMessageIntegrity32(const char* data,
                                              const std::string& password) {
   return ValidateMessageIntegrityOfType(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32,
                                         kStunMessageIntegrity32Size, data, size,
-                                        password);
+                                        StunMessageIntegrityKey(password));
 }
 
 // Verifies a STUN message has a valid MESSAGE-INTEGRITY attribute, using the
 // procedure outlined in RFC 5389, section 15.4.
-bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
-                                                 size_t mi_attr_size,
-                                                 const char* data,
-                                                 size_t size,
-                                                 const std::string& password) {
+bool StunMessage::ValidateMessageIntegrityOfType(
+    int mi_attr_type,
+    size_t mi_attr_size,
+    const char* data,
+    size_t size,
+    const StunMessageIntegrityKey& key) {
   RTC_DCHECK(mi_attr_size <= kStunMessageIntegritySize);
 
   // Verifying the size of the message.
@@ -328,53 +389,35 @@ bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + mi_attr_size) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset =
-        size - (mi_pos + kStunAttributeHeaderSize + mi_attr_size);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
-  char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
+  if (!key.hmac_) {
     return false;
   }
 
-  // Comparing the calculated HMAC with the one present in the message.
-  return memcmp(data + current_pos + kStunAttributeHeaderSize, hmac,
-                mi_attr_size) == 0;
+  return VerifyMessageIntegrityAt(*key.hmac_, data, current_pos, mi_attr_size);
 }
 
 bool StunMessage::AddMessageIntegrity(absl::string_view password) {
+  return AddMessageIntegrity(StunMessageIntegrityKey(password));
+}
+
+bool StunMessage::AddMessageIntegrity(const StunMessageIntegrityKey& key) {
   return AddMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
-                                   kStunMessageIntegritySize, password);
+                                   kStunMessageIntegritySize, key);
 }
 
 bool StunMessage::AddMessageIntegrity32(absl::string_view password) {
+  return AddMessageIntegrity32(StunMessageIntegrityKey(password));
+}
+
+bool StunMessage::AddMessageIntegrity32(const StunMessageIntegrityKey& key) {
   return AddMessageIntegrityOfType(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32,
-                                   kStunMessageIntegrity32Size, password);
+                                   kStunMessageIntegrity32Size, key);
 }
 
-bool StunMessage::AddMessageIntegrityOfType(int attr_type,
-                                            size_t attr_size,
-                                            absl::string_view key) {
+bool StunMessage::AddMessageIntegrityOfType(
+    int attr_type,
+    size_t attr_size,
+    const StunMessageIntegrityKey& key) {
   // Add the attribute with a dummy value. Since this is a known attribute, it
   // can't fail.
   RTC_DCHECK(attr_size <= kStunMessageIntegritySize);
@@ -391,9 +434,11 @@ bool StunMessage::AddMessageIntegrityOfType(int attr_type,
   int msg_len_for_hmac = static_cast<int>(
       buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length());
   char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, key.data(), key.size(), buf.Data(),
-                       msg_len_for_hmac, hmac, sizeof(hmac));
+  size_t ret = 0;
+  if (key.hmac_) {
+    key.hmac_->Update(buf.Data(), msg_len_for_hmac);
+    ret = key.hmac_->Finish(hmac, sizeof(hmac));
+  }
   RTC_DCHECK(ret == sizeof(hmac));
   if (ret != sizeof(hmac)) {
     RTC_LOG(LS_ERROR) << "HMAC computation failed. Message-Integrity "
@@ -403,7 +448,7 @@ bool StunMessage::AddMessageIntegrityOfType(int attr_type,
 
   // Insert correct HMAC into the attribute.
   msg_integrity_attr->CopyBytes(hmac, attr_size);
-  password_ = std::string(key);
+  password_ = key.password();
   integrity_ = IntegrityStatus::kIntegrityOk;
   return true;
 }
@@ -1400,6 +1445,212 @@ StunMessage* IceMessage::CreateNew() const {
   return new IceMessage();
 }
 
+// static
+absl::optional<IceBindingRequestView> IceBindingRequestView::Parse(
+    const char* data,
+    size_t size) {
+  if (size < kStunHeaderSize || size % 4 != 0 ||
+      rtc::GetBE16(data) != STUN_BINDING_REQUEST ||
+      rtc::GetBE16(data + 2) != size - kStunHeaderSize ||
+      rtc::GetBE32(data + kStunTransactionIdOffset - kStunMagicCookieLength) !=
+          kStunMagicCookie) {
+    return absl::nullopt;
+  }
+
+  IceBindingRequestView view(data, size);
+  bool has_username = false;
+  bool has_priority = false;
+  bool has_fingerprint = false;
+  size_t pos = kStunHeaderSize;
+  while (pos < size) {
+    // FINGERPRINT must be the last attribute.
+    if (has_fingerprint || size - pos < kStunAttributeHeaderSize) {
+      return absl::nullopt;
+    }
+    const uint16_t attr_type = rtc::GetBE16(data + pos);
+    const uint16_t attr_length = rtc::GetBE16(data + pos + 2);
+    const size_t padded_length = (attr_length + 3u) & ~3u;
+    if (size - pos - kStunAttributeHeaderSize < padded_length) {
+      return absl::nullopt;
+    }
+    // Attributes following MESSAGE-INTEGRITY are not covered by it, so only
+    // FINGERPRINT is accepted there.
+    if (view.integrity_pos_ != 0 && attr_type != STUN_ATTR_FINGERPRINT) {
+      return absl::nullopt;
+    }
+
+    const char* value = data + pos + kStunAttributeHeaderSize;
+    switch (attr_type) {
+      case STUN_ATTR_USERNAME:
+        if (has_username || attr_length > k127Utf8CharactersLengthInBytes) {
+          return absl::nullopt;
+        }
+        has_username = true;
+        view.username_ = absl::string_view(value, attr_length);
+        break;
+      case STUN_ATTR_PRIORITY:
+        if (has_priority || attr_length != StunUInt32Attribute::SIZE) {
+          return absl::nullopt;
+        }
+        has_priority = true;
+        break;
+      case STUN_ATTR_ICE_CONTROLLING:
+        if (view.ice_controlling_ || attr_length != StunUInt64Attribute::SIZE) {
+          return absl::nullopt;
+        }
+        view.ice_controlling_ = true;
+        break;
+      case STUN_ATTR_ICE_CONTROLLED:
+        if (view.ice_controlled_ || attr_length != StunUInt64Attribute::SIZE) {
+          return absl::nullopt;
+        }
+        view.ice_controlled_ = true;
+        break;
+      case STUN_ATTR_USE_CANDIDATE:
+        if (view.use_candidate_ || attr_length != 0) {
+          return absl::nullopt;
+        }
+        view.use_candidate_ = true;
+        break;
+      case STUN_ATTR_NOMINATION:
+        if (view.nomination_ || attr_length != StunUInt32Attribute::SIZE) {
+          return absl::nullopt;
+        }
+        view.nomination_ = rtc::GetBE32(value);
+        break;
+      case STUN_ATTR_GOOG_NETWORK_INFO:
+        if (view.network_info_ || attr_length != StunUInt32Attribute::SIZE) {
+          return absl::nullopt;
+        }
+        view.network_info_ = rtc::GetBE32(value);
+        break;
+      case STUN_ATTR_MESSAGE_INTEGRITY:
+        if (attr_length != kStunMessageIntegritySize) {
+          return absl::nullopt;
+        }
+        view.integrity_pos_ = pos;
+        break;
+      case STUN_ATTR_FINGERPRINT:
+        if (attr_length != StunUInt32Attribute::SIZE ||
+            (rtc::GetBE32(value) ^ STUN_FINGERPRINT_XOR_VALUE) !=
+                rtc::ComputeCrc32(data, pos)) {
+          return absl::nullopt;
+        }
+        has_fingerprint = true;
+        break;
+      default:
+        return absl::nullopt;
+    }
+    pos += kStunAttributeHeaderSize + padded_length;
+  }
+
+  // Requests with both roles are left to the role conflict handling of the
+  // full parser.
+  if (!has_username || view.integrity_pos_ == 0 || !has_fingerprint ||
+      (view.ice_controlling_ && view.ice_controlled_)) {
+    return absl::nullopt;
+  }
+  return view;
+}
+
+absl::string_view IceBindingRequestView::transaction_id() const {
+  return absl::string_view(data_ + kStunTransactionIdOffset,
+                           kStunTransactionIdLength);
+}
+
+uint32_t IceBindingRequestView::reduced_transaction_id() const {
+  return ReduceTransactionId(transaction_id());
+}
+
+bool IceBindingRequestView::ValidateMessageIntegrity(
+    const StunMessageIntegrityKey& key) const {
+  if (!key.hmac_) {
+    return false;
+  }
+  return VerifyMessageIntegrityAt(*key.hmac_, data_, integrity_pos_,
+                                  kStunMessageIntegritySize);
+}
+
+size_t IceBindingRequestView::WriteSuccessResponse(
+    const rtc::SocketAddress& mapped_address,
+    const StunMessageIntegrityKey& key,
+    rtc::ArrayView<char> buffer) const {
+  StunAddressFamily family;
+  size_t address_length;
+  switch (mapped_address.family()) {
+    case AF_INET:
+      family = STUN_ADDRESS_IPV4;
+      address_length = StunAddressAttribute::SIZE_IP4;
+      break;
+    case AF_INET6:
+      family = STUN_ADDRESS_IPV6;
+      address_length = StunAddressAttribute::SIZE_IP6;
+      break;
+    default:
+      return 0;
+  }
+  const size_t integrity_pos =
+      kStunHeaderSize + kStunAttributeHeaderSize + address_length;
+  const size_t fingerprint_pos =
+      integrity_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize;
+  const size_t size =
+      fingerprint_pos + kStunAttributeHeaderSize + StunUInt32Attribute::SIZE;
+  RTC_DCHECK_LE(size, kMaxSuccessResponseSize);
+  if (buffer.size() < size || !key.hmac_) {
+    return 0;
+  }
+  char* out = buffer.data();
+
+  // The header, with the length as if MESSAGE-INTEGRITY was the last
+  // attribute, and the magic cookie and transaction id of the request.
+  rtc::SetBE16(out, STUN_BINDING_RESPONSE);
+  rtc::SetBE16(out + 2,
+               static_cast<uint16_t>(fingerprint_pos - kStunHeaderSize));
+  memcpy(out + 4, data_ + 4, kStunMagicCookieLength + kStunTransactionIdLength);
+
+  // XOR-MAPPED-ADDRESS. The port is XORed with the upper half of the magic
+  // cookie, and the address with the magic cookie and transaction id, which
+  // follow each other in the header.
+  char* attr = out + kStunHeaderSize;
+  rtc::SetBE16(attr, STUN_ATTR_XOR_MAPPED_ADDRESS);
+  rtc::SetBE16(attr + 2, static_cast<uint16_t>(address_length));
+  rtc::Set8(attr, 4, 0);
+  rtc::Set8(attr, 5, family);
+  rtc::SetBE16(attr + 6, mapped_address.port() ^ (kStunMagicCookie >> 16));
+  char* address = attr + 8;
+  if (family == STUN_ADDRESS_IPV4) {
+    in_addr v4addr = mapped_address.ipaddr().ipv4_address();
+    memcpy(address, &v4addr, sizeof(v4addr));
+  } else {
+    in6_addr v6addr = mapped_address.ipaddr().ipv6_address();
+    memcpy(address, &v6addr, sizeof(v6addr));
+  }
+  for (size_t i = 0; i < address_length - 4; ++i) {
+    address[i] ^= out[4 + i];
+  }
+
+  // MESSAGE-INTEGRITY.
+  attr = out + integrity_pos;
+  rtc::SetBE16(attr, STUN_ATTR_MESSAGE_INTEGRITY);
+  rtc::SetBE16(attr + 2, kStunMessageIntegritySize);
+  key.hmac_->Update(out, integrity_pos);
+  if (key.hmac_->Finish(attr + kStunAttributeHeaderSize,
+                        kStunMessageIntegritySize) !=
+      kStunMessageIntegritySize) {
+    return 0;
+  }
+
+  // FINGERPRINT, which covers the final length.
+  rtc::SetBE16(out + 2, static_cast<uint16_t>(size - kStunHeaderSize));
+  attr = out + fingerprint_pos;
+  rtc::SetBE16(attr, STUN_ATTR_FINGERPRINT);
+  rtc::SetBE16(attr + 2, StunUInt32Attribute::SIZE);
+  rtc::SetBE32(attr + kStunAttributeHeaderSize,
+               rtc::ComputeCrc32(out, fingerprint_pos) ^
+                   STUN_FINGERPRINT_XOR_VALUE);
+  return size;
+}
+
 std::unique_ptr<StunMessage> StunMessage::Clone() const {
   std::unique_ptr<StunMessage> copy(CreateNew());
   if (!copy) {
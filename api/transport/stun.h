@@ -23,9 +23,11 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "rtc_base/byte_buffer.h"
 #include "rtc_base/ip_address.h"
+#include "rtc_base/message_digest.h"
 #include "rtc_base/socket_address.h"
 
 namespace cricket {
@@ -139,6 +141,33 @@ class StunUInt32Attribute;
 class StunUInt64Attribute;
 class StunXorAddressAttribute;
 
+// A MESSAGE-INTEGRITY password together with its HMAC-SHA1 key schedule.
+// Signing and verifying messages with a key kept per ICE credential, instead
+// of with the password, avoids redoing the HMAC key setup for every message.
+// Not thread safe.
+class StunMessageIntegrityKey {
+ public:
+  StunMessageIntegrityKey() : StunMessageIntegrityKey("") {}
+  explicit StunMessageIntegrityKey(absl::string_view password);
+  ~StunMessageIntegrityKey();
+
+  StunMessageIntegrityKey(StunMessageIntegrityKey&&);
+  StunMessageIntegrityKey& operator=(StunMessageIntegrityKey&&);
+
+  // Changes the password. The key schedule is only recomputed if `password`
+  // differs from the current one.
+  void SetPassword(absl::string_view password);
+
+  const std::string& password() const { return password_; }
+
+ private:
+  friend class IceBindingRequestView;
+  friend class StunMessage;
+
+  std::string password_;
+  std::unique_ptr<rtc::Hmac> hmac_;
+};
+
 // Records a complete STUN/TURN message.  Each message consists of a type and
 // any number of attributes.  Each attribute is parsed into an instance of an
 // appropriate class (see above).  The Get* methods will return instances of
@@ -216,6 +245,7 @@ class StunMessage {
   // Validates that a STUN message has a correct MESSAGE-INTEGRITY value.
   // This uses the buffered raw-format message stored by Read().
   IntegrityStatus ValidateMessageIntegrity(const std::string& password);
+  IntegrityStatus ValidateMessageIntegrity(const StunMessageIntegrityKey& key);
 
   // Returns the current integrity status of the message.
   IntegrityStatus integrity() const { return integrity_; }
@@ -234,10 +264,12 @@ class StunMessage {
 
   // Adds a MESSAGE-INTEGRITY attribute that is valid for the current message.
   bool AddMessageIntegrity(absl::string_view password);
+  bool AddMessageIntegrity(const StunMessageIntegrityKey& key);
 
   // Adds a STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32 attribute that is valid for the
   // current message.
   bool AddMessageIntegrity32(absl::string_view password);
+  bool AddMessageIntegrity32(const StunMessageIntegrityKey& key);
 
   // Verify that a buffer has stun magic cookie and one of the specified
   // methods. Note that it does not check for the existance of FINGERPRINT.
@@ -316,12 +348,13 @@ class StunMessage {
   static bool IsValidTransactionId(absl::string_view transaction_id);
   bool AddMessageIntegrityOfType(int mi_attr_type,
                                  size_t mi_attr_size,
-                                 absl::string_view key);
-  static bool ValidateMessageIntegrityOfType(int mi_attr_type,
-                                             size_t mi_attr_size,
-                                             const char* data,
-                                             size_t size,
-                                             const std::string& password);
+                                 const StunMessageIntegrityKey& key);
+  static bool ValidateMessageIntegrityOfType(
+      int mi_attr_type,
+      size_t mi_attr_size,
+      const char* data,
+      size_t size,
+      const StunMessageIntegrityKey& key);
 
   uint16_t type_ = STUN_INVALID_MESSAGE_TYPE;
   uint16_t length_ = 0;
@@ -787,6 +820,60 @@ class IceMessage : public StunMessage {
   StunMessage* CreateNew() const override;
 };
 
+// A read-only view of a serialized ICE connectivity check, i.e. a binding
+// request with the attributes a regular ICE agent sends. Parsing and answering
+// such a request through this class does not allocate, unlike IceMessage.
+// Anything unusual, like unknown or duplicate attributes, attributes after
+// MESSAGE-INTEGRITY other than FINGERPRINT, or a legacy transaction id, makes
+// Parse() fail, and such requests should be handled with IceMessage instead.
+// The view refers to the parsed data, which must outlive it.
+class IceBindingRequestView {
+ public:
+  // Size of the largest response WriteSuccessResponse() writes, i.e. one with
+  // an IPv6 XOR-MAPPED-ADDRESS.
+  static constexpr size_t kMaxSuccessResponseSize = 76;
+
+  // Returns a view of `data` if it is a binding request which the view can
+  // represent, with USERNAME, MESSAGE-INTEGRITY and a valid FINGERPRINT.
+  static absl::optional<IceBindingRequestView> Parse(const char* data,
+                                                     size_t size);
+
+  absl::string_view transaction_id() const;
+  uint32_t reduced_transaction_id() const;
+  absl::string_view username() const { return username_; }
+  bool ice_controlling() const { return ice_controlling_; }
+  bool ice_controlled() const { return ice_controlled_; }
+  bool use_candidate() const { return use_candidate_; }
+  absl::optional<uint32_t> nomination() const { return nomination_; }
+  absl::optional<uint32_t> network_info() const { return network_info_; }
+
+  // Verifies the MESSAGE-INTEGRITY attribute with `key`.
+  bool ValidateMessageIntegrity(const StunMessageIntegrityKey& key) const;
+
+  // Writes a STUN_BINDING_RESPONSE with XOR-MAPPED-ADDRESS `mapped_address`,
+  // MESSAGE-INTEGRITY signed with `key` and FINGERPRINT to `buffer`, the same
+  // way StunMessage would. Returns the size of the response, or 0 if `buffer`
+  // is too small or the address family is not supported.
+  size_t WriteSuccessResponse(const rtc::SocketAddress& mapped_address,
+                              const StunMessageIntegrityKey& key,
+                              rtc::ArrayView<char> buffer) const;
+
+ private:
+  IceBindingRequestView(const char* data, size_t size)
+      : data_(data), size_(size) {}
+
+  const char* data_;
+  size_t size_;
+  // Offset of the MESSAGE-INTEGRITY attribute.
+  size_t integrity_pos_ = 0;
+  absl::string_view username_;
+  bool ice_controlling_ = false;
+  bool ice_controlled_ = false;
+  bool use_candidate_ = false;
+  absl::optional<uint32_t> nomination_;
+  absl::optional<uint32_t> network_info_;
+};
+
 }  // namespace cricket
 
 #endif  // API_TRANSPORT_STUN_H_
@@ -1263,6 +1263,163 @@ TEST_F(StunTest, AddMessageIntegrity) {
       kRfc5769SampleMsgPassword));
 }
 
+// Check that a key reused for several messages gives the same results as
+// the password.
+TEST_F(StunTest, MessageIntegrityWithKey) {
+  StunMessageIntegrityKey key(kRfc5769SampleMsgPassword);
+  EXPECT_EQ(kRfc5769SampleMsgPassword, key.password());
+
+  IceMessage request;
+  ReadStunMessage(&request, kRfc5769SampleRequest);
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityOk,
+            request.ValidateMessageIntegrity(key));
+  EXPECT_EQ(kRfc5769SampleMsgPassword, request.password());
+  IceMessage response;
+  ReadStunMessage(&response, kRfc5769SampleResponse);
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityOk,
+            response.ValidateMessageIntegrity(key));
+
+  IceMessage msg;
+  rtc::ByteBufferReader buf(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+      sizeof(kRfc5769SampleRequestWithoutMI));
+  EXPECT_TRUE(msg.Read(&buf));
+  EXPECT_TRUE(msg.AddMessageIntegrity(key));
+  const StunByteStringAttribute* mi_attr =
+      msg.GetByteString(STUN_ATTR_MESSAGE_INTEGRITY);
+  EXPECT_EQ(
+      0, memcmp(mi_attr->bytes(), kCalculatedHmac1, sizeof(kCalculatedHmac1)));
+
+  key.SetPassword("InvalidPassword");
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityBad,
+            request.ValidateMessageIntegrity(key));
+  key.SetPassword(kRfc5769SampleMsgPassword);
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityOk,
+            request.ValidateMessageIntegrity(key));
+}
+
+// Serializes `msg` into a string.
+static std::string WriteStunMessage(const StunMessage& msg) {
+  rtc::ByteBufferWriter buf;
+  EXPECT_TRUE(msg.Write(&buf));
+  return std::string(buf.Data(), buf.Length());
+}
+
+TEST_F(StunTest, IceBindingRequestViewParsesIceConnectivityCheck) {
+  IceMessage request(STUN_BINDING_REQUEST);
+  request.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, "rfrg:lfrg"));
+  request.AddAttribute(std::make_unique<StunUInt64Attribute>(
+      STUN_ATTR_ICE_CONTROLLING, 0x0123456789abcdef));
+  request.AddAttribute(
+      std::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+  request.AddAttribute(
+      std::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 0x6e0001ff));
+  request.AddAttribute(
+      std::make_unique<StunUInt32Attribute>(STUN_ATTR_NOMINATION, 3));
+  request.AddAttribute(std::make_unique<StunUInt32Attribute>(
+      STUN_ATTR_GOOG_NETWORK_INFO, 0x00010032));
+  request.AddMessageIntegrity(kRfc5769SampleMsgPassword);
+  request.AddFingerprint();
+  const std::string packet = WriteStunMessage(request);
+
+  absl::optional<IceBindingRequestView> view =
+      IceBindingRequestView::Parse(packet.data(), packet.size());
+  ASSERT_TRUE(view);
+  EXPECT_EQ(request.transaction_id(), view->transaction_id());
+  EXPECT_EQ(request.reduced_transaction_id(), view->reduced_transaction_id());
+  EXPECT_EQ("rfrg:lfrg", view->username());
+  EXPECT_TRUE(view->ice_controlling());
+  EXPECT_FALSE(view->ice_controlled());
+  EXPECT_TRUE(view->use_candidate());
+  EXPECT_EQ(3u, view->nomination());
+  EXPECT_EQ(0x00010032u, view->network_info());
+
+  StunMessageIntegrityKey key(kRfc5769SampleMsgPassword);
+  EXPECT_TRUE(view->ValidateMessageIntegrity(key));
+  EXPECT_FALSE(view->ValidateMessageIntegrity(
+      StunMessageIntegrityKey("InvalidPassword")));
+
+  // The response is the same as the one written by StunMessage.
+  for (const rtc::SocketAddress& address :
+       {rtc::SocketAddress(rtc::IPAddress(kIPv4TestAddress1),
+                           kTestMessagePort1),
+        rtc::SocketAddress(rtc::IPAddress(kIPv6TestAddress1),
+                           kTestMessagePort2)}) {
+    StunMessage response(STUN_BINDING_RESPONSE, request.transaction_id());
+    response.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_MAPPED_ADDRESS, address));
+    response.AddMessageIntegrity(key);
+    response.AddFingerprint();
+
+    char buffer[IceBindingRequestView::kMaxSuccessResponseSize];
+    size_t size = view->WriteSuccessResponse(address, key, buffer);
+    EXPECT_EQ(WriteStunMessage(response), std::string(buffer, size));
+    EXPECT_EQ(0u, view->WriteSuccessResponse(
+                      address, key, rtc::ArrayView<char>(buffer, size - 1)));
+  }
+}
+
+TEST_F(StunTest, IceBindingRequestViewRejectsUnusualMessages) {
+  auto parse = [](const std::string& packet) {
+    return IceBindingRequestView::Parse(packet.data(), packet.size());
+  };
+  auto create_request = [] {
+    auto request = std::make_unique<IceMessage>(STUN_BINDING_REQUEST);
+    request->AddAttribute(std::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, "rfrg:lfrg"));
+    return request;
+  };
+
+  std::unique_ptr<IceMessage> request = create_request();
+  request->AddMessageIntegrity(kRfc5769SampleMsgPassword);
+  request->AddFingerprint();
+  std::string packet = WriteStunMessage(*request);
+  EXPECT_TRUE(parse(packet));
+  // Corrupted fingerprint.
+  packet[packet.size() - 1] ^= 1;
+  EXPECT_FALSE(parse(packet));
+
+  // Unknown attributes, here the SOFTWARE attribute of the RFC 5769 sample.
+  EXPECT_FALSE(IceBindingRequestView::Parse(
+      reinterpret_cast<const char*>(kRfc5769SampleRequest),
+      sizeof(kRfc5769SampleRequest)));
+
+  // Missing fingerprint.
+  request = create_request();
+  request->AddMessageIntegrity(kRfc5769SampleMsgPassword);
+  EXPECT_FALSE(parse(WriteStunMessage(*request)));
+
+  // Missing message integrity.
+  request = create_request();
+  request->AddFingerprint();
+  EXPECT_FALSE(parse(WriteStunMessage(*request)));
+
+  // An attribute between MESSAGE-INTEGRITY and FINGERPRINT.
+  request = create_request();
+  request->AddMessageIntegrity(kRfc5769SampleMsgPassword);
+  request->AddAttribute(
+      std::make_unique<StunUInt32Attribute>(STUN_ATTR_NOMINATION, 1));
+  request->AddFingerprint();
+  EXPECT_FALSE(parse(WriteStunMessage(*request)));
+
+  // Duplicate attributes.
+  request = create_request();
+  request->AddAttribute(
+      std::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+  request->AddAttribute(
+      std::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+  request->AddMessageIntegrity(kRfc5769SampleMsgPassword);
+  request->AddFingerprint();
+  EXPECT_FALSE(parse(WriteStunMessage(*request)));
+
+  // Not a binding request.
+  StunMessage response(STUN_BINDING_RESPONSE);
+  response.AddMessageIntegrity(kRfc5769SampleMsgPassword);
+  response.AddFingerprint();
+  EXPECT_FALSE(parse(WriteStunMessage(response)));
+}
+
 // Check our STUN message validation code against the RFC5769 test messages.
 TEST_F(StunTest, ValidateMessageIntegrity32) {
   // Try the messages from RFC 5769.
@@ -23,6 +23,7 @@
 #include "absl/functional/bind_front.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "api/location.h"
 #include "api/rtc_event_log/rtc_event_log.h"
 #include "api/sequence_checker.h"
 #include "api/task_queue/pending_task_safety_flag.h"
@@ -1436,7 +1437,8 @@ void Call::DeliverRtcp(MediaType media_type, rtc::CopyOnWriteBuffer packet) {
           event_log_->Log(std::make_unique<RtcEventRtcpPacketIncoming>(
               rtc::MakeArrayView(packet.cdata(), packet.size())));
         }
-      }));
+      }),
+      Location::Current());
 }
 
 PacketReceiver::DeliveryStatus Call::DeliverRtp(MediaType media_type,
@@ -1452,9 +1454,10 @@ PacketReceiver::DeliveryStatus Call::DeliverRtp(MediaType media_type,
   if (packet_time_us != -1) {
     if (receive_time_calculator_) {
       // Repair packet_time_us for clock resets by comparing a new read of
-      // the same clock (TimeUTCMicros) to a monotonic clock reading.
+      // the same clock (TimeMicros, which AsyncUDPSocket translates kernel
+      // receive timestamps to) to a monotonic clock reading.
       packet_time_us = receive_time_calculator_->ReconcileReceiveTimes(
-          packet_time_us, rtc::TimeUTCMicros(), clock_->TimeInMicroseconds());
+          packet_time_us, rtc::TimeMicros(), clock_->TimeInMicroseconds());
     }
     parsed_packet.set_arrival_time(Timestamp::Micros(packet_time_us));
   } else {
@@ -10,7 +10,7 @@
 
 #include "media/base/media_channel.h"
 
-#include "media/base/rtp_utils.h"
+#include "api/location.h"
 
 namespace cricket {
 using webrtc::FrameDecryptorInterface;
@@ -93,6 +93,12 @@ bool MediaChannel::HasNetworkInterface() const {
   return network_interface_ != nullptr;
 }
 
+void MediaChannel::SetPacketBufferReservation(size_t headroom,
+                                              size_t tailroom) {
+  packet_headroom_.store(headroom, std::memory_order_relaxed);
+  packet_tailroom_.store(tailroom, std::memory_order_relaxed);
+}
+
 void MediaChannel::SetEncoderToPacketizerFrameTransformer(
     uint32_t ssrc,
     rtc::scoped_refptr<FrameTransformerInterface> frame_transformer) {}
@@ -162,6 +168,13 @@ bool MediaChannel::DoSendPacket(rtc::CopyOnWriteBuffer* packet,
                  : network_interface_->SendRtcp(packet, options);
 }
 
+rtc::CopyOnWriteBuffer MediaChannel::CreatePacketBuffer(const uint8_t* data,
+                                                       size_t len) const {
+  return rtc::CopyOnWriteBuffer::CreatePooled(
+      data, len, len + packet_tailroom_.load(std::memory_order_relaxed),
+      packet_headroom_.load(std::memory_order_relaxed));
+}
+
 void MediaChannel::SendRtp(const uint8_t* data,
                            size_t len,
                            const webrtc::PacketOptions& options) {
@@ -169,7 +182,9 @@ void MediaChannel::SendRtp(const uint8_t* data,
       [this, packet_id = options.packet_id,
        included_in_feedback = options.included_in_feedback,
        included_in_allocation = options.included_in_allocation,
-       packet = rtc::CopyOnWriteBuffer(data, len, kMaxRtpPacketLen)]() mutable {
+       batchable = options.batchable,
+       last_packet_in_batch = options.last_packet_in_batch,
+       packet = CreatePacketBuffer(data, len)]() mutable {
         rtc::PacketOptions rtc_options;
         rtc_options.packet_id = packet_id;
         if (DscpEnabled()) {
@@ -179,6 +194,8 @@ void MediaChannel::SendRtp(const uint8_t* data,
             included_in_feedback;
         rtc_options.info_signaled_after_sent.included_in_allocation =
             included_in_allocation;
+        rtc_options.batchable = batchable;
+        rtc_options.last_packet_in_batch = last_packet_in_batch;
         SendPacket(&packet, rtc_options);
       };
 
@@ -189,13 +206,13 @@ void MediaChannel::SendRtp(const uint8_t* data,
   if (network_thread_->IsCurrent()) {
     send();
   } else {
-    network_thread_->PostTask(SafeTask(network_safety_, std::move(send)));
+    network_thread_->PostTask(SafeTask(network_safety_, std::move(send)),
+                              webrtc::Location::Current());
   }
 }
 
 void MediaChannel::SendRtcp(const uint8_t* data, size_t len) {
-  auto send = [this, packet = rtc::CopyOnWriteBuffer(
-                         data, len, kMaxRtpPacketLen)]() mutable {
+  auto send = [this, packet = CreatePacketBuffer(data, len)]() mutable {
     rtc::PacketOptions rtc_options;
     if (DscpEnabled()) {
       rtc_options.dscp = PreferredDscp();
@@ -206,7 +223,8 @@ void MediaChannel::SendRtcp(const uint8_t* data, size_t len) {
   if (network_thread_->IsCurrent()) {
     send();
   } else {
-    network_thread_->PostTask(SafeTask(network_safety_, std::move(send)));
+    network_thread_->PostTask(SafeTask(network_safety_, std::move(send)),
+                              webrtc::Location::Current());
   }
 }
 
@@ -11,6 +11,7 @@
 #ifndef MEDIA_BASE_MEDIA_CHANNEL_H_
 #define MEDIA_BASE_MEDIA_CHANNEL_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -274,6 +275,11 @@ class MediaChannel {
   // Must be called on the network thread.
   bool HasNetworkInterface() const;
 
+  // Sets the number of bytes to reserve in front of and after the packets
+  // passed to the NetworkInterface, so that the transport can frame and
+  // protect them in place. Can be called on any thread.
+  void SetPacketBufferReservation(size_t headroom, size_t tailroom);
+
   virtual webrtc::RtpParameters GetRtpSendParameters(uint32_t ssrc) const = 0;
   virtual webrtc::RTCError SetRtpSendParameters(
       uint32_t ssrc,
@@ -317,6 +323,9 @@ class MediaChannel {
                     bool rtcp,
                     const rtc::PacketOptions& options);
 
+  rtc::CopyOnWriteBuffer CreatePacketBuffer(const uint8_t* data,
+                                            size_t len) const;
+
   const bool enable_dscp_;
   const rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> network_safety_
       RTC_PT_GUARDED_BY(network_thread_);
@@ -326,6 +335,8 @@ class MediaChannel {
   rtc::DiffServCodePoint preferred_dscp_ RTC_GUARDED_BY(network_thread_) =
       rtc::DSCP_DEFAULT;
   bool extmap_allow_mixed_ = false;
+  std::atomic<size_t> packet_headroom_{0};
+  std::atomic<size_t> packet_tailroom_{0};
 };
 
 // The stats information is structured as follows:
@@ -19,6 +19,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
+#include "api/location.h"
 #include "api/media_stream_interface.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video/video_codec_type.h"
@@ -1764,7 +1765,8 @@ void WebRtcVideoChannel::OnPacketReceived(rtc::CopyOnWriteBuffer packet,
           RTC_LOG(LS_WARNING) << "Failed to deliver RTP packet on re-delivery.";
         }
         last_unsignalled_ssrc_creation_time_ms_ = rtc::TimeMillis();
-      }));
+      }),
+      webrtc::Location::Current());
 }
 
 void WebRtcVideoChannel::OnPacketSent(const rtc::SentPacket& sent_packet) {
@@ -24,6 +24,7 @@
 #include "api/audio_codecs/audio_codec_pair_id.h"
 #include "api/call/audio_sink.h"
 #include "api/field_trials_view.h"
+#include "api/location.h"
 #include "api/task_queue/pending_task_safety_flag.h"
 #include "media/base/audio_source.h"
 #include "media/base/media_constants.h"
@@ -2205,7 +2206,8 @@ void WebRtcVoiceMediaChannel::OnPacketReceived(rtc::CopyOnWriteBuffer packet,
                                                        packet, packet_time_us);
     RTC_DCHECK_NE(webrtc::PacketReceiver::DELIVERY_UNKNOWN_SSRC,
                   delivery_result);
-  }));
+  }),
+                           webrtc::Location::Current());
 }
 
 void WebRtcVoiceMediaChannel::OnPacketSent(const rtc::SentPacket& sent_packet) {
@@ -391,6 +391,9 @@ void PacingController::ProcessPackets() {
           EnqueuePacket(std::move(packet));
         }
       }
+      if (!keepalive_packets.empty()) {
+        packet_sender_->OnBatchComplete();
+      }
     }
     OnPacketSent(RtpPacketMediaType::kPadding, keepalive_data_sent, now);
   }
@@ -510,6 +513,10 @@ void PacingController::ProcessPackets() {
     }
   }
 
+  if (packets_sent > 0) {
+    packet_sender_->OnBatchComplete();
+  }
+
   if (iteration >= kMaxIterations) {
     // Circuit break activated. Log warning, adjust send time and return.
     // TODO(sprang): Consider completely clearing state.
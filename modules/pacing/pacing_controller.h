@@ -61,6 +61,10 @@ class PacingController {
     virtual absl::optional<uint32_t> GetRtxSsrcForMedia(uint32_t ssrc) const {
       return absl::nullopt;
     }
+    // Called after a burst of one or more SendPacket() calls from a single
+    // ProcessPackets() invocation, so that the packets can be flushed to the
+    // network together.
+    virtual void OnBatchComplete() {}
   };
 
   // Expected max pacer delay. If ExpectedQueueTime() is higher than
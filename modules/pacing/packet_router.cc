@@ -107,6 +107,7 @@ void PacketRouter::RemoveSendRtpModule(RtpRtcpInterface* rtp_module) {
   if (last_send_module_ == rtp_module) {
     last_send_module_ = nullptr;
   }
+  modules_used_in_current_batch_.erase(rtp_module);
   rtp_module->OnPacketSendingThreadSwitched();
 }
 
@@ -167,6 +168,7 @@ void PacketRouter::SendPacket(std::unique_ptr<RtpPacketToSend> packet,
   }
 
   // Sending succeeded.
+  modules_used_in_current_batch_.insert(rtp_module);
 
   if (assign_transport_sequence_number) {
     ++transport_seq_;
@@ -245,6 +247,14 @@ void PacketRouter::OnAbortedRetransmissions(
   }
 }
 
+void PacketRouter::OnBatchComplete() {
+  MutexLock lock(&modules_mutex_);
+  for (RtpRtcpInterface* rtp_module : modules_used_in_current_batch_) {
+    rtp_module->OnBatchComplete();
+  }
+  modules_used_in_current_batch_.clear();
+}
+
 absl::optional<uint32_t> PacketRouter::GetRtxSsrcForMedia(uint32_t ssrc) const {
   MutexLock lock(&modules_mutex_);
   auto it = send_modules_map_.find(ssrc);
@@ -64,7 +64,7 @@ RtpPacket::RtpPacket(const RtpPacket&) = default;
 
 RtpPacket::RtpPacket(const ExtensionManager* extensions, size_t capacity)
     : extensions_(extensions ? *extensions : ExtensionManager()),
-      buffer_(capacity) {
+      buffer_(rtc::CopyOnWriteBuffer::CreatePooled(capacity, capacity)) {
   RTC_DCHECK_GE(capacity, kFixedHeaderSize);
   Clear();
 }
@@ -399,6 +399,10 @@ bool ModuleRtpRtcpImpl::TrySendPacket(RtpPacketToSend* packet,
   return true;
 }
 
+void ModuleRtpRtcpImpl::OnBatchComplete() {
+  // Packets are never held back by the legacy egress, nothing to flush.
+}
+
 void ModuleRtpRtcpImpl::SetFecProtectionParams(const FecProtectionParams&,
                                                const FecProtectionParams&) {
   // Deferred FEC not supported in deprecated RTP module.
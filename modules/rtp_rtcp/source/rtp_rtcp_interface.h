@@ -320,6 +320,11 @@ class RtpRtcpInterface : public RtcpFeedbackSenderInterface {
   virtual bool TrySendPacket(RtpPacketToSend* packet,
                              const PacedPacketInfo& pacing_info) = 0;
 
+  // Called by the pacer once it has finished sending a burst of packets with
+  // TrySendPacket(). Packets that the module has held back in order to send
+  // them as a batch must be forwarded to the transport before this returns.
+  virtual void OnBatchComplete() = 0;
+
   // Update the FEC protection parameters to use for delta- and key-frames.
   // Only used when deferred FEC is active.
   virtual void SetFecProtectionParams(
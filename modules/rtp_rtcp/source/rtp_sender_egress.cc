@@ -52,6 +52,7 @@ void RtpSenderEgress::NonPacedPacketSender::EnqueuePackets(
     PrepareForSend(packet.get());
     sender_->SendPacket(packet.get(), PacedPacketInfo());
   }
+  sender_->OnBatchComplete();
   auto fec_packets = sender_->FetchFecPackets();
   if (!fec_packets.empty()) {
     EnqueuePackets(std::move(fec_packets));
@@ -85,6 +86,9 @@ RtpSenderEgress::RtpSenderEgress(const RtpRtcpInterface::Configuration& config,
           !IsTrialSetTo(config.field_trials,
                         "WebRTC-SendSideBwe-WithOverhead",
                         "Disabled")),
+      enable_send_packet_batching_(IsTrialSetTo(config.field_trials,
+                                                "WebRTC-SendPacketBatching",
+                                                "Enabled")),
       clock_(config.clock),
       packet_history_(packet_history),
       transport_(config.outgoing_transport),
@@ -268,15 +272,46 @@ void RtpSenderEgress::SendPacket(RtpPacketToSend* packet,
                        packet_ssrc);
   }
 
-  const bool send_success = SendPacketToNetwork(*packet, options, pacing_info);
+  if (enable_send_packet_batching_) {
+    // Hold the packet back until the pacer signals the end of the burst, so
+    // that the transport can tell which packet closes the batch.
+    options.batchable = true;
+    packets_to_send_.push_back(
+        {std::make_unique<RtpPacketToSend>(*packet), options, pacing_info, now});
+    return;
+  }
+  CompleteSendPacket(*packet, options, pacing_info, now);
+}
+
+void RtpSenderEgress::OnBatchComplete() {
+  RTC_DCHECK_RUN_ON(&pacer_checker_);
+  for (PendingPacket& pending : packets_to_send_) {
+    pending.options.last_packet_in_batch =
+        &pending == &packets_to_send_.back();
+    CompleteSendPacket(*pending.rtp_packet, pending.options,
+                       pending.pacing_info, pending.now);
+  }
+  packets_to_send_.clear();
+}
+
+void RtpSenderEgress::CompleteSendPacket(const RtpPacketToSend& packet,
+                                         const PacketOptions& options,
+                                         const PacedPacketInfo& pacing_info,
+                                         Timestamp now) {
+  RTC_DCHECK_RUN_ON(&pacer_checker_);
+  const bool is_media = packet.packet_type() == RtpPacketMediaType::kAudio ||
+                        packet.packet_type() == RtpPacketMediaType::kVideo;
+  const uint32_t packet_ssrc = packet.Ssrc();
+
+  const bool send_success = SendPacketToNetwork(packet, options, pacing_info);
 
   // Put packet in retransmission history or update pending status even if
   // actual sending fails.
-  if (is_media && packet->allow_retransmission()) {
-    packet_history_->PutRtpPacket(std::make_unique<RtpPacketToSend>(*packet),
+  if (is_media && packet.allow_retransmission()) {
+    packet_history_->PutRtpPacket(std::make_unique<RtpPacketToSend>(packet),
                                   now);
-  } else if (packet->retransmitted_sequence_number()) {
-    packet_history_->MarkPacketAsSent(*packet->retransmitted_sequence_number());
+  } else if (packet.retransmitted_sequence_number()) {
+    packet_history_->MarkPacketAsSent(*packet.retransmitted_sequence_number());
   }
 
   if (send_success) {
@@ -288,10 +323,10 @@ void RtpSenderEgress::SendPacket(RtpPacketToSend* packet,
     // TODO(sprang): Add support for FEC protecting all header extensions, add
     // media packet to generator here instead.
 
-    RTC_DCHECK(packet->packet_type().has_value());
-    RtpPacketMediaType packet_type = *packet->packet_type();
-    RtpPacketCounter counter(*packet);
-    size_t size = packet->size();
+    RTC_DCHECK(packet.packet_type().has_value());
+    RtpPacketMediaType packet_type = *packet.packet_type();
+    RtpPacketCounter counter(packet);
+    size_t size = packet.size();
     worker_queue_->PostTask(
         SafeTask(task_safety_.flag(), [this, now, packet_ssrc, packet_type,
                                        counter = std::move(counter), size]() {
@@ -63,6 +63,10 @@ class RtpSenderEgress {
 
   void SendPacket(RtpPacketToSend* packet, const PacedPacketInfo& pacing_info)
       RTC_LOCKS_EXCLUDED(lock_);
+  // Forwards packets held back by SendPacket() to the transport, marking the
+  // last one as the end of the batch. Only has an effect if send packet
+  // batching is enabled.
+  void OnBatchComplete() RTC_LOCKS_EXCLUDED(lock_);
   uint32_t Ssrc() const { return ssrc_; }
   absl::optional<uint32_t> RtxSsrc() const { return rtx_ssrc_; }
   absl::optional<uint32_t> FlexFecSsrc() const { return flexfec_ssrc_; }
@@ -96,6 +100,14 @@ class RtpSenderEgress {
       rtc::ArrayView<const uint16_t> sequence_numbers);
 
  private:
+  // A packet held back by SendPacket() until OnBatchComplete().
+  struct PendingPacket {
+    std::unique_ptr<RtpPacketToSend> rtp_packet;
+    PacketOptions options;
+    PacedPacketInfo pacing_info;
+    Timestamp now;
+  };
+
   // Maps capture time in milliseconds to send-side delay in milliseconds.
   // Send-side delay is the difference between transmission time and capture
   // time.
@@ -118,6 +130,11 @@ class RtpSenderEgress {
   bool SendPacketToNetwork(const RtpPacketToSend& packet,
                            const PacketOptions& options,
                            const PacedPacketInfo& pacing_info);
+  // Sends `packet` and updates history and statistics accordingly.
+  void CompleteSendPacket(const RtpPacketToSend& packet,
+                          const PacketOptions& options,
+                          const PacedPacketInfo& pacing_info,
+                          Timestamp now) RTC_LOCKS_EXCLUDED(lock_);
 
   void UpdateRtpStats(int64_t now_ms,
                       uint32_t packet_ssrc,
@@ -138,6 +155,7 @@ class RtpSenderEgress {
   const absl::optional<uint32_t> flexfec_ssrc_;
   const bool populate_network2_timestamp_;
   const bool send_side_bwe_with_overhead_;
+  const bool enable_send_packet_batching_;
   Clock* const clock_;
   RtpPacketHistory* const packet_history_;
   Transport* const transport_;
@@ -149,6 +167,7 @@ class RtpSenderEgress {
   VideoFecGenerator* const fec_generator_ RTC_GUARDED_BY(pacer_checker_);
   absl::optional<uint16_t> last_sent_seq_ RTC_GUARDED_BY(pacer_checker_);
   absl::optional<uint16_t> last_sent_rtx_seq_ RTC_GUARDED_BY(pacer_checker_);
+  std::vector<PendingPacket> packets_to_send_ RTC_GUARDED_BY(pacer_checker_);
 
   TransportFeedbackObserver* const transport_feedback_observer_;
   SendSideDelayObserver* const send_side_delay_observer_;
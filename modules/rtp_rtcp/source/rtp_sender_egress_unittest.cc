@@ -89,20 +89,27 @@ class MockSendSideDelayObserver : public SendSideDelayObserver {
 
 class FieldTrialConfig : public FieldTrialsView {
  public:
-  FieldTrialConfig() : overhead_enabled_(false) {}
+  FieldTrialConfig() : overhead_enabled_(false), batching_enabled_(false) {}
   ~FieldTrialConfig() override {}
 
   void SetOverHeadEnabled(bool enabled) { overhead_enabled_ = enabled; }
+  void SetSendPacketBatchingEnabled(bool enabled) {
+    batching_enabled_ = enabled;
+  }
 
   std::string Lookup(absl::string_view key) const override {
     if (key == "WebRTC-SendSideBwe-WithOverhead") {
       return overhead_enabled_ ? "Enabled" : "Disabled";
     }
+    if (key == "WebRTC-SendPacketBatching") {
+      return batching_enabled_ ? "Enabled" : "Disabled";
+    }
     return "";
   }
 
  private:
   bool overhead_enabled_;
+  bool batching_enabled_;
 };
 
 struct TransmittedPacket {
@@ -124,6 +131,7 @@ class TestTransport : public Transport {
                size_t length,
                const PacketOptions& options) override {
     total_data_sent_ += DataSize::Bytes(length);
+    ++num_packets_sent_;
     last_packet_.emplace(rtc::MakeArrayView(packet, length), options,
                          extensions_);
     return true;
@@ -132,8 +140,10 @@ class TestTransport : public Transport {
   bool SendRtcp(const uint8_t*, size_t) override { RTC_CHECK_NOTREACHED(); }
 
   absl::optional<TransmittedPacket> last_packet() { return last_packet_; }
+  int num_packets_sent() const { return num_packets_sent_; }
 
  private:
+  int num_packets_sent_ = 0;
   DataSize total_data_sent_;
   absl::optional<TransmittedPacket> last_packet_;
   RtpHeaderExtensionMap* const extensions_;
@@ -990,6 +1000,39 @@ TEST_P(RtpSenderEgressTest, SupportsAbortingRetransmissions) {
   EXPECT_TRUE(packet_history_.GetPacketAndMarkAsPending(media_sequence_number));
 }
 
+TEST_P(RtpSenderEgressTest, HoldsBatchedPacketsUntilBatchComplete) {
+  trials_.SetSendPacketBatchingEnabled(true);
+  std::unique_ptr<RtpSenderEgress> sender = CreateRtpSenderEgress();
+  packet_history_.SetStorePacketsStatus(
+      RtpPacketHistory::StorageMode::kStoreAndCull, 10);
+
+  std::unique_ptr<RtpPacketToSend> first_packet = BuildRtpPacket();
+  first_packet->set_allow_retransmission(true);
+  std::unique_ptr<RtpPacketToSend> second_packet = BuildRtpPacket();
+  sender->SendPacket(first_packet.get(), PacedPacketInfo());
+  sender->SendPacket(second_packet.get(), PacedPacketInfo());
+  EXPECT_EQ(transport_.num_packets_sent(), 0);
+
+  sender->OnBatchComplete();
+  EXPECT_EQ(transport_.num_packets_sent(), 2);
+  ASSERT_TRUE(transport_.last_packet().has_value());
+  EXPECT_EQ(transport_.last_packet()->packet.SequenceNumber(),
+            second_packet->SequenceNumber());
+  EXPECT_TRUE(transport_.last_packet()->options.batchable);
+  EXPECT_TRUE(transport_.last_packet()->options.last_packet_in_batch);
+
+  // Batched packets are still stored for retransmission.
+  EXPECT_TRUE(packet_history_.GetPacketState(first_packet->SequenceNumber()));
+}
+
+TEST_P(RtpSenderEgressTest, DoesNotMarkPacketsBatchableByDefault) {
+  std::unique_ptr<RtpSenderEgress> sender = CreateRtpSenderEgress();
+  sender->SendPacket(BuildRtpPacket().get(), PacedPacketInfo());
+  ASSERT_TRUE(transport_.last_packet().has_value());
+  EXPECT_FALSE(transport_.last_packet()->options.batchable);
+  EXPECT_FALSE(transport_.last_packet()->options.last_packet_in_batch);
+}
+
 INSTANTIATE_TEST_SUITE_P(WithAndWithoutOverhead,
                          RtpSenderEgressTest,
                          ::testing::Values(TestConfig(false),
@@ -0,0 +1,41 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "net/dcsctp/packet/crc32c.h"
+
+namespace dcsctp {
+namespace {
+
+// Measures the throughput of GenerateCrc32C() on SCTP packets of
+// `state.range(0)` bytes, from a SACK up to a full data packet.
+void BM_GenerateCrc32C(benchmark::State& state) {
+  std::vector<uint8_t> packet(state.range(0));
+  for (size_t i = 0; i < packet.size(); ++i) {
+    packet[i] = static_cast<uint8_t>(i);
+  }
+  for (auto s : state) {
+    benchmark::DoNotOptimize(GenerateCrc32C(packet));
+  }
+  state.SetBytesProcessed(state.iterations() * packet.size());
+}
+
+BENCHMARK(BM_GenerateCrc32C)
+    ->Arg(28)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1200)
+    ->Arg(8192)
+    ->Arg(65536);
+
+}  // namespace
+}  // namespace dcsctp
@@ -14,6 +14,10 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <utility>
+
+#include "api/location.h"
+#include "api/task_queue/task_queue_base.h"
 #include "api/transport/stun.h"
 #include "rtc_base/byte_order.h"
 #include "rtc_base/checks.h"
@@ -59,8 +63,14 @@ int AsyncStunTCPSocket::Send(const void* pv,
     return -1;
   }
 
+  // Send the current batch first if the packet, with padding, might not fit
+  // in the buffer.
+  if (!batched_packets_.empty() && batched_size_ + cb + 3 > kBufSize) {
+    FlushBatch();
+  }
+
   // If we are blocking on send, then silently drop this packet
-  if (!IsOutBufferEmpty())
+  if (!IsOutBufferEmpty() && batched_packets_.empty())
     return static_cast<int>(cb);
 
   int pad_bytes;
@@ -76,20 +86,65 @@ int AsyncStunTCPSocket::Send(const void* pv,
   char padding[4] = {0};
   AppendToOutBuffer(padding, pad_bytes);
 
-  int res = FlushOutBuffer();
+  batched_packets_.emplace_back(options.packet_id, rtc::TimeMillis());
+  batched_size_ += cb + pad_bytes;
+  if (options.batchable && !options.last_packet_in_batch) {
+    if (webrtc::TaskQueueBase* current = webrtc::TaskQueueBase::Current()) {
+      // Make sure the batch is sent even if it is never closed by a packet
+      // marked `last_packet_in_batch`.
+      if (batched_packets_.size() == 1) {
+        current->PostTask(
+            webrtc::SafeTask(task_safety_.flag(), [this] { FlushBatch(); }),
+            webrtc::Location::Current());
+      }
+      return static_cast<int>(cb);
+    }
+  }
+
+  int res = FlushBatch();
   if (res <= 0) {
-    // drop packet if we made no progress
-    ClearOutBuffer();
     return res;
   }
 
-  rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis());
-  SignalSentPacket(this, sent_packet);
-
   // We claim to have sent the whole thing, even if we only sent partial
   return static_cast<int>(cb);
 }
 
+int AsyncStunTCPSocket::Close() {
+  FlushBatch();
+  return AsyncTCPSocketBase::Close();
+}
+
+int AsyncStunTCPSocket::FlushBatch() {
+  if (batched_packets_.empty()) {
+    return 0;
+  }
+  std::vector<rtc::SentPacket> sent_packets = std::move(batched_packets_);
+  batched_packets_.clear();
+  batched_size_ = 0;
+
+  // The batch may already have been written out when the socket became
+  // writable again, after a send that would have blocked.
+  if (IsOutBufferEmpty()) {
+    for (const rtc::SentPacket& sent_packet : sent_packets) {
+      SignalSentPacket(this, sent_packet);
+    }
+    return 0;
+  }
+
+  int res = FlushOutBuffer();
+  if (res <= 0) {
+    // drop the packets if we made no progress
+    ClearOutBuffer();
+    return res;
+  }
+
+  for (const rtc::SentPacket& sent_packet : sent_packets) {
+    SignalSentPacket(this, sent_packet);
+  }
+  return res;
+}
+
 void AsyncStunTCPSocket::ProcessInput(char* data, size_t* len) {
   rtc::SocketAddress remote_addr(GetRemoteAddress());
   // STUN packet - First 4 bytes. Total header size is 20 bytes.
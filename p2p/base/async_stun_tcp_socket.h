@@ -13,13 +13,20 @@
 
 #include <stddef.h>
 
+#include <vector>
+
+#include "api/task_queue/pending_task_safety_flag.h"
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/async_tcp_socket.h"
+#include "rtc_base/network/sent_packet.h"
 #include "rtc_base/socket.h"
 #include "rtc_base/socket_address.h"
 
 namespace cricket {
 
+// Sends and receives STUN and TURN ChannelData messages framed for TCP.
+// Packets marked as batchable (see PacketOptions) are held back, and sent
+// together with the rest of the batch in a single write.
 class AsyncStunTCPSocket : public rtc::AsyncTCPSocketBase {
  public:
   // Binds and connects `socket` and creates AsyncTCPSocket for
@@ -37,13 +44,25 @@ class AsyncStunTCPSocket : public rtc::AsyncTCPSocketBase {
   int Send(const void* pv,
            size_t cb,
            const rtc::PacketOptions& options) override;
+  int Close() override;
   void ProcessInput(char* data, size_t* len) override;
 
  private:
+  // Writes out the output buffer, with the packets held back by batchable
+  // Send() calls. Returns the result of FlushOutBuffer(), or 0 if there was
+  // nothing to send.
+  int FlushBatch();
+
   // This method returns the message hdr + length written in the header.
   // This method also returns the number of padding bytes needed/added to the
   // turn message. `pad_bytes` should be used only when `is_turn` is true.
   size_t GetExpectedLength(const void* data, size_t len, int* pad_bytes);
+
+  // The packets held back in the output buffer until the end of the current
+  // send batch, and their size including padding.
+  std::vector<rtc::SentPacket> batched_packets_;
+  size_t batched_size_ = 0;
+  webrtc::ScopedTaskSafetyDetached task_safety_;
 };
 
 }  // namespace cricket
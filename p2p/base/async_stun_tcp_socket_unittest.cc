@@ -123,6 +123,16 @@ class AsyncStunTCPSocketTest : public ::testing::Test,
     return (ret == static_cast<int>(len));
   }
 
+  // Sends a packet as part of a batch, without processing messages.
+  bool SendBatchable(const void* data, size_t len, bool last_packet_in_batch) {
+    rtc::PacketOptions options;
+    options.batchable = true;
+    options.last_packet_in_batch = last_packet_in_batch;
+    int ret =
+        send_socket_->Send(reinterpret_cast<const char*>(data), len, options);
+    return (ret == static_cast<int>(len));
+  }
+
   bool CheckData(const void* data, int len) {
     bool ret = false;
     if (recv_packets_.size()) {
@@ -285,4 +295,68 @@ TEST_F(AsyncStunTCPSocketTest, SignalSentPacketNotFiredWhenPacketNotSent) {
   EXPECT_EQ(0, sent_packets_);
 }
 
+// Test that batched packets are held back until the end of the batch, and
+// then sent and received in order.
+TEST_F(AsyncStunTCPSocketTest, SendsBatchWhenLastPacketInBatchIsSent) {
+  ASSERT_TRUE(SendBatchable(kStunMessageWithZeroLength,
+                            sizeof(kStunMessageWithZeroLength),
+                            /*last_packet_in_batch=*/false));
+  ASSERT_TRUE(SendBatchable(kTurnChannelDataMessageWithOddLength,
+                            sizeof(kTurnChannelDataMessageWithOddLength),
+                            /*last_packet_in_batch=*/false));
+  EXPECT_EQ(0, sent_packets_);
+  ASSERT_TRUE(SendBatchable(kTurnChannelDataMessage,
+                            sizeof(kTurnChannelDataMessage),
+                            /*last_packet_in_batch=*/true));
+  EXPECT_EQ(3, sent_packets_);
+
+  vss_->ProcessMessagesUntilIdle();
+  ASSERT_EQ(3u, recv_packets_.size());
+  EXPECT_TRUE(CheckData(kStunMessageWithZeroLength,
+                        sizeof(kStunMessageWithZeroLength)));
+  EXPECT_TRUE(CheckData(kTurnChannelDataMessageWithOddLength,
+                        sizeof(kTurnChannelDataMessageWithOddLength)));
+  EXPECT_TRUE(
+      CheckData(kTurnChannelDataMessage, sizeof(kTurnChannelDataMessage)));
+}
+
+// Test that a batch which is never closed is sent once the current task has
+// finished running.
+TEST_F(AsyncStunTCPSocketTest, SendsUnfinishedBatchAfterCurrentTask) {
+  ASSERT_TRUE(SendBatchable(kTurnChannelDataMessage,
+                            sizeof(kTurnChannelDataMessage),
+                            /*last_packet_in_batch=*/false));
+  ASSERT_TRUE(SendBatchable(kTurnChannelDataMessage,
+                            sizeof(kTurnChannelDataMessage),
+                            /*last_packet_in_batch=*/false));
+  EXPECT_EQ(0, sent_packets_);
+
+  vss_->ProcessMessagesUntilIdle();
+  EXPECT_EQ(2, sent_packets_);
+  EXPECT_EQ(2u, recv_packets_.size());
+}
+
+// Test that a batch which is written out when the socket becomes writable,
+// before the batch is flushed, is still signaled as sent.
+TEST_F(AsyncStunTCPSocketTest, SignalsBatchSentOnWriteEvent) {
+  vss_->SetSendingBlocked(true);
+  vss_->set_send_buffer_capacity(sizeof(kTurnChannelDataMessage));
+  ASSERT_TRUE(Send(kTurnChannelDataMessage, sizeof(kTurnChannelDataMessage)));
+  // The send buffer is full, so the send would block and the packet is
+  // dropped.
+  ASSERT_FALSE(Send(kTurnChannelDataMessage, sizeof(kTurnChannelDataMessage)));
+  EXPECT_EQ(1, sent_packets_);
+
+  ASSERT_TRUE(SendBatchable(kTurnChannelDataMessage,
+                            sizeof(kTurnChannelDataMessage),
+                            /*last_packet_in_batch=*/false));
+  // Writes out the batch before the task which flushes it runs.
+  vss_->SetSendingBlocked(false);
+  EXPECT_EQ(1, sent_packets_);
+
+  vss_->ProcessMessagesUntilIdle();
+  EXPECT_EQ(2, sent_packets_);
+  EXPECT_EQ(2u, recv_packets_.size());
+}
+
 }  // namespace cricket
@@ -10,6 +10,8 @@
 
 #include "p2p/base/basic_ice_controller.h"
 
+#include <tuple>
+
 namespace {
 
 // The minimum improvement in RTT that justifies a switch.
@@ -160,62 +162,22 @@ const Connection* BasicIceController::FindNextPingableConnection() {
     }
   }
 
-  // Rule 3: Triggered checks have priority over non-triggered connections.
-  // Rule 3.1: Among triggered checks, oldest takes precedence.
-  const Connection* oldest_triggered_check =
-      FindOldestConnectionNeedingTriggeredCheck(now);
-  if (oldest_triggered_check) {
-    return oldest_triggered_check;
-  }
-
-  // Rule 4: Unpinged connections have priority over pinged ones.
+  // Rules 3 and 4 are evaluated in a single pass over `connections_`, which
+  // checks whether each connection is pingable only once, so that finding the
+  // connection takes linear time.
   RTC_CHECK(connections_.size() ==
             pinged_connections_.size() + unpinged_connections_.size());
-  // If there are unpinged and pingable connections, only ping those.
-  // Otherwise, treat everything as unpinged.
-  // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
-  // "pinged" to filter out unpinged connections.
-  if (absl::c_none_of(unpinged_connections_,
-                      [this, now](const Connection* conn) {
-                        return this->IsPingable(conn, now);
-                      })) {
-    unpinged_connections_.insert(pinged_connections_.begin(),
-                                 pinged_connections_.end());
-    pinged_connections_.clear();
-  }
-
-  // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<const Connection*> pingable_connections;
-  absl::c_copy_if(
-      unpinged_connections_, std::back_inserter(pingable_connections),
-      [this, now](const Connection* conn) { return IsPingable(conn, now); });
-  auto iter = absl::c_max_element(
-      pingable_connections,
-      [this](const Connection* conn1, const Connection* conn2) {
-        // Some implementations of max_element
-        // compare an element with itself.
-        if (conn1 == conn2) {
-          return false;
-        }
-        return MorePingable(conn1, conn2) == conn2;
-      });
-  if (iter != pingable_connections.end()) {
-    return *iter;
-  }
-  return nullptr;
-}
-
-// Find "triggered checks".  We ping first those connections that have
-// received a ping but have not sent a ping since receiving it
-// (last_ping_received > last_ping_sent).  But we shouldn't do
-// triggered checks if the connection is already writable.
-const Connection* BasicIceController::FindOldestConnectionNeedingTriggeredCheck(
-    int64_t now) {
   const Connection* oldest_needing_triggered_check = nullptr;
-  for (auto* conn : connections_) {
+  const Connection* most_pingable_unpinged = nullptr;
+  const Connection* most_pingable = nullptr;
+  for (const Connection* conn : connections_) {
     if (!IsPingable(conn, now)) {
       continue;
     }
+    // Find "triggered checks".  We ping first those connections that have
+    // received a ping but have not sent a ping since receiving it
+    // (last_ping_received > last_ping_sent).  But we shouldn't do
+    // triggered checks if the connection is already writable.
     bool needs_triggered_check =
         (!conn->writable() &&
          conn->last_ping_received() > conn->last_ping_sent());
@@ -225,13 +187,39 @@ const Connection* BasicIceController::FindOldestConnectionNeedingTriggeredCheck(
           oldest_needing_triggered_check->last_ping_received()))) {
       oldest_needing_triggered_check = conn;
     }
+
+    if (!most_pingable || MorePingable(most_pingable, conn) == conn) {
+      most_pingable = conn;
+    }
+    if (unpinged_connections_.count(conn) &&
+        (!most_pingable_unpinged ||
+         MorePingable(most_pingable_unpinged, conn) == conn)) {
+      most_pingable_unpinged = conn;
+    }
   }
 
+  // Rule 3: Triggered checks have priority over non-triggered connections.
+  // Rule 3.1: Among triggered checks, oldest takes precedence.
   if (oldest_needing_triggered_check) {
     RTC_LOG(LS_INFO) << "Selecting connection for triggered check: "
                      << oldest_needing_triggered_check->ToString();
+    return oldest_needing_triggered_check;
   }
-  return oldest_needing_triggered_check;
+
+  // Rule 4: Unpinged connections have priority over pinged ones.
+  // If there are unpinged and pingable connections, only ping those.
+  // Otherwise, treat everything as unpinged.
+  // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
+  // "pinged" to filter out unpinged connections.
+  if (!most_pingable_unpinged) {
+    unpinged_connections_.insert(pinged_connections_.begin(),
+                                 pinged_connections_.end());
+    pinged_connections_.clear();
+    most_pingable_unpinged = most_pingable;
+  }
+
+  // Among un-pinged pingable connections, "more pingable" takes precedence.
+  return most_pingable_unpinged;
 }
 
 bool BasicIceController::WritableConnectionPastPingInterval(
@@ -334,19 +322,9 @@ const Connection* BasicIceController::MorePingable(const Connection* conn1,
     }
   }
 
-  const Connection* least_recently_pinged_conn =
-      LeastRecentlyPinged(conn1, conn2);
-  if (least_recently_pinged_conn) {
-    return least_recently_pinged_conn;
-  }
-
-  // During the initial state when nothing has been pinged yet, return the first
-  // one in the ordered `connections_`.
-  auto connections = connections_;
-  return *(std::find_if(connections.begin(), connections.end(),
-                        [conn1, conn2](const Connection* conn) {
-                          return conn == conn1 || conn == conn2;
-                        }));
+  // During the initial state when nothing has been pinged yet, this returns
+  // null, and the caller picks the first one in the ordered `connections_`.
+  return LeastRecentlyPinged(conn1, conn2);
 }
 
 const Connection* BasicIceController::MostLikelyToWork(
@@ -529,15 +507,30 @@ BasicIceController::SortAndSwitchConnection(IceSwitchReason reason) {
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
   // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  absl::c_stable_sort(
-      connections_, [this](const Connection* a, const Connection* b) {
-        int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
-        if (cmp != 0) {
-          return cmp > 0;
-        }
-        // Otherwise, sort based on latency estimate.
-        return a->rtt() < b->rtt();
-      });
+  std::vector<std::pair<ConnectionRank, const Connection*>> ranked_connections;
+  ranked_connections.reserve(connections_.size());
+  for (const Connection* conn : connections_) {
+    ranked_connections.emplace_back(RankConnection(conn), conn);
+  }
+  auto better = [](const std::pair<ConnectionRank, const Connection*>& a,
+                   const std::pair<ConnectionRank, const Connection*>& b) {
+    return IsBetterRank(a.first, b.first);
+  };
+  // The order usually changes little between calls, so skip sorting if it
+  // has not changed at all.
+  if (!absl::c_is_sorted(ranked_connections, better)) {
+    absl::c_stable_sort(ranked_connections, better);
+    for (size_t i = 0; i < ranked_connections.size(); ++i) {
+      connections_[i] = ranked_connections[i].second;
+    }
+  }
+#if RTC_DCHECK_IS_ON
+  for (size_t i = 1; i < connections_.size(); ++i) {
+    RTC_DCHECK_GE(CompareConnections(connections_[i - 1], connections_[i],
+                                     absl::nullopt, nullptr),
+                  0);
+  }
+#endif
 
   RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
                       << " available connections";
@@ -569,6 +562,62 @@ bool BasicIceController::PresumedWritable(const Connection* conn) const {
            conn->remote_candidate().type() == PRFLX_PORT_TYPE));
 }
 
+BasicIceController::ConnectionRank BasicIceController::RankConnection(
+    const Connection* conn) const {
+  ConnectionRank rank;
+  // See CompareConnectionStates().
+  rank.writable = conn->writable() || PresumedWritable(conn);
+  // Better write states have lower values.
+  rank.write_state = -static_cast<int>(conn->write_state());
+  rank.receiving = conn->receiving();
+  rank.connected_while_writable =
+      conn->write_state() == Connection::STATE_WRITABLE && conn->connected();
+  // See CompareConnections().
+  if (ice_role_func_() == ICEROLE_CONTROLLED) {
+    rank.remote_nomination = conn->remote_nomination();
+    rank.last_data_received = conn->last_data_received();
+  }
+  // See CompareCandidatePairNetworks().
+  rank.uses_preferred_network =
+      LocalCandidateUsesPreferredNetwork(conn, config_.network_preference);
+  switch (config_.vpn_preference) {
+    case webrtc::VpnPreference::kOnlyUseVpn:
+    case webrtc::VpnPreference::kPreferVpn:
+      rank.vpn_preference = conn->network()->IsVpn() ? 1 : 0;
+      break;
+    case webrtc::VpnPreference::kNeverUseVpn:
+    case webrtc::VpnPreference::kAvoidVpn:
+      rank.vpn_preference = conn->network()->IsVpn() ? 0 : 1;
+      break;
+    default:
+      break;
+  }
+  // Prefer lower network cost.
+  rank.network_cost = -static_cast<int64_t>(conn->ComputeNetworkCost());
+  // See CompareConnectionCandidates().
+  rank.priority = conn->priority();
+  rank.generation =
+      static_cast<int64_t>(conn->remote_candidate().generation()) +
+      conn->generation();
+  rank.not_pruned = !is_connection_pruned_func_(conn);
+  // Prefer lower latency.
+  rank.rtt = -conn->rtt();
+  return rank;
+}
+
+// static
+bool BasicIceController::IsBetterRank(const ConnectionRank& a,
+                                      const ConnectionRank& b) {
+  auto tie = [](const ConnectionRank& rank) {
+    return std::tie(rank.writable, rank.write_state, rank.receiving,
+                    rank.connected_while_writable, rank.remote_nomination,
+                    rank.last_data_received, rank.uses_preferred_network,
+                    rank.vpn_preference, rank.network_cost, rank.priority,
+                    rank.generation, rank.not_pruned, rank.rtt);
+  };
+  return tie(a) > tie(b);
+}
+
 // Compare two connections based on their writing, receiving, and connected
 // states.
 int BasicIceController::CompareConnectionStates(
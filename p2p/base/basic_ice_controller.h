@@ -78,9 +78,9 @@ class BasicIceController : public IceControllerInterface {
                     config_.receiving_timeout_or_default() / 10);
   }
 
-  const Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
   // Between `conn1` and `conn2`, this function returns the one which should
-  // be pinged first.
+  // be pinged first, or null if neither is preferred, in which case the one
+  // first in `connections_` is pinged first.
   const Connection* MorePingable(const Connection* conn1,
                                  const Connection* conn2);
   // Select the connection which is Relay/Relay. If both of them are,
@@ -136,6 +136,28 @@ class BasicIceController : public IceControllerInterface {
                          absl::optional<int64_t> receiving_unchanged_threshold,
                          bool* missed_receiving_unchanged_threshold) const;
 
+  // The values CompareConnections() compares, without a receiving threshold,
+  // followed by the latency, in order of precedence. Larger values are better.
+  // Computing them once per connection keeps sorting from evaluating the
+  // comparison, which calls back into the transport, O(n log n) times.
+  struct ConnectionRank {
+    bool writable = false;
+    int write_state = 0;
+    bool receiving = false;
+    bool connected_while_writable = false;
+    uint32_t remote_nomination = 0;
+    int64_t last_data_received = 0;
+    bool uses_preferred_network = false;
+    int vpn_preference = 0;
+    int64_t network_cost = 0;
+    uint64_t priority = 0;
+    int64_t generation = 0;
+    bool not_pruned = false;
+    int rtt = 0;
+  };
+  ConnectionRank RankConnection(const Connection* conn) const;
+  static bool IsBetterRank(const ConnectionRank& a, const ConnectionRank& b);
+
   SwitchResult HandleInitialSelectDampening(IceSwitchReason reason,
                                             const Connection* new_connection);
 
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/basic_ice_controller.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/p2p_constants.h"
+#include "p2p/base/p2p_transport_channel_ice_field_trials.h"
+#include "p2p/base/port.h"
+#include "p2p/base/stun_port.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/network.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+
+namespace cricket {
+namespace {
+
+// A controlling ICE agent with one local UDP port and `num_connections`
+// candidate pairs, all of them pingable and none writable yet, as after
+// receiving many remote candidates.
+class IceControllerFixture {
+ public:
+  explicit IceControllerFixture(int num_connections)
+      : thread_(&socket_server_),
+        socket_factory_(&socket_server_),
+        network_("benchmark", "benchmark", rtc::IPAddress(0xc0a80101), 32),
+        controller_(IceControllerFactoryArgs{
+            [] { return IceTransportState::STATE_CONNECTING; },
+            [] { return ICEROLE_CONTROLLING; },
+            [](const Connection*) { return false; }, &field_trials_}) {
+    network_.AddIP(rtc::IPAddress(0xc0a80101));
+    port_ = UDPPort::Create(&thread_, &socket_factory_, &network_, 0, 0,
+                            "lfrg", "lpasswordlpasswordlpass", true,
+                            absl::nullopt);
+    port_->SetIceRole(ICEROLE_CONTROLLING);
+    port_->PrepareAddress();
+    for (int i = 0; i < num_connections; ++i) {
+      Candidate remote(ICE_CANDIDATE_COMPONENT_RTP, UDP_PROTOCOL_NAME,
+                       rtc::SocketAddress(rtc::IPAddress(0x0a000000 + i / 16),
+                                          10000 + i % 16),
+                       /*priority=*/2130706431 - i, "rfrg",
+                       "rpasswordrpasswordrpass", LOCAL_PORT_TYPE,
+                       /*generation=*/0, /*foundation=*/"");
+      Connection* connection =
+          port_->CreateConnection(remote, Port::ORIGIN_MESSAGE);
+      if (connection) {
+        controller_.AddConnection(connection);
+      }
+    }
+  }
+
+  BasicIceController& controller() { return controller_; }
+
+ private:
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  IceFieldTrials field_trials_;
+  std::unique_ptr<UDPPort> port_;
+  BasicIceController controller_;
+};
+
+void BM_SortAndSwitchConnection(benchmark::State& state) {
+  IceControllerFixture fixture(state.range(0));
+  for (auto s : state) {
+    benchmark::DoNotOptimize(fixture.controller().SortAndSwitchConnection(
+        IceSwitchReason::NEW_CONNECTION_FROM_REMOTE_CANDIDATE));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_SortAndSwitchConnection)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096)
+    ->Complexity();
+
+// Selects and marks the connection to ping, as P2PTransportChannel does on
+// every ping timer. The connections are not actually pinged.
+void BM_SelectConnectionToPing(benchmark::State& state) {
+  IceControllerFixture fixture(state.range(0));
+  fixture.controller().SortAndSwitchConnection(
+      IceSwitchReason::NEW_CONNECTION_FROM_REMOTE_CANDIDATE);
+  for (auto s : state) {
+    IceControllerInterface::PingResult result =
+        fixture.controller().SelectConnectionToPing(/*last_ping_sent_ms=*/0);
+    fixture.controller().MarkConnectionPinged(
+        result.connection.value_or(nullptr));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_SelectConnectionToPing)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096)
+    ->Complexity();
+
+}  // namespace
+}  // namespace cricket
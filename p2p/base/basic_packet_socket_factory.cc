@@ -21,12 +21,35 @@
 #include "rtc_base/async_tcp_socket.h"
 #include "rtc_base/async_udp_socket.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/socket.h"
 #include "rtc_base/socket_adapters.h"
 #include "rtc_base/ssl_adapter.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace rtc {
+namespace {
+
+// Makes UDP sockets read up to `packets` datagrams of at most `packet_size`
+// bytes per read event, e.g.
+// "WebRTC-UdpReceiveBatching/Enabled,packets:16,packet_size:2048/".
+constexpr char kUdpReceiveBatchingFieldTrial[] = "WebRTC-UdpReceiveBatching";
+
+void MaybeEnableReceiveBatching(AsyncUDPSocket* socket) {
+  webrtc::FieldTrialFlag enabled("Enabled");
+  webrtc::FieldTrialParameter<unsigned> packets("packets", 16);
+  webrtc::FieldTrialParameter<unsigned> packet_size(
+      "packet_size", AsyncUDPSocket::kDefaultBatchPacketSize);
+  webrtc::ParseFieldTrial(
+      {&enabled, &packets, &packet_size},
+      webrtc::field_trial::FindFullName(kUdpReceiveBatchingFieldTrial));
+  if (enabled && packets.Get() > 1 && packet_size.Get() > 0) {
+    socket->SetReceiveBatchSize(packets.Get(), packet_size.Get());
+  }
+}
+
+}  // namespace
 
 BasicPacketSocketFactory::BasicPacketSocketFactory(
     SocketFactory* socket_factory)
@@ -48,7 +71,9 @@ AsyncPacketSocket* BasicPacketSocketFactory::CreateUdpSocket(
     delete socket;
     return NULL;
   }
-  return new AsyncUDPSocket(socket);
+  AsyncUDPSocket* udp_socket = new AsyncUDPSocket(socket);
+  MaybeEnableReceiveBatching(udp_socket);
+  return udp_socket;
 }
 
 AsyncListenSocket* BasicPacketSocketFactory::CreateServerTcpSocket(
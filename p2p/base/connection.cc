@@ -444,6 +444,10 @@ void Connection::OnReadPacket(const char* data,
                               size_t size,
                               int64_t packet_time_us) {
   RTC_DCHECK_RUN_ON(network_thread_);
+  if (MaybeHandleBindingRequestInPlace(data, size)) {
+    return;
+  }
+
   std::unique_ptr<IceMessage> msg;
   std::string remote_ufrag;
   const rtc::SocketAddress& addr(remote_candidate_.address());
@@ -472,7 +476,7 @@ void Connection::OnReadPacket(const char* data,
     // If this is a STUN response, then update the writable bit.
     // Log at LS_INFO if we receive a ping on an unwritable connection.
     rtc::LoggingSeverity sev = (!writable() ? rtc::LS_INFO : rtc::LS_VERBOSE);
-    msg->ValidateMessageIntegrity(remote_candidate().password());
+    msg->ValidateMessageIntegrity(RemoteIntegrityKey());
     switch (msg->type()) {
       case STUN_BINDING_REQUEST:
         RTC_LOG_V(sev) << ToString() << ": Received "
@@ -526,32 +530,56 @@ void Connection::OnReadPacket(const char* data,
   }
 }
 
+bool Connection::MaybeHandleBindingRequestInPlace(const char* data,
+                                                  size_t size) {
+  absl::optional<IceBindingRequestView> request =
+      IceBindingRequestView::Parse(data, size);
+  absl::string_view remote_ufrag;
+  if (!request ||
+      !port_->CanHandleBindingRequestView(*request, &remote_ufrag) ||
+      remote_ufrag != remote_candidate_.username()) {
+    return false;
+  }
+  char response[IceBindingRequestView::kMaxSuccessResponseSize];
+  size_t response_size = request->WriteSuccessResponse(
+      remote_candidate_.address(), LocalIntegrityKey(), response);
+  if (response_size == 0) {
+    return false;
+  }
+
+  const absl::string_view transaction_id = request->transaction_id();
+  const uint32_t reduced_transaction_id = request->reduced_transaction_id();
+  rtc::LoggingSeverity sev = (!writable() ? rtc::LS_INFO : rtc::LS_VERBOSE);
+  RTC_LOG_V(sev) << ToString() << ": Received "
+                 << StunMethodToString(STUN_BINDING_REQUEST)
+                 << ", id=" << rtc::hex_encode(transaction_id);
+
+  // The same steps as HandleStunBindingOrGoogPingRequest(), for a request
+  // which has no role conflict.
+  ReceivedPing(std::string(transaction_id));
+  MaybeSendExtraPing();
+  stats_.recv_ping_requests++;
+  LogCandidatePairEvent(webrtc::IceCandidatePairEventType::kCheckReceived,
+                        reduced_transaction_id);
+  SendResponsePacket(response, response_size, STUN_BINDING_RESPONSE,
+                     transaction_id, reduced_transaction_id);
+  if (!pruned_ && write_state_ == STATE_WRITE_TIMEOUT) {
+    set_write_state(STATE_WRITE_INIT);
+  }
+  if (port_->GetIceRole() == ICEROLE_CONTROLLED) {
+    UpdateRemoteNomination(request->nomination(), request->use_candidate());
+  }
+  if (request->network_info()) {
+    UpdateRemoteNetworkCost(*request->network_info());
+  }
+  return true;
+}
+
 void Connection::HandleStunBindingOrGoogPingRequest(IceMessage* msg) {
   RTC_DCHECK_RUN_ON(network_thread_);
   // This connection should now be receiving.
   ReceivedPing(msg->transaction_id());
-  if (field_trials_->extra_ice_ping && last_ping_response_received_ == 0) {
-    if (local_candidate().type() == RELAY_PORT_TYPE ||
-        local_candidate().type() == PRFLX_PORT_TYPE ||
-        remote_candidate().type() == RELAY_PORT_TYPE ||
-        remote_candidate().type() == PRFLX_PORT_TYPE) {
-      const int64_t now = rtc::TimeMillis();
-      if (last_ping_sent_ + kMinExtraPingDelayMs <= now) {
-        RTC_LOG(LS_INFO) << ToString()
-                         << "WebRTC-ExtraICEPing/Sending extra ping"
-                            " last_ping_sent_: "
-                         << last_ping_sent_ << " now: " << now
-                         << " (diff: " << (now - last_ping_sent_) << ")";
-        Ping(now);
-      } else {
-        RTC_LOG(LS_INFO) << ToString()
-                         << "WebRTC-ExtraICEPing/Not sending extra ping"
-                            " last_ping_sent_: "
-                         << last_ping_sent_ << " now: " << now
-                         << " (diff: " << (now - last_ping_sent_) << ")";
-      }
-    }
-  }
+  MaybeSendExtraPing();
 
   const rtc::SocketAddress& remote_addr = remote_candidate_.address();
   if (msg->type() == STUN_BINDING_REQUEST) {
@@ -584,39 +612,16 @@ void Connection::HandleStunBindingOrGoogPingRequest(IceMessage* msg) {
   if (port_->GetIceRole() == ICEROLE_CONTROLLED) {
     const StunUInt32Attribute* nomination_attr =
         msg->GetUInt32(STUN_ATTR_NOMINATION);
-    uint32_t nomination = 0;
-    if (nomination_attr) {
-      nomination = nomination_attr->value();
-      if (nomination == 0) {
-        RTC_LOG(LS_ERROR) << "Invalid nomination: " << nomination;
-      }
-    } else {
-      const StunByteStringAttribute* use_candidate_attr =
-          msg->GetByteString(STUN_ATTR_USE_CANDIDATE);
-      if (use_candidate_attr) {
-        nomination = 1;
-      }
-    }
-    // We don't un-nominate a connection, so we only keep a larger nomination.
-    if (nomination > remote_nomination_) {
-      set_remote_nomination(nomination);
-      SignalNominated(this);
-    }
+    UpdateRemoteNomination(
+        nomination_attr ? absl::make_optional(nomination_attr->value())
+                        : absl::nullopt,
+        msg->GetByteString(STUN_ATTR_USE_CANDIDATE) != nullptr);
   }
   // Set the remote cost if the network_info attribute is available.
-  // Note: If packets are re-ordered, we may get incorrect network cost
-  // temporarily, but it should get the correct value shortly after that.
   const StunUInt32Attribute* network_attr =
       msg->GetUInt32(STUN_ATTR_GOOG_NETWORK_INFO);
   if (network_attr) {
-    uint32_t network_info = network_attr->value();
-    uint16_t network_cost = static_cast<uint16_t>(network_info);
-    if (network_cost != remote_candidate_.network_cost()) {
-      remote_candidate_.set_network_cost(network_cost);
-      // Network cost change will affect the connection ranking, so signal
-      // state change to force a re-sort in P2PTransportChannel.
-      SignalStateChange(this);
-    }
+    UpdateRemoteNetworkCost(network_attr->value());
   }
 
   if (field_trials_->piggyback_ice_check_acknowledgement) {
@@ -624,6 +629,61 @@ void Connection::HandleStunBindingOrGoogPingRequest(IceMessage* msg) {
   }
 }
 
+void Connection::MaybeSendExtraPing() {
+  if (field_trials_->extra_ice_ping && last_ping_response_received_ == 0) {
+    if (local_candidate().type() == RELAY_PORT_TYPE ||
+        local_candidate().type() == PRFLX_PORT_TYPE ||
+        remote_candidate().type() == RELAY_PORT_TYPE ||
+        remote_candidate().type() == PRFLX_PORT_TYPE) {
+      const int64_t now = rtc::TimeMillis();
+      if (last_ping_sent_ + kMinExtraPingDelayMs <= now) {
+        RTC_LOG(LS_INFO) << ToString()
+                         << "WebRTC-ExtraICEPing/Sending extra ping"
+                            " last_ping_sent_: "
+                         << last_ping_sent_ << " now: " << now
+                         << " (diff: " << (now - last_ping_sent_) << ")";
+        Ping(now);
+      } else {
+        RTC_LOG(LS_INFO) << ToString()
+                         << "WebRTC-ExtraICEPing/Not sending extra ping"
+                            " last_ping_sent_: "
+                         << last_ping_sent_ << " now: " << now
+                         << " (diff: " << (now - last_ping_sent_) << ")";
+      }
+    }
+  }
+}
+
+void Connection::UpdateRemoteNomination(absl::optional<uint32_t> nomination,
+                                        bool use_candidate) {
+  uint32_t value = 0;
+  if (nomination) {
+    value = *nomination;
+    if (value == 0) {
+      RTC_LOG(LS_ERROR) << "Invalid nomination: " << value;
+    }
+  } else if (use_candidate) {
+    value = 1;
+  }
+  // We don't un-nominate a connection, so we only keep a larger nomination.
+  if (value > remote_nomination_) {
+    set_remote_nomination(value);
+    SignalNominated(this);
+  }
+}
+
+void Connection::UpdateRemoteNetworkCost(uint32_t network_info) {
+  // Note: If packets are re-ordered, we may get incorrect network cost
+  // temporarily, but it should get the correct value shortly after that.
+  uint16_t network_cost = static_cast<uint16_t>(network_info);
+  if (network_cost != remote_candidate_.network_cost()) {
+    remote_candidate_.set_network_cost(network_cost);
+    // Network cost change will affect the connection ranking, so signal
+    // state change to force a re-sort in P2PTransportChannel.
+    SignalStateChange(this);
+  }
+}
+
 void Connection::SendStunBindingResponse(const StunMessage* message) {
   RTC_DCHECK_RUN_ON(network_thread_);
   RTC_DCHECK_EQ(message->type(), STUN_BINDING_REQUEST);
@@ -673,7 +733,7 @@ void Connection::SendStunBindingResponse(const StunMessage* message) {
     }
   }
 
-  response.AddMessageIntegrity(local_candidate().password());
+  response.AddMessageIntegrity(LocalIntegrityKey());
   response.AddFingerprint();
 
   SendResponseMessage(response);
@@ -685,39 +745,48 @@ void Connection::SendGoogPingResponse(const StunMessage* message) {
 
   // Fill in the response.
   StunMessage response(GOOG_PING_RESPONSE, message->transaction_id());
-  response.AddMessageIntegrity32(local_candidate().password());
+  response.AddMessageIntegrity32(LocalIntegrityKey());
   SendResponseMessage(response);
 }
 
 void Connection::SendResponseMessage(const StunMessage& response) {
   RTC_DCHECK_RUN_ON(network_thread_);
+  rtc::ByteBufferWriter buf;
+  response.Write(&buf);
+  SendResponsePacket(buf.Data(), buf.Length(), response.type(),
+                     response.transaction_id(),
+                     response.reduced_transaction_id());
+}
+
+void Connection::SendResponsePacket(const char* data,
+                                    size_t size,
+                                    int type,
+                                    absl::string_view transaction_id,
+                                    uint32_t reduced_transaction_id) {
   // Where I send the response.
   const rtc::SocketAddress& addr = remote_candidate_.address();
 
   // Send the response.
-  rtc::ByteBufferWriter buf;
-  response.Write(&buf);
   rtc::PacketOptions options(port_->StunDscpValue());
   options.info_signaled_after_sent.packet_type =
       rtc::PacketType::kIceConnectivityCheckResponse;
-  auto err = port_->SendTo(buf.Data(), buf.Length(), addr, options, false);
+  auto err = port_->SendTo(data, size, addr, options, false);
   if (err < 0) {
     RTC_LOG(LS_ERROR) << ToString() << ": Failed to send "
-                      << StunMethodToString(response.type())
+                      << StunMethodToString(type)
                       << ", to=" << addr.ToSensitiveString() << ", err=" << err
-                      << ", id=" << rtc::hex_encode(response.transaction_id());
+                      << ", id=" << rtc::hex_encode(transaction_id);
   } else {
     // Log at LS_INFO if we send a stun ping response on an unwritable
     // connection.
     rtc::LoggingSeverity sev = (!writable()) ? rtc::LS_INFO : rtc::LS_VERBOSE;
-    RTC_LOG_V(sev) << ToString() << ": Sent "
-                   << StunMethodToString(response.type())
+    RTC_LOG_V(sev) << ToString() << ": Sent " << StunMethodToString(type)
                    << ", to=" << addr.ToSensitiveString()
-                   << ", id=" << rtc::hex_encode(response.transaction_id());
+                   << ", id=" << rtc::hex_encode(transaction_id);
 
     stats_.sent_ping_responses++;
     LogCandidatePairEvent(webrtc::IceCandidatePairEventType::kCheckResponseSent,
-                          response.reduced_transaction_id());
+                          reduced_transaction_id);
   }
 }
 
@@ -922,7 +991,7 @@ void Connection::Ping(int64_t now) {
 
   if (ShouldSendGoogPing(req->msg())) {
     auto message = std::make_unique<IceMessage>(GOOG_PING_REQUEST, req->id());
-    message->AddMessageIntegrity32(remote_candidate_.password());
+    message->AddMessageIntegrity32(RemoteIntegrityKey());
     req.reset(new ConnectionRequest(requests_, this, std::move(message)));
   }
 
@@ -991,7 +1060,7 @@ std::unique_ptr<IceMessage> Connection::BuildPingRequest() {
     list->AddTypeAtIndex(kSupportGoogPingVersionRequestIndex, kGoogPingVersion);
     message->AddAttribute(std::move(list));
   }
-  message->AddMessageIntegrity(remote_candidate_.password());
+  message->AddMessageIntegrity(RemoteIntegrityKey());
   message->AddFingerprint();
 
   return message;
@@ -1509,6 +1578,18 @@ ConnectionInfo Connection::stats() {
   return stats_;
 }
 
+const StunMessageIntegrityKey& Connection::LocalIntegrityKey() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  local_integrity_key_.SetPassword(local_candidate_.password());
+  return local_integrity_key_;
+}
+
+const StunMessageIntegrityKey& Connection::RemoteIntegrityKey() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  remote_integrity_key_.SetPassword(remote_candidate_.password());
+  return remote_integrity_key_;
+}
+
 void Connection::MaybeUpdateLocalCandidate(StunRequest* request,
                                            StunMessage* response) {
   if (!port_)
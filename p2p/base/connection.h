@@ -373,6 +373,33 @@ class Connection : public CandidatePairInterface {
   int64_t last_send_data_ = 0;
 
  private:
+  // Return the MESSAGE-INTEGRITY keys for the current local and remote
+  // passwords. The keys are cached, so that connectivity checks do not redo
+  // the HMAC key setup for every message.
+  const StunMessageIntegrityKey& LocalIntegrityKey();
+  const StunMessageIntegrityKey& RemoteIntegrityKey();
+
+  // Handles a plain connectivity check for this connection without parsing
+  // it into an IceMessage, and writes the response on the stack. Returns
+  // false if the packet is anything else, in which case nothing was done.
+  bool MaybeHandleBindingRequestInPlace(const char* data, size_t size)
+      RTC_RUN_ON(network_thread_);
+
+  // Parts of handling a connectivity check, shared by
+  // HandleStunBindingOrGoogPingRequest() and
+  // MaybeHandleBindingRequestInPlace().
+  void MaybeSendExtraPing() RTC_RUN_ON(network_thread_);
+  void UpdateRemoteNomination(absl::optional<uint32_t> nomination,
+                              bool use_candidate) RTC_RUN_ON(network_thread_);
+  void UpdateRemoteNetworkCost(uint32_t network_info)
+      RTC_RUN_ON(network_thread_);
+  void SendResponsePacket(const char* data,
+                          size_t size,
+                          int type,
+                          absl::string_view transaction_id,
+                          uint32_t reduced_transaction_id)
+      RTC_RUN_ON(network_thread_);
+
   // Update the local candidate based on the mapped address attribute.
   // If the local candidate changed, fires SignalStateChange.
   void MaybeUpdateLocalCandidate(StunRequest* request, StunMessage* response)
@@ -458,6 +485,10 @@ class Connection : public CandidatePairInterface {
   std::unique_ptr<StunMessage> cached_stun_binding_
       RTC_GUARDED_BY(network_thread_);
 
+  StunMessageIntegrityKey local_integrity_key_ RTC_GUARDED_BY(network_thread_);
+  StunMessageIntegrityKey remote_integrity_key_
+      RTC_GUARDED_BY(network_thread_);
+
   const IceFieldTrials* field_trials_;
   rtc::EventBasedExponentialMovingAverage rtt_estimate_
       RTC_GUARDED_BY(network_thread_);
@@ -26,6 +26,7 @@
 #include "api/async_dns_resolver.h"
 #include "api/candidate.h"
 #include "api/field_trials_view.h"
+#include "api/location.h"
 #include "api/units/time_delta.h"
 #include "logging/rtc_event_log/ice_logger.h"
 #include "p2p/base/basic_async_resolver_factory.h"
@@ -328,7 +329,8 @@ bool P2PTransportChannel::MaybeSwitchSelectedConnection(
                  [this, reason = result.recheck_event->reason]() {
                    SortConnectionsAndUpdateState(reason);
                  }),
-        TimeDelta::Millis(result.recheck_event->recheck_delay_ms));
+        TimeDelta::Millis(result.recheck_event->recheck_delay_ms),
+        webrtc::Location::Current());
   }
 
   for (const auto* con : result.connections_to_forget_state_on) {
@@ -1746,7 +1748,8 @@ void P2PTransportChannel::RequestSortAndStateUpdate(
     network_thread_->PostTask(
         SafeTask(task_safety_.flag(), [this, reason_to_sort]() {
           SortConnectionsAndUpdateState(reason_to_sort);
-        }));
+        }),
+        webrtc::Location::Current());
     sort_dirty_ = true;
   }
 }
@@ -1763,7 +1766,8 @@ void P2PTransportChannel::MaybeStartPinging() {
                      << ": Have a pingable connection for the first time; "
                         "starting to ping.";
     network_thread_->PostTask(
-        SafeTask(task_safety_.flag(), [this]() { CheckAndPing(); }));
+        SafeTask(task_safety_.flag(), [this]() { CheckAndPing(); }),
+        webrtc::Location::Current());
     regathering_controller_->Start();
     started_pinging_ = true;
   }
@@ -2158,7 +2162,8 @@ void P2PTransportChannel::CheckAndPing() {
   }
 
   network_thread_->PostDelayedTask(
-      SafeTask(task_safety_.flag(), [this]() { CheckAndPing(); }), delay);
+      SafeTask(task_safety_.flag(), [this]() { CheckAndPing(); }), delay,
+      webrtc::Location::Current());
 }
 
 // This method is only for unit testing.
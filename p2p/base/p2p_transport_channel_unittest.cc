@@ -15,6 +15,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/string_view.h"
@@ -45,6 +46,7 @@
 #include "rtc_base/mdns_responder_interface.h"
 #include "rtc_base/nat_server.h"
 #include "rtc_base/nat_socket_factory.h"
+#include "rtc_base/network/received_packet_buffer.h"
 #include "rtc_base/proxy_server.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/ssl_adapter.h"
@@ -52,6 +54,7 @@
 #include "rtc_base/thread.h"
 #include "rtc_base/virtual_socket_server.h"
 #include "system_wrappers/include/metrics.h"
+#include "test/field_trial.h"
 #include "test/scoped_key_value_config.h"
 
 namespace {
@@ -1413,6 +1416,52 @@ TEST_P(P2PTransportChannelTestWithFieldTrials, GetStats) {
   DestroyChannels();
 }
 
+// Keeps the packets received on a transport, taking over the buffer they were
+// read into if possible.
+class ReceivedPacketTaker : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t len,
+                    const int64_t& /* packet_time_us */,
+                    int flags) {
+    packets.push_back(rtc::ScopedReceivedPacketBuffer::TakeOrCopy(data, len));
+  }
+
+  std::vector<rtc::CopyOnWriteBuffer> packets;
+};
+
+// Test that, with batched receive, packets reach the listeners of the channel
+// in the buffer the UDP socket read them into.
+TEST_P(P2PTransportChannelTestWithFieldTrials,
+       ReceivedPacketsCanBeTakenWithoutCopy) {
+  webrtc::test::ScopedFieldTrials field_trials(
+      "WebRTC-UdpReceiveBatching/Enabled/");
+  rtc::ScopedFakeClock clock;
+  ConfigureEndpoints(OPEN, OPEN, kOnlyLocalPorts, kOnlyLocalPorts);
+  CreateChannels();
+  EXPECT_TRUE_SIMULATED_WAIT(CheckConnected(ep1_ch1(), ep2_ch1()),
+                             kMediumTimeout, clock);
+  ReceivedPacketTaker taker;
+  ep2_ch1()->SignalReadPacket.connect(&taker,
+                                      &ReceivedPacketTaker::OnReadPacket);
+
+  const rtc::ScopedReceivedPacketBuffer::Stats before =
+      rtc::ScopedReceivedPacketBuffer::GetStats();
+  const char* data = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890";
+  int len = static_cast<int>(strlen(data));
+  EXPECT_EQ(len, SendData(ep1_ch1(), data, len));
+  EXPECT_EQ_SIMULATED_WAIT(1u, taker.packets.size(), kMediumTimeout, clock);
+  EXPECT_EQ(std::string(data, len),
+            std::string(taker.packets[0].data<char>(), taker.packets[0].size()));
+  const rtc::ScopedReceivedPacketBuffer::Stats after =
+      rtc::ScopedReceivedPacketBuffer::GetStats();
+  EXPECT_EQ(before.taken + 1, after.taken);
+  EXPECT_EQ(before.copies, after.copies);
+
+  DestroyChannels();
+}
+
 TEST_P(P2PTransportChannelTestWithFieldTrials, GetStatsSwitchConnection) {
   rtc::ScopedFakeClock clock;
   IceConfig continual_gathering_config =
@@ -175,6 +175,7 @@ void Port::Construct() {
     ice_username_fragment_ = rtc::CreateRandomString(ICE_UFRAG_LENGTH);
     password_ = rtc::CreateRandomString(ICE_PWD_LENGTH);
   }
+  integrity_key_.SetPassword(password_);
   network_->SignalTypeChanged.connect(this, &Port::OnNetworkTypeChanged);
   network_cost_ = network_->GetCost(field_trials());
 
@@ -222,6 +223,7 @@ void Port::SetIceParameters(int component,
   component_ = component;
   ice_username_fragment_ = std::string(username_fragment);
   password_ = std::string(password);
+  integrity_key_.SetPassword(password_);
   for (Candidate& c : candidates_) {
     c.set_component(component);
     c.set_username(username_fragment);
@@ -485,7 +487,7 @@ bool Port::GetStunMessage(const char* data,
     }
 
     // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
-    if (stun_msg->ValidateMessageIntegrity(password_) !=
+    if (stun_msg->ValidateMessageIntegrity(integrity_key_) !=
         StunMessage::IntegrityStatus::kIntegrityOk) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
                         << StunMethodToString(stun_msg->type())
@@ -552,7 +554,7 @@ bool Port::GetStunMessage(const char* data,
     // No stun attributes will be verified, if it's stun indication message.
     // Returning from end of the this method.
   } else if (stun_msg->type() == GOOG_PING_REQUEST) {
-    if (stun_msg->ValidateMessageIntegrity(password_) !=
+    if (stun_msg->ValidateMessageIntegrity(integrity_key_) !=
         StunMessage::IntegrityStatus::kIntegrityOk) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
                         << StunMethodToString(stun_msg->type())
@@ -586,6 +588,39 @@ bool Port::GetStunMessage(const char* data,
   return true;
 }
 
+bool Port::CanHandleBindingRequestView(const IceBindingRequestView& request,
+                                       absl::string_view* remote_ufrag) const {
+  // RFRAG:LFRAG
+  const absl::string_view username = request.username();
+  size_t colon_pos = username.find(':');
+  if (colon_pos == absl::string_view::npos ||
+      username.substr(0, colon_pos) != username_fragment()) {
+    return false;
+  }
+
+  // Role conflicts are left to MaybeIceRoleConflict().
+  switch (ice_role_) {
+    case ICEROLE_CONTROLLING:
+      if (request.ice_controlling()) {
+        return false;
+      }
+      break;
+    case ICEROLE_CONTROLLED:
+      if (request.ice_controlled()) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+
+  if (!request.ValidateMessageIntegrity(integrity_key_)) {
+    return false;
+  }
+  *remote_ufrag = username.substr(colon_pos + 1);
+  return true;
+}
+
 bool Port::IsCompatibleAddress(const rtc::SocketAddress& addr) {
   // Get a representative IP for the Network this port is configured to use.
   rtc::IPAddress ip = network_->GetBestIP();
@@ -754,9 +789,9 @@ void Port::SendBindingErrorResponse(StunMessage* message,
       error_code != STUN_ERROR_UNAUTHORIZED &&
       message->type() != GOOG_PING_REQUEST) {
     if (message->type() == STUN_BINDING_REQUEST) {
-      response.AddMessageIntegrity(password_);
+      response.AddMessageIntegrity(integrity_key_);
     } else {
-      response.AddMessageIntegrity32(password_);
+      response.AddMessageIntegrity32(integrity_key_);
     }
   }
 
@@ -798,7 +833,7 @@ void Port::SendUnknownAttributesErrorResponse(
   }
   response.AddAttribute(std::move(unknown_attr));
 
-  response.AddMessageIntegrity(password_);
+  response.AddMessageIntegrity(integrity_key_);
   response.AddFingerprint();
 
   // Send the response message.
@@ -439,6 +439,15 @@ class Port : public PortInterface, public sigslot::has_slots<> {
                       std::unique_ptr<IceMessage>* out_msg,
                       std::string* out_username);
 
+  // Does the checks GetStunMessage() does for a binding request on `request`,
+  // without parsing it into an IceMessage. Returns true if the request is for
+  // this port, is authenticated with its password and does not signal an ICE
+  // role conflict, and sets `remote_ufrag` to the remote fragment of the
+  // username. Otherwise returns false without sending a response, and the
+  // request should be handled with GetStunMessage().
+  bool CanHandleBindingRequestView(const IceBindingRequestView& request,
+                                   absl::string_view* remote_ufrag) const;
+
   // Checks if the address in addr is compatible with the port's ip.
   bool IsCompatibleAddress(const rtc::SocketAddress& addr);
 
@@ -502,6 +511,8 @@ class Port : public PortInterface, public sigslot::has_slots<> {
   // username_fragment().
   std::string ice_username_fragment_;
   std::string password_;
+  // Key for `password_`, used for the MESSAGE-INTEGRITY of connectivity checks.
+  StunMessageIntegrityKey integrity_key_;
   std::vector<Candidate> candidates_ RTC_GUARDED_BY(thread_);
   AddressMap connections_;
   int timeout_delay_;
@@ -15,7 +15,9 @@
 #include <string.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <set>
 
@@ -71,9 +73,12 @@ const uint32_t UDP_HEADER_SIZE = 8;
 // TODO(?): Make JINGLE_HEADER_SIZE transparent to this code?
 const uint32_t JINGLE_HEADER_SIZE = 64;  // when relay framing is in use
 
-// Default size for receive and send buffer.
-const uint32_t DEFAULT_RCV_BUF_SIZE = 60 * 1024;
-const uint32_t DEFAULT_SND_BUF_SIZE = 90 * 1024;
+// Default size for receive and send buffer. The receive buffer is large
+// enough to need window scaling.
+const uint32_t DEFAULT_RCV_BUF_SIZE = 256 * 1024;
+const uint32_t DEFAULT_SND_BUF_SIZE = 384 * 1024;
+// Receive buffer size used with peers that don't support window scaling.
+const uint32_t NO_WND_SCALE_RCV_BUF_SIZE = 60 * 1024;
 
 //////////////////////////////////////////////////////////////////////
 // Global Constants and Functions
@@ -89,15 +94,24 @@ const uint32_t DEFAULT_SND_BUF_SIZE = 90 * 1024;
 //  8 |                     Acknowledgment Number                     |
 //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //    |               |   |U|A|P|R|S|F|                               |
-// 12 |    Control    |   |R|C|S|S|Y|I|            Window             |
+// 12 |  SACK blocks  |   |R|C|S|S|Y|I|            Window             |
 //    |               |   |G|K|H|T|N|N|                               |
 //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // 16 |                       Timestamp sending                       |
 //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // 20 |                      Timestamp receiving                      |
 //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-// 24 |                             data                              |
+// 24 |              Left edge of 1st block (if any)                  |
 //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// 28 |              Right edge of 1st block (if any)                 |
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//    |                              ...                              |
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//    |                             data                              |
+//    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+// The SACK blocks byte was always 0 before selective acknowledgements were
+// added, and is only set when the peer sent the SACK permitted option.
 //
 //////////////////////////////////////////////////////////////////////
 
@@ -107,6 +121,9 @@ const uint32_t HEADER_SIZE = 24;
 const uint32_t PACKET_OVERHEAD =
     HEADER_SIZE + UDP_HEADER_SIZE + IP_HEADER_SIZE + JINGLE_HEADER_SIZE;
 
+const uint32_t SACK_BLOCK_SIZE = 8;
+const uint8_t MAX_SACK_BLOCKS = 4;
+
 const uint32_t MIN_RTO =
     250;  // 250 ms (RFC1122, Sec 4.2.3.1 "fractions of a second")
 const uint32_t DEF_RTO = 3000;       // 3 seconds (RFC1122, Sec 4.2.3.1)
@@ -119,10 +136,20 @@ const uint8_t FLAG_RST = 0x04;
 const uint8_t CTL_CONNECT = 0;
 
 // TCP options.
-const uint8_t TCP_OPT_EOL = 0;        // End of list.
-const uint8_t TCP_OPT_NOOP = 1;       // No-op.
-const uint8_t TCP_OPT_MSS = 2;        // Maximum segment size.
-const uint8_t TCP_OPT_WND_SCALE = 3;  // Window scale factor.
+const uint8_t TCP_OPT_EOL = 0;             // End of list.
+const uint8_t TCP_OPT_NOOP = 1;            // No-op.
+const uint8_t TCP_OPT_MSS = 2;             // Maximum segment size.
+const uint8_t TCP_OPT_WND_SCALE = 3;       // Window scale factor.
+const uint8_t TCP_OPT_SACK_PERMITTED = 4;  // Selective acknowledgements.
+
+// Number of segments, or of bytes in excess of this many minus one MSS,
+// which must be selectively acknowledged after a segment to deem it lost
+// (RFC 6675).
+const uint32_t DUP_THRESH = 3;
+
+// CUBIC constants (RFC 8312).
+const double CUBIC_BETA = 0.7;
+const double CUBIC_C = 0.4;
 
 const long DEFAULT_TIMEOUT =
     4000;  // If there are no pending clocks, wake up every 4 seconds
@@ -214,7 +241,8 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
       m_rbuf_len(DEFAULT_RCV_BUF_SIZE),
       m_rbuf(m_rbuf_len),
       m_sbuf_len(DEFAULT_SND_BUF_SIZE),
-      m_sbuf(m_sbuf_len) {
+      m_sbuf(m_sbuf_len),
+      m_packet(new uint8_t[MAX_PACKET]) {
   // Sanity check on buffer sizes (needed for OnTcpWriteable notification logic)
   RTC_DCHECK(m_rbuf_len + MIN_PACKET < m_sbuf_len);
 
@@ -224,6 +252,7 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_conv = conv;
   m_rcv_wnd = m_rbuf_len;
   m_rwnd_scale = m_swnd_scale = 0;
+  m_rcv_sack_seq = 0;
   m_snd_nxt = 0;
   m_snd_wnd = 1;
   m_snd_una = m_rcv_nxt = 0;
@@ -247,6 +276,13 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_dup_acks = 0;
   m_recover = 0;
 
+  m_sack_permitted = false;
+  m_sacked_bytes = m_lost_bytes = m_high_rxt = 0;
+  m_in_recovery = false;
+
+  m_cubic_wmax = m_cubic_origin = m_cubic_west = m_cubic_epoch = 0;
+  m_cubic_k = 0;
+
   m_ts_recent = m_ts_lastack = 0;
 
   m_rx_rto = DEF_RTO;
@@ -255,6 +291,10 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
   m_use_nagling = true;
   m_ack_delay = DEF_ACK_DELAY;
   m_support_wnd_scale = true;
+  m_support_sack = true;
+
+  // Set the window scale factor for the default receive buffer size.
+  resizeReceiveBuffer(m_rbuf_len);
 }
 
 PseudoTcp::~PseudoTcp() {}
@@ -298,15 +338,26 @@ void PseudoTcp::NotifyClock(uint32_t now) {
                        << ") (dup_acks: " << static_cast<unsigned>(m_dup_acks)
                        << ")";
 #endif  // _DEBUGMSG
+      if (m_sack_permitted) {
+        // All the data in flight which hasn't been selectively acknowledged
+        // is retransmitted, as the window opens again (RFC 6675, Sec 5.1).
+        for (SSegment& sseg : m_slist) {
+          if (sseg.xmit > 0 && !sseg.sacked && !sseg.lost) {
+            sseg.lost = true;
+            m_lost_bytes += sseg.len;
+          }
+        }
+        m_high_rxt = m_snd_una;
+        m_in_recovery = true;
+        m_recover = m_snd_nxt;
+      }
+
       if (!transmit(m_slist.begin(), now)) {
         closedown(ECONNABORTED);
         return;
       }
 
-      uint32_t nInFlight = m_snd_nxt - m_snd_una;
-      m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-      // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " <<
-      // nInFlight << "  m_mss: " << m_mss;
+      reduceCongestionWindow();
       m_cwnd = m_mss;
 
       // Back off retransmit timer.  Note: the limit is lower when connecting.
@@ -433,7 +484,9 @@ int PseudoTcp::Recv(char* buffer, size_t len) {
   if (uint32_t(available_space) - m_rcv_wnd >=
       std::min<uint32_t>(m_rbuf_len / 2, m_mss)) {
     // TODO(jbeda): !?! Not sure about this was closed business
-    bool bWasClosed = (m_rcv_wnd == 0);
+    // The advertised window is closed when less than one unit of the scaled
+    // window is left.
+    bool bWasClosed = ((m_rcv_wnd >> m_rwnd_scale) == 0);
     m_rcv_wnd = static_cast<uint32_t>(available_space);
 
     if (bWasClosed) {
@@ -506,28 +559,36 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
                                                 uint8_t flags,
                                                 uint32_t offset,
                                                 uint32_t len) {
-  RTC_DCHECK(HEADER_SIZE + len <= MAX_PACKET);
-
   uint32_t now = Now();
 
-  std::unique_ptr<uint8_t[]> buffer(new uint8_t[MAX_PACKET]);
-  long_to_bytes(m_conv, buffer.get());
-  long_to_bytes(seq, buffer.get() + 4);
-  long_to_bytes(m_rcv_nxt, buffer.get() + 8);
-  buffer[12] = 0;
+  uint8_t* buffer = m_packet.get();
+  // The SACK blocks take the room the data leaves in the MSS, so that they
+  // don't reduce the MSS, as ACKs carry no data anyway.
+  uint8_t sack_blocks = 0;
+  if (m_sack_permitted && !m_rlist.empty() && len < m_mss) {
+    sack_blocks = writeSackBlocks(
+        buffer + HEADER_SIZE,
+        std::min<uint32_t>(MAX_SACK_BLOCKS, (m_mss - len) / SACK_BLOCK_SIZE));
+  }
+  uint32_t header_len = HEADER_SIZE + sack_blocks * SACK_BLOCK_SIZE;
+  RTC_DCHECK(header_len + len <= MAX_PACKET);
+
+  long_to_bytes(m_conv, buffer);
+  long_to_bytes(seq, buffer + 4);
+  long_to_bytes(m_rcv_nxt, buffer + 8);
+  buffer[12] = sack_blocks;
   buffer[13] = flags;
-  short_to_bytes(static_cast<uint16_t>(m_rcv_wnd >> m_rwnd_scale),
-                 buffer.get() + 14);
+  short_to_bytes(static_cast<uint16_t>(m_rcv_wnd >> m_rwnd_scale), buffer + 14);
 
   // Timestamp computations
-  long_to_bytes(now, buffer.get() + 16);
-  long_to_bytes(m_ts_recent, buffer.get() + 20);
+  long_to_bytes(now, buffer + 16);
+  long_to_bytes(m_ts_recent, buffer + 20);
   m_ts_lastack = m_rcv_nxt;
 
   if (len) {
     size_t bytes_read = 0;
     bool result =
-        m_sbuf.ReadOffset(buffer.get() + HEADER_SIZE, len, offset, &bytes_read);
+        m_sbuf.ReadOffset(buffer + header_len, len, offset, &bytes_read);
     RTC_DCHECK(result);
     RTC_DCHECK(static_cast<uint32_t>(bytes_read) == len);
   }
@@ -543,7 +604,7 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 #endif  // _DEBUGMSG
 
   IPseudoTcpNotify::WriteResult wres = m_notify->TcpWritePacket(
-      this, reinterpret_cast<char*>(buffer.get()), len + HEADER_SIZE);
+      this, reinterpret_cast<char*>(buffer), len + header_len);
   // Note: When len is 0, this is an ACK packet.  We don't read the return value
   // for those, and thus we won't retry.  So go ahead and treat the packet as a
   // success (basically simulate as if it were dropped), which will prevent our
@@ -575,8 +636,18 @@ bool PseudoTcp::parse(const uint8_t* buffer, uint32_t size) {
   seg.tsval = bytes_to_long(buffer + 16);
   seg.tsecr = bytes_to_long(buffer + 20);
 
-  seg.data = reinterpret_cast<const char*>(buffer) + HEADER_SIZE;
-  seg.len = size - HEADER_SIZE;
+  // Peers which don't support SACK always send 0, and only send SACK blocks
+  // if we do.
+  seg.sack_blocks = m_support_sack ? buffer[12] : 0;
+  uint32_t header_len = HEADER_SIZE + seg.sack_blocks * SACK_BLOCK_SIZE;
+  if (seg.sack_blocks > MAX_SACK_BLOCKS || size < header_len) {
+    RTC_LOG_F(LS_WARNING) << "Invalid SACK blocks";
+    return false;
+  }
+  seg.sack = reinterpret_cast<const char*>(buffer) + HEADER_SIZE;
+
+  seg.data = reinterpret_cast<const char*>(buffer) + header_len;
+  seg.len = size - header_len;
 
 #if _DEBUGMSG >= _DBG_VERBOSE
   RTC_LOG(LS_INFO) << "--> <CONV=" << seg.conv
@@ -735,19 +806,32 @@ bool PseudoTcp::process(Segment& seg) {
 
     for (uint32_t nFree = nAcked; nFree > 0;) {
       RTC_DCHECK(!m_slist.empty());
-      if (nFree < m_slist.front().len) {
-        m_slist.front().len -= nFree;
+      SSegment& front = m_slist.front();
+      uint32_t nFreed = std::min(nFree, front.len);
+      if (front.sacked) {
+        m_sacked_bytes -= nFreed;
+      }
+      if (front.lost) {
+        m_lost_bytes -= nFreed;
+      }
+      if (nFree < front.len) {
+        front.len -= nFree;
         nFree = 0;
       } else {
-        if (m_slist.front().len > m_largest) {
-          m_largest = m_slist.front().len;
+        if (front.len > m_largest) {
+          m_largest = front.len;
         }
-        nFree -= m_slist.front().len;
+        nFree -= front.len;
         m_slist.pop_front();
       }
     }
 
-    if (m_dup_acks >= 3) {
+    if (m_sack_permitted) {
+      if (!processSack(seg, nAcked, now)) {
+        closedown(ECONNABORTED);
+        return false;
+      }
+    } else if (m_dup_acks >= 3) {
       if (m_snd_una >= m_recover) {  // NewReno
         uint32_t nInFlight = m_snd_nxt - m_snd_una;
         m_cwnd = std::min(m_ssthresh, nInFlight + m_mss);  // (Fast Retransmit)
@@ -767,12 +851,7 @@ bool PseudoTcp::process(Segment& seg) {
       }
     } else {
       m_dup_acks = 0;
-      // Slow start, congestion avoidance
-      if (m_cwnd < m_ssthresh) {
-        m_cwnd += m_mss;
-      } else {
-        m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
-      }
+      increaseCongestionWindow(nAcked, now);
     }
   } else if (seg.ack == m_snd_una) {
     // !?! Note, tcp says don't do this... but otherwise how does a closed
@@ -780,7 +859,12 @@ bool PseudoTcp::process(Segment& seg) {
     m_snd_wnd = static_cast<uint32_t>(seg.wnd) << m_swnd_scale;
 
     // Check duplicate acks
-    if (seg.len > 0) {
+    if (m_sack_permitted) {
+      if (!processSack(seg, 0, now)) {
+        closedown(ECONNABORTED);
+        return false;
+      }
+    } else if (seg.len > 0) {
       // it's a dup ack, but with a data payload, so don't modify m_dup_acks
     } else if (m_snd_una != m_snd_nxt) {
       m_dup_acks += 1;
@@ -794,10 +878,7 @@ bool PseudoTcp::process(Segment& seg) {
           return false;
         }
         m_recover = m_snd_nxt;
-        uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
-        // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: "
-        // << nInFlight << "  m_mss: " << m_mss;
+        reduceCongestionWindow();
         m_cwnd = m_ssthresh + 3 * m_mss;
       } else if (m_dup_acks > 3) {
         m_cwnd += m_mss;
@@ -926,6 +1007,11 @@ bool PseudoTcp::process(Segment& seg) {
         // May be able to recover packets previously received out-of-order
         // now.
         bRecover = true;
+        // A segment which fills part of a hole is acknowledged at once, so
+        // that the sender learns about the rest (RFC 5681, Sec 4.2).
+        if (!m_rlist.empty()) {
+          sflags = sfImmediateAck;
+        }
       } else {
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "Saving " << seg.len << " bytes (" << seg.seq
@@ -934,6 +1020,7 @@ bool PseudoTcp::process(Segment& seg) {
         RSegment rseg;
         rseg.seq = seg.seq;
         rseg.len = seg.len;
+        m_rcv_sack_seq = seg.seq;
         RList::iterator it = m_rlist.begin();
         while ((it != m_rlist.end()) && (it->seq < rseg.seq)) {
           ++it;
@@ -1025,6 +1112,7 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
     SSegment subseg(seg->seq + nTransmit, seg->len - nTransmit, seg->bCtrl);
     // subseg.tstamp = seg->tstamp;
     subseg.xmit = seg->xmit;
+    subseg.lost = seg->lost;
     seg->len = nTransmit;
 
     SList::iterator next = seg;
@@ -1034,6 +1122,16 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
   if (seg->xmit == 0) {
     m_snd_nxt += seg->len;
   }
+  if (seg->lost) {
+    seg->lost = false;
+    m_lost_bytes -= seg->len;
+    m_high_rxt = std::max(m_high_rxt, seg->seq + seg->len);
+    // The retransmission of the first segment may wait for the pipe to drain
+    // in recovery, so give it a full RTO, rather than one from the last ACK.
+    if (seg == m_slist.begin()) {
+      m_rto_base = now;
+    }
+  }
   seg->xmit += 1;
   // seg->tstamp = now;
   if (m_rto_base == 0) {
@@ -1048,6 +1146,7 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
 
   if (rtc::TimeDiff32(now, m_lastsend) > static_cast<long>(m_rx_rto)) {
     m_cwnd = m_mss;
+    m_cubic_epoch = 0;
   }
 
 #if _DEBUGMSG
@@ -1061,7 +1160,28 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
     }
     uint32_t nWindow = std::min(m_snd_wnd, cwnd);
     uint32_t nInFlight = m_snd_nxt - m_snd_una;
-    uint32_t nUseable = (nInFlight < nWindow) ? (nWindow - nInFlight) : 0;
+    // The data selectively acknowledged or deemed lost has left the network,
+    // and doesn't count against the congestion window (RFC 6675 "pipe").
+    uint32_t nPipe = nInFlight - m_sacked_bytes - m_lost_bytes;
+
+    // Retransmit the lost segments first.
+    if (m_lost_bytes > 0 && nPipe + m_mss <= cwnd) {
+      SList::iterator seg = m_slist.begin();
+      while (!seg->lost) {
+        ++seg;
+        RTC_DCHECK(seg != m_slist.end());
+      }
+      if (!transmit(seg, now)) {
+        RTC_LOG_F(LS_VERBOSE) << "retransmit failed";
+        return;
+      }
+      sflags = sfNone;
+      continue;
+    }
+
+    uint32_t nUseable = std::min(
+        (nInFlight < m_snd_wnd) ? (m_snd_wnd - nInFlight) : 0,
+        (nPipe < cwnd) ? (cwnd - nPipe) : 0);
 
     size_t snd_buffered = m_sbuf.GetBuffered();
     uint32_t nAvailable =
@@ -1112,12 +1232,13 @@ void PseudoTcp::attemptSend(SendFlags sflags) {
       return;
     }
 
-    // Find the next segment to transmit
-    SList::iterator it = m_slist.begin();
-    while (it->xmit > 0) {
-      ++it;
-      RTC_DCHECK(it != m_slist.end());
+    // Find the next segment to transmit. The segments which have been
+    // transmitted come first, so search from the end.
+    SList::iterator it = m_slist.end();
+    while (it != m_slist.begin() && std::prev(it)->xmit == 0) {
+      --it;
     }
+    RTC_DCHECK(it != m_slist.end());
     SList::iterator seg = it;
 
     // If the segment is too large, break it into two
@@ -1166,11 +1287,16 @@ void PseudoTcp::adjustMTU() {
 bool PseudoTcp::isReceiveBufferFull() const {
   size_t available_space = 0;
   m_rbuf.GetWriteRemaining(&available_space);
-  return !available_space;
+  return (available_space >> m_rwnd_scale) == 0;
 }
 
 void PseudoTcp::disableWindowScale() {
   m_support_wnd_scale = false;
+  resizeReceiveBuffer(m_rbuf_len);
+}
+
+void PseudoTcp::disableSack() {
+  m_support_sack = false;
 }
 
 void PseudoTcp::queueConnectMessage() {
@@ -1182,6 +1308,10 @@ void PseudoTcp::queueConnectMessage() {
     buf.WriteUInt8(1);
     buf.WriteUInt8(m_rwnd_scale);
   }
+  if (m_support_sack) {
+    buf.WriteUInt8(TCP_OPT_SACK_PERMITTED);
+    buf.WriteUInt8(0);
+  }
   m_snd_wnd = static_cast<uint32_t>(buf.Length());
   queue(buf.Data(), static_cast<uint32_t>(buf.Length()), true);
 }
@@ -1225,11 +1355,17 @@ void PseudoTcp::parseOptions(const char* data, uint32_t len) {
 
     if (m_rwnd_scale > 0) {
       // Peer doesn't support TCP options and window scaling.
-      // Revert receive buffer size to default value.
-      resizeReceiveBuffer(DEFAULT_RCV_BUF_SIZE);
+      // Revert receive buffer size to a value which doesn't need scaling.
+      resizeReceiveBuffer(NO_WND_SCALE_RCV_BUF_SIZE);
       m_swnd_scale = 0;
     }
   }
+
+  // Selective acknowledgements are used if both peers support them. Peers
+  // which don't ignore the option.
+  m_sack_permitted =
+      m_support_sack && (options_specified.find(TCP_OPT_SACK_PERMITTED) !=
+                         options_specified.end());
 }
 
 void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
@@ -1259,6 +1395,11 @@ void PseudoTcp::resizeSendBuffer(uint32_t new_size) {
 void PseudoTcp::resizeReceiveBuffer(uint32_t new_size) {
   uint8_t scale_factor = 0;
 
+  // Without window scaling, the window must fit in 16 bits as is.
+  if (!m_support_wnd_scale) {
+    new_size = std::min(new_size, NO_WND_SCALE_RCV_BUF_SIZE);
+  }
+
   // Determine the scale factor such that the scaled window size can fit
   // in a 16-bit unsigned integer.
   while (new_size > 0xFFFF) {
@@ -1284,6 +1425,188 @@ void PseudoTcp::resizeReceiveBuffer(uint32_t new_size) {
   m_rcv_wnd = static_cast<uint32_t>(available_space);
 }
 
+uint8_t PseudoTcp::writeSackBlocks(uint8_t* buffer, uint8_t max_blocks) const {
+  // Merge the out-of-order segments, which are sorted but may overlap, into
+  // blocks. The first block holds the last segment received, and the others
+  // follow in order (RFC 2018, Sec 4).
+  if (max_blocks == 0) {
+    return 0;
+  }
+  uint8_t blocks = 1;
+  bool have_first = false;
+  RList::const_iterator it = m_rlist.begin();
+  while (it != m_rlist.end()) {
+    uint32_t left = it->seq;
+    uint32_t right = it->seq + it->len;
+    for (++it; it != m_rlist.end() && it->seq <= right; ++it) {
+      right = std::max(right, it->seq + it->len);
+    }
+    if (right <= m_rcv_nxt) {
+      continue;
+    }
+    left = std::max(left, m_rcv_nxt);
+    uint8_t* block;
+    if (!have_first && left <= m_rcv_sack_seq && m_rcv_sack_seq < right) {
+      block = buffer;
+      have_first = true;
+    } else if (blocks < max_blocks) {
+      block = buffer + blocks++ * SACK_BLOCK_SIZE;
+    } else if (have_first) {
+      break;
+    } else {
+      continue;
+    }
+    long_to_bytes(left, block);
+    long_to_bytes(right, block + 4);
+  }
+  if (!have_first) {
+    memmove(buffer, buffer + SACK_BLOCK_SIZE, (blocks - 1) * SACK_BLOCK_SIZE);
+    --blocks;
+  }
+  return blocks;
+}
+
+bool PseudoTcp::processSack(const Segment& seg, uint32_t nAcked, uint32_t now) {
+  applySackBlocks(seg);
+  if (m_in_recovery && m_snd_una >= m_recover) {
+#if _DEBUGMSG >= _DBG_NORMAL
+    RTC_LOG(LS_INFO) << "exit recovery";
+#endif  // _DEBUGMSG
+    m_in_recovery = false;
+  }
+  if (m_sacked_bytes > 0) {
+    markLostSegments();
+  }
+
+  // Duplicate acks still mark the first segment as lost, as the peer sends
+  // no SACK blocks until it got our connect message.
+  if (nAcked > 0) {
+    m_dup_acks = 0;
+  } else if (seg.len == 0 && m_snd_una != m_snd_nxt &&
+             m_dup_acks < DUP_THRESH) {
+    ++m_dup_acks;
+    SSegment& front = m_slist.front();
+    if (m_dup_acks == DUP_THRESH && front.xmit > 0 && !front.sacked &&
+        !front.lost && front.seq >= m_high_rxt) {
+      front.lost = true;
+      m_lost_bytes += front.len;
+    }
+  }
+
+  if (!m_in_recovery && m_lost_bytes > 0) {
+#if _DEBUGMSG >= _DBG_NORMAL
+    RTC_LOG(LS_INFO) << "enter recovery";
+#endif  // _DEBUGMSG
+    m_in_recovery = true;
+    m_recover = m_snd_nxt;
+    reduceCongestionWindow();
+    m_cwnd = m_ssthresh;
+    // The first lost segment is retransmitted now, and the others by
+    // attemptSend, as the data in flight drops below the reduced window.
+    SList::iterator it = m_slist.begin();
+    while (!it->lost) {
+      ++it;
+      RTC_DCHECK(it != m_slist.end());
+    }
+    return transmit(it, now);
+  }
+  if (nAcked > 0 && (!m_in_recovery || m_cwnd < m_ssthresh)) {
+    // The window only grows in recovery in slow start after a timeout.
+    increaseCongestionWindow(nAcked, now);
+  }
+  return true;
+}
+
+void PseudoTcp::applySackBlocks(const Segment& seg) {
+  for (uint8_t i = 0; i < seg.sack_blocks; ++i) {
+    uint32_t left = bytes_to_long(seg.sack + i * SACK_BLOCK_SIZE);
+    uint32_t right = bytes_to_long(seg.sack + i * SACK_BLOCK_SIZE + 4);
+    if (left >= right || left < m_snd_una || right > m_snd_nxt) {
+      continue;
+    }
+    SList::iterator it = m_slist.begin();
+    while (it != m_slist.end() && it->seq < left) {
+      ++it;
+    }
+    for (; it != m_slist.end() && it->seq + it->len <= right; ++it) {
+      if (it->sacked) {
+        continue;
+      }
+      it->sacked = true;
+      m_sacked_bytes += it->len;
+      if (it->lost) {
+        it->lost = false;
+        m_lost_bytes -= it->len;
+      }
+    }
+  }
+}
+
+void PseudoTcp::markLostSegments() {
+  uint32_t sacked_segments = 0;
+  uint32_t sacked_bytes = 0;
+  for (SList::reverse_iterator it = m_slist.rbegin();
+       it != m_slist.rend() && it->seq >= m_high_rxt; ++it) {
+    if (it->sacked) {
+      ++sacked_segments;
+      sacked_bytes += it->len;
+    } else if (it->xmit > 0 && !it->lost &&
+               (sacked_segments >= DUP_THRESH ||
+                sacked_bytes > (DUP_THRESH - 1) * m_mss)) {
+      it->lost = true;
+      m_lost_bytes += it->len;
+    }
+  }
+}
+
+void PseudoTcp::reduceCongestionWindow() {
+  // The window is not grown past the data in flight if the sender is limited
+  // by the application or the receive window.
+  uint32_t cwnd = std::min(m_cwnd, std::max(m_snd_nxt - m_snd_una, m_mss));
+  // Fast convergence: release bandwidth for new flows if the window is
+  // reduced again before it grew back.
+  if (cwnd < m_cubic_wmax) {
+    m_cubic_wmax = static_cast<uint32_t>(cwnd * (1 + CUBIC_BETA) / 2);
+  } else {
+    m_cubic_wmax = cwnd;
+  }
+  m_ssthresh = std::max(static_cast<uint32_t>(cwnd * CUBIC_BETA), 2 * m_mss);
+  m_cubic_epoch = 0;
+}
+
+void PseudoTcp::increaseCongestionWindow(uint32_t nAcked, uint32_t now) {
+  // Slow start
+  if (m_cwnd < m_ssthresh) {
+    m_cwnd += m_mss;
+    return;
+  }
+
+  // Congestion avoidance
+  if (m_cubic_epoch == 0) {
+    m_cubic_epoch = now ? now : 1;
+    m_cubic_origin = std::max(m_cubic_wmax, m_cwnd);
+    m_cubic_k = std::cbrt(static_cast<double>(m_cubic_origin - m_cwnd) /
+                          m_mss / CUBIC_C);
+    m_cubic_west = m_cwnd;
+  }
+  // The window at one round trip from now, per the cubic function of the
+  // time since the epoch started, and the window that standard TCP would
+  // have reached in the same time, which is used if larger.
+  uint32_t rtt = std::max<uint32_t>(m_rx_srtt, 1);
+  double t = rtc::TimeDiff32(now + rtt, m_cubic_epoch) / 1000.0;
+  double target =
+      m_cubic_origin + CUBIC_C * std::pow(t - m_cubic_k, 3) * m_mss;
+  double west = m_cubic_west + 3 * (1 - CUBIC_BETA) / (1 + CUBIC_BETA) *
+                                   (t * 1000 / rtt) * m_mss;
+  target = std::min(std::max(target, west), 1.5 * m_cwnd);
+  // Over a round trip, a window's worth of data is acknowledged, and the
+  // window grows to the target.
+  if (target > m_cwnd) {
+    m_cwnd += std::max<uint32_t>(
+        1, static_cast<uint32_t>((target - m_cwnd) * nAcked / m_cwnd));
+  }
+}
+
 PseudoTcp::LockedFifoBuffer::LockedFifoBuffer(size_t size)
     : buffer_(new char[size]),
       buffer_length_(size),
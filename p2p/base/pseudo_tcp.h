@@ -126,15 +126,26 @@ class RTC_EXPORT PseudoTcp {
     const char* data;
     uint32_t len;
     uint32_t tsval, tsecr;
+    // SACK blocks, as pairs of left and right edge sequence numbers.
+    const char* sack;
+    uint8_t sack_blocks;
   };
 
   struct SSegment {
     SSegment(uint32_t s, uint32_t l, bool c)
-        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c) {}
+        : seq(s),
+          len(l),
+          /*tstamp(0),*/ xmit(0),
+          bCtrl(c),
+          sacked(false),
+          lost(false) {}
     uint32_t seq, len;
     // uint32_t tstamp;
     uint8_t xmit;
     bool bCtrl;
+    // Whether the peer has selectively acknowledged this segment, and whether
+    // it is deemed lost and waiting to be retransmitted.
+    bool sacked, lost;
   };
   typedef std::list<SSegment> SList;
 
@@ -177,6 +188,10 @@ class RTC_EXPORT PseudoTcp {
   // support for testing backward compatibility.
   void disableWindowScale();
 
+  // This method is only used in tests, to disable selective acknowledgement
+  // support for testing backward compatibility.
+  void disableSack();
+
  private:
   // Queue the connect message with TCP options.
   void queueConnectMessage();
@@ -197,6 +212,29 @@ class RTC_EXPORT PseudoTcp {
   // window scale factor `m_swnd_scale` accordingly.
   void resizeReceiveBuffer(uint32_t new_size);
 
+  // Write at most `max_blocks` SACK blocks describing the out-of-order data
+  // received to `buffer`, and return their number.
+  uint8_t writeSackBlocks(uint8_t* buffer, uint8_t max_blocks) const;
+
+  // Update the SACK scoreboard and the congestion window with an incoming
+  // segment which acknowledges `nAcked` new bytes, and retransmit the first
+  // lost segment when entering recovery. Returns false if that fails.
+  bool processSack(const Segment& seg, uint32_t nAcked, uint32_t now);
+
+  // Mark the segments which SACK blocks show as received by the peer.
+  void applySackBlocks(const Segment& seg);
+
+  // Mark the unacknowledged segments with enough data selectively
+  // acknowledged after them as lost (RFC 6675).
+  void markLostSegments();
+
+  // Set `m_ssthresh` after a congestion event.
+  void reduceCongestionWindow();
+
+  // Grow the congestion window for `nAcked` newly acknowledged bytes, with
+  // slow start or CUBIC congestion avoidance (RFC 8312).
+  void increaseCongestionWindow(uint32_t nAcked, uint32_t now);
+
   class LockedFifoBuffer final {
    public:
     explicit LockedFifoBuffer(size_t size);
@@ -257,12 +295,16 @@ class RTC_EXPORT PseudoTcp {
   uint32_t m_rbuf_len, m_rcv_nxt, m_rcv_wnd, m_lastrecv;
   uint8_t m_rwnd_scale;  // Window scale factor.
   LockedFifoBuffer m_rbuf;
+  // Start of the last out-of-order segment, reported first in SACK blocks.
+  uint32_t m_rcv_sack_seq;
 
   // Outgoing data
   SList m_slist;
   uint32_t m_sbuf_len, m_snd_nxt, m_snd_wnd, m_lastsend, m_snd_una;
   uint8_t m_swnd_scale;  // Window scale factor.
   LockedFifoBuffer m_sbuf;
+  // Buffer to build outgoing packets in.
+  std::unique_ptr<uint8_t[]> m_packet;
 
   // Maximum segment size, estimated protocol level, largest segment sent
   uint32_t m_mss, m_msslevel, m_largest, m_mtu_advise;
@@ -281,6 +323,20 @@ class RTC_EXPORT PseudoTcp {
   uint32_t m_recover;
   uint32_t m_t_ack;
 
+  // Selective acknowledgements: whether both peers support them, the bytes
+  // of the segments in flight which are selectively acknowledged or deemed
+  // lost, the end of the data retransmitted in the current recovery, and
+  // whether no new congestion event is taken until `m_recover` is acked.
+  bool m_sack_permitted;
+  uint32_t m_sacked_bytes, m_lost_bytes, m_high_rxt;
+  bool m_in_recovery;
+
+  // CUBIC: the window before the last reduction, the window the current
+  // congestion avoidance epoch grows back to and from, when it started, and
+  // the time in seconds to reach the former.
+  uint32_t m_cubic_wmax, m_cubic_origin, m_cubic_west, m_cubic_epoch;
+  double m_cubic_k;
+
   // Configuration options
   bool m_use_nagling;
   uint32_t m_ack_delay;
@@ -288,6 +344,10 @@ class RTC_EXPORT PseudoTcp {
   // This is used by unit tests to test backward compatibility of
   // PseudoTcp implementations that don't support window scaling.
   bool m_support_wnd_scale;
+
+  // This is used by unit tests to test backward compatibility of
+  // PseudoTcp implementations that don't support selective acknowledgements.
+  bool m_support_sack;
 };
 
 }  // namespace cricket
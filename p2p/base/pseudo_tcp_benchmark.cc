@@ -0,0 +1,198 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "api/task_queue/pending_task_safety_flag.h"
+#include "api/units/time_delta.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/pseudo_tcp.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+
+namespace cricket {
+namespace {
+
+using ::webrtc::ScopedTaskSafety;
+using ::webrtc::TimeDelta;
+
+constexpr uint32_t kConversationId = 1;
+constexpr int kMtu = 1500;
+constexpr uint32_t kBandwidth = 12500000;  // 100 Mbps
+constexpr size_t kTransferSize = 4 * 1024 * 1024;
+constexpr int64_t kTransferTimeoutMs = 300000;
+constexpr size_t kBlockSize = 16 * 1024;
+
+const rtc::SocketAddress kSenderAddress("11.11.11.11", 5000);
+const rtc::SocketAddress kReceiverAddress("22.22.22.22", 5000);
+
+// Exposes the switches back to 64 KB windows without selective
+// acknowledgements, as before they were on by default.
+class BenchmarkPseudoTcp : public PseudoTcp {
+ public:
+  using PseudoTcp::disableSack;
+  using PseudoTcp::disableWindowScale;
+  using PseudoTcp::PseudoTcp;
+};
+
+// One end of a PseudoTcp connection over a UDP socket of the virtual network,
+// which either sends `kTransferSize` bytes or receives them.
+class Endpoint : public IPseudoTcpNotify, public sigslot::has_slots<> {
+ public:
+  Endpoint(rtc::SocketFactory* socket_factory,
+           const rtc::SocketAddress& address,
+           const rtc::SocketAddress& remote_address,
+           bool legacy)
+      : socket_(rtc::AsyncUDPSocket::Create(socket_factory, address)),
+        remote_address_(remote_address),
+        tcp_(this, kConversationId) {
+    socket_->SignalReadPacket.connect(this, &Endpoint::OnReadPacket);
+    tcp_.NotifyMTU(kMtu);
+    if (legacy) {
+      tcp_.disableWindowScale();
+      tcp_.disableSack();
+    }
+  }
+
+  // Connects to the other endpoint, and sends it `kTransferSize` bytes.
+  void SendTransfer() {
+    bytes_to_send_ = kTransferSize;
+    tcp_.Connect();
+    UpdateClock();
+  }
+
+  size_t bytes_received() const { return bytes_received_; }
+
+ private:
+  // IPseudoTcpNotify implementation.
+  void OnTcpOpen(PseudoTcp* tcp) override { WriteData(); }
+  void OnTcpReadable(PseudoTcp* tcp) override { ReadData(); }
+  void OnTcpWriteable(PseudoTcp* tcp) override { WriteData(); }
+  void OnTcpClosed(PseudoTcp* tcp, uint32_t error) override {}
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    if (socket_->SendTo(buffer, len, remote_address_, rtc::PacketOptions()) <
+        0) {
+      return WR_FAIL;
+    }
+    return WR_SUCCESS;
+  }
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_address,
+                    const int64_t& packet_time_us) {
+    tcp_.NotifyPacket(data, size);
+    UpdateClock();
+  }
+
+  void WriteData() {
+    static const char kBlock[kBlockSize] = {0};
+    while (bytes_to_send_ > 0) {
+      int sent = tcp_.Send(kBlock, std::min(bytes_to_send_, kBlockSize));
+      if (sent <= 0) {
+        break;
+      }
+      bytes_to_send_ -= sent;
+    }
+    UpdateClock();
+  }
+
+  void ReadData() {
+    char block[kBlockSize];
+    int received;
+    while ((received = tcp_.Recv(block, sizeof(block))) > 0) {
+      bytes_received_ += received;
+    }
+    UpdateClock();
+  }
+
+  void UpdateClock() {
+    long interval = 0;  // NOLINT
+    if (!tcp_.GetNextClock(PseudoTcp::Now(), interval)) {
+      return;
+    }
+    timer_.reset();
+    rtc::Thread::Current()->PostDelayedTask(
+        SafeTask(timer_.flag(),
+                 [this] {
+                   tcp_.NotifyClock(PseudoTcp::Now());
+                   UpdateClock();
+                 }),
+        TimeDelta::Millis(std::max<long>(interval, 0)));  // NOLINT
+  }
+
+  const std::unique_ptr<rtc::AsyncUDPSocket> socket_;
+  const rtc::SocketAddress remote_address_;
+  BenchmarkPseudoTcp tcp_;
+  ScopedTaskSafety timer_;
+  size_t bytes_to_send_ = 0;
+  size_t bytes_received_ = 0;
+};
+
+// Transfers `kTransferSize` bytes over a 100 Mbps virtual network with the
+// given round trip time and random loss, and a bottleneck queue of 100 ms.
+// The time reported is the simulated time of the transfer, so the bytes per
+// second are the goodput of the connection. With `sack_wscale` set to 0, both
+// ends use 64 KB windows and no selective acknowledgements.
+void BM_PseudoTcpTransfer(benchmark::State& state) {
+  const int rtt_ms = state.range(0);
+  const double loss = state.range(1) / 1000.0;
+  const bool legacy = state.range(2) == 0;
+  for (auto s : state) {
+    rtc::ScopedFakeClock clock;
+    clock.AdvanceTime(TimeDelta::Seconds(1));
+    rtc::VirtualSocketServer socket_server(&clock);
+    rtc::AutoSocketServerThread thread(&socket_server);
+    socket_server.set_bandwidth(kBandwidth);
+    socket_server.set_network_capacity(kBandwidth / 10);
+    socket_server.set_delay_mean(rtt_ms / 2);
+    socket_server.UpdateDelayDistribution();
+    socket_server.set_drop_probability(loss);
+
+    Endpoint sender(&socket_server, kSenderAddress, kReceiverAddress, legacy);
+    Endpoint receiver(&socket_server, kReceiverAddress, kSenderAddress,
+                      legacy);
+    const int64_t start_ms = rtc::TimeMillis();
+    sender.SendTransfer();
+    while (receiver.bytes_received() < kTransferSize &&
+           rtc::TimeMillis() - start_ms < kTransferTimeoutMs) {
+      clock.AdvanceTime(TimeDelta::Millis(1));
+    }
+    if (receiver.bytes_received() < kTransferSize) {
+      state.SkipWithError("The transfer timed out.");
+      return;
+    }
+    state.SetIterationTime((rtc::TimeMillis() - start_ms) / 1000.0);
+  }
+  state.SetBytesProcessed(state.iterations() * kTransferSize);
+}
+
+BENCHMARK(BM_PseudoTcpTransfer)
+    ->ArgNames({"rtt_ms", "loss_permille", "sack_wscale"})
+    ->ArgsProduct({{10, 50, 200}, {0, 1, 10}, {0, 1}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+}  // namespace
+}  // namespace cricket
@@ -45,6 +45,8 @@ class PseudoTcpForTest : public cricket::PseudoTcp {
   bool isReceiveBufferFull() const { return PseudoTcp::isReceiveBufferFull(); }
 
   void disableWindowScale() { PseudoTcp::disableWindowScale(); }
+
+  void disableSack() { PseudoTcp::disableSack(); }
 };
 
 class PseudoTcpTestBase : public ::testing::Test,
@@ -104,6 +106,8 @@ class PseudoTcpTestBase : public ::testing::Test,
   }
   void DisableRemoteWindowScale() { remote_.disableWindowScale(); }
   void DisableLocalWindowScale() { local_.disableWindowScale(); }
+  void DisableRemoteSack() { remote_.disableSack(); }
+  void DisableLocalSack() { local_.disableSack(); }
 
  protected:
   int Connect() {
@@ -615,6 +619,26 @@ TEST_F(PseudoTcpTest, TestSendWithDelayAndLoss) {
   TestTransfer(100000);  // less data so test runs faster
 }
 
+// Test sending data with 10% packet loss to a receiver that doesn't support
+// selective acknowledgements, which falls back to NewReno recovery.
+TEST_F(PseudoTcpTest, TestSendWithLossRemoteNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  DisableRemoteSack();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
+// Test sending data with 10% packet loss from a sender that doesn't support
+// selective acknowledgements.
+TEST_F(PseudoTcpTest, TestSendWithLossLocalNoSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  DisableLocalSack();
+  TestTransfer(100000);  // less data so test runs faster
+}
+
 // Test sending data with 10% packet loss and Nagling disabled.  Transmission
 // should take about the same time as with Nagling enabled.
 TEST_F(PseudoTcpTest, TestSendWithLossAndOptNaglingOff) {
@@ -826,6 +850,8 @@ TEST_F(PseudoTcpTestReceiveWindow, TestSetVerySmallSendWindowSize) {
   SetOptNagling(false);
   SetOptAckDelay(0);
   SetOptSndBuf(900);
+  // Each round trip only moves 900 bytes, so keep the receive window small.
+  SetRemoteOptRcvBuf(60 * 1024);
   TestTransfer(1024 * 1000);
   EXPECT_EQ(900u, EstimateSendWindowSize());
 }
@@ -842,6 +868,17 @@ TEST_F(PseudoTcpTestReceiveWindow, TestSetReceiveWindowSize) {
   EXPECT_EQ(100000u, EstimateReceiveWindowSize());
 }
 
+// Test that the default receive window is larger than 64 KB, which needs
+// window scaling.
+TEST_F(PseudoTcpTestReceiveWindow, TestDefaultReceiveWindowSize) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetOptNagling(false);
+  SetOptAckDelay(0);
+  TestTransfer(1024 * 1000);
+  EXPECT_EQ(256u * 1024, EstimateReceiveWindowSize());
+}
+
 /* Test sending data with mismatched MTUs. We should detect this and reduce
 // our packet size accordingly.
 // TODO(?): This doesn't actually work right now. The current code
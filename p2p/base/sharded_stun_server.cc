@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_stun_server.h"
+
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/checks.h"
+
+namespace cricket {
+
+ShardedStunServer::ShardedStunServer(std::vector<rtc::Thread*> threads) {
+  RTC_DCHECK(!threads.empty());
+  for (rtc::Thread* thread : threads) {
+    shards_.push_back(Shard{.thread = thread});
+  }
+}
+
+ShardedStunServer::~ShardedStunServer() {
+  for (Shard& shard : shards_) {
+    shard.thread->BlockingCall([&] { shard.server.reset(); });
+  }
+}
+
+rtc::SocketAddress ShardedStunServer::Start(const rtc::SocketAddress& address) {
+  rtc::SocketAddress bound_address = address;
+  for (Shard& shard : shards_) {
+    RTC_DCHECK(!shard.server);
+    shard.thread->BlockingCall([&] {
+      rtc::AsyncUDPSocket* socket = rtc::AsyncUDPSocket::CreateWithReusePort(
+          shard.thread->socketserver(), bound_address);
+      if (socket) {
+        bound_address = socket->GetLocalAddress();
+        shard.server = std::make_unique<StunServer>(socket);
+      }
+    });
+    if (!shard.server) {
+      for (Shard& started_shard : shards_) {
+        started_shard.thread->BlockingCall(
+            [&] { started_shard.server.reset(); });
+      }
+      return rtc::SocketAddress();
+    }
+  }
+  return bound_address;
+}
+
+}  // namespace cricket
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_SHARDED_STUN_SERVER_H_
+#define P2P_BASE_SHARDED_STUN_SERVER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "p2p/base/stun_server.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+// Answers STUN binding requests on several threads. Each thread has its own
+// StunServer, listening on its own UDP socket, and all the sockets are bound
+// to the same address with SO_REUSEPORT, so that the kernel spreads the
+// clients across them by hashing the 5-tuple. Only supported on Linux.
+class ShardedStunServer {
+ public:
+  // The threads must outlive the server, and need a socket server, as created
+  // with rtc::Thread::CreateWithSocketServer.
+  explicit ShardedStunServer(std::vector<rtc::Thread*> threads);
+  ~ShardedStunServer();
+
+  size_t num_shards() const { return shards_.size(); }
+
+  // Opens a socket bound to `address` on each thread. If the port of
+  // `address` is 0, all the sockets bind the port picked for the first one.
+  // Returns the bound address, or nil if the sockets could not be opened.
+  // Must be called once.
+  rtc::SocketAddress Start(const rtc::SocketAddress& address);
+
+ private:
+  struct Shard {
+    rtc::Thread* thread;
+    std::unique_ptr<StunServer> server;
+  };
+
+  std::vector<Shard> shards_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_SHARDED_STUN_SERVER_H_
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_stun_server.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/stun.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/test_client.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumShards = 4;
+constexpr int kNumClients = 32;
+constexpr int kRequestsPerClient = 50;
+
+class ShardedStunServerTest : public ::testing::Test {
+ public:
+  ShardedStunServerTest() : main_thread_(&socket_server_) {
+    std::vector<rtc::Thread*> threads;
+    for (int i = 0; i < kNumShards; ++i) {
+      threads_.push_back(rtc::Thread::CreateWithSocketServer());
+      threads_.back()->Start();
+      threads.push_back(threads_.back().get());
+    }
+    server_ = std::make_unique<ShardedStunServer>(threads);
+  }
+
+  std::unique_ptr<rtc::TestClient> CreateClient() {
+    return std::make_unique<rtc::TestClient>(
+        absl::WrapUnique(rtc::AsyncUDPSocket::Create(
+            &socket_server_, rtc::SocketAddress("127.0.0.1", 0))));
+  }
+
+ protected:
+  rtc::PhysicalSocketServer socket_server_;
+  rtc::AutoSocketServerThread main_thread_;
+  std::vector<std::unique_ptr<rtc::Thread>> threads_;
+  std::unique_ptr<ShardedStunServer> server_;
+};
+
+#if defined(WEBRTC_LINUX)
+
+// Many clients keep one binding request each in flight, for several rounds,
+// and all of them get answered.
+TEST_F(ShardedStunServerTest, AnswersManyClients) {
+  const rtc::SocketAddress server_address =
+      server_->Start(rtc::SocketAddress("127.0.0.1", 0));
+  ASSERT_FALSE(server_address.IsNil());
+  EXPECT_NE(0, server_address.port());
+
+  std::vector<std::unique_ptr<rtc::TestClient>> clients;
+  for (int i = 0; i < kNumClients; ++i) {
+    clients.push_back(CreateClient());
+  }
+
+  const int64_t start_ms = rtc::TimeMillis();
+  int responses = 0;
+  for (int round = 0; round < kRequestsPerClient; ++round) {
+    std::vector<std::string> transaction_ids;
+    for (const auto& client : clients) {
+      StunMessage request(STUN_BINDING_REQUEST);
+      rtc::ByteBufferWriter buf;
+      request.Write(&buf);
+      client->SendTo(buf.Data(), buf.Length(), server_address);
+      transaction_ids.push_back(request.transaction_id());
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+      std::unique_ptr<rtc::TestClient::Packet> packet =
+          clients[i]->NextPacket(rtc::TestClient::kTimeoutMs);
+      ASSERT_TRUE(packet);
+      StunMessage response;
+      rtc::ByteBufferReader buf(packet->buf, packet->size);
+      ASSERT_TRUE(response.Read(&buf));
+      EXPECT_EQ(STUN_BINDING_RESPONSE, response.type());
+      EXPECT_EQ(transaction_ids[i], response.transaction_id());
+      const StunAddressAttribute* mapped_address =
+          response.GetAddress(STUN_ATTR_XOR_MAPPED_ADDRESS);
+      ASSERT_TRUE(mapped_address);
+      EXPECT_EQ(clients[i]->address(), mapped_address->GetAddress());
+      ++responses;
+    }
+  }
+  const int64_t elapsed_ms = rtc::TimeMillis() - start_ms;
+  EXPECT_EQ(kNumClients * kRequestsPerClient, responses);
+  RTC_LOG(LS_INFO) << responses << " binding requests answered in "
+                   << elapsed_ms << " ms by " << server_->num_shards()
+                   << " shards";
+}
+
+#endif  // defined(WEBRTC_LINUX)
+
+}  // namespace
+}  // namespace cricket
@@ -0,0 +1,178 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <memory>
+#include <utility>
+
+#include "p2p/base/port_interface.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+
+namespace cricket {
+
+// Stands in for an internal UDP socket in a shard's TurnServer. Packets for
+// the shard are signalled on the shard's thread, and packets sent by the
+// shard are posted to the thread of the internal socket.
+class ShardedTurnServer::ShardSocket : public rtc::AsyncPacketSocket {
+ public:
+  ShardSocket(rtc::Thread* socket_thread,
+              rtc::AsyncPacketSocket* socket,
+              rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> safety)
+      : socket_thread_(socket_thread),
+        socket_(socket),
+        local_address_(socket->GetLocalAddress()),
+        safety_(std::move(safety)) {}
+
+  rtc::SocketAddress GetLocalAddress() const override {
+    return local_address_;
+  }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    RTC_DCHECK_NOTREACHED() << "Only UDP sockets can be sharded";
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    rtc::Buffer packet(static_cast<const char*>(pv), cb);
+    socket_thread_->PostTask(webrtc::SafeTask(
+        safety_, [socket = socket_, packet = std::move(packet), addr, options] {
+          socket->SendTo(packet.data(), packet.size(), addr, options);
+        }));
+    return static_cast<int>(cb);
+  }
+  int Close() override { return 0; }
+  State GetState() const override { return STATE_BOUND; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int SetOption(rtc::Socket::Option opt, int value) override { return -1; }
+  int GetError() const override { return 0; }
+  void SetError(int error) override {}
+
+ private:
+  rtc::Thread* const socket_thread_;
+  rtc::AsyncPacketSocket* const socket_;
+  const rtc::SocketAddress local_address_;
+  const rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> safety_;
+};
+
+ShardedTurnServer::ShardedTurnServer(rtc::Thread* thread,
+                                     std::vector<rtc::Thread*> shard_threads)
+    : thread_(thread) {
+  RTC_DCHECK(!shard_threads.empty());
+  for (rtc::Thread* shard_thread : shard_threads) {
+    Shard shard{.thread = shard_thread};
+    shard_thread->BlockingCall([&] {
+      shard.server = std::make_unique<TurnServer>(shard_thread);
+      shard.safety = webrtc::PendingTaskSafetyFlag::Create();
+    });
+    shards_.push_back(std::move(shard));
+  }
+}
+
+ShardedTurnServer::~ShardedTurnServer() {
+  RTC_DCHECK_RUN_ON(thread_);
+  // Drop the packets the shards have sent but which are not yet sent on.
+  safety_.reset();
+  for (Shard& shard : shards_) {
+    shard.thread->BlockingCall([&] {
+      shard.safety->SetNotAlive();
+      shard.server.reset();
+    });
+  }
+  for (const auto& socket : internal_sockets_) {
+    delete socket.first;
+  }
+}
+
+void ShardedTurnServer::ConfigureShards(
+    std::function<void(TurnServer* server, size_t shard)> configure) {
+  RTC_DCHECK_RUN_ON(thread_);
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    shards_[i].thread->BlockingCall(
+        [&] { configure(shards_[i].server.get(), i); });
+  }
+}
+
+void ShardedTurnServer::AddInternalSocket(rtc::AsyncPacketSocket* socket) {
+  RTC_DCHECK_RUN_ON(thread_);
+  RTC_DCHECK(internal_sockets_.find(socket) == internal_sockets_.end());
+  std::vector<ShardSocket*>& shard_sockets = internal_sockets_[socket];
+  for (Shard& shard : shards_) {
+    ShardSocket* shard_socket =
+        new ShardSocket(thread_, socket, safety_.flag());
+    shard.thread->BlockingCall(
+        [&] { shard.server->AddInternalSocket(shard_socket, PROTO_UDP); });
+    shard_sockets.push_back(shard_socket);
+  }
+  socket->SignalReadPacket.connect(this, &ShardedTurnServer::OnInternalPacket);
+}
+
+rtc::SocketAddress ShardedTurnServer::AddReusePortSockets(
+    const rtc::SocketAddress& address) {
+  RTC_DCHECK_RUN_ON(thread_);
+  // Each socket is created, and handed over or destroyed, on its shard's
+  // thread, where its socket server signals it.
+  std::vector<std::unique_ptr<rtc::AsyncUDPSocket>> sockets;
+  rtc::SocketAddress bound_address = address;
+  for (Shard& shard : shards_) {
+    shard.thread->BlockingCall([&] {
+      sockets.emplace_back(rtc::AsyncUDPSocket::CreateWithReusePort(
+          shard.thread->socketserver(), bound_address));
+      if (sockets.back()) {
+        bound_address = sockets.back()->GetLocalAddress();
+      }
+    });
+    if (!sockets.back()) {
+      break;
+    }
+  }
+  const bool success = sockets.back() != nullptr;
+  for (size_t i = 0; i < sockets.size(); ++i) {
+    shards_[i].thread->BlockingCall([&] {
+      if (success) {
+        shards_[i].server->AddInternalSocket(sockets[i].release(), PROTO_UDP);
+      } else {
+        sockets[i].reset();
+      }
+    });
+  }
+  if (!success) {
+    return rtc::SocketAddress();
+  }
+  return bound_address;
+}
+
+void ShardedTurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
+                                         const char* data,
+                                         size_t size,
+                                         const rtc::SocketAddress& addr,
+                                         const int64_t& packet_time_us) {
+  RTC_DCHECK_RUN_ON(thread_);
+  auto it = internal_sockets_.find(socket);
+  RTC_DCHECK(it != internal_sockets_.end());
+  const size_t index = addr.Hash() % shards_.size();
+  ShardSocket* shard_socket = it->second[index];
+  shards_[index].thread->PostTask(webrtc::SafeTask(
+      shards_[index].safety,
+      [shard_socket, packet = rtc::Buffer(data, size), addr, packet_time_us] {
+        shard_socket->SignalReadPacket(shard_socket, packet.data<char>(),
+                                       packet.size(), addr, packet_time_us);
+      }));
+}
+
+}  // namespace cricket
@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_SHARDED_TURN_SERVER_H_
+#define P2P_BASE_SHARDED_TURN_SERVER_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/sequence_checker.h"
+#include "api/task_queue/pending_task_safety_flag.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+// Spreads the allocations of a TURN server across several threads.
+// Each shard runs its own TurnServer, with its own external sockets, on its
+// own thread, so relaying for different clients runs in parallel. A client
+// always reaches the same shard, so its nonces and allocation behave as with a
+// single TurnServer. The clients are spread in one of two ways:
+// - AddInternalSocket: the internal UDP socket lives on `thread`, and each
+//   packet it receives is handed to the shard chosen by the client's address.
+// - AddReusePortSockets: each shard has its own internal UDP socket, all bound
+//   to the same address with SO_REUSEPORT, and the kernel picks the socket by
+//   hashing the 5-tuple. This avoids the hop through `thread`, but is only
+//   supported on Linux.
+// Not supported: TCP internal sockets.
+class ShardedTurnServer : public sigslot::has_slots<> {
+ public:
+  // Must be created and destroyed on `thread`. The shard threads must outlive
+  // the server, and need a socket server for the external sockets, as created
+  // with rtc::Thread::CreateWithSocketServer.
+  ShardedTurnServer(rtc::Thread* thread,
+                    std::vector<rtc::Thread*> shard_threads);
+  ~ShardedTurnServer() override;
+
+  size_t num_shards() const { return shards_.size(); }
+
+  // Calls `configure` with each shard's TurnServer and index, on the shard's
+  // thread, to set the realm, auth hook, external socket factory and so on.
+  void ConfigureShards(
+      std::function<void(TurnServer* server, size_t shard)> configure);
+
+  // Starts listening for packets from internal clients. Takes ownership of
+  // `socket`.
+  void AddInternalSocket(rtc::AsyncPacketSocket* socket);
+
+  // Opens an internal UDP socket bound to `address` with SO_REUSEPORT on
+  // each shard's thread. If the port of `address` is 0, all the sockets bind
+  // the port picked for the first one. Returns the bound address, or nil if
+  // the sockets could not be opened, in which case none are added.
+  rtc::SocketAddress AddReusePortSockets(const rtc::SocketAddress& address);
+
+ private:
+  class ShardSocket;
+  struct Shard {
+    rtc::Thread* thread;
+    std::unique_ptr<TurnServer> server;
+    // Flags that `server` is still alive, for packets posted to the shard.
+    rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> safety;
+  };
+
+  void OnInternalPacket(rtc::AsyncPacketSocket* socket,
+                        const char* data,
+                        size_t size,
+                        const rtc::SocketAddress& addr,
+                        const int64_t& packet_time_us);
+
+  rtc::Thread* const thread_;
+  std::vector<Shard> shards_;
+  // For each internal socket, the socket standing in for it in each shard's
+  // TurnServer, which owns it.
+  std::map<rtc::AsyncPacketSocket*, std::vector<ShardSocket*>>
+      internal_sockets_ RTC_GUARDED_BY(thread_);
+  // Guards packets sent by the shards, which are posted to `thread_`.
+  webrtc::ScopedTaskSafety safety_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_SHARDED_TURN_SERVER_H_
@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/stun.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/test_client.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumShards = 4;
+constexpr int kNumClients = 32;
+const rtc::SocketAddress kServerAddr("99.99.99.1", 3478);
+
+// Sends a binding request from `client` to `server`, and returns the SOFTWARE
+// attribute of the response, or an empty string if there is no valid
+// response.
+std::string SendBindingRequest(rtc::TestClient* client,
+                               const rtc::SocketAddress& server) {
+  StunMessage request(STUN_BINDING_REQUEST);
+  rtc::ByteBufferWriter request_buf;
+  request.Write(&request_buf);
+  client->SendTo(request_buf.Data(), request_buf.Length(), server);
+
+  std::unique_ptr<rtc::TestClient::Packet> packet =
+      client->NextPacket(rtc::TestClient::kTimeoutMs);
+  if (!packet) {
+    return std::string();
+  }
+  StunMessage response;
+  rtc::ByteBufferReader response_buf(packet->buf, packet->size);
+  if (!response.Read(&response_buf) ||
+      response.type() != STUN_BINDING_RESPONSE ||
+      response.transaction_id() != request.transaction_id()) {
+    return std::string();
+  }
+  const StunAddressAttribute* mapped_address =
+      response.GetAddress(STUN_ATTR_XOR_MAPPED_ADDRESS);
+  const StunByteStringAttribute* software =
+      response.GetByteString(STUN_ATTR_SOFTWARE);
+  if (!mapped_address || mapped_address->GetAddress() != client->address() ||
+      !software) {
+    return std::string();
+  }
+  return std::string(software->string_view());
+}
+
+// Names each shard's TurnServer after the shard, in the SOFTWARE attribute.
+void NameShards(TurnServer* server, size_t shard) {
+  server->set_software("shard" + std::to_string(shard));
+}
+
+class ShardedTurnServerTest : public ::testing::Test {
+ public:
+  ShardedTurnServerTest() : ss_(new rtc::VirtualSocketServer()) {
+    network_thread_ = std::make_unique<rtc::Thread>(ss_.get());
+    network_thread_->Start();
+    std::vector<rtc::Thread*> shard_threads;
+    for (int i = 0; i < kNumShards; ++i) {
+      shard_threads_.push_back(rtc::Thread::Create());
+      shard_threads_.back()->Start();
+      shard_threads.push_back(shard_threads_.back().get());
+    }
+    network_thread_->BlockingCall([&] {
+      server_ = std::make_unique<ShardedTurnServer>(network_thread_.get(),
+                                                    shard_threads);
+      server_->AddInternalSocket(
+          rtc::AsyncUDPSocket::Create(ss_.get(), kServerAddr));
+    });
+  }
+  ~ShardedTurnServerTest() override {
+    network_thread_->BlockingCall([&] { server_.reset(); });
+    network_thread_->Stop();
+  }
+
+  std::unique_ptr<rtc::TestClient> CreateClient(int i) {
+    rtc::SocketAddress address("1.2.3.4", 1000 + i);
+    return std::make_unique<rtc::TestClient>(
+        absl::WrapUnique(rtc::AsyncUDPSocket::Create(ss_.get(), address)));
+  }
+
+ protected:
+  rtc::AutoThread main_thread_;
+  std::unique_ptr<rtc::VirtualSocketServer> ss_;
+  std::unique_ptr<rtc::Thread> network_thread_;
+  std::vector<std::unique_ptr<rtc::Thread>> shard_threads_;
+  std::unique_ptr<ShardedTurnServer> server_;
+};
+
+TEST_F(ShardedTurnServerTest, EachClientIsServedByOneShard) {
+  network_thread_->BlockingCall([&] {
+    EXPECT_EQ(static_cast<size_t>(kNumShards), server_->num_shards());
+    server_->ConfigureShards(&NameShards);
+  });
+
+  std::map<int, std::string> shard_by_client;
+  for (int i = 0; i < kNumClients; ++i) {
+    std::unique_ptr<rtc::TestClient> client = CreateClient(i);
+    shard_by_client[i] = SendBindingRequest(client.get(), kServerAddr);
+    ASSERT_FALSE(shard_by_client[i].empty());
+    EXPECT_EQ(shard_by_client[i],
+              SendBindingRequest(client.get(), kServerAddr));
+  }
+
+  std::set<std::string> shards;
+  for (const auto& client : shard_by_client) {
+    shards.insert(client.second);
+  }
+  EXPECT_GT(shards.size(), 1u);
+}
+
+#if defined(WEBRTC_LINUX)
+
+// With a SO_REUSEPORT socket per shard, the kernel picks the shard for each
+// client, and keeps picking the same one. Many clients keep one binding
+// request each in flight, for several rounds, and all of them get answered.
+TEST(ShardedTurnServerReusePortTest, AnswersManyClients) {
+  constexpr int kRequestsPerClient = 20;
+  rtc::PhysicalSocketServer socket_server;
+  rtc::AutoSocketServerThread main_thread(&socket_server);
+  std::vector<std::unique_ptr<rtc::Thread>> shard_threads;
+  std::vector<rtc::Thread*> threads;
+  for (int i = 0; i < kNumShards; ++i) {
+    shard_threads.push_back(rtc::Thread::CreateWithSocketServer());
+    shard_threads.back()->Start();
+    threads.push_back(shard_threads.back().get());
+  }
+  ShardedTurnServer server(&main_thread, threads);
+  server.ConfigureShards(&NameShards);
+  const rtc::SocketAddress server_address =
+      server.AddReusePortSockets(rtc::SocketAddress("127.0.0.1", 0));
+  ASSERT_FALSE(server_address.IsNil());
+
+  std::vector<std::unique_ptr<rtc::TestClient>> clients;
+  for (int i = 0; i < kNumClients; ++i) {
+    clients.push_back(std::make_unique<rtc::TestClient>(
+        absl::WrapUnique(rtc::AsyncUDPSocket::Create(
+            &socket_server, rtc::SocketAddress("127.0.0.1", 0)))));
+  }
+  std::vector<std::string> shard_by_client;
+  for (const auto& client : clients) {
+    shard_by_client.push_back(
+        SendBindingRequest(client.get(), server_address));
+    ASSERT_FALSE(shard_by_client.back().empty());
+  }
+
+  const int64_t start_ms = rtc::TimeMillis();
+  for (int round = 0; round < kRequestsPerClient; ++round) {
+    for (size_t i = 0; i < clients.size(); ++i) {
+      EXPECT_EQ(shard_by_client[i],
+                SendBindingRequest(clients[i].get(), server_address));
+    }
+  }
+  RTC_LOG(LS_INFO) << kNumClients * kRequestsPerClient
+                   << " binding requests answered in "
+                   << rtc::TimeMillis() - start_ms << " ms";
+
+  std::set<std::string> shards(shard_by_client.begin(),
+                               shard_by_client.end());
+  EXPECT_GT(shards.size(), 1u);
+}
+
+#endif  // defined(WEBRTC_LINUX)
+
+}  // namespace
+}  // namespace cricket
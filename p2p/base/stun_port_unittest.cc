@@ -17,9 +17,11 @@
 #include "p2p/base/test_stun_server.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/helpers.h"
+#include "rtc_base/network/received_packet_buffer.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/ssl_adapter.h"
 #include "rtc_base/virtual_socket_server.h"
+#include "test/field_trial.h"
 #include "test/gmock.h"
 #include "test/scoped_key_value_config.h"
 
@@ -364,6 +366,23 @@ TEST_F(StunPortTest, TestSharedSocketPrepareAddress) {
   EXPECT_TRUE(kLocalAddr.EqualIPs(port()->Candidates()[0].address()));
 }
 
+// Test that a local candidate can be generated when UDP sockets read batches
+// of datagrams.
+TEST_F(StunPortTest, TestSharedSocketPrepareAddressWithReceiveBatching) {
+  webrtc::test::ScopedFieldTrials field_trials(
+      "WebRTC-UdpReceiveBatching/Enabled,packets:4/");
+  const uint64_t allocations_before =
+      rtc::ScopedReceivedPacketBuffer::GetStats().allocations;
+  CreateSharedUdpPort(kStunAddr1, nullptr);
+  PrepareAddress();
+  EXPECT_TRUE_SIMULATED_WAIT(done(), kTimeoutMs, fake_clock);
+  ASSERT_EQ(1U, port()->Candidates().size());
+  EXPECT_TRUE(kLocalAddr.EqualIPs(port()->Candidates()[0].address()));
+  // The socket read the STUN response into a batch buffer.
+  EXPECT_EQ(allocations_before + 4,
+            rtc::ScopedReceivedPacketBuffer::GetStats().allocations);
+}
+
 // Test that we still get a local candidate with invalid stun server hostname.
 // Also verifing that UDPPort can receive packets when stun address can't be
 // resolved.
@@ -110,7 +110,10 @@ bool StunRequestManager::CheckResponse(StunMessage* msg) {
   bool skip_integrity_checking = false;
   if (request->msg()->integrity() == StunMessage::IntegrityStatus::kNotSet) {
     skip_integrity_checking = true;
-  } else {
+  } else if (msg->integrity() == StunMessage::IntegrityStatus::kNotSet ||
+             msg->password() != request->msg()->password()) {
+    // Connections have usually checked the response with the same password
+    // already, in which case the result is reused.
     msg->ValidateMessageIntegrity(request->msg()->password());
   }
 
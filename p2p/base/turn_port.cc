@@ -1809,9 +1809,28 @@ int TurnEntry::Send(const void* data,
                     size_t size,
                     bool payload,
                     const rtc::PacketOptions& options) {
-  rtc::ByteBufferWriter buf;
-  if (state_ != STATE_BOUND ||
-      !port_->TurnCustomizerAllowChannelData(data, size, payload)) {
+  rtc::PacketOptions modified_options(options);
+  // The framed packet is sent from another buffer, or from the headroom.
+  modified_options.headroom = 0;
+  const bool use_channel_data =
+      state_ == STATE_BOUND &&
+      port_->TurnCustomizerAllowChannelData(data, size, payload);
+  if (use_channel_data && options.headroom >= TURN_CHANNEL_HEADER_SIZE) {
+    // Write the ChannelData header in the room the sender left in front of
+    // the data, so that the data is not copied.
+    char* packet = const_cast<char*>(static_cast<const char*>(data)) -
+                   TURN_CHANNEL_HEADER_SIZE;
+    rtc::SetBE16(packet, channel_id_);
+    rtc::SetBE16(packet + 2, static_cast<uint16_t>(size));
+    modified_options.info_signaled_after_sent.turn_overhead_bytes =
+        TURN_CHANNEL_HEADER_SIZE;
+    return port_->Send(packet, size + TURN_CHANNEL_HEADER_SIZE,
+                       modified_options);
+  }
+
+  rtc::ByteBufferWriter& buf = port_->send_buffer_;
+  buf.Clear();
+  if (!use_channel_data) {
     // If we haven't bound the channel yet, we have to use a Send Indication.
     // The turn_customizer_ can also make us use Send Indication.
     TurnMessage msg(TURN_SEND_INDICATION);
@@ -1836,7 +1855,6 @@ int TurnEntry::Send(const void* data,
     buf.WriteUInt16(static_cast<uint16_t>(size));
     buf.WriteBytes(reinterpret_cast<const char*>(data), size);
   }
-  rtc::PacketOptions modified_options(options);
   modified_options.info_signaled_after_sent.turn_overhead_bytes =
       buf.Length() - size;
   return port_->Send(buf.Data(), buf.Length(), modified_options);
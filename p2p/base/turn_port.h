@@ -28,6 +28,7 @@
 #include "p2p/base/port.h"
 #include "p2p/client/basic_port_allocator.h"
 #include "rtc_base/async_packet_socket.h"
+#include "rtc_base/byte_buffer.h"
 #include "rtc_base/ssl_certificate.h"
 
 namespace webrtc {
@@ -341,6 +342,9 @@ class TurnPort : public Port {
 
   int next_channel_number_;
   EntryList entries_;
+  // Holds the ChannelData message or Send indication being sent by a
+  // TurnEntry. Reused, so that relaying media does not allocate per packet.
+  rtc::ByteBufferWriter send_buffer_;
 
   PortState state_;
   // By default the value will be set to 0. This value will be used in
@@ -0,0 +1,295 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "api/packet_socket_factory.h"
+#include "api/transport/stun.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/p2p_constants.h"
+#include "p2p/base/port.h"
+#include "p2p/base/port_interface.h"
+#include "p2p/base/stun_port.h"
+#include "p2p/base/turn_port.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/network.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+namespace {
+
+constexpr char kRealm[] = "example.org";
+constexpr char kUsername[] = "user";
+constexpr char kPassword[] = "password";
+constexpr char kIceUfrag[] = "lfrg";
+constexpr char kIcePwd[] = "lpasswordlpasswordlpass";
+constexpr size_t kPayloadSize = 1200;
+
+const rtc::SocketAddress kClientAddress(rtc::IPAddress(0xc0a80002), 5000);
+const rtc::SocketAddress kServerAddress(rtc::IPAddress(0x0a000001),
+                                        TURN_SERVER_PORT);
+const rtc::SocketAddress kPeerAddress(rtc::IPAddress(0xac100001), 6000);
+
+// A socket which counts the packets sent through it and, if asked to, keeps
+// them for the fixture to deliver.
+class FakePacketSocket : public rtc::AsyncPacketSocket {
+ public:
+  explicit FakePacketSocket(const rtc::SocketAddress& address)
+      : address_(address) {}
+
+  void set_keep_packets(bool keep_packets) { keep_packets_ = keep_packets; }
+  std::vector<std::pair<rtc::SocketAddress, std::string>> TakePackets() {
+    return std::move(packets_);
+  }
+  int packets_sent() const { return packets_sent_; }
+  const std::string& last_packet() const { return last_packet_; }
+
+  rtc::SocketAddress GetLocalAddress() const override { return address_; }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    ++packets_sent_;
+    if (keep_packets_) {
+      last_packet_.assign(static_cast<const char*>(pv), cb);
+      packets_.emplace_back(addr, last_packet_);
+    }
+    return static_cast<int>(cb);
+  }
+  int Close() override { return 0; }
+  State GetState() const override { return STATE_BOUND; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int SetOption(rtc::Socket::Option opt, int value) override { return -1; }
+  int GetError() const override { return 0; }
+  void SetError(int error) override {}
+
+ private:
+  const rtc::SocketAddress address_;
+  bool keep_packets_ = true;
+  int packets_sent_ = 0;
+  std::string last_packet_;
+  std::vector<std::pair<rtc::SocketAddress, std::string>> packets_;
+};
+
+// Creates the external sockets of the TURN server, which drop the packets.
+class FakePacketSocketFactory : public rtc::PacketSocketFactory {
+ public:
+  rtc::AsyncPacketSocket* CreateUdpSocket(const rtc::SocketAddress& address,
+                                          uint16_t min_port,
+                                          uint16_t max_port) override {
+    FakePacketSocket* socket =
+        new FakePacketSocket(rtc::SocketAddress(address.ipaddr(), 10000));
+    socket->set_keep_packets(false);
+    return socket;
+  }
+  rtc::AsyncListenSocket* CreateServerTcpSocket(
+      const rtc::SocketAddress& local_address,
+      uint16_t min_port,
+      uint16_t max_port,
+      int opts) override {
+    return nullptr;
+  }
+  rtc::AsyncPacketSocket* CreateClientTcpSocket(
+      const rtc::SocketAddress& local_address,
+      const rtc::SocketAddress& remote_address,
+      const rtc::ProxyInfo& proxy_info,
+      const std::string& user_agent,
+      const rtc::PacketSocketTcpOptions& tcp_options) override {
+    return nullptr;
+  }
+};
+
+class FakeAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(absl::string_view username,
+              absl::string_view realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(std::string(username), std::string(realm),
+                                     kPassword, key);
+  }
+};
+
+// A UDP port and a TURN port sharing one client socket, where the TURN port
+// has allocated a relayed address, and bound a channel to a peer, on a
+// TurnServer. The packets between the client socket and the TurnServer are
+// delivered by the fixture until the channel is bound, and dropped after.
+class PortFixture {
+ public:
+  PortFixture()
+      : network_("benchmark", "benchmark", rtc::IPAddress(0xc0a80000), 16),
+        client_socket_(kClientAddress),
+        server_socket_(new FakePacketSocket(kServerAddress)),
+        server_(&thread_),
+        server_address_(kServerAddress, PROTO_UDP),
+        peer_(ICE_CANDIDATE_COMPONENT_RTP,
+              UDP_PROTOCOL_NAME,
+              kPeerAddress,
+              /*priority=*/2130706431,
+              "rfrg",
+              "rpasswordrpasswordrpass",
+              LOCAL_PORT_TYPE,
+              /*generation=*/0,
+              /*foundation=*/"") {
+    network_.AddIP(kClientAddress.ipaddr());
+    server_.set_realm(kRealm);
+    server_.set_auth_hook(&auth_);
+    server_.AddInternalSocket(server_socket_, PROTO_UDP);
+    server_.SetExternalSocketFactory(
+        new FakePacketSocketFactory,
+        rtc::SocketAddress(rtc::IPAddress(0x0a000002), 0));
+
+    udp_port_ = UDPPort::Create(&thread_, &socket_factory_, &network_,
+                                &client_socket_, kIceUfrag, kIcePwd, false,
+                                absl::nullopt);
+
+    config_.credentials = RelayCredentials(kUsername, kPassword);
+    CreateRelayPortArgs args;
+    args.network_thread = &thread_;
+    args.socket_factory = &socket_factory_;
+    args.network = &network_;
+    args.server_address = &server_address_;
+    args.config = &config_;
+    args.username = kIceUfrag;
+    args.password = kIcePwd;
+    turn_port_ = TurnPort::Create(args, &client_socket_);
+    turn_port_->PrepareAddress();
+    DeliverPackets();
+    if (!turn_port_->CreateConnection(peer_, Port::ORIGIN_MESSAGE)) {
+      return;
+    }
+    DeliverPackets();
+    // The first packet with payload asks for the channel to be bound.
+    const std::string payload(kPayloadSize, 'x');
+    turn_port_->SendTo(payload.data(), payload.size(), kPeerAddress,
+                       rtc::PacketOptions(), /*payload=*/true);
+    DeliverPackets();
+    turn_port_->SendTo(payload.data(), payload.size(), kPeerAddress,
+                       rtc::PacketOptions(), /*payload=*/true);
+    channel_bound_ = IsChannelData(client_socket_.last_packet());
+    client_socket_.set_keep_packets(false);
+  }
+
+  // Returns true if relayed packets are sent as ChannelData messages.
+  bool ChannelBound() const { return channel_bound_; }
+
+  PortInterface* udp_port() { return udp_port_.get(); }
+  PortInterface* turn_port() { return turn_port_.get(); }
+  const FakePacketSocket& client_socket() const { return client_socket_; }
+
+ private:
+  static bool IsChannelData(const std::string& packet) {
+    return packet.size() >= 4 &&
+           (rtc::GetBE16(packet.data()) & 0xC000) == 0x4000;
+  }
+
+  // Delivers the packets between the client socket and the TurnServer, and
+  // runs the tasks they post, until there are none left.
+  void DeliverPackets() {
+    for (int i = 0; i < 10; ++i) {
+      thread_.ProcessMessages(0);
+      auto to_server = client_socket_.TakePackets();
+      auto to_client = server_socket_->TakePackets();
+      if (to_server.empty() && to_client.empty()) {
+        return;
+      }
+      for (const auto& packet : to_server) {
+        server_socket_->SignalReadPacket(server_socket_, packet.second.data(),
+                                         packet.second.size(), kClientAddress,
+                                         -1);
+      }
+      for (const auto& packet : to_client) {
+        turn_port_->HandleIncomingPacket(&client_socket_, packet.second.data(),
+                                         packet.second.size(), kServerAddress,
+                                         -1);
+      }
+    }
+  }
+
+  rtc::AutoThread thread_;
+  rtc::Network network_;
+  FakePacketSocket client_socket_;
+  FakePacketSocketFactory socket_factory_;
+  FakeAuth auth_;
+  // Owned by `server_`.
+  FakePacketSocket* const server_socket_;
+  TurnServer server_;
+  ProtocolAddress server_address_;
+  RelayServerConfig config_;
+  Candidate peer_;
+  std::unique_ptr<UDPPort> udp_port_;
+  std::unique_ptr<TurnPort> turn_port_;
+  bool channel_bound_ = false;
+};
+
+// Sends media straight to the peer, as over a host or srflx candidate pair.
+void BM_UdpPortSendTo(benchmark::State& state) {
+  PortFixture fixture;
+  const std::string payload(kPayloadSize, 'x');
+  for (auto s : state) {
+    fixture.udp_port()->SendTo(payload.data(), payload.size(), kPeerAddress,
+                               rtc::PacketOptions(), /*payload=*/true);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+
+BENCHMARK(BM_UdpPortSendTo);
+
+// Sends media to the peer through the TURN server, as ChannelData messages.
+// With `headroom` set to 4, the packets leave room for the ChannelData header
+// in front of them, as the packets of a media channel on a relayed route do,
+// so that they are framed without being copied.
+void BM_TurnPortSendTo(benchmark::State& state) {
+  PortFixture fixture;
+  if (!fixture.ChannelBound()) {
+    state.SkipWithError("Failed to bind a channel.");
+    return;
+  }
+  const size_t headroom = state.range(0);
+  std::vector<char> packet(headroom + kPayloadSize, 'x');
+  const char* payload = packet.data() + headroom;
+  rtc::PacketOptions options;
+  options.headroom = headroom;
+  const int packets_sent = fixture.client_socket().packets_sent();
+  for (auto s : state) {
+    fixture.turn_port()->SendTo(payload, kPayloadSize, kPeerAddress, options,
+                                /*payload=*/true);
+  }
+  if (fixture.client_socket().packets_sent() - packets_sent !=
+      static_cast<int>(state.iterations())) {
+    state.SkipWithError("Not all packets were sent.");
+    return;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+
+BENCHMARK(BM_TurnPortSendTo)->ArgNames({"headroom"})->Arg(0)->Arg(4);
+
+}  // namespace
+}  // namespace cricket
@@ -32,6 +32,7 @@
 #include "p2p/base/turn_server.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/byte_buffer.h"
+#include "rtc_base/byte_order.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/fake_clock.h"
 #include "rtc_base/gunit.h"
@@ -663,7 +664,9 @@ class TurnPortTest : public ::testing::Test,
     EXPECT_TRUE_SIMULATED_WAIT(conn2->receiving(), kSimulatedRtt, fake_clock_);
   }
 
-  void TestTurnSendData(ProtocolType protocol_type) {
+  // Sends packets both ways. With `headroom`, the packets sent through TURN
+  // leave room for the ChannelData header in front of them.
+  void TestTurnSendData(ProtocolType protocol_type, size_t headroom = 0) {
     PrepareTurnAndUdpPorts(protocol_type);
 
     // Create connections and send pings.
@@ -686,14 +689,23 @@ class TurnPortTest : public ::testing::Test,
 
     // Send some data.
     size_t num_packets = 256;
+    rtc::PacketOptions turn_options = options;
+    turn_options.headroom = headroom;
     for (size_t i = 0; i < num_packets; ++i) {
-      unsigned char buf[256] = {0};
+      unsigned char packet[4 + 256] = {0};
+      unsigned char* buf = packet + headroom;
       for (size_t j = 0; j < i + 1; ++j) {
         buf[j] = 0xFF - static_cast<unsigned char>(j);
       }
-      conn1->Send(buf, i + 1, options);
+      conn1->Send(buf, i + 1, turn_options);
       conn2->Send(buf, i + 1, options);
       SIMULATED_WAIT(false, kSimulatedRtt, fake_clock_);
+      if (headroom > 0 && i == num_packets - 1) {
+        // Once the channel is bound, the header is written in front of the
+        // packet rather than in a copy of it.
+        EXPECT_EQ(0x40, packet[0] & 0xC0);
+        EXPECT_EQ(i + 1, rtc::GetBE16(packet + 2));
+      }
     }
 
     // Check the data.
@@ -1485,6 +1497,12 @@ TEST_F(TurnPortTest, TestTurnSendDataTurnUdpToUdp) {
   EXPECT_EQ(UDP_PROTOCOL_NAME, turn_port_->Candidates()[0].relay_protocol());
 }
 
+// Send data through TURN with room for the ChannelData header in front of it.
+TEST_F(TurnPortTest, TestTurnSendDataInPlaceTurnUdpToUdp) {
+  CreateTurnPort(kTurnUsername, kTurnPassword, kTurnUdpProtoAddr);
+  TestTurnSendData(PROTO_UDP, /*headroom=*/4);
+}
+
 // Do a TURN allocation, establish a TCP connection, and send some data.
 TEST_F(TurnPortTest, TestTurnSendDataTurnTcpToUdp) {
   turn_server_.AddInternalSocket(kTurnTcpIntAddr, PROTO_TCP);
@@ -1494,6 +1512,12 @@ TEST_F(TurnPortTest, TestTurnSendDataTurnTcpToUdp) {
   EXPECT_EQ(TCP_PROTOCOL_NAME, turn_port_->Candidates()[0].relay_protocol());
 }
 
+TEST_F(TurnPortTest, TestTurnSendDataInPlaceTurnTcpToUdp) {
+  turn_server_.AddInternalSocket(kTurnTcpIntAddr, PROTO_TCP);
+  CreateTurnPort(kTurnUsername, kTurnPassword, kTurnTcpProtoAddr);
+  TestTurnSendData(PROTO_TCP, /*headroom=*/4);
+}
+
 // Do a TURN allocation, establish a TLS connection, and send some data.
 TEST_F(TurnPortTest, TestTurnSendDataTurnTlsToUdp) {
   turn_server_.AddInternalSocket(kTurnTcpIntAddr, PROTO_TLS);
@@ -15,7 +15,6 @@
 #include <tuple>  // for std::tie
 #include <utility>
 
-#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "api/array_view.h"
@@ -543,6 +542,13 @@ bool TurnServerConnection::operator<(const TurnServerConnection& c) const {
   return std::tie(src_, dst_, proto_) < std::tie(c.src_, c.dst_, c.proto_);
 }
 
+size_t TurnServerConnection::Hash() const {
+  size_t hash = src_.Hash();
+  hash = hash * 31 + dst_.Hash();
+  hash = hash * 31 + proto_;
+  return hash;
+}
+
 std::string TurnServerConnection::ToString() const {
   const char* const kProtos[] = {"unknown", "udp", "tcp", "ssltcp"};
   rtc::StringBuilder ost;
@@ -566,6 +572,7 @@ TurnServerAllocation::TurnServerAllocation(TurnServer* server,
 }
 
 TurnServerAllocation::~TurnServerAllocation() {
+  channels_by_peer_.clear();
   channels_.clear();
   perms_.clear();
   RTC_LOG(LS_INFO) << ToString() << ": Allocation destroyed";
@@ -727,23 +734,25 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
 
   // Check that this channel id isn't bound to another transport address, and
   // that this transport address isn't bound to another channel id.
-  auto channel1 = FindChannel(channel_id);
-  auto channel2 = FindChannel(peer_attr->GetAddress());
+  Channel* channel1 = FindChannel(channel_id);
+  Channel* channel2 = FindChannel(peer_attr->GetAddress());
   if (channel1 != channel2) {
     SendBadRequestResponse(msg);
     return;
   }
 
   // Add or refresh this channel.
-  if (channel1 == channels_.end()) {
-    channel1 = channels_.insert(
-        channels_.end(), {.id = channel_id, .peer = peer_attr->GetAddress()});
+  if (!channel1) {
+    channel1 = &channels_[channel_id];
+    channel1->id = channel_id;
+    channel1->peer = peer_attr->GetAddress();
+    channels_by_peer_[channel1->peer] = channel1;
   } else {
     channel1->pending_delete.reset();
   }
   thread_->PostDelayedTask(
       SafeTask(channel1->pending_delete.flag(),
-               [this, channel1] { channels_.erase(channel1); }),
+               [this, channel_id] { RemoveChannel(channel_id); }),
       kChannelTimeout);
 
   // Channel binds also refresh permissions.
@@ -761,8 +770,8 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
 void TurnServerAllocation::HandleChannelData(const char* data, size_t size) {
   // Extract the channel number from the data.
   uint16_t channel_id = rtc::GetBE16(data);
-  auto channel = FindChannel(channel_id);
-  if (channel != channels_.end()) {
+  const Channel* channel = FindChannel(channel_id);
+  if (channel) {
     // Send the data to the peer address.
     SendExternal(data + TURN_CHANNEL_HEADER_SIZE,
                  size - TURN_CHANNEL_HEADER_SIZE, channel->peer);
@@ -780,8 +789,8 @@ void TurnServerAllocation::OnExternalPacket(
     const rtc::SocketAddress& addr,
     const int64_t& /* packet_time_us */) {
   RTC_DCHECK(external_socket_.get() == socket);
-  auto channel = FindChannel(addr);
-  if (channel != channels_.end()) {
+  const Channel* channel = FindChannel(addr);
+  if (channel) {
     // There is a channel bound to this address. Send as a channel message.
     rtc::ByteBufferWriter buf;
     buf.WriteUInt16(channel->id);
@@ -813,37 +822,36 @@ TimeDelta TurnServerAllocation::ComputeLifetime(const TurnMessage& msg) {
 }
 
 bool TurnServerAllocation::HasPermission(const rtc::IPAddress& addr) {
-  return FindPermission(addr) != perms_.end();
+  return perms_.find(addr) != perms_.end();
 }
 
 void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
-  auto perm = FindPermission(addr);
-  if (perm == perms_.end()) {
-    perm = perms_.insert(perms_.end(), {.peer = addr});
-  } else {
-    perm->pending_delete.reset();
+  auto [perm, inserted] = perms_.try_emplace(addr);
+  if (!inserted) {
+    perm->second.pending_delete.reset();
   }
-  thread_->PostDelayedTask(SafeTask(perm->pending_delete.flag(),
-                                    [this, perm] { perms_.erase(perm); }),
+  thread_->PostDelayedTask(SafeTask(perm->second.pending_delete.flag(),
+                                    [this, addr] { perms_.erase(addr); }),
                            kPermissionTimeout);
 }
 
-TurnServerAllocation::PermissionList::iterator
-TurnServerAllocation::FindPermission(const rtc::IPAddress& addr) {
-  return absl::c_find_if(perms_,
-                         [&](const Permission& p) { return p.peer == addr; });
-}
-
-TurnServerAllocation::ChannelList::iterator TurnServerAllocation::FindChannel(
+TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     int channel_id) {
-  return absl::c_find_if(channels_,
-                         [&](const Channel& c) { return c.id == channel_id; });
+  auto it = channels_.find(channel_id);
+  return it != channels_.end() ? &it->second : nullptr;
 }
 
-TurnServerAllocation::ChannelList::iterator TurnServerAllocation::FindChannel(
+TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     const rtc::SocketAddress& addr) {
-  return absl::c_find_if(channels_,
-                         [&](const Channel& c) { return c.peer == addr; });
+  auto it = channels_by_peer_.find(addr);
+  return it != channels_by_peer_.end() ? it->second : nullptr;
+}
+
+void TurnServerAllocation::RemoveChannel(int channel_id) {
+  auto it = channels_.find(channel_id);
+  RTC_DCHECK(it != channels_.end());
+  channels_by_peer_.erase(it->second.peer);
+  channels_.erase(it);
 }
 
 void TurnServerAllocation::SendResponse(TurnMessage* msg) {
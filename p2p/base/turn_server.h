@@ -11,11 +11,11 @@
 #ifndef P2P_BASE_TURN_SERVER_H_
 #define P2P_BASE_TURN_SERVER_H_
 
-#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -26,6 +26,7 @@
 #include "api/units/time_delta.h"
 #include "p2p/base/port_interface.h"
 #include "rtc_base/async_packet_socket.h"
+#include "rtc_base/ip_address.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/ssl_adapter.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
@@ -47,6 +48,12 @@ const int TURN_SERVER_PORT = 3478;
 // Encapsulates the client's connection to the server.
 class TurnServerConnection {
  public:
+  struct Hasher {
+    size_t operator()(const TurnServerConnection& conn) const {
+      return conn.Hash();
+    }
+  };
+
   TurnServerConnection() : proto_(PROTO_UDP), socket_(NULL) {}
   TurnServerConnection(const rtc::SocketAddress& src,
                        ProtocolType proto,
@@ -55,6 +62,8 @@ class TurnServerConnection {
   rtc::AsyncPacketSocket* socket() { return socket_; }
   bool operator==(const TurnServerConnection& t) const;
   bool operator<(const TurnServerConnection& t) const;
+  // Hashes the fields compared by operator==.
+  size_t Hash() const;
   std::string ToString() const;
 
  private:
@@ -100,10 +109,23 @@ class TurnServerAllocation : public sigslot::has_slots<> {
   };
   struct Permission {
     webrtc::ScopedTaskSafety pending_delete;
-    rtc::IPAddress peer;
   };
-  using PermissionList = std::list<Permission>;
-  using ChannelList = std::list<Channel>;
+  struct IPAddressHasher {
+    size_t operator()(const rtc::IPAddress& ip) const {
+      return rtc::HashIP(ip);
+    }
+  };
+  struct SocketAddressHasher {
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+  // Permissions and channels are looked up for every relayed packet, so they
+  // are kept in hash maps. Channels are keyed by channel number, and indexed
+  // by peer address in `channels_by_peer_`.
+  using PermissionMap =
+      std::unordered_map<rtc::IPAddress, Permission, IPAddressHasher>;
+  using ChannelMap = std::unordered_map<int, Channel>;
 
   void PostDeleteSelf(webrtc::TimeDelta delay);
 
@@ -122,9 +144,9 @@ class TurnServerAllocation : public sigslot::has_slots<> {
   static webrtc::TimeDelta ComputeLifetime(const TurnMessage& msg);
   bool HasPermission(const rtc::IPAddress& addr);
   void AddPermission(const rtc::IPAddress& addr);
-  PermissionList::iterator FindPermission(const rtc::IPAddress& addr);
-  ChannelList::iterator FindChannel(int channel_id);
-  ChannelList::iterator FindChannel(const rtc::SocketAddress& addr);
+  Channel* FindChannel(int channel_id);
+  Channel* FindChannel(const rtc::SocketAddress& addr);
+  void RemoveChannel(int channel_id);
 
   void SendResponse(TurnMessage* msg);
   void SendBadRequestResponse(const TurnMessage* req);
@@ -143,8 +165,10 @@ class TurnServerAllocation : public sigslot::has_slots<> {
   std::string transaction_id_;
   std::string username_;
   std::string last_nonce_;
-  PermissionList perms_;
-  ChannelList channels_;
+  PermissionMap perms_;
+  ChannelMap channels_;
+  std::unordered_map<rtc::SocketAddress, Channel*, SocketAddressHasher>
+      channels_by_peer_;
   webrtc::ScopedTaskSafety safety_;
 };
 
@@ -181,7 +205,9 @@ class StunMessageObserver {
 // Not yet wired up: TCP support.
 class TurnServer : public sigslot::has_slots<> {
  public:
-  typedef std::map<TurnServerConnection, std::unique_ptr<TurnServerAllocation>>
+  typedef std::unordered_map<TurnServerConnection,
+                             std::unique_ptr<TurnServerAllocation>,
+                             TurnServerConnection::Hasher>
       AllocationMap;
 
   explicit TurnServer(webrtc::TaskQueueBase* thread);
@@ -0,0 +1,299 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "api/packet_socket_factory.h"
+#include "api/transport/stun.h"
+#include "benchmark/benchmark.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+namespace {
+
+constexpr char kRealm[] = "example.org";
+constexpr char kUsername[] = "user";
+constexpr char kPassword[] = "password";
+constexpr int kFirstChannelNumber = 0x4000;
+constexpr size_t kPayloadSize = 160;
+
+// A socket which counts the packets sent through it, and remembers the last
+// one, and on which the benchmark injects received packets.
+class FakePacketSocket : public rtc::AsyncPacketSocket {
+ public:
+  explicit FakePacketSocket(const rtc::SocketAddress& address)
+      : address_(address) {}
+
+  void ReceivePacket(absl::string_view packet, const rtc::SocketAddress& from) {
+    SignalReadPacket(this, packet.data(), packet.size(), from, -1);
+  }
+  int packets_sent() const { return packets_sent_; }
+  const std::string& last_packet() const { return last_packet_; }
+
+  rtc::SocketAddress GetLocalAddress() const override { return address_; }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    ++packets_sent_;
+    last_packet_.assign(static_cast<const char*>(pv), cb);
+    return static_cast<int>(cb);
+  }
+  int Close() override { return 0; }
+  State GetState() const override { return STATE_BOUND; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int SetOption(rtc::Socket::Option opt, int value) override { return -1; }
+  int GetError() const override { return 0; }
+  void SetError(int error) override {}
+
+ private:
+  const rtc::SocketAddress address_;
+  int packets_sent_ = 0;
+  std::string last_packet_;
+};
+
+// Creates the external sockets of the allocations, in order.
+class FakePacketSocketFactory : public rtc::PacketSocketFactory {
+ public:
+  const std::vector<FakePacketSocket*>& sockets() const { return sockets_; }
+
+  rtc::AsyncPacketSocket* CreateUdpSocket(const rtc::SocketAddress& address,
+                                          uint16_t min_port,
+                                          uint16_t max_port) override {
+    sockets_.push_back(new FakePacketSocket(
+        rtc::SocketAddress(address.ipaddr(), 10000 + sockets_.size())));
+    return sockets_.back();
+  }
+  rtc::AsyncListenSocket* CreateServerTcpSocket(
+      const rtc::SocketAddress& local_address,
+      uint16_t min_port,
+      uint16_t max_port,
+      int opts) override {
+    return nullptr;
+  }
+  rtc::AsyncPacketSocket* CreateClientTcpSocket(
+      const rtc::SocketAddress& local_address,
+      const rtc::SocketAddress& remote_address,
+      const rtc::ProxyInfo& proxy_info,
+      const std::string& user_agent,
+      const rtc::PacketSocketTcpOptions& tcp_options) override {
+    return nullptr;
+  }
+
+ private:
+  // Owned by the allocations.
+  std::vector<FakePacketSocket*> sockets_;
+};
+
+class FakeAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(absl::string_view username,
+              absl::string_view realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(std::string(username), std::string(realm),
+                                     kPassword, key);
+  }
+};
+
+std::string Serialize(const StunMessage& msg) {
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+// A TurnServer with `num_allocations` allocations, each with
+// `num_channels` channels bound to different peers.
+class TurnServerFixture {
+ public:
+  TurnServerFixture(int num_allocations, int num_channels)
+      : internal_socket_(new FakePacketSocket(rtc::SocketAddress(
+            rtc::IPAddress(0x0a000001), TURN_SERVER_PORT))),
+        external_socket_factory_(new FakePacketSocketFactory),
+        server_(&thread_) {
+    server_.set_realm(kRealm);
+    server_.set_auth_hook(&auth_);
+    server_.AddInternalSocket(internal_socket_, PROTO_UDP);
+    server_.SetExternalSocketFactory(
+        external_socket_factory_,
+        rtc::SocketAddress(rtc::IPAddress(0x0a000002), 0));
+    ComputeStunCredentialHash(kUsername, kRealm, kPassword, &key_);
+
+    for (int i = 0; i < num_allocations; ++i) {
+      clients_.emplace_back(rtc::IPAddress(0xc0a80000 + i), 5000);
+    }
+    for (int i = 0; i < num_channels; ++i) {
+      peers_.emplace_back(rtc::IPAddress(0xac100000 + i), 6000);
+    }
+
+    // Get a nonce, and allocate and bind the channels for each client.
+    TurnMessage request(STUN_ALLOCATE_REQUEST);
+    request.AddAttribute(std::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_REQUESTED_TRANSPORT, IPPROTO_UDP << 24));
+    internal_socket_->ReceivePacket(Serialize(request), clients_[0]);
+    TurnMessage response;
+    rtc::ByteBufferReader buf(internal_socket_->last_packet().data(),
+                              internal_socket_->last_packet().size());
+    if (response.Read(&buf) && response.GetByteString(STUN_ATTR_NONCE)) {
+      nonce_ = std::string(
+          response.GetByteString(STUN_ATTR_NONCE)->string_view());
+    }
+    for (const rtc::SocketAddress& client : clients_) {
+      SendRequest(STUN_ALLOCATE_REQUEST, client,
+                  std::make_unique<StunUInt32Attribute>(
+                      STUN_ATTR_REQUESTED_TRANSPORT, IPPROTO_UDP << 24));
+      for (int j = 0; j < num_channels; ++j) {
+        const uint32_t channel_number = kFirstChannelNumber + j;
+        SendRequest(TURN_CHANNEL_BIND_REQUEST, client,
+                    std::make_unique<StunUInt32Attribute>(
+                        STUN_ATTR_CHANNEL_NUMBER, channel_number << 16),
+                    std::make_unique<StunXorAddressAttribute>(
+                        STUN_ATTR_XOR_PEER_ADDRESS, peers_[j]));
+      }
+    }
+
+    for (int j = 0; j < num_channels; ++j) {
+      rtc::ByteBufferWriter channel_data;
+      channel_data.WriteUInt16(kFirstChannelNumber + j);
+      channel_data.WriteUInt16(kPayloadSize);
+      channel_data.WriteString(std::string(kPayloadSize, 'x'));
+      channel_data_.emplace_back(channel_data.Data(), channel_data.Length());
+    }
+  }
+
+  // Returns true if all the allocations and channels were created.
+  bool Ready() const {
+    return server_.allocations().size() == clients_.size() &&
+           external_socket_factory_->sockets().size() == clients_.size() &&
+           rtc::GetBE16(internal_socket_->last_packet().data()) ==
+               GetStunSuccessResponseType(TURN_CHANNEL_BIND_REQUEST);
+  }
+
+  FakePacketSocket* internal_socket() { return internal_socket_; }
+  FakePacketSocket* external_socket(int i) {
+    return external_socket_factory_->sockets()[i];
+  }
+  const std::vector<rtc::SocketAddress>& clients() const { return clients_; }
+  const std::vector<rtc::SocketAddress>& peers() const { return peers_; }
+  const std::vector<std::string>& channel_data() const {
+    return channel_data_;
+  }
+
+ private:
+  void SendRequest(int type,
+                   const rtc::SocketAddress& client,
+                   std::unique_ptr<StunAttribute> attr1,
+                   std::unique_ptr<StunAttribute> attr2 = nullptr) {
+    TurnMessage request(type);
+    request.AddAttribute(std::move(attr1));
+    if (attr2) {
+      request.AddAttribute(std::move(attr2));
+    }
+    request.AddAttribute(std::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, kUsername));
+    request.AddAttribute(
+        std::make_unique<StunByteStringAttribute>(STUN_ATTR_REALM, kRealm));
+    request.AddAttribute(
+        std::make_unique<StunByteStringAttribute>(STUN_ATTR_NONCE, nonce_));
+    request.AddMessageIntegrity(key_);
+    internal_socket_->ReceivePacket(Serialize(request), client);
+  }
+
+  rtc::AutoThread thread_;
+  FakeAuth auth_;
+  // Owned by `server_`.
+  FakePacketSocket* const internal_socket_;
+  FakePacketSocketFactory* const external_socket_factory_;
+  TurnServer server_;
+  std::string key_;
+  std::string nonce_;
+  std::vector<rtc::SocketAddress> clients_;
+  std::vector<rtc::SocketAddress> peers_;
+  std::vector<std::string> channel_data_;
+};
+
+// Relays ChannelData messages from the clients to their peers, cycling
+// through the allocations and channels.
+void BM_TurnServerRelayToPeer(benchmark::State& state) {
+  TurnServerFixture fixture(state.range(0), state.range(1));
+  if (!fixture.Ready()) {
+    state.SkipWithError("Failed to set up the allocations.");
+    return;
+  }
+  const size_t num_clients = fixture.clients().size();
+  const size_t num_channels = fixture.channel_data().size();
+  size_t i = 0;
+  for (auto s : state) {
+    fixture.internal_socket()->ReceivePacket(
+        fixture.channel_data()[(i / num_clients) % num_channels],
+        fixture.clients()[i % num_clients]);
+    ++i;
+  }
+  if (fixture.external_socket(0)->packets_sent() == 0) {
+    state.SkipWithError("No packets were relayed.");
+    return;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+
+BENCHMARK(BM_TurnServerRelayToPeer)
+    ->ArgNames({"allocations", "channels"})
+    ->ArgsProduct({{1, 64, 1024}, {1, 16, 128}});
+
+// Relays packets from the peers to the clients, as ChannelData messages.
+void BM_TurnServerRelayToClient(benchmark::State& state) {
+  TurnServerFixture fixture(state.range(0), state.range(1));
+  if (!fixture.Ready()) {
+    state.SkipWithError("Failed to set up the allocations.");
+    return;
+  }
+  const size_t num_clients = fixture.clients().size();
+  const size_t num_peers = fixture.peers().size();
+  const std::string payload(kPayloadSize, 'x');
+  const int packets_sent = fixture.internal_socket()->packets_sent();
+  size_t i = 0;
+  for (auto s : state) {
+    const rtc::SocketAddress& peer =
+        fixture.peers()[(i / num_clients) % num_peers];
+    fixture.external_socket(i % num_clients)->ReceivePacket(payload, peer);
+    ++i;
+  }
+  if (fixture.internal_socket()->packets_sent() == packets_sent) {
+    state.SkipWithError("No packets were relayed.");
+    return;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+
+BENCHMARK(BM_TurnServerRelayToClient)
+    ->ArgNames({"allocations", "channels"})
+    ->ArgsProduct({{1, 64, 1024}, {1, 16, 128}});
+
+}  // namespace
+}  // namespace cricket
@@ -0,0 +1,385 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/udp_socket_mux.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "api/transport/stun.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/network/sent_packet.h"
+
+namespace cricket {
+
+namespace {
+
+// Bounds the number of STUN transactions remembered per shared socket. A
+// transaction is forgotten when it gets a response or, failing that, when
+// this many newer ones have been sent.
+constexpr size_t kMaxPendingTransactions = 16384;
+
+// Returns the type of the STUN message in `data`, or -1 if it is not one.
+// Only messages with the RFC 5389 magic cookie are recognized.
+int GetStunMessageType(const char* data, size_t size) {
+  if (size < kStunHeaderSize || (data[0] & 0xC0) != 0 ||
+      rtc::GetBE32(data + kStunTransactionIdOffset - kStunMagicCookieLength) !=
+          kStunMagicCookie) {
+    return -1;
+  }
+  return rtc::GetBE16(data);
+}
+
+std::string GetTransactionId(const char* data) {
+  return std::string(data + kStunTransactionIdOffset, kStunTransactionIdLength);
+}
+
+// Returns the local ufrag in the USERNAME attribute of the STUN message in
+// `data`, which is "local:remote" in an ICE connectivity check, or an empty
+// string if there is no USERNAME.
+absl::string_view GetLocalUfrag(const char* data, size_t size) {
+  const size_t end = std::min(size, kStunHeaderSize + rtc::GetBE16(data + 2));
+  size_t pos = kStunHeaderSize;
+  while (pos + kStunAttributeHeaderSize <= end) {
+    const uint16_t attr_type = rtc::GetBE16(data + pos);
+    const uint16_t attr_length = rtc::GetBE16(data + pos + 2);
+    pos += kStunAttributeHeaderSize;
+    if (end - pos < attr_length) {
+      break;
+    }
+    if (attr_type == STUN_ATTR_USERNAME) {
+      absl::string_view username(data + pos, attr_length);
+      return username.substr(0, username.find(':'));
+    }
+    pos += (attr_length + 3u) & ~3u;
+  }
+  return absl::string_view();
+}
+
+struct SocketAddressHasher {
+  size_t operator()(const rtc::SocketAddress& addr) const {
+    return addr.Hash();
+  }
+};
+
+}  // namespace
+
+// The socket of one session. Sends through the shared socket, and receives
+// the packets the shared socket hands to it.
+class UdpSocketMux::MuxedSocket : public rtc::AsyncPacketSocket {
+ public:
+  MuxedSocket(UdpSocketMux* mux,
+              SharedSocket* shared_socket,
+              absl::string_view ice_ufrag)
+      : mux_(mux), shared_socket_(shared_socket), ice_ufrag_(ice_ufrag) {}
+  ~MuxedSocket() override { mux_->OnSocketDestroyed(this); }
+
+  SharedSocket* shared_socket() const { return shared_socket_; }
+  const std::string& ice_ufrag() const { return ice_ufrag_; }
+  void set_ice_ufrag(absl::string_view ice_ufrag) {
+    ice_ufrag_ = std::string(ice_ufrag);
+  }
+
+  rtc::SocketAddress GetLocalAddress() const override;
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    RTC_DCHECK_NOTREACHED() << "Only UDP sockets can be muxed";
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override;
+  // The shared socket stays open for the other sessions.
+  int Close() override { return 0; }
+  State GetState() const override;
+  int GetOption(rtc::Socket::Option opt, int* value) override;
+  int SetOption(rtc::Socket::Option opt, int value) override;
+  int GetError() const override;
+  void SetError(int error) override;
+
+ private:
+  UdpSocketMux* const mux_;
+  SharedSocket* const shared_socket_;
+  std::string ice_ufrag_;
+};
+
+// A bound UDP socket, and the tables that route its packets to the sessions.
+class UdpSocketMux::SharedSocket : public sigslot::has_slots<> {
+ public:
+  explicit SharedSocket(std::unique_ptr<rtc::AsyncPacketSocket> socket)
+      : socket_(std::move(socket)) {
+    socket_->SignalReadPacket.connect(this, &SharedSocket::OnReadPacket);
+    socket_->SignalSentPacket.connect(this, &SharedSocket::OnSentPacket);
+    socket_->SignalReadyToSend.connect(this, &SharedSocket::OnReadyToSend);
+  }
+
+  rtc::AsyncPacketSocket* socket() const { return socket_.get(); }
+  bool empty() const { return sockets_.empty(); }
+
+  void AddSocket(MuxedSocket* socket) {
+    sockets_.push_back(socket);
+    AddUfrag(socket);
+  }
+
+  void RemoveSocket(MuxedSocket* socket) {
+    sockets_.erase(std::find(sockets_.begin(), sockets_.end(), socket));
+    RemoveUfrag(socket);
+    EraseSocket(sockets_by_remote_address_, socket);
+    EraseSocket(sockets_by_transaction_id_, socket);
+  }
+
+  // Routes the STUN requests for `ice_ufrag` to `socket` instead of those for
+  // its previous ufrag.
+  void SetIceUfrag(MuxedSocket* socket, absl::string_view ice_ufrag) {
+    RemoveUfrag(socket);
+    socket->set_ice_ufrag(ice_ufrag);
+    AddUfrag(socket);
+  }
+
+  int SendTo(MuxedSocket* socket,
+             const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) {
+    const char* data = static_cast<const char*>(pv);
+    const int stun_type = GetStunMessageType(data, cb);
+    if (stun_type >= 0 && IsStunRequestType(stun_type)) {
+      std::string transaction_id = GetTransactionId(data);
+      if (sockets_by_transaction_id_.insert_or_assign(transaction_id, socket)
+              .second) {
+        transaction_ids_.push_back(std::move(transaction_id));
+      }
+      if (transaction_ids_.size() > kMaxPendingTransactions) {
+        sockets_by_transaction_id_.erase(transaction_ids_.front());
+        transaction_ids_.pop_front();
+      }
+    }
+    sockets_by_remote_address_[addr] = socket;
+
+    // The sent packet is signalled to the session that sent it, which is only
+    // known until SendTo returns, so the packet can't be held for a batch.
+    rtc::PacketOptions unbatched_options(options);
+    unbatched_options.batchable = false;
+    sending_socket_ = socket;
+    int result = socket_->SendTo(pv, cb, addr, unbatched_options);
+    sending_socket_ = nullptr;
+    return result;
+  }
+
+ private:
+  void AddUfrag(MuxedSocket* socket) {
+    MuxedSocket*& by_ufrag = sockets_by_ufrag_[socket->ice_ufrag()];
+    if (by_ufrag) {
+      RTC_LOG(LS_WARNING) << "ICE ufrag " << socket->ice_ufrag()
+                          << " is already used by another session on "
+                          << socket_->GetLocalAddress().ToSensitiveString();
+    }
+    by_ufrag = socket;
+  }
+
+  void RemoveUfrag(MuxedSocket* socket) {
+    auto it = sockets_by_ufrag_.find(socket->ice_ufrag());
+    if (it != sockets_by_ufrag_.end() && it->second == socket) {
+      sockets_by_ufrag_.erase(it);
+    }
+  }
+
+  template <typename Map>
+  static void EraseSocket(Map& map, MuxedSocket* socket) {
+    for (auto it = map.begin(); it != map.end();) {
+      if (it->second == socket) {
+        it = map.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  MuxedSocket* Route(const char* data,
+                     size_t size,
+                     const rtc::SocketAddress& remote_addr) {
+    const int stun_type = GetStunMessageType(data, size);
+    if (stun_type >= 0) {
+      if (IsStunSuccessResponseType(stun_type) ||
+          IsStunErrorResponseType(stun_type)) {
+        auto it = sockets_by_transaction_id_.find(GetTransactionId(data));
+        if (it != sockets_by_transaction_id_.end()) {
+          MuxedSocket* socket = it->second;
+          sockets_by_transaction_id_.erase(it);
+          return socket;
+        }
+      } else if (IsStunRequestType(stun_type)) {
+        auto it =
+            sockets_by_ufrag_.find(std::string(GetLocalUfrag(data, size)));
+        if (it != sockets_by_ufrag_.end()) {
+          sockets_by_remote_address_[remote_addr] = it->second;
+          return it->second;
+        }
+      }
+    }
+    auto it = sockets_by_remote_address_.find(remote_addr);
+    if (it != sockets_by_remote_address_.end()) {
+      return it->second;
+    }
+    return nullptr;
+  }
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    MuxedSocket* muxed_socket = Route(data, size, remote_addr);
+    if (!muxed_socket) {
+      RTC_LOG(LS_VERBOSE) << "Dropping packet from "
+                          << remote_addr.ToSensitiveString()
+                          << ", which is for no session on "
+                          << socket_->GetLocalAddress().ToSensitiveString();
+      return;
+    }
+    muxed_socket->SignalReadPacket(muxed_socket, data, size, remote_addr,
+                                   packet_time_us);
+  }
+
+  void OnSentPacket(rtc::AsyncPacketSocket* socket,
+                    const rtc::SentPacket& sent_packet) {
+    if (sending_socket_) {
+      sending_socket_->SignalSentPacket(sending_socket_, sent_packet);
+    }
+  }
+
+  void OnReadyToSend(rtc::AsyncPacketSocket* socket) {
+    // Copied, as a session may destroy its socket when signalled.
+    std::vector<MuxedSocket*> sockets = sockets_;
+    for (MuxedSocket* muxed_socket : sockets) {
+      if (std::find(sockets_.begin(), sockets_.end(), muxed_socket) !=
+          sockets_.end()) {
+        muxed_socket->SignalReadyToSend(muxed_socket);
+      }
+    }
+  }
+
+  const std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::vector<MuxedSocket*> sockets_;
+  std::unordered_map<std::string, MuxedSocket*> sockets_by_ufrag_;
+  std::unordered_map<rtc::SocketAddress, MuxedSocket*, SocketAddressHasher>
+      sockets_by_remote_address_;
+  // The requests sent by the sessions, by transaction ID, and the transaction
+  // IDs in the order they were sent, to forget the oldest ones.
+  std::unordered_map<std::string, MuxedSocket*> sockets_by_transaction_id_;
+  std::deque<std::string> transaction_ids_;
+  MuxedSocket* sending_socket_ = nullptr;
+};
+
+rtc::SocketAddress UdpSocketMux::MuxedSocket::GetLocalAddress() const {
+  return shared_socket_->socket()->GetLocalAddress();
+}
+
+int UdpSocketMux::MuxedSocket::SendTo(const void* pv,
+                                      size_t cb,
+                                      const rtc::SocketAddress& addr,
+                                      const rtc::PacketOptions& options) {
+  return shared_socket_->SendTo(this, pv, cb, addr, options);
+}
+
+rtc::AsyncPacketSocket::State UdpSocketMux::MuxedSocket::GetState() const {
+  return shared_socket_->socket()->GetState();
+}
+
+int UdpSocketMux::MuxedSocket::GetOption(rtc::Socket::Option opt,
+                                         int* value) {
+  return shared_socket_->socket()->GetOption(opt, value);
+}
+
+int UdpSocketMux::MuxedSocket::SetOption(rtc::Socket::Option opt, int value) {
+  return shared_socket_->socket()->SetOption(opt, value);
+}
+
+int UdpSocketMux::MuxedSocket::GetError() const {
+  return shared_socket_->socket()->GetError();
+}
+
+void UdpSocketMux::MuxedSocket::SetError(int error) {
+  shared_socket_->socket()->SetError(error);
+}
+
+UdpSocketMux::UdpSocketMux(rtc::PacketSocketFactory* socket_factory)
+    : socket_factory_(socket_factory) {
+  sequence_checker_.Detach();
+}
+
+UdpSocketMux::~UdpSocketMux() {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  RTC_DCHECK(shared_sockets_.empty());
+}
+
+std::unique_ptr<rtc::AsyncPacketSocket> UdpSocketMux::CreateSocket(
+    const rtc::SocketAddress& local_address,
+    uint16_t min_port,
+    uint16_t max_port,
+    absl::string_view ice_ufrag) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  std::unique_ptr<SharedSocket>& shared_socket =
+      shared_sockets_[local_address.ipaddr()];
+  if (!shared_socket) {
+    std::unique_ptr<rtc::AsyncPacketSocket> socket(
+        socket_factory_->CreateUdpSocket(local_address, min_port, max_port));
+    if (!socket) {
+      shared_sockets_.erase(local_address.ipaddr());
+      return nullptr;
+    }
+    shared_socket = std::make_unique<SharedSocket>(std::move(socket));
+  }
+  auto socket =
+      std::make_unique<MuxedSocket>(this, shared_socket.get(), ice_ufrag);
+  shared_socket->AddSocket(socket.get());
+  return socket;
+}
+
+void UdpSocketMux::SetIceUfrag(rtc::AsyncPacketSocket* socket,
+                               absl::string_view ice_ufrag) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  MuxedSocket* muxed_socket = static_cast<MuxedSocket*>(socket);
+  muxed_socket->shared_socket()->SetIceUfrag(muxed_socket, ice_ufrag);
+}
+
+size_t UdpSocketMux::num_shared_sockets() const {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  return shared_sockets_.size();
+}
+
+void UdpSocketMux::OnSocketDestroyed(MuxedSocket* socket) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  SharedSocket* shared_socket = socket->shared_socket();
+  shared_socket->RemoveSocket(socket);
+  if (!shared_socket->empty()) {
+    return;
+  }
+  // There is one shared socket per local IP address, so there are few.
+  for (auto it = shared_sockets_.begin(); it != shared_sockets_.end(); ++it) {
+    if (it->second.get() == shared_socket) {
+      shared_sockets_.erase(it);
+      return;
+    }
+  }
+}
+
+}  // namespace cricket
@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_UDP_SOCKET_MUX_H_
+#define P2P_BASE_UDP_SOCKET_MUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "api/packet_socket_factory.h"
+#include "api/sequence_checker.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/system/no_unique_address.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace cricket {
+
+// Lets many port allocator sessions, typically of different PeerConnections,
+// share one bound UDP socket per local IP address, instead of each opening
+// its own. A packet received on a shared socket is handed to the socket of
+// one session, chosen by:
+// - the transaction ID, for a STUN response to a request the session sent;
+// - the local ICE ufrag in the USERNAME, for a STUN request;
+// - the remote address otherwise. A session claims a remote address by
+//   sending to it, or by receiving a STUN request from it.
+// So the sessions sharing a socket must have different ICE ufrags, which
+// also means that RTCP must be muxed with RTP, and must not talk to the same
+// remote address, other than STUN servers. The sessions don't share TURN
+// over UDP, as a TURN server only allows one allocation per 5-tuple.
+// Must be used on the network thread, and outlive the sockets it creates.
+class RTC_EXPORT UdpSocketMux {
+ public:
+  // `socket_factory` opens the shared sockets, and must outlive the mux.
+  explicit UdpSocketMux(rtc::PacketSocketFactory* socket_factory);
+  ~UdpSocketMux();
+
+  UdpSocketMux(const UdpSocketMux&) = delete;
+  UdpSocketMux& operator=(const UdpSocketMux&) = delete;
+
+  // Returns a socket which sends through the shared socket for the IP of
+  // `local_address`, opened between `min_port` and `max_port` if there is none
+  // yet, and receives the packets for the session with `ice_ufrag`. Returns
+  // null if the shared socket could not be opened.
+  std::unique_ptr<rtc::AsyncPacketSocket> CreateSocket(
+      const rtc::SocketAddress& local_address,
+      uint16_t min_port,
+      uint16_t max_port,
+      absl::string_view ice_ufrag);
+
+  // Makes `socket`, which must have been created by this mux, receive the
+  // STUN requests for `ice_ufrag` instead of its previous ufrag, for when the
+  // session changes its ICE parameters, as a pooled session does when it is
+  // taken.
+  void SetIceUfrag(rtc::AsyncPacketSocket* socket,
+                   absl::string_view ice_ufrag);
+
+  // Returns the number of shared sockets currently open.
+  size_t num_shared_sockets() const;
+
+ private:
+  class MuxedSocket;
+  class SharedSocket;
+
+  void OnSocketDestroyed(MuxedSocket* socket);
+
+  RTC_NO_UNIQUE_ADDRESS webrtc::SequenceChecker sequence_checker_;
+  rtc::PacketSocketFactory* const socket_factory_;
+  std::map<rtc::IPAddress, std::unique_ptr<SharedSocket>> shared_sockets_
+      RTC_GUARDED_BY(sequence_checker_);
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_UDP_SOCKET_MUX_H_
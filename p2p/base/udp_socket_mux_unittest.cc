@@ -0,0 +1,214 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/udp_socket_mux.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "api/transport/stun.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/test_client.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kLocalAddr1("11.11.11.11", 0);
+const rtc::SocketAddress kLocalAddr2("22.22.22.22", 0);
+const rtc::SocketAddress kRemoteAddr1("33.33.33.33", 3000);
+const rtc::SocketAddress kRemoteAddr2("44.44.44.44", 4000);
+constexpr char kUfrag1[] = "frg1";
+constexpr char kUfrag2[] = "frg2";
+constexpr char kUfrag3[] = "frg3";
+constexpr char kData[] = "media";
+
+std::string Serialize(const StunMessage& msg) {
+  rtc::ByteBufferWriter buf;
+  msg.Write(&buf);
+  return std::string(buf.Data(), buf.Length());
+}
+
+class UdpSocketMuxTest : public ::testing::Test {
+ public:
+  UdpSocketMuxTest()
+      : thread_(&socket_server_),
+        socket_factory_(&socket_server_),
+        mux_(&socket_factory_) {}
+
+  // Returns a client on a socket of the mux, for the session with
+  // `ice_ufrag`.
+  std::unique_ptr<rtc::TestClient> CreateMuxedClient(
+      const rtc::SocketAddress& local_address,
+      absl::string_view ice_ufrag) {
+    return std::make_unique<rtc::TestClient>(
+        mux_.CreateSocket(local_address, 0, 0, ice_ufrag));
+  }
+
+  std::unique_ptr<rtc::TestClient> CreateRemoteClient(
+      const rtc::SocketAddress& address) {
+    return std::make_unique<rtc::TestClient>(absl::WrapUnique(
+        rtc::AsyncUDPSocket::Create(&socket_server_, address)));
+  }
+
+  // Returns true if `client` receives `packet` from `remote_address`.
+  static bool Receives(rtc::TestClient* client,
+                       const std::string& packet,
+                       const rtc::SocketAddress& remote_address) {
+    std::unique_ptr<rtc::TestClient::Packet> received =
+        client->NextPacket(rtc::TestClient::kTimeoutMs);
+    return received && received->addr == remote_address &&
+           std::string(received->buf, received->size) == packet;
+  }
+
+ protected:
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  UdpSocketMux mux_;
+};
+
+TEST_F(UdpSocketMuxTest, SharesOneSocketPerLocalAddress) {
+  std::unique_ptr<rtc::TestClient> client1 =
+      CreateMuxedClient(kLocalAddr1, kUfrag1);
+  std::unique_ptr<rtc::TestClient> client2 =
+      CreateMuxedClient(kLocalAddr1, kUfrag2);
+  std::unique_ptr<rtc::TestClient> client3 =
+      CreateMuxedClient(kLocalAddr2, kUfrag1);
+  EXPECT_EQ(client1->address(), client2->address());
+  EXPECT_EQ(kLocalAddr2.ipaddr(), client3->address().ipaddr());
+  EXPECT_EQ(2u, mux_.num_shared_sockets());
+
+  client1.reset();
+  EXPECT_EQ(2u, mux_.num_shared_sockets());
+  client2.reset();
+  EXPECT_EQ(1u, mux_.num_shared_sockets());
+  client3.reset();
+  EXPECT_EQ(0u, mux_.num_shared_sockets());
+}
+
+// A binding request goes to the session with the ufrag in its USERNAME, and
+// the packets that follow from the same address too.
+TEST_F(UdpSocketMuxTest, RoutesStunRequestsByUfrag) {
+  std::unique_ptr<rtc::TestClient> client1 =
+      CreateMuxedClient(kLocalAddr1, kUfrag1);
+  std::unique_ptr<rtc::TestClient> client2 =
+      CreateMuxedClient(kLocalAddr1, kUfrag2);
+  std::unique_ptr<rtc::TestClient> remote = CreateRemoteClient(kRemoteAddr1);
+
+  StunMessage request(STUN_BINDING_REQUEST);
+  request.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, std::string(kUfrag2) + ":rfrg"));
+  const std::string packet = Serialize(request);
+  remote->SendTo(packet.data(), packet.size(), client2->address());
+  EXPECT_TRUE(Receives(client2.get(), packet, kRemoteAddr1));
+
+  remote->SendTo(kData, sizeof(kData), client2->address());
+  EXPECT_TRUE(Receives(client2.get(), std::string(kData, sizeof(kData)),
+                       kRemoteAddr1));
+  EXPECT_TRUE(client1->CheckNoPacket());
+}
+
+// A session which changes its ufrag, as a pooled one does when it is taken,
+// gets the binding requests for the new ufrag and no longer those for the old
+// one.
+TEST_F(UdpSocketMuxTest, RoutesStunRequestsByNewUfrag) {
+  std::unique_ptr<rtc::AsyncPacketSocket> socket =
+      mux_.CreateSocket(kLocalAddr1, 0, 0, kUfrag1);
+  rtc::AsyncPacketSocket* socket_ptr = socket.get();
+  rtc::TestClient client1(std::move(socket));
+  std::unique_ptr<rtc::TestClient> client2 =
+      CreateMuxedClient(kLocalAddr1, kUfrag2);
+  std::unique_ptr<rtc::TestClient> remote1 = CreateRemoteClient(kRemoteAddr1);
+  std::unique_ptr<rtc::TestClient> remote2 = CreateRemoteClient(kRemoteAddr2);
+  mux_.SetIceUfrag(socket_ptr, kUfrag3);
+
+  StunMessage request(STUN_BINDING_REQUEST);
+  request.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, std::string(kUfrag3) + ":rfrg"));
+  const std::string packet = Serialize(request);
+  remote1->SendTo(packet.data(), packet.size(), client1.address());
+  EXPECT_TRUE(Receives(&client1, packet, kRemoteAddr1));
+
+  StunMessage old_request(STUN_BINDING_REQUEST);
+  old_request.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, std::string(kUfrag1) + ":rfrg"));
+  const std::string old_packet = Serialize(old_request);
+  remote2->SendTo(old_packet.data(), old_packet.size(), client1.address());
+  EXPECT_TRUE(client1.CheckNoPacket());
+  EXPECT_TRUE(client2->CheckNoPacket());
+}
+
+// STUN responses go to the session which sent the request, even if several
+// sessions talk to the same server.
+TEST_F(UdpSocketMuxTest, RoutesStunResponsesByTransactionId) {
+  std::unique_ptr<rtc::TestClient> client1 =
+      CreateMuxedClient(kLocalAddr1, kUfrag1);
+  std::unique_ptr<rtc::TestClient> client2 =
+      CreateMuxedClient(kLocalAddr1, kUfrag2);
+  std::unique_ptr<rtc::TestClient> server = CreateRemoteClient(kRemoteAddr1);
+
+  StunMessage request1(STUN_BINDING_REQUEST);
+  StunMessage request2(STUN_BINDING_REQUEST);
+  const std::string packet1 = Serialize(request1);
+  const std::string packet2 = Serialize(request2);
+  client1->SendTo(packet1.data(), packet1.size(), kRemoteAddr1);
+  client2->SendTo(packet2.data(), packet2.size(), kRemoteAddr1);
+  EXPECT_TRUE(Receives(server.get(), packet1, client1->address()));
+  EXPECT_TRUE(Receives(server.get(), packet2, client2->address()));
+
+  const std::string response1 = Serialize(
+      StunMessage(STUN_BINDING_RESPONSE, request1.transaction_id()));
+  const std::string response2 = Serialize(
+      StunMessage(STUN_BINDING_RESPONSE, request2.transaction_id()));
+  server->SendTo(response1.data(), response1.size(), client1->address());
+  server->SendTo(response2.data(), response2.size(), client1->address());
+  EXPECT_TRUE(Receives(client1.get(), response1, kRemoteAddr1));
+  EXPECT_TRUE(Receives(client2.get(), response2, kRemoteAddr1));
+  EXPECT_TRUE(client1->CheckNoPacket());
+}
+
+// Other packets go to the session which last sent to their source, and are
+// dropped if there is none.
+TEST_F(UdpSocketMuxTest, RoutesOtherPacketsByRemoteAddress) {
+  std::unique_ptr<rtc::TestClient> client1 =
+      CreateMuxedClient(kLocalAddr1, kUfrag1);
+  std::unique_ptr<rtc::TestClient> client2 =
+      CreateMuxedClient(kLocalAddr1, kUfrag2);
+  std::unique_ptr<rtc::TestClient> remote1 = CreateRemoteClient(kRemoteAddr1);
+  std::unique_ptr<rtc::TestClient> remote2 = CreateRemoteClient(kRemoteAddr2);
+  const std::string data(kData, sizeof(kData));
+
+  remote1->SendTo(data.data(), data.size(), client1->address());
+  EXPECT_TRUE(client1->CheckNoPacket());
+  EXPECT_TRUE(client2->CheckNoPacket());
+
+  client1->SendTo(data.data(), data.size(), kRemoteAddr1);
+  client2->SendTo(data.data(), data.size(), kRemoteAddr2);
+  EXPECT_TRUE(Receives(remote1.get(), data, client1->address()));
+  EXPECT_TRUE(Receives(remote2.get(), data, client2->address()));
+  remote1->SendTo(data.data(), data.size(), client1->address());
+  remote2->SendTo(data.data(), data.size(), client1->address());
+  EXPECT_TRUE(Receives(client1.get(), data, kRemoteAddr1));
+  EXPECT_TRUE(Receives(client2.get(), data, kRemoteAddr2));
+
+  // Once the session is gone, its packets are dropped.
+  client2.reset();
+  remote2->SendTo(data.data(), data.size(), client1->address());
+  EXPECT_TRUE(client1->CheckNoPacket());
+}
+
+}  // namespace
+}  // namespace cricket
@@ -647,6 +647,9 @@ void BasicPortAllocatorSession::UpdateIceParametersInternal() {
     port.port()->set_content_name(content_name());
     port.port()->SetIceParameters(component(), ice_ufrag(), ice_pwd());
   }
+  for (AllocationSequence* sequence : sequences_) {
+    sequence->SetIceUfrag(ice_ufrag());
+  }
 }
 
 void BasicPortAllocatorSession::GetPortConfigurations() {
@@ -1369,9 +1372,18 @@ AllocationSequence::AllocationSequence(
 
 void AllocationSequence::Init() {
   if (IsFlagSet(PORTALLOCATOR_ENABLE_SHARED_SOCKET)) {
-    udp_socket_.reset(session_->socket_factory()->CreateUdpSocket(
-        rtc::SocketAddress(network_->GetBestIP(), 0),
-        session_->allocator()->min_port(), session_->allocator()->max_port()));
+    udp_socket_mux_ = session_->allocator()->udp_socket_mux();
+    if (udp_socket_mux_) {
+      udp_socket_ = udp_socket_mux_->CreateSocket(
+          rtc::SocketAddress(network_->GetBestIP(), 0),
+          session_->allocator()->min_port(), session_->allocator()->max_port(),
+          session_->username());
+    } else {
+      udp_socket_.reset(session_->socket_factory()->CreateUdpSocket(
+          rtc::SocketAddress(network_->GetBestIP(), 0),
+          session_->allocator()->min_port(),
+          session_->allocator()->max_port()));
+    }
     if (udp_socket_) {
       udp_socket_->SignalReadPacket.connect(this,
                                             &AllocationSequence::OnReadPacket);
@@ -1485,6 +1497,12 @@ void AllocationSequence::Stop() {
   }
 }
 
+void AllocationSequence::SetIceUfrag(absl::string_view ice_ufrag) {
+  if (udp_socket_mux_ && udp_socket_) {
+    udp_socket_mux_->SetIceUfrag(udp_socket_.get(), ice_ufrag);
+  }
+}
+
 void AllocationSequence::Process(int epoch) {
   RTC_DCHECK(rtc::Thread::Current() == session_->network_thread());
   const char* const PHASE_NAMES[kNumPhases] = {"Udp", "Relay", "Tcp"};
@@ -1689,8 +1707,11 @@ void AllocationSequence::CreateTurnPort(const RelayServerConfig& config) {
     // don't pass shared socket for ports which will create TCP sockets.
     // TODO(mallinath) - Enable shared socket mode for TURN ports. Disabled
     // due to webrtc bug https://code.google.com/p/webrtc/issues/detail?id=3537
+    // A TURN server only allows one allocation per 5-tuple, so the TURN
+    // ports of different sessions can't share a socket from the mux.
     if (IsFlagSet(PORTALLOCATOR_ENABLE_SHARED_SOCKET) &&
-        relay_port->proto == PROTO_UDP && udp_socket_) {
+        relay_port->proto == PROTO_UDP && udp_socket_ &&
+        !udp_socket_mux_) {
       port = session_->allocator()->relay_port_factory()->Create(
           args, udp_socket_.get());
 
@@ -20,6 +20,7 @@
 #include "api/task_queue/pending_task_safety_flag.h"
 #include "api/turn_customizer.h"
 #include "p2p/base/port_allocator.h"
+#include "p2p/base/udp_socket_mux.h"
 #include "p2p/client/relay_port_factory_interface.h"
 #include "p2p/client/turn_port_factory.h"
 #include "rtc_base/checks.h"
@@ -88,6 +89,20 @@ class RTC_EXPORT BasicPortAllocator : public PortAllocator {
 
   void SetVpnList(const std::vector<rtc::NetworkMask>& vpn_list) override;
 
+  // If set, and PORTALLOCATOR_ENABLE_SHARED_SOCKET is set, the sessions get
+  // their UDP sockets from `udp_socket_mux`, and so share one UDP socket per
+  // local IP address with the sessions of the other allocators using the same
+  // mux. The TURN ports still open their own sockets. The mux must outlive
+  // the sessions.
+  void set_udp_socket_mux(UdpSocketMux* udp_socket_mux) {
+    CheckRunOnValidThreadIfInitialized();
+    udp_socket_mux_ = udp_socket_mux;
+  }
+  UdpSocketMux* udp_socket_mux() const {
+    CheckRunOnValidThreadIfInitialized();
+    return udp_socket_mux_;
+  }
+
   const webrtc::FieldTrialsView* field_trials() const {
     return field_trials_.get();
   }
@@ -108,6 +123,7 @@ class RTC_EXPORT BasicPortAllocator : public PortAllocator {
   const webrtc::AlwaysValidPointerNoDefault<rtc::PacketSocketFactory>
       socket_factory_;
   int network_ignore_mask_ = rtc::kDefaultNetworkIgnoreMask;
+  UdpSocketMux* udp_socket_mux_ = nullptr;
 
   // This is the factory being used.
   RelayPortFactoryInterface* relay_port_factory_;
@@ -386,6 +402,10 @@ class AllocationSequence : public sigslot::has_slots<> {
   void Start();
   void Stop();
 
+  // Routes the STUN requests for `ice_ufrag` to this sequence's ports, when
+  // its UDP socket is shared with other sessions.
+  void SetIceUfrag(absl::string_view ice_ufrag);
+
  protected:
   // For testing.
   void CreateTurnPort(const RelayServerConfig& config);
@@ -417,6 +437,8 @@ class AllocationSequence : public sigslot::has_slots<> {
   State state_;
   uint32_t flags_;
   ProtocolList protocols_;
+  // The mux `udp_socket_` was created by, if it is shared.
+  UdpSocketMux* udp_socket_mux_ = nullptr;
   std::unique_ptr<rtc::AsyncPacketSocket> udp_socket_;
   // There will be only one udp port per AllocationSequence.
   UDPPort* udp_port_;
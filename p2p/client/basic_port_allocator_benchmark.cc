@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/p2p_constants.h"
+#include "p2p/base/port_allocator.h"
+#include "p2p/client/basic_port_allocator.h"
+#include "rtc_base/ifaddrs_cache.h"
+#include "rtc_base/network.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+
+namespace cricket {
+namespace {
+
+constexpr char kContentName[] = "data";
+constexpr char kIceUfrag[] = "lfrg";
+constexpr char kIcePwd[] = "lpasswordlpasswordlpass";
+constexpr int64_t kTimeoutMs = 5000;
+
+// Gathers the host candidates of one session, as a new PeerConnection does.
+class Gatherer : public sigslot::has_slots<> {
+ public:
+  Gatherer(rtc::NetworkManager* network_manager,
+           rtc::PacketSocketFactory* socket_factory)
+      : allocator_(network_manager, socket_factory) {
+    allocator_.set_flags(PORTALLOCATOR_DISABLE_TCP |
+                         PORTALLOCATOR_DISABLE_RELAY);
+    allocator_.Initialize();
+  }
+
+  // Returns how long it took for the first candidate to be ready, in
+  // microseconds, or -1 if none was.
+  int64_t GatherFirstCandidate() {
+    session_ =
+        allocator_.CreateSession(kContentName, ICE_CANDIDATE_COMPONENT_RTP,
+                                 kIceUfrag, kIcePwd);
+    session_->SignalCandidatesReady.connect(this,
+                                            &Gatherer::OnCandidatesReady);
+    const int64_t start_us = rtc::TimeMicros();
+    session_->StartGettingPorts();
+    while (!candidate_ready_ &&
+           rtc::TimeMicros() - start_us <
+               kTimeoutMs * rtc::kNumMicrosecsPerMillisec) {
+      rtc::Thread::Current()->ProcessMessages(0);
+    }
+    return candidate_ready_ ? rtc::TimeMicros() - start_us : -1;
+  }
+
+ private:
+  void OnCandidatesReady(PortAllocatorSession* session,
+                         const std::vector<Candidate>& candidates) {
+    candidate_ready_ = true;
+  }
+
+  BasicPortAllocator allocator_;
+  std::unique_ptr<PortAllocatorSession> session_;
+  bool candidate_ready_ = false;
+};
+
+// Measures the time from starting to gather to the first host candidate, for
+// a session whose network manager was just created, as when PeerConnections
+// do not share one. With `cached` set to 0, the interfaces are enumerated
+// again for each session, as they were before their snapshot was shared.
+void BM_TimeToFirstCandidate(benchmark::State& state) {
+  const bool cached = state.range(0) != 0;
+  rtc::PhysicalSocketServer socket_server;
+  rtc::AutoSocketServerThread thread(&socket_server);
+  rtc::BasicPacketSocketFactory socket_factory(&socket_server);
+  for (auto s : state) {
+    if (!cached) {
+      rtc::IfAddrsCache::Get()->Invalidate();
+    }
+    rtc::BasicNetworkManager network_manager(&socket_server);
+    Gatherer gatherer(&network_manager, &socket_factory);
+    const int64_t elapsed_us = gatherer.GatherFirstCandidate();
+    if (elapsed_us < 0) {
+      state.SkipWithError("No candidate was gathered.");
+      return;
+    }
+    state.SetIterationTime(elapsed_us /
+                           static_cast<double>(rtc::kNumMicrosecsPerSec));
+  }
+}
+
+BENCHMARK(BM_TimeToFirstCandidate)
+    ->ArgNames({"cached"})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace cricket
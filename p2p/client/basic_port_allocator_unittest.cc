@@ -15,6 +15,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/string_view.h"
+#include "api/transport/stun.h"
 #include "p2p/base/basic_packet_socket_factory.h"
 #include "p2p/base/p2p_constants.h"
 #include "p2p/base/stun_port.h"
@@ -22,6 +23,9 @@
 #include "p2p/base/stun_server.h"
 #include "p2p/base/test_stun_server.h"
 #include "p2p/base/test_turn_server.h"
+#include "p2p/base/udp_socket_mux.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
 #include "rtc_base/fake_clock.h"
 #include "rtc_base/fake_mdns_responder.h"
 #include "rtc_base/fake_network.h"
@@ -98,8 +102,10 @@ static const int kMaxPort = 10099;
 
 // Based on ICE_UFRAG_LENGTH
 static const char kIceUfrag0[] = "UF00";
+static const char kIceUfrag1[] = "UF01";
 // Based on ICE_PWD_LENGTH
 static const char kIcePwd0[] = "TESTICEPWD00000000000000";
+static const char kIcePwd1[] = "TESTICEPWD00000000000001";
 
 static const char kContentName[] = "test content";
 
@@ -474,6 +480,22 @@ class BasicPortAllocatorTestBase : public ::testing::Test,
     candidates_.erase(new_end, candidates_.end());
   }
 
+  // Records the binding requests `port` gets from unknown addresses in
+  // `unknown_address_ports_`.
+  void ConnectUnknownAddress(PortInterface* port) {
+    port->SignalUnknownAddress.connect(
+        this, &BasicPortAllocatorTestBase::OnUnknownAddress);
+  }
+
+  void OnUnknownAddress(PortInterface* port,
+                        const rtc::SocketAddress& address,
+                        ProtocolType proto,
+                        IceMessage* stun_msg,
+                        const std::string& remote_ufrag,
+                        bool port_muxed) {
+    unknown_address_ports_.push_back(port);
+  }
+
   bool HasRelayAddress(const ProtocolAddress& proto_addr) {
     for (size_t i = 0; i < allocator_->turn_servers().size(); ++i) {
       RelayServerConfig server_config = allocator_->turn_servers()[i];
@@ -523,6 +545,8 @@ class BasicPortAllocatorTestBase : public ::testing::Test,
   std::unique_ptr<PortAllocatorSession> session_;
   std::vector<PortInterface*> ports_;
   std::vector<Candidate> candidates_;
+  // The ports which got a binding request from an unknown address.
+  std::vector<PortInterface*> unknown_address_ports_;
   bool candidate_allocation_done_;
   webrtc::test::ScopedKeyValueConfig field_trials_;
 };
@@ -2020,6 +2044,100 @@ TEST_F(BasicPortAllocatorTest, TestSharedSocketNoUdpAllowed) {
   EXPECT_EQ(1U, candidates_.size());
 }
 
+// Test that with a UdpSocketMux, the sessions share one UDP socket, and each
+// gets the responses from the STUN server to its own requests.
+TEST_F(BasicPortAllocatorTest, TestSharedSocketWithUdpSocketMux) {
+  AddInterface(kClientAddr);
+  // Behind the NAT, the server reflexive address differs from the host one, so
+  // each session signals a srflx candidate only if it got its own response.
+  ResetWithStunServerAndNat(kStunAddr);
+  UdpSocketMux udp_socket_mux(allocator().socket_factory());
+  allocator().set_udp_socket_mux(&udp_socket_mux);
+  allocator().set_flags(allocator().flags() | PORTALLOCATOR_DISABLE_RELAY |
+                        PORTALLOCATOR_DISABLE_TCP |
+                        PORTALLOCATOR_ENABLE_SHARED_SOCKET);
+  std::unique_ptr<PortAllocatorSession> session1 =
+      CreateSession("session1", kContentName, ICE_CANDIDATE_COMPONENT_RTP,
+                    kIceUfrag0, kIcePwd0);
+  std::unique_ptr<PortAllocatorSession> session2 =
+      CreateSession("session2", kContentName, ICE_CANDIDATE_COMPONENT_RTP,
+                    kIceUfrag1, kIcePwd1);
+  session1->StartGettingPorts();
+  session2->StartGettingPorts();
+  ASSERT_EQ_SIMULATED_WAIT(4U, candidates_.size(), kDefaultAllocationTimeout,
+                           fake_clock);
+  EXPECT_EQ(1U, udp_socket_mux.num_shared_sockets());
+  for (const char* ice_ufrag : {kIceUfrag0, kIceUfrag1}) {
+    EXPECT_EQ(1, absl::c_count_if(candidates_, [&](const Candidate& c) {
+                return c.type() == LOCAL_PORT_TYPE &&
+                       c.username() == ice_ufrag &&
+                       c.address().ipaddr() == kClientAddr.ipaddr();
+              }))
+        << ice_ufrag;
+    EXPECT_EQ(1, absl::c_count_if(candidates_, [&](const Candidate& c) {
+                return c.type() == STUN_PORT_TYPE &&
+                       c.username() == ice_ufrag &&
+                       c.address().ipaddr() == kNatUdpAddr.ipaddr();
+              }))
+        << ice_ufrag;
+  }
+  EXPECT_TRUE_SIMULATED_WAIT(
+      session1->CandidatesAllocationDone() &&
+          session2->CandidatesAllocationDone(),
+      kDefaultAllocationTimeout, fake_clock);
+
+  session1.reset();
+  session2.reset();
+  EXPECT_EQ(0U, udp_socket_mux.num_shared_sockets());
+}
+
+// Test that a pooled session which shares its UDP socket through a
+// UdpSocketMux gets the binding requests for the ufrag it is given when it is
+// taken, rather than for the one it gathered with.
+TEST_F(BasicPortAllocatorTest, TestPooledSessionWithUdpSocketMux) {
+  AddInterface(kClientAddr);
+  UdpSocketMux udp_socket_mux(allocator().socket_factory());
+  allocator().set_udp_socket_mux(&udp_socket_mux);
+  allocator().set_flags(allocator().flags() | PORTALLOCATOR_DISABLE_RELAY |
+                        PORTALLOCATOR_DISABLE_TCP |
+                        PORTALLOCATOR_ENABLE_SHARED_SOCKET);
+  allocator_->SetConfiguration(allocator_->stun_servers(),
+                               allocator_->turn_servers(), 1,
+                               webrtc::NO_PRUNE);
+  const PortAllocatorSession* peeked_session = allocator_->GetPooledSession();
+  ASSERT_NE(nullptr, peeked_session);
+  EXPECT_EQ_SIMULATED_WAIT(true, peeked_session->CandidatesAllocationDone(),
+                           kDefaultAllocationTimeout, fake_clock);
+  session_ = allocator_->TakePooledSession(kContentName, 1, kIceUfrag0,
+                                           kIcePwd0);
+  ASSERT_NE(nullptr, session_);
+  std::vector<PortInterface*> ready_ports = session_->ReadyPorts();
+  ASSERT_EQ(1U, ready_ports.size());
+  ready_ports[0]->SetIceRole(ICEROLE_CONTROLLING);
+  ConnectUnknownAddress(ready_ports[0]);
+
+  IceMessage request(STUN_BINDING_REQUEST);
+  request.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, std::string(kIceUfrag0) + ":rfrg"));
+  request.AddMessageIntegrity(kIcePwd0);
+  request.AddFingerprint();
+  rtc::ByteBufferWriter buf;
+  request.Write(&buf);
+  std::unique_ptr<rtc::AsyncPacketSocket> remote(
+      rtc::AsyncUDPSocket::Create(vss_.get(), kRemoteClientAddr));
+  ASSERT_NE(nullptr, remote);
+  remote->SendTo(buf.Data(), buf.Length(),
+                 ready_ports[0]->Candidates()[0].address(),
+                 rtc::PacketOptions());
+  ASSERT_EQ_SIMULATED_WAIT(1U, unknown_address_ports_.size(),
+                           kDefaultAllocationTimeout, fake_clock);
+  EXPECT_EQ(ready_ports[0], unknown_address_ports_[0]);
+
+  // The mux must outlive the sockets of the sessions.
+  session_.reset();
+  allocator_->DiscardCandidatePool();
+}
+
 // Test that when the NetworkManager doesn't have permission to enumerate
 // adapters, the PORTALLOCATOR_DISABLE_ADAPTER_ENUMERATION is specified
 // automatically.
@@ -42,6 +42,10 @@ using ::rtc::UniqueRandomIdGenerator;
 using ::webrtc::PendingTaskSafetyFlag;
 using ::webrtc::SdpType;
 
+// Size of the header TURN puts in front of relayed packets once a channel is
+// bound, see RFC 8656, section 12.4.
+constexpr size_t kTurnChannelDataHeaderSize = 4;
+
 // Finds a stream based on target's Primary SSRC or RIDs.
 // This struct is used in BaseChannel::UpdateLocalStreams_w.
 struct StreamFinder {
@@ -169,6 +173,7 @@ bool BaseChannel::ConnectToRtpTransport_n() {
                                               &BaseChannel::OnWritableState);
   rtp_transport_->SignalSentPacket.connect(this,
                                            &BaseChannel::SignalSentPacket_n);
+  UpdatePacketBufferReservation_n(rtc::NetworkRoute());
   return true;
 }
 
@@ -339,6 +344,15 @@ void BaseChannel::OnNetworkRouteChanged(
   // work correctly. Intentionally leave it broken to simplify the code and
   // encourage the users to stop using non-muxing RTCP.
   media_channel_->OnNetworkRouteChanged(transport_name(), new_route);
+  UpdatePacketBufferReservation_n(new_route);
+}
+
+void BaseChannel::UpdatePacketBufferReservation_n(
+    const rtc::NetworkRoute& network_route) {
+  size_t headroom =
+      network_route.local.uses_turn() ? kTurnChannelDataHeaderSize : 0;
+  media_channel_->SetPacketBufferReservation(
+      headroom, rtp_transport_->GetPacketTailroom());
 }
 
 void BaseChannel::SetFirstPacketReceivedCallback(
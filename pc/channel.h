@@ -298,6 +298,10 @@ class BaseChannel : public ChannelInterface,
   bool ConnectToRtpTransport_n() RTC_RUN_ON(network_thread());
   void DisconnectFromRtpTransport_n() RTC_RUN_ON(network_thread());
   void SignalSentPacket_n(const rtc::SentPacket& sent_packet);
+  // Lets the media channel allocate outgoing packets with room for what the
+  // transport adds to them.
+  void UpdatePacketBufferReservation_n(const rtc::NetworkRoute& network_route)
+      RTC_RUN_ON(network_thread());
 
   rtc::Thread* const worker_thread_;
   rtc::Thread* const network_thread_;
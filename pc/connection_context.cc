@@ -17,11 +17,16 @@
 #include "api/transport/field_trial_based_config.h"
 #include "media/base/media_engine.h"
 #include "media/sctp/sctp_transport_factory.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/internal/default_socket_server.h"
 #include "rtc_base/socket_server.h"
 #include "rtc_base/time_utils.h"
 
+#if defined(WEBRTC_USE_IO_URING)
+#include "rtc_base/io_uring_socket_server.h"
+#endif
+
 namespace webrtc {
 
 namespace {
@@ -33,8 +38,14 @@ rtc::Thread* MaybeStartNetworkThread(
   if (old_thread) {
     return old_thread;
   }
+#if defined(WEBRTC_USE_IO_URING)
+  // Falls back to a PhysicalSocketServer if the kernel lacks io_uring support.
+  std::unique_ptr<rtc::SocketServer> socket_server =
+      rtc::CreateIoUringSocketServer();
+#else
   std::unique_ptr<rtc::SocketServer> socket_server =
       rtc::CreateDefaultSocketServer();
+#endif
   thread_holder = std::make_unique<rtc::Thread>(socket_server.get());
   socket_factory_holder = std::move(socket_server);
 
@@ -73,6 +84,19 @@ std::unique_ptr<SctpTransportFactoryInterface> MaybeCreateSctpFactory(
 #endif
 }
 
+// The pool is enabled with e.g. "WebRTC-CertificatePool/size:4/".
+std::unique_ptr<rtc::RTCCertificatePool> MaybeCreateCertificatePool(
+    TaskQueueFactory* task_queue_factory,
+    const FieldTrialsView& field_trials) {
+  FieldTrialParameter<int> size("size", 0);
+  ParseFieldTrial({&size}, field_trials.Lookup("WebRTC-CertificatePool"));
+  if (size.Get() <= 0 || !task_queue_factory) {
+    return nullptr;
+  }
+  return std::make_unique<rtc::RTCCertificatePool>(task_queue_factory,
+                                                   size.Get());
+}
+
 }  // namespace
 
 // Static
@@ -155,6 +179,8 @@ ConnectionContext::ConnectionContext(
     default_socket_factory_ =
         std::make_unique<rtc::BasicPacketSocketFactory>(socket_factory);
   }
+  certificate_pool_ = MaybeCreateCertificatePool(
+      dependencies->task_queue_factory.get(), *trials_);
   // Set warning levels on the threads, to give warnings when response
   // may be slower than is expected of the thread.
   // Since some of the threads may be the same, start with the least
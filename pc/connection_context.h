@@ -28,6 +28,7 @@
 #include "rtc_base/network.h"
 #include "rtc_base/network_monitor_factory.h"
 #include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/rtc_certificate_pool.h"
 #include "rtc_base/socket_factory.h"
 #include "rtc_base/thread.h"
 #include "rtc_base/thread_annotations.h"
@@ -100,6 +101,12 @@ class ConnectionContext final
     return call_factory_.get();
   }
   rtc::UniqueRandomIdGenerator* ssrc_generator() { return &ssrc_generator_; }
+  // Certificates generated ahead of time for PeerConnections which are not
+  // given one. Null unless enabled with the "WebRTC-CertificatePool" field
+  // trial.
+  rtc::RTCCertificatePool* certificate_pool() {
+    return certificate_pool_.get();
+  }
   // Note: There is lots of code that wants to know whether or not we
   // use RTX, but so far, no code has been found that sets it to false.
   // Kept in the API in order to ease introduction if we want to resurrect
@@ -133,6 +140,7 @@ class ConnectionContext final
   // TODO(bugs.webrtc.org/12666): This variable is used from both the signaling
   // and worker threads. See if we can't restrict usage to a single thread.
   rtc::UniqueRandomIdGenerator ssrc_generator_;
+  std::unique_ptr<rtc::RTCCertificatePool> certificate_pool_;
   std::unique_ptr<rtc::NetworkMonitorFactory> const network_monitor_factory_
       RTC_GUARDED_BY(signaling_thread_);
   std::unique_ptr<rtc::NetworkManager> default_network_manager_
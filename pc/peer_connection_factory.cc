@@ -204,8 +204,8 @@ PeerConnectionFactory::CreatePeerConnectionOrError(
   // Set internal defaults if optional dependencies are not set.
   if (!dependencies.cert_generator) {
     dependencies.cert_generator =
-        std::make_unique<rtc::RTCCertificateGenerator>(signaling_thread(),
-                                                       network_thread());
+        std::make_unique<rtc::RTCCertificateGenerator>(
+            signaling_thread(), network_thread(), context_->certificate_pool());
   }
   if (!dependencies.allocator) {
     const FieldTrialsView* trials =
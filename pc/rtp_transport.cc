@@ -23,6 +23,7 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/copy_on_write_buffer.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/network/received_packet_buffer.h"
 #include "rtc_base/trace_event.h"
 
 namespace webrtc {
@@ -145,8 +146,18 @@ bool RtpTransport::SendPacket(bool rtcp,
   rtc::PacketTransportInternal* transport = rtcp && !rtcp_mux_enabled_
                                                 ? rtcp_packet_transport_
                                                 : rtp_packet_transport_;
-  int ret = transport->SendPacket(packet->cdata<char>(), packet->size(),
-                                  options, flags);
+  int ret;
+  if (packet->headroom() > 0) {
+    // Lets the ICE transport frame the packet in place, see
+    // rtc::PacketOptions::headroom.
+    rtc::PacketOptions options_with_headroom(options);
+    options_with_headroom.headroom = packet->headroom();
+    ret = transport->SendPacket(packet->MutableData<char>(), packet->size(),
+                                options_with_headroom, flags);
+  } else {
+    ret = transport->SendPacket(packet->cdata<char>(), packet->size(), options,
+                                flags);
+  }
   if (ret != static_cast<int>(packet->size())) {
     if (transport->GetError() == ENOTCONN) {
       RTC_LOG(LS_WARNING) << "Got ENOTCONN from transport.";
@@ -262,7 +273,11 @@ void RtpTransport::OnReadPacket(rtc::PacketTransportInternal* transport,
     return;
   }
 
-  rtc::CopyOnWriteBuffer packet(data, len);
+  // Takes over the socket's buffer if possible, so that SrtpTransport can
+  // decrypt in place and RtpPacketReceived shares the same bytes. That is only
+  // the case for UDP sockets reading batches, see ScopedReceivedPacketBuffer.
+  rtc::CopyOnWriteBuffer packet =
+      rtc::ScopedReceivedPacketBuffer::TakeOrCopy(data, len);
   if (packet_type == cricket::RtpPacketType::kRtcp) {
     OnRtcpPacketReceived(std::move(packet), packet_time_us);
   } else {
@@ -79,6 +79,11 @@ class RtpTransportInternal : public sigslot::has_slots<> {
                               const rtc::PacketOptions& options,
                               int flags) = 0;
 
+  // Number of bytes the transport may append to a packet passed to
+  // SendRtpPacket() or SendRtcpPacket(), such as an SRTP auth tag. Packets with
+  // that much spare capacity are sent without reallocating them.
+  virtual size_t GetPacketTailroom() const { return 0; }
+
   // This method updates the RTP header extension map so that the RTP transport
   // can parse the received packets and identify the MID. This is called by the
   // BaseChannel when setting the content description.
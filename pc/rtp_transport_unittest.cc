@@ -14,6 +14,7 @@
 #include "pc/test/rtp_transport_test_util.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/containers/flat_set.h"
+#include "rtc_base/network/received_packet_buffer.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "test/gtest.h"
 
@@ -316,4 +317,35 @@ TEST(RtpTransportTest, DontSignalUnhandledRtpPayloadType) {
   transport.UnregisterRtpDemuxerSink(&observer);
 }
 
+// Test that a packet the socket read into a ref counted buffer reaches the
+// demuxer sink without being copied.
+TEST(RtpTransportTest, ReceivedPacketIsNotCopied) {
+  RtpTransport transport(kMuxDisabled);
+  rtc::FakePacketTransport fake_rtp("fake_rtp");
+  transport.SetRtpPacketTransport(&fake_rtp);
+  TransportObserver observer(&transport);
+  RtpDemuxerCriteria demuxer_criteria;
+  demuxer_criteria.payload_types().insert(0x11);
+  transport.RegisterRtpDemuxerSink(demuxer_criteria, &observer);
+
+  rtc::CopyOnWriteBuffer received =
+      rtc::ScopedReceivedPacketBuffer::AllocateBuffer(kRtpLen);
+  memcpy(received.MutableData(), kRtpData, kRtpLen);
+  const uint8_t* data = received.cdata();
+  const rtc::ScopedReceivedPacketBuffer::Stats before =
+      rtc::ScopedReceivedPacketBuffer::GetStats();
+  {
+    rtc::ScopedReceivedPacketBuffer scoped_packet(&received);
+    fake_rtp.SignalReadPacket(&fake_rtp, reinterpret_cast<const char*>(data),
+                              kRtpLen, /*packet_time_us=*/-1, /*flags=*/0);
+  }
+  ASSERT_EQ(1, observer.rtp_count());
+  EXPECT_EQ(data, observer.last_recv_rtp_packet().cdata());
+  const rtc::ScopedReceivedPacketBuffer::Stats after =
+      rtc::ScopedReceivedPacketBuffer::GetStats();
+  EXPECT_EQ(before.taken + 1, after.taken);
+  EXPECT_EQ(before.copies, after.copies);
+  transport.UnregisterRtpDemuxerSink(&observer);
+}
+
 }  // namespace webrtc
@@ -319,6 +319,10 @@ int SrtpSession::GetSrtpOverhead() const {
   return rtp_auth_tag_len_;
 }
 
+int SrtpSession::GetSrtcpOverhead() const {
+  return sizeof(uint32_t) + rtcp_auth_tag_len_;
+}
+
 void SrtpSession::EnableExternalAuth() {
   RTC_DCHECK(!session_);
   external_auth_enabled_ = true;
@@ -83,6 +83,8 @@ class SrtpSession {
   bool GetRtpAuthParams(uint8_t** key, int* key_len, int* tag_len);
 
   int GetSrtpOverhead() const;
+  // As above, for RTCP packets. Includes the SRTCP index.
+  int GetSrtcpOverhead() const;
 
   // If external auth is enabled, SRTP will write a dummy auth tag that then
   // later must get replaced before the packet is sent out. Only supported for
@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "pc/srtp_session.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/ssl_stream_adapter.h"
+
+namespace cricket {
+namespace {
+
+constexpr size_t kPacketsPerIteration = 32;
+constexpr int kPayloadSize = 1100;
+constexpr int kRtpHeaderSize = 12;
+// Large enough for the auth tag of all cipher suites.
+constexpr int kPacketBufferSize = kRtpHeaderSize + kPayloadSize + 16;
+
+// 30 bytes for AES_CM_128_HMAC_SHA1_80, the first 28 for AEAD_AES_128_GCM.
+const uint8_t kKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234";
+
+int KeyLength(int crypto_suite) {
+  int key_len;
+  int salt_len;
+  rtc::GetSrtpKeyAndSaltLengths(crypto_suite, &key_len, &salt_len);
+  return key_len + salt_len;
+}
+
+// A burst of unprotected RTP packets with consecutive sequence numbers.
+class PacketBurst {
+ public:
+  struct Packet {
+    uint8_t* data;
+    int len;
+  };
+
+  PacketBurst()
+      : storage_(kPacketsPerIteration * kPacketBufferSize),
+        packets_(kPacketsPerIteration) {
+    for (size_t i = 0; i < kPacketsPerIteration; ++i) {
+      packets_[i].data = &storage_[i * kPacketBufferSize];
+    }
+  }
+
+  // Rewrites the packets with the next `kPacketsPerIteration` sequence
+  // numbers.
+  void Reset() {
+    for (Packet& packet : packets_) {
+      memset(packet.data, 0, kRtpHeaderSize + kPayloadSize);
+      packet.data[0] = 0x80;
+      packet.data[1] = 111;
+      rtc::SetBE16(packet.data + 2, sequence_number_++);
+      rtc::SetBE32(packet.data + 8, 0x12345678);
+      packet.len = kRtpHeaderSize + kPayloadSize;
+    }
+  }
+
+  std::vector<Packet>& packets() { return packets_; }
+
+ private:
+  std::vector<uint8_t> storage_;
+  std::vector<Packet> packets_;
+  uint16_t sequence_number_ = 0;
+};
+
+size_t Protect(SrtpSession& session,
+               std::vector<PacketBurst::Packet>& packets) {
+  size_t num_protected = 0;
+  for (PacketBurst::Packet& packet : packets) {
+    if (session.ProtectRtp(packet.data, packet.len, kPacketBufferSize,
+                           &packet.len)) {
+      ++num_protected;
+    }
+  }
+  return num_protected;
+}
+
+size_t Unprotect(SrtpSession& session,
+                 std::vector<PacketBurst::Packet>& packets) {
+  size_t num_unprotected = 0;
+  for (PacketBurst::Packet& packet : packets) {
+    if (session.UnprotectRtp(packet.data, packet.len, &packet.len)) {
+      ++num_unprotected;
+    }
+  }
+  return num_unprotected;
+}
+
+// Measures the throughput of protecting bursts of RTP packets with the cipher
+// suite `state.range(0)`.
+void BM_SrtpProtectRtp(benchmark::State& state) {
+  const int crypto_suite = state.range(0);
+  SrtpSession sender;
+  if (!sender.SetSend(crypto_suite, kKey, KeyLength(crypto_suite), {})) {
+    state.SkipWithError("Failed to set up the SRTP session.");
+    return;
+  }
+  PacketBurst burst;
+
+  for (auto s : state) {
+    state.PauseTiming();
+    burst.Reset();
+    state.ResumeTiming();
+    if (Protect(sender, burst.packets()) != kPacketsPerIteration) {
+      state.SkipWithError("Failed to protect packets.");
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerIteration);
+  state.SetBytesProcessed(state.iterations() * kPacketsPerIteration *
+                          kPayloadSize);
+  state.SetLabel(rtc::SrtpCryptoSuiteToName(crypto_suite));
+}
+
+// As above, for unprotecting.
+void BM_SrtpUnprotectRtp(benchmark::State& state) {
+  const int crypto_suite = state.range(0);
+  SrtpSession sender;
+  SrtpSession receiver;
+  if (!sender.SetSend(crypto_suite, kKey, KeyLength(crypto_suite), {}) ||
+      !receiver.SetRecv(crypto_suite, kKey, KeyLength(crypto_suite), {})) {
+    state.SkipWithError("Failed to set up the SRTP sessions.");
+    return;
+  }
+  PacketBurst burst;
+
+  for (auto s : state) {
+    state.PauseTiming();
+    burst.Reset();
+    Protect(sender, burst.packets());
+    state.ResumeTiming();
+    if (Unprotect(receiver, burst.packets()) != kPacketsPerIteration) {
+      state.SkipWithError("Failed to unprotect packets.");
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerIteration);
+  state.SetBytesProcessed(state.iterations() * kPacketsPerIteration *
+                          kPayloadSize);
+  state.SetLabel(rtc::SrtpCryptoSuiteToName(crypto_suite));
+}
+
+BENCHMARK(BM_SrtpProtectRtp)
+    ->Arg(rtc::kSrtpAeadAes128Gcm)
+    ->Arg(rtc::kSrtpAes128CmSha1_80);
+BENCHMARK(BM_SrtpUnprotectRtp)
+    ->Arg(rtc::kSrtpAeadAes128Gcm)
+    ->Arg(rtc::kSrtpAes128CmSha1_80);
+
+}  // namespace
+}  // namespace cricket
@@ -32,6 +32,14 @@
 #include "rtc_base/zero_memory.h"
 
 namespace webrtc {
+namespace {
+
+// The most bytes protection adds to a packet with any of the supported cipher
+// suites: a 16 byte AEAD auth tag, plus the 4 byte index for SRTCP. WebRTC
+// does not use MKIs.
+constexpr size_t kMaxSrtpTrailerSize = 20;
+
+}  // namespace
 
 SrtpTransport::SrtpTransport(bool rtcp_mux_enabled,
                              const FieldTrialsView& field_trials)
@@ -128,6 +136,8 @@ bool SrtpTransport::SendRtpPacket(rtc::CopyOnWriteBuffer* packet,
   rtc::PacketOptions updated_options = options;
   TRACE_EVENT0("webrtc", "SRTP Encode");
   bool res;
+  // Protect in place if the packet has enough tailroom for the auth tag.
+  packet->EnsureCapacity(packet->size() + send_session_->GetSrtpOverhead());
   uint8_t* data = packet->MutableData();
   int len = rtc::checked_cast<int>(packet->size());
 // If ENABLE_EXTERNAL_AUTH flag is on then packet authentication is not done
@@ -183,6 +193,9 @@ bool SrtpTransport::SendRtcpPacket(rtc::CopyOnWriteBuffer* packet,
   }
 
   TRACE_EVENT0("webrtc", "SRTP Encode");
+  const cricket::SrtpSession* session =
+      send_rtcp_session_ ? send_rtcp_session_.get() : send_session_.get();
+  packet->EnsureCapacity(packet->size() + session->GetSrtcpOverhead());
   uint8_t* data = packet->MutableData();
   int len = rtc::checked_cast<int>(packet->size());
   if (!ProtectRtcp(data, len, static_cast<int>(packet->capacity()), &len)) {
@@ -198,6 +211,10 @@ bool SrtpTransport::SendRtcpPacket(rtc::CopyOnWriteBuffer* packet,
   return SendPacket(/*rtcp=*/true, packet, options, flags);
 }
 
+size_t SrtpTransport::GetPacketTailroom() const {
+  return kMaxSrtpTrailerSize;
+}
+
 void SrtpTransport::OnRtpPacketReceived(rtc::CopyOnWriteBuffer packet,
                                         int64_t packet_time_us) {
   TRACE_EVENT0("webrtc", "SrtpTransport::OnRtpPacketReceived");
@@ -52,6 +52,8 @@ class SrtpTransport : public RtpTransport {
                       const rtc::PacketOptions& options,
                       int flags) override;
 
+  size_t GetPacketTailroom() const override;
+
   // The transport becomes active if the send_session_ and recv_session_ are
   // created.
   bool IsSrtpActive() const override;
@@ -408,6 +408,42 @@ INSTANTIATE_TEST_SUITE_P(ExternalAuth,
                          SrtpTransportTestWithExternalAuth,
                          ::testing::Values(true, false));
 
+// Test that packets allocated with the tailroom the transport asks for are
+// protected without reallocating them, and that other packets are grown.
+TEST_F(SrtpTransportTest, ProtectsPacketsWithTailroomInPlace) {
+  std::vector<int> extension_ids;
+  EXPECT_TRUE(srtp_transport1_->SetRtpParams(
+      rtc::kSrtpAeadAes128Gcm, kTestKeyGcm128_1, kTestKeyGcm128Len,
+      extension_ids, rtc::kSrtpAeadAes128Gcm, kTestKeyGcm128_2,
+      kTestKeyGcm128Len, extension_ids));
+  const size_t tailroom = srtp_transport1_->GetPacketTailroom();
+  EXPECT_GE(tailroom, static_cast<size_t>(
+                          rtc::rtcp_auth_tag_len(rtc::kCsAeadAes128Gcm) + 4));
+
+  rtc::CopyOnWriteBuffer rtp_packet = rtc::CopyOnWriteBuffer::CreatePooled(
+      kPcmuFrame, sizeof(kPcmuFrame), sizeof(kPcmuFrame) + tailroom);
+  const uint8_t* rtp_data = rtp_packet.cdata();
+  rtc::PacketOptions options;
+  ASSERT_TRUE(srtp_transport1_->SendRtpPacket(&rtp_packet, options,
+                                              cricket::PF_SRTP_BYPASS));
+  EXPECT_EQ(rtp_data, rtp_packet.cdata());
+  EXPECT_EQ(sizeof(kPcmuFrame) + rtc::rtp_auth_tag_len(rtc::kCsAeadAes128Gcm),
+            rtp_packet.size());
+
+  rtc::CopyOnWriteBuffer rtcp_packet = rtc::CopyOnWriteBuffer::CreatePooled(
+      kRtcpReport, sizeof(kRtcpReport), sizeof(kRtcpReport) + tailroom);
+  const uint8_t* rtcp_data = rtcp_packet.cdata();
+  ASSERT_TRUE(srtp_transport1_->SendRtcpPacket(&rtcp_packet, options,
+                                               cricket::PF_SRTP_BYPASS));
+  EXPECT_EQ(rtcp_data, rtcp_packet.cdata());
+
+  rtc::CopyOnWriteBuffer small_packet(kPcmuFrame);
+  ASSERT_TRUE(srtp_transport1_->SendRtpPacket(&small_packet, options,
+                                              cricket::PF_SRTP_BYPASS));
+  EXPECT_EQ(sizeof(kPcmuFrame) + rtc::rtp_auth_tag_len(rtc::kCsAeadAes128Gcm),
+            small_packet.size());
+}
+
 // Test directly setting the params with bogus keys.
 TEST_F(SrtpTransportTest, TestSetParamsKeyTooShort) {
   std::vector<int> extension_ids;
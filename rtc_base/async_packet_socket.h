@@ -54,6 +54,18 @@ struct RTC_EXPORT PacketOptions {
   PacketTimeUpdateParams packet_time_params;
   // PacketInfo is passed to SentPacket when signaling this packet is sent.
   PacketInfo info_signaled_after_sent;
+  // Sockets that support batching may hold back a packet marked `batchable`
+  // and send it together with the batchable packets that follow, using fewer
+  // system calls. A batch is flushed by a packet with `last_packet_in_batch`
+  // set, or at the latest once the current task has finished running.
+  bool batchable = false;
+  bool last_packet_in_batch = false;
+  // Number of bytes in front of the packet data which belong to the same
+  // buffer, are not used by the sender, and may be overwritten. Lets a
+  // transport write its header there instead of copying the packet, as TURN
+  // does with ChannelData. Only valid with the data it was set for, so it has
+  // to be reset when the data is passed on in another buffer.
+  size_t headroom = 0;
 };
 
 // Provides the ability to receive packets asynchronously. Sends are not
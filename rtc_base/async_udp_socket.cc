@@ -12,10 +12,15 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <string>
+#include <utility>
 
+#include "api/location.h"
+#include "api/task_queue/task_queue_base.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/network/received_packet_buffer.h"
 #include "rtc_base/network/sent_packet.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/time_utils.h"
@@ -23,6 +28,29 @@
 namespace rtc {
 
 static const int BUF_SIZE = 64 * 1024;
+// Upper bound on the number of packets held back for a send batch.
+static const size_t kMaxPendingPackets = 64;
+// Kernel receive timestamps further in the past than this are assumed to
+// predate a change of the system clock.
+static const int64_t kMaxReceiveQueueDelayUs = kNumMicrosecsPerSec;
+
+// Socket receive timestamps come from the system (UTC) clock, while packet
+// times are expected in the rtc::TimeMicros() domain. Translates
+// `socket_timestamp_us` by how long the packet has been queued, measured with
+// `now_utc_us`, a fresh read of the system clock. Falls back to `now_us` if
+// there is no timestamp or the system clock has changed in between.
+static int64_t ToPacketTime(int64_t socket_timestamp_us,
+                            int64_t now_us,
+                            int64_t now_utc_us) {
+  if (socket_timestamp_us < 0) {
+    return now_us;
+  }
+  int64_t queue_delay_us = now_utc_us - socket_timestamp_us;
+  if (queue_delay_us < 0 || queue_delay_us > kMaxReceiveQueueDelayUs) {
+    return now_us;
+  }
+  return now_us - queue_delay_us;
+}
 
 AsyncUDPSocket* AsyncUDPSocket::Create(Socket* socket,
                                        const SocketAddress& bind_address) {
@@ -42,6 +70,21 @@ AsyncUDPSocket* AsyncUDPSocket::Create(SocketFactory* factory,
   return Create(socket, bind_address);
 }
 
+AsyncUDPSocket* AsyncUDPSocket::CreateWithReusePort(
+    SocketFactory* factory,
+    const SocketAddress& bind_address) {
+  std::unique_ptr<Socket> socket(
+      factory->CreateSocket(bind_address.family(), SOCK_DGRAM));
+  if (!socket)
+    return nullptr;
+  if (socket->SetOption(Socket::OPT_REUSEPORT, 1) < 0) {
+    RTC_LOG(LS_ERROR) << "Setting SO_REUSEPORT failed with error "
+                      << socket->GetError();
+    return nullptr;
+  }
+  return Create(socket.release(), bind_address);
+}
+
 AsyncUDPSocket::AsyncUDPSocket(Socket* socket) : socket_(socket) {
   size_ = BUF_SIZE;
   buf_ = new char[size_];
@@ -52,6 +95,10 @@ AsyncUDPSocket::AsyncUDPSocket(Socket* socket) : socket_(socket) {
 }
 
 AsyncUDPSocket::~AsyncUDPSocket() {
+  FlushPendingPackets();
+  if (destroyed_) {
+    *destroyed_ = true;
+  }
   delete[] buf_;
 }
 
@@ -66,6 +113,7 @@ SocketAddress AsyncUDPSocket::GetRemoteAddress() const {
 int AsyncUDPSocket::Send(const void* pv,
                          size_t cb,
                          const rtc::PacketOptions& options) {
+  FlushPendingPackets();
   rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis(),
                               options.info_signaled_after_sent);
   CopySocketInformationToPacketInfo(cb, *this, false, &sent_packet.info);
@@ -78,6 +126,34 @@ int AsyncUDPSocket::SendTo(const void* pv,
                            size_t cb,
                            const SocketAddress& addr,
                            const rtc::PacketOptions& options) {
+  if (options.batchable) {
+    if (pending_packets_.empty()) {
+      // Make sure the batch is sent even if it is never closed by a packet
+      // marked `last_packet_in_batch`.
+      if (webrtc::TaskQueueBase* current = webrtc::TaskQueueBase::Current()) {
+        current->PostTask(webrtc::SafeTask(task_safety_.flag(),
+                                           [this] { FlushPendingPackets(); }),
+                          webrtc::Location::Current());
+      }
+    }
+    PendingPacket pending{addr, options.packet_id,
+                          options.info_signaled_after_sent};
+    CopySocketInformationToPacketInfo(cb, *this, true, &pending.info);
+    if (pending_payloads_.size() <= pending_packets_.size()) {
+      pending_payloads_.emplace_back();
+    }
+    pending_payloads_[pending_packets_.size()].SetData(
+        static_cast<const uint8_t*>(pv), cb);
+    pending_packets_.push_back(std::move(pending));
+    if (options.last_packet_in_batch ||
+        pending_packets_.size() >= kMaxPendingPackets ||
+        !webrtc::TaskQueueBase::Current()) {
+      FlushPendingPackets();
+    }
+    return static_cast<int>(cb);
+  }
+
+  FlushPendingPackets();
   rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis(),
                               options.info_signaled_after_sent);
   CopySocketInformationToPacketInfo(cb, *this, true, &sent_packet.info);
@@ -87,6 +163,7 @@ int AsyncUDPSocket::SendTo(const void* pv,
 }
 
 int AsyncUDPSocket::Close() {
+  FlushPendingPackets();
   return socket_->Close();
 }
 
@@ -110,9 +187,40 @@ void AsyncUDPSocket::SetError(int error) {
   return socket_->SetError(error);
 }
 
+void AsyncUDPSocket::SetReceiveBatchSize(size_t max_packets,
+                                         size_t max_packet_size) {
+  RTC_DCHECK_GT(max_packets, 0);
+  RTC_DCHECK_GT(max_packet_size, 0);
+  if (destroyed_) {
+    // A listener called this from ReadBatch(), which is still iterating over
+    // the batch buffers.
+    pending_batch_size_.emplace(max_packets, max_packet_size);
+    return;
+  }
+  ResizeReceiveBatch(max_packets, max_packet_size);
+}
+
+void AsyncUDPSocket::ResizeReceiveBatch(size_t max_packets,
+                                        size_t max_packet_size) {
+  batch_buffers_.clear();
+  batch_packets_.clear();
+  batch_packet_size_ = 0;
+  if (max_packets <= 1) {
+    return;
+  }
+  batch_packet_size_ = max_packet_size;
+  batch_packets_.resize(max_packets);
+  batch_buffers_.resize(max_packets);
+}
+
 void AsyncUDPSocket::OnReadEvent(Socket* socket) {
   RTC_DCHECK(socket_.get() == socket);
 
+  if (!batch_buffers_.empty()) {
+    ReadBatch();
+    return;
+  }
+
   SocketAddress remote_addr;
   int64_t timestamp;
   int len = socket_->RecvFrom(buf_, size_, &remote_addr, &timestamp);
@@ -130,7 +238,86 @@ void AsyncUDPSocket::OnReadEvent(Socket* socket) {
   // TODO: Make sure that we got all of the packet.
   // If we did not, then we should resize our buffer to be large enough.
   SignalReadPacket(this, buf_, static_cast<size_t>(len), remote_addr,
-                   (timestamp > -1 ? timestamp : TimeMicros()));
+                   ToPacketTime(timestamp, TimeMicros(), TimeUTCMicros()));
+}
+
+void AsyncUDPSocket::ReadBatch() {
+  for (size_t i = 0; i < batch_packets_.size(); ++i) {
+    CopyOnWriteBuffer& packet = batch_packets_[i];
+    if (packet.capacity() < batch_packet_size_) {
+      packet = ScopedReceivedPacketBuffer::AllocateBuffer(batch_packet_size_);
+    } else {
+      packet.SetSize(batch_packet_size_);
+    }
+    batch_buffers_[i].data = packet.MutableData<char>();
+    batch_buffers_[i].capacity = batch_packet_size_;
+  }
+  int count = socket_->RecvFromBatch(batch_buffers_);
+  if (count < 0) {
+    // See OnReadEvent() for why errors are not propagated.
+    SocketAddress local_addr = socket_->GetLocalAddress();
+    RTC_LOG(LS_INFO) << "AsyncUDPSocket[" << local_addr.ToSensitiveString()
+                     << "] batched receive failed with error "
+                     << socket_->GetError();
+    return;
+  }
+
+  // The clocks are read once per batch. Datagrams without a kernel timestamp
+  // share that arrival time.
+  const int64_t now_us = count > 0 ? TimeMicros() : -1;
+  const int64_t now_utc_us = count > 0 ? TimeUTCMicros() : -1;
+  bool destroyed = false;
+  destroyed_ = &destroyed;
+  for (int i = 0; i < count; ++i) {
+    const Socket::ReceiveBuffer& buffer = batch_buffers_[i];
+    if (buffer.truncated) {
+      RTC_LOG(LS_WARNING) << "AsyncUDPSocket["
+                          << socket_->GetLocalAddress().ToSensitiveString()
+                          << "] dropped datagram larger than "
+                          << buffer.capacity << " bytes.";
+      continue;
+    }
+    batch_packets_[i].SetSize(buffer.length);
+    {
+      ScopedReceivedPacketBuffer scoped_packet(&batch_packets_[i]);
+      SignalReadPacket(this, buffer.data, buffer.length, buffer.source_address,
+                       ToPacketTime(buffer.timestamp, now_us, now_utc_us));
+    }
+    if (destroyed) {
+      return;
+    }
+  }
+  destroyed_ = nullptr;
+  if (pending_batch_size_) {
+    ResizeReceiveBatch(pending_batch_size_->first, pending_batch_size_->second);
+    pending_batch_size_.reset();
+  }
+}
+
+void AsyncUDPSocket::FlushPendingPackets() {
+  if (pending_packets_.empty()) {
+    return;
+  }
+  send_buffers_.clear();
+  for (size_t i = 0; i < pending_packets_.size(); ++i) {
+    const Buffer& payload = pending_payloads_[i];
+    send_buffers_.push_back({payload.data<char>(), payload.size(),
+                             pending_packets_[i].destination});
+  }
+  int sent = socket_->SendToBatch(send_buffers_);
+  if (sent < static_cast<int>(send_buffers_.size())) {
+    RTC_LOG(LS_VERBOSE) << "AsyncUDPSocket sent " << std::max(sent, 0)
+                        << " of " << send_buffers_.size()
+                        << " batched packets, error " << socket_->GetError();
+  }
+  // Like the unbatched path, signal every packet whether or not it was sent.
+  const int64_t now_ms = rtc::TimeMillis();
+  std::vector<PendingPacket> packets;
+  packets.swap(pending_packets_);
+  for (const PendingPacket& packet : packets) {
+    SignalSentPacket(this, rtc::SentPacket(packet.packet_id, now_ms,
+                                           packet.info));
+  }
 }
 
 void AsyncUDPSocket::OnWriteEvent(Socket* socket) {
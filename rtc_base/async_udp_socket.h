@@ -14,8 +14,15 @@
 #include <stddef.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "absl/types/optional.h"
+#include "api/task_queue/pending_task_safety_flag.h"
 #include "rtc_base/async_packet_socket.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/network/sent_packet.h"
 #include "rtc_base/socket.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/socket_factory.h"
@@ -23,7 +30,9 @@
 namespace rtc {
 
 // Provides the ability to receive packets asynchronously.  Sends are not
-// buffered since it is acceptable to drop packets under high load.
+// buffered since it is acceptable to drop packets under high load, except
+// that packets marked as batchable (see PacketOptions) are briefly held back
+// and sent together with Socket::SendToBatch().
 class AsyncUDPSocket : public AsyncPacketSocket {
  public:
   // Binds `socket` and creates AsyncUDPSocket for it. Takes ownership
@@ -35,6 +44,12 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   // asynchronous socket from the given factory.
   static AsyncUDPSocket* Create(SocketFactory* factory,
                                 const SocketAddress& bind_address);
+  // Like the above, but sets Socket::OPT_REUSEPORT before binding, so that
+  // several sockets, typically on different threads, can share
+  // `bind_address`. The kernel then spreads the incoming packets across them
+  // by hashing their 5-tuple. Returns null if the option is not supported.
+  static AsyncUDPSocket* CreateWithReusePort(SocketFactory* factory,
+                                             const SocketAddress& bind_address);
   explicit AsyncUDPSocket(Socket* socket);
   ~AsyncUDPSocket() override;
 
@@ -55,15 +70,65 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   int GetError() const override;
   void SetError(int error) override;
 
+  // Default per-datagram capacity used when batched receive is enabled.
+  static constexpr size_t kDefaultBatchPacketSize = 2048;
+
+  // Enables reading up to `max_packets` queued datagrams per read event with
+  // a single Socket::RecvFromBatch() call, each delivered through
+  // SignalReadPacket in arrival order. Datagrams larger than
+  // `max_packet_size` are dropped. Passing 1 restores the default of reading
+  // one datagram, of up to 64 KB, per read event.
+  //
+  // In batched mode every datagram is read into a buffer of its own, and
+  // delivered within a ScopedReceivedPacketBuffer, so that the listener that
+  // keeps the packet can take the buffer instead of copying it.
+  //
+  // May be called by a SignalReadPacket listener, in which case the new size
+  // takes effect once the current batch has been delivered.
+  void SetReceiveBatchSize(size_t max_packets,
+                           size_t max_packet_size = kDefaultBatchPacketSize);
+
  private:
   // Called when the underlying socket is ready to be read from.
   void OnReadEvent(Socket* socket);
   // Called when the underlying socket is ready to send.
   void OnWriteEvent(Socket* socket);
+  // Reads and delivers a batch of datagrams when batching is enabled.
+  void ReadBatch();
+  // Reallocates the batch buffers, which must not be in use.
+  void ResizeReceiveBatch(size_t max_packets, size_t max_packet_size);
+  // Sends all packets held back by batchable SendTo() calls.
+  void FlushPendingPackets();
 
   std::unique_ptr<Socket> socket_;
   char* buf_;
   size_t size_;
+  // Buffers for batched receive, empty unless SetReceiveBatchSize() was
+  // called with `max_packets` > 1. Buffers taken by listeners are replaced
+  // before the next read.
+  size_t batch_packet_size_ = 0;
+  std::vector<CopyOnWriteBuffer> batch_packets_;
+  std::vector<Socket::ReceiveBuffer> batch_buffers_;
+  // Points to a flag on the stack of ReadBatch() while it is delivering
+  // packets, so that it can stop if a listener destroys this socket.
+  bool* destroyed_ = nullptr;
+  // Batch size requested while ReadBatch() was delivering packets, as
+  // `max_packets` and `max_packet_size`.
+  absl::optional<std::pair<size_t, size_t>> pending_batch_size_;
+
+  // Packets held back until the end of the current send batch. The payload of
+  // the i-th one is in `pending_payloads_[i]`, whose buffers are kept across
+  // batches so that they are seldom reallocated, and never copied again
+  // before being sent.
+  struct PendingPacket {
+    SocketAddress destination;
+    int64_t packet_id;
+    PacketInfo info;
+  };
+  std::vector<Buffer> pending_payloads_;
+  std::vector<PendingPacket> pending_packets_;
+  std::vector<Socket::SendBuffer> send_buffers_;
+  webrtc::ScopedTaskSafetyDetached task_safety_;
 };
 
 }  // namespace rtc
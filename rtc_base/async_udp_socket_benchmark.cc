@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+
+#include "api/units/time_delta.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kPacketsPerIteration = 64;
+constexpr size_t kPacketSize = 1200;
+
+class PacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++received;
+  }
+
+  int received = 0;
+};
+
+// Measures the cost of receiving and dispatching a burst of datagrams through
+// PhysicalSocketServer and AsyncUDPSocket, with one datagram per read event
+// (batch size 1) or up to `state.range(0)` per read event.
+void BM_AsyncUdpSocketReceive(benchmark::State& state) {
+  PhysicalSocketServer ss;
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(&ss, SocketAddress("127.0.0.1", 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&ss, SocketAddress("127.0.0.1", 0)));
+  if (!receiver || !sender) {
+    state.SkipWithError("Failed to bind loopback sockets.");
+    return;
+  }
+  receiver->SetReceiveBatchSize(state.range(0));
+  PacketCounter counter;
+  receiver->SignalReadPacket.connect(&counter, &PacketCounter::OnReadPacket);
+  const SocketAddress destination = receiver->GetLocalAddress();
+  char payload[kPacketSize] = {};
+
+  for (auto s : state) {
+    state.PauseTiming();
+    counter.received = 0;
+    for (int i = 0; i < kPacketsPerIteration; ++i) {
+      sender->SendTo(payload, sizeof(payload), destination, PacketOptions());
+    }
+    state.ResumeTiming();
+    while (counter.received < kPacketsPerIteration) {
+      ss.Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerIteration);
+}
+
+BENCHMARK(BM_AsyncUdpSocketReceive)->Arg(1)->Arg(8)->Arg(32)->Arg(64);
+
+// Measures the cost of sending a paced burst of datagrams through
+// AsyncUDPSocket, either one system call per datagram (arg 0) or as a single
+// batch flushed with sendmmsg/UDP GSO where available (arg 1).
+void BM_AsyncUdpSocketSend(benchmark::State& state) {
+  PhysicalSocketServer ss;
+  // Batches are only held back while running on a task queue.
+  AutoSocketServerThread thread(&ss);
+  std::unique_ptr<Socket> receiver(ss.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&ss, SocketAddress("127.0.0.1", 0)));
+  if (!receiver || receiver->Bind(SocketAddress("127.0.0.1", 0)) != 0 ||
+      !sender) {
+    state.SkipWithError("Failed to bind loopback sockets.");
+    return;
+  }
+  const SocketAddress destination = receiver->GetLocalAddress();
+  char payload[kPacketSize] = {};
+  char drain_buffer[kPacketSize];
+  PacketOptions options;
+  options.batchable = state.range(0) != 0;
+
+  for (auto s : state) {
+    for (int i = 0; i < kPacketsPerIteration; ++i) {
+      options.last_packet_in_batch = i == kPacketsPerIteration - 1;
+      sender->SendTo(payload, sizeof(payload), destination, options);
+    }
+    state.PauseTiming();
+    while (receiver->RecvFrom(drain_buffer, sizeof(drain_buffer), nullptr,
+                              nullptr) > 0) {
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerIteration);
+}
+
+BENCHMARK(BM_AsyncUdpSocketSend)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace rtc
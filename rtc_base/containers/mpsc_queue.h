@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_CONTAINERS_MPSC_QUEUE_H_
+#define RTC_BASE_CONTAINERS_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+namespace webrtc {
+
+// Base class for elements of an MpscQueue, holding the link to the next one.
+class MpscQueueNode {
+ public:
+  MpscQueueNode() = default;
+  MpscQueueNode(const MpscQueueNode&) = delete;
+  MpscQueueNode& operator=(const MpscQueueNode&) = delete;
+
+ private:
+  template <typename T>
+  friend class MpscQueue;
+
+  std::atomic<MpscQueueNode*> next_{nullptr};
+};
+
+// An intrusive, unbounded, lock-free multi-producer/single-consumer FIFO
+// queue of elements derived from MpscQueueNode (Dmitry Vyukov's algorithm).
+//
+// Push() may be called from any thread and never blocks: it costs one atomic
+// exchange and one store, so producers don't contend on a lock with each
+// other or with the consumer. Pop() must only be called by one thread at a
+// time. It may briefly report the queue as empty while a concurrent Push() is
+// between its two steps, so a producer should notify the consumer only after
+// Push() has returned.
+template <typename T>
+class MpscQueue {
+  static_assert(std::is_base_of<MpscQueueNode, T>::value,
+                "Elements must derive from MpscQueueNode");
+
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+  // Destroys remaining elements. There must be no concurrent Push().
+  ~MpscQueue() { Clear(); }
+
+  // Thread safe.
+  void Push(std::unique_ptr<T> element) { PushNode(element.release()); }
+
+  // Returns the oldest element, or null if there is none. Single consumer.
+  std::unique_ptr<T> Pop() {
+    MpscQueueNode* tail = tail_;
+    MpscQueueNode* next = tail->next_.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next_.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return std::unique_ptr<T>(static_cast<T*>(tail));
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // A producer has swapped in a new head but not linked it yet.
+      return nullptr;
+    }
+    // `tail` is the last element. Put the stub behind it so that it can be
+    // detached.
+    PushNode(&stub_);
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      return std::unique_ptr<T>(static_cast<T*>(tail));
+    }
+    return nullptr;
+  }
+
+  // Destroys all elements that can be popped. Single consumer.
+  void Clear() {
+    while (Pop()) {
+    }
+  }
+
+ private:
+  void PushNode(MpscQueueNode* node) {
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    MpscQueueNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next_.store(node, std::memory_order_release);
+  }
+
+  // Most recently pushed node, written by producers.
+  std::atomic<MpscQueueNode*> head_;
+  // Oldest node, only touched by the consumer. Kept apart from `head_` to
+  // avoid false sharing.
+  alignas(64) MpscQueueNode* tail_;
+  MpscQueueNode stub_;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_CONTAINERS_MPSC_QUEUE_H_
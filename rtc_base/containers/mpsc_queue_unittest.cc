@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/containers/mpsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+struct Element : public MpscQueueNode {
+  Element(int producer, int value, int* destroyed = nullptr)
+      : producer(producer), value(value), destroyed(destroyed) {}
+  ~Element() {
+    if (destroyed) {
+      ++*destroyed;
+    }
+  }
+
+  const int producer;
+  const int value;
+  int* const destroyed;
+};
+
+TEST(MpscQueueTest, PopsInPushOrder) {
+  MpscQueue<Element> queue;
+  EXPECT_EQ(nullptr, queue.Pop());
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(std::make_unique<Element>(0, i));
+  }
+  for (int i = 0; i < 3; ++i) {
+    std::unique_ptr<Element> element = queue.Pop();
+    ASSERT_NE(nullptr, element);
+    EXPECT_EQ(i, element->value);
+  }
+  EXPECT_EQ(nullptr, queue.Pop());
+}
+
+TEST(MpscQueueTest, CanBeReusedAfterDraining) {
+  MpscQueue<Element> queue;
+  for (int round = 0; round < 3; ++round) {
+    queue.Push(std::make_unique<Element>(0, round));
+    std::unique_ptr<Element> element = queue.Pop();
+    ASSERT_NE(nullptr, element);
+    EXPECT_EQ(round, element->value);
+    EXPECT_EQ(nullptr, queue.Pop());
+  }
+}
+
+TEST(MpscQueueTest, DestroysRemainingElements) {
+  int destroyed = 0;
+  {
+    MpscQueue<Element> queue;
+    queue.Push(std::make_unique<Element>(0, 0, &destroyed));
+    queue.Push(std::make_unique<Element>(0, 1, &destroyed));
+  }
+  EXPECT_EQ(2, destroyed);
+}
+
+TEST(MpscQueueTest, KeepsPerProducerOrderUnderConcurrentPushes) {
+  constexpr int kProducers = 4;
+  constexpr int kElementsPerProducer = 10000;
+  MpscQueue<Element> queue;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < kElementsPerProducer; ++i) {
+        queue.Push(std::make_unique<Element>(p, i));
+      }
+    });
+  }
+
+  std::vector<int> next_value(kProducers, 0);
+  int received = 0;
+  while (received < kProducers * kElementsPerProducer) {
+    std::unique_ptr<Element> element = queue.Pop();
+    if (!element) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(next_value[element->producer], element->value);
+    next_value[element->producer] = element->value + 1;
+    ++received;
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(nullptr, queue.Pop());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,276 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_CONTAINERS_TIMING_WHEEL_H_
+#define RTC_BASE_CONTAINERS_TIMING_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+// Rounds `run_time` up to a multiple of `granularity`. Deadlines that may be
+// late by up to `granularity - 1` ticks can be rounded like this so that the
+// ones falling into the same interval expire together, with a single wakeup.
+inline int64_t CoalesceRunTime(int64_t run_time, int64_t granularity) {
+  RTC_DCHECK_GT(granularity, 0);
+  int64_t remainder = run_time % granularity;
+  if (remainder < 0) {
+    remainder += granularity;
+  }
+  return remainder == 0 ? run_time : run_time + granularity - remainder;
+}
+
+// Granularity to which task queues that coalesce low precision delayed tasks
+// round their run times up, in milliseconds. Low precision tasks may run up
+// to 17 ms late, so this stays within their leeway.
+constexpr int64_t kLowPrecisionGridMs = 16;
+
+// A hierarchical timing wheel holding values of type T until their run time,
+// in integer ticks of a clock chosen by the owner (e.g. milliseconds).
+//
+// Insert() is O(1), regardless of the number of pending values, unlike the
+// O(log n) of a priority queue. Values are kept in kLevels wheels of kSlots
+// slots each, where a slot of level L spans kSlots^L ticks. A value goes into
+// the level matching the most significant bits in which its run time differs
+// from the current time, and moves down to lower levels as time advances
+// towards it. Beyond the range of the top level, values wait in an overflow
+// list.
+//
+// Expired values are returned ordered by run time, and in insertion order for
+// equal run times. Not thread safe.
+template <typename T>
+class TimingWheel {
+ public:
+  explicit TimingWheel(int64_t now) : now_(now) {}
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  int64_t now() const { return now_; }
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Adds `value`, to expire once the time is advanced to `run_time` or later.
+  // A `run_time` that isn't after now() expires on the next AdvanceTo().
+  void Insert(int64_t run_time, T value) {
+    Place(Entry{run_time, next_sequence_number_++, std::move(value)});
+    ++size_;
+  }
+
+  // Returns the earliest run time of the values in the wheel, which must not
+  // be empty. Cheap when that run time is less than kSlots ticks ahead,
+  // otherwise proportional to the number of values sharing its slot.
+  int64_t NextRunTime() const {
+    RTC_DCHECK(!empty());
+    if (!due_.empty()) {
+      return std::min_element(due_.begin(), due_.end(), RunsBefore)->run_time;
+    }
+    for (int level = 0; level < kLevels; ++level) {
+      if (occupied_[level] == 0) {
+        continue;
+      }
+      int slot = LowestSlot(occupied_[level]);
+      if (level == 0) {
+        // All values in a level 0 slot share one run time.
+        return (now_ & ~static_cast<int64_t>(kSlots - 1)) | slot;
+      }
+      const std::vector<Entry>& entries = slots_[level][slot];
+      return std::min_element(entries.begin(), entries.end(), RunsBefore)
+          ->run_time;
+    }
+    return std::min_element(overflow_.begin(), overflow_.end(), RunsBefore)
+        ->run_time;
+  }
+
+  // Advances the current time to `now` and passes each value whose run time
+  // is `now` or earlier to `on_expired`, in order. Returns the number of
+  // expired values. If `now` is before now(), the clock has been replaced
+  // (e.g. by a fake clock in a test) and all values are rescheduled relative
+  // to `now`.
+  template <typename Callback>
+  size_t AdvanceTo(int64_t now, Callback on_expired) {
+    if (now < now_) {
+      Rewind(now);
+    } else if (now > now_) {
+      Advance(now);
+    }
+    if (due_.empty()) {
+      return 0;
+    }
+    std::sort(due_.begin(), due_.end(), RunsBefore);
+    size_t expired = due_.size();
+    // Moved aside first, so that `on_expired` may safely call Insert().
+    std::vector<Entry> due;
+    due.swap(due_);
+    size_ -= expired;
+    for (Entry& entry : due) {
+      on_expired(std::move(entry.value));
+    }
+    // Keeps the capacity for the next call.
+    due.clear();
+    if (due_.empty()) {
+      due_.swap(due);
+    }
+    return expired;
+  }
+
+  // Destroys all values.
+  void Clear() {
+    for (int level = 0; level < kLevels; ++level) {
+      for (std::vector<Entry>& entries : slots_[level]) {
+        entries.clear();
+      }
+      occupied_[level] = 0;
+    }
+    overflow_.clear();
+    due_.clear();
+    size_ = 0;
+  }
+
+ private:
+  static constexpr int kSlotBits = 6;
+  static constexpr int kSlots = 1 << kSlotBits;
+  static constexpr int kLevels = 4;
+
+  struct Entry {
+    int64_t run_time;
+    uint64_t sequence_number;
+    T value;
+  };
+
+  static bool RunsBefore(const Entry& a, const Entry& b) {
+    return a.run_time < b.run_time ||
+           (a.run_time == b.run_time && a.sequence_number < b.sequence_number);
+  }
+
+  static int LowestSlot(uint64_t occupied) {
+    RTC_DCHECK_NE(occupied, 0);
+    int slot = 0;
+    while ((occupied & (uint64_t{1} << slot)) == 0) {
+      ++slot;
+    }
+    return slot;
+  }
+
+  static int SlotAt(int64_t time, int level) {
+    return static_cast<int>((time >> (level * kSlotBits)) & (kSlots - 1));
+  }
+
+  // Whether `a` and `b` are in the same span of the slots of `level`.
+  static bool SameSpan(int64_t a, int64_t b, int level) {
+    return (a >> ((level + 1) * kSlotBits)) == (b >> ((level + 1) * kSlotBits));
+  }
+
+  // Puts `entry` where it belongs relative to `now_`. Doesn't update `size_`.
+  void Place(Entry entry) {
+    if (entry.run_time <= now_) {
+      due_.push_back(std::move(entry));
+      return;
+    }
+    for (int level = 0; level < kLevels; ++level) {
+      if (SameSpan(entry.run_time, now_, level)) {
+        int slot = SlotAt(entry.run_time, level);
+        slots_[level][slot].push_back(std::move(entry));
+        occupied_[level] |= uint64_t{1} << slot;
+        return;
+      }
+    }
+    overflow_.push_back(std::move(entry));
+  }
+
+  // Moves all entries of a slot to `out`.
+  void TakeSlot(int level, int slot, std::vector<Entry>& out) {
+    std::vector<Entry>& entries = slots_[level][slot];
+    for (Entry& entry : entries) {
+      out.push_back(std::move(entry));
+    }
+    entries.clear();
+    occupied_[level] &= ~(uint64_t{1} << slot);
+  }
+
+  void Advance(int64_t now) {
+    RTC_DCHECK_GT(now, now_);
+    // The entries of a level all run after `now_` and in the same span of
+    // that level's slots. The slots before the one `now` falls in have
+    // expired, and that one has to be redistributed to the lower levels.
+    // Entries put aside for redistribution are only placed after all levels
+    // have been visited, relative to the new time.
+    std::vector<Entry> cascade;
+    for (int level = 0; level < kLevels; ++level) {
+      if (occupied_[level] == 0) {
+        continue;
+      }
+      if (!SameSpan(now, now_, level)) {
+        for (int slot = 0; slot < kSlots; ++slot) {
+          if (occupied_[level] & (uint64_t{1} << slot)) {
+            TakeSlot(level, slot, due_);
+          }
+        }
+        continue;
+      }
+      int now_slot = SlotAt(now, level);
+      for (int slot = SlotAt(now_, level) + 1; slot <= now_slot; ++slot) {
+        if (occupied_[level] & (uint64_t{1} << slot)) {
+          TakeSlot(level, slot, slot < now_slot ? due_ : cascade);
+        }
+      }
+    }
+    if (!overflow_.empty() && !SameSpan(now, now_, kLevels - 1)) {
+      for (Entry& entry : overflow_) {
+        cascade.push_back(std::move(entry));
+      }
+      overflow_.clear();
+    }
+    now_ = now;
+    for (Entry& entry : cascade) {
+      Place(std::move(entry));
+    }
+  }
+
+  void Rewind(int64_t now) {
+    std::vector<Entry> all;
+    all.swap(due_);
+    for (int level = 0; level < kLevels; ++level) {
+      for (int slot = 0; slot < kSlots; ++slot) {
+        if (occupied_[level] & (uint64_t{1} << slot)) {
+          TakeSlot(level, slot, all);
+        }
+      }
+    }
+    for (Entry& entry : overflow_) {
+      all.push_back(std::move(entry));
+    }
+    overflow_.clear();
+    now_ = now;
+    for (Entry& entry : all) {
+      Place(std::move(entry));
+    }
+  }
+
+  int64_t now_;
+  uint64_t next_sequence_number_ = 0;
+  size_t size_ = 0;
+  // Bit i of occupied_[L] is set when slots_[L][i] isn't empty.
+  uint64_t occupied_[kLevels] = {};
+  std::vector<Entry> slots_[kLevels][kSlots];
+  std::vector<Entry> overflow_;
+  // Entries whose run time has been reached.
+  std::vector<Entry> due_;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_CONTAINERS_TIMING_WHEEL_H_
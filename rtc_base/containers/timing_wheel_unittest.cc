@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/containers/timing_wheel.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::vector<int> AdvanceTo(TimingWheel<int>& wheel, int64_t now) {
+  std::vector<int> expired;
+  wheel.AdvanceTo(now, [&expired](int value) { expired.push_back(value); });
+  return expired;
+}
+
+TEST(TimingWheelTest, ExpiresValuesInRunTimeOrder) {
+  TimingWheel<int> wheel(/*now=*/1000);
+  wheel.Insert(1030, 3);
+  wheel.Insert(1010, 1);
+  wheel.Insert(1020, 2);
+  EXPECT_EQ(3u, wheel.size());
+  EXPECT_EQ(1010, wheel.NextRunTime());
+
+  EXPECT_THAT(AdvanceTo(wheel, 1009), IsEmpty());
+  EXPECT_THAT(AdvanceTo(wheel, 1010), ElementsAre(1));
+  EXPECT_EQ(1020, wheel.NextRunTime());
+  EXPECT_THAT(AdvanceTo(wheel, 1100), ElementsAre(2, 3));
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimingWheelTest, ExpiresEqualRunTimesInInsertionOrder) {
+  TimingWheel<int> wheel(/*now=*/0);
+  for (int i = 0; i < 5; ++i) {
+    wheel.Insert(10'000, i);
+  }
+  EXPECT_THAT(AdvanceTo(wheel, 10'000), ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST(TimingWheelTest, ExpiresPastRunTimesOnNextAdvance) {
+  TimingWheel<int> wheel(/*now=*/100);
+  wheel.Insert(50, 1);
+  wheel.Insert(100, 2);
+  EXPECT_EQ(50, wheel.NextRunTime());
+  EXPECT_THAT(AdvanceTo(wheel, 100), ElementsAre(1, 2));
+}
+
+TEST(TimingWheelTest, HandlesRunTimesBeyondAllLevels) {
+  TimingWheel<int> wheel(/*now=*/0);
+  const int64_t kFarAway = int64_t{1} << 40;
+  wheel.Insert(kFarAway, 2);
+  wheel.Insert(5, 1);
+  EXPECT_THAT(AdvanceTo(wheel, 5), ElementsAre(1));
+  EXPECT_EQ(kFarAway, wheel.NextRunTime());
+  EXPECT_THAT(AdvanceTo(wheel, kFarAway - 1), IsEmpty());
+  EXPECT_EQ(kFarAway, wheel.NextRunTime());
+  EXPECT_THAT(AdvanceTo(wheel, kFarAway), ElementsAre(2));
+}
+
+TEST(TimingWheelTest, ReschedulesWhenTimeGoesBackwards) {
+  TimingWheel<int> wheel(/*now=*/1'000'000);
+  wheel.Insert(1'000'100, 1);
+  // Values inserted relative to the old time are only due at their run time.
+  wheel.Insert(200, 2);
+  EXPECT_THAT(AdvanceTo(wheel, 100), IsEmpty());
+  EXPECT_EQ(200, wheel.NextRunTime());
+  EXPECT_THAT(AdvanceTo(wheel, 200), ElementsAre(2));
+  EXPECT_THAT(AdvanceTo(wheel, 1'000'100), ElementsAre(1));
+}
+
+TEST(TimingWheelTest, AllowsInsertionFromExpiryCallback) {
+  TimingWheel<int> wheel(/*now=*/0);
+  wheel.Insert(10, 1);
+  std::vector<int> expired;
+  wheel.AdvanceTo(10, [&](int value) {
+    expired.push_back(value);
+    wheel.Insert(20, value + 1);
+  });
+  EXPECT_THAT(expired, ElementsAre(1));
+  EXPECT_THAT(AdvanceTo(wheel, 20), ElementsAre(2));
+}
+
+TEST(TimingWheelTest, HoldsMoveOnlyValues) {
+  TimingWheel<std::unique_ptr<int>> wheel(/*now=*/0);
+  wheel.Insert(100, std::make_unique<int>(7));
+  int value = 0;
+  wheel.AdvanceTo(100, [&](std::unique_ptr<int> v) { value = *v; });
+  EXPECT_EQ(7, value);
+}
+
+TEST(TimingWheelTest, CoalesceRunTimeRoundsUpToGranularity) {
+  EXPECT_EQ(0, CoalesceRunTime(0, 16));
+  EXPECT_EQ(16, CoalesceRunTime(1, 16));
+  EXPECT_EQ(16, CoalesceRunTime(16, 16));
+  EXPECT_EQ(32, CoalesceRunTime(17, 16));
+  EXPECT_EQ(0, CoalesceRunTime(-15, 16));
+}
+
+// Compares against a sorted map, advancing time in random steps.
+TEST(TimingWheelTest, MatchesReferenceForRandomRunTimes) {
+  std::mt19937 random(/*seed=*/42);
+  std::uniform_int_distribution<int64_t> delay(0, 300'000);
+  std::uniform_int_distribution<int64_t> step(0, 5'000);
+  int64_t now = 123'456;
+  TimingWheel<int> wheel(now);
+  std::multimap<int64_t, int> reference;
+  int next_value = 0;
+  for (int round = 0; round < 2000; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      int64_t run_time = now + delay(random);
+      wheel.Insert(run_time, next_value);
+      reference.emplace(run_time, next_value);
+      ++next_value;
+    }
+    ASSERT_EQ(reference.begin()->first, wheel.NextRunTime());
+    now += step(random);
+    std::vector<int> expected;
+    while (!reference.empty() && reference.begin()->first <= now) {
+      expected.push_back(reference.begin()->second);
+      reference.erase(reference.begin());
+    }
+    ASSERT_EQ(expected, AdvanceTo(wheel, now));
+    ASSERT_EQ(reference.size(), wheel.size());
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -12,10 +12,45 @@
 
 #include <stddef.h>
 
+#include <new>
+
 #include "absl/strings/string_view.h"
+#include "rtc_base/memory/slab_pool.h"
 
 namespace rtc {
 
+CopyOnWriteBuffer::Storage* CopyOnWriteBuffer::Storage::Create(
+    size_t size,
+    size_t capacity,
+    bool pooled) {
+  capacity = std::max(size, capacity);
+  size_t block_size = sizeof(Storage) + capacity;
+  void* block;
+  int size_class = SlabPool::kNoSizeClass;
+  if (pooled) {
+    block = SlabPool::Instance()->Allocate(block_size, &size_class);
+  } else {
+    block = ::operator new(block_size);
+  }
+  return new (block) Storage(size, capacity, size_class, pooled);
+}
+
+RefCountReleaseStatus CopyOnWriteBuffer::Storage::Release() const {
+  const RefCountReleaseStatus status = ref_count_.DecRef();
+  if (status == RefCountReleaseStatus::kDroppedLastRef) {
+    Storage* block = const_cast<Storage*>(this);
+    const int size_class = size_class_;
+    const bool pooled = pooled_;
+    block->~Storage();
+    if (pooled) {
+      SlabPool::Instance()->Free(block, size_class);
+    } else {
+      ::operator delete(block);
+    }
+  }
+  return status;
+}
+
 CopyOnWriteBuffer::CopyOnWriteBuffer() : offset_(0), size_(0) {
   RTC_DCHECK(IsConsistent());
 }
@@ -34,15 +69,17 @@ CopyOnWriteBuffer::CopyOnWriteBuffer(absl::string_view s)
     : CopyOnWriteBuffer(s.data(), s.length()) {}
 
 CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size)
-    : buffer_(size > 0 ? new RefCountedBuffer(size) : nullptr),
+    : buffer_(size > 0 ? Storage::Create(size, size, /*pooled=*/false)
+                       : nullptr),
       offset_(0),
       size_(size) {
   RTC_DCHECK(IsConsistent());
 }
 
 CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity)
-    : buffer_(size > 0 || capacity > 0 ? new RefCountedBuffer(size, capacity)
-                                       : nullptr),
+    : buffer_(size > 0 || capacity > 0
+                  ? Storage::Create(size, capacity, /*pooled=*/false)
+                  : nullptr),
       offset_(0),
       size_(size) {
   RTC_DCHECK(IsConsistent());
@@ -50,6 +87,33 @@ CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity)
 
 CopyOnWriteBuffer::~CopyOnWriteBuffer() = default;
 
+CopyOnWriteBuffer CopyOnWriteBuffer::CreatePooled(size_t size,
+                                                  size_t capacity) {
+  CopyOnWriteBuffer buffer;
+  if (size > 0 || capacity > 0) {
+    buffer.buffer_ = Storage::Create(size, capacity, /*pooled=*/true);
+    buffer.size_ = size;
+  }
+  RTC_DCHECK(buffer.IsConsistent());
+  return buffer;
+}
+
+CopyOnWriteBuffer CopyOnWriteBuffer::CreatePooled(size_t size,
+                                                  size_t capacity,
+                                                  size_t headroom) {
+  if (headroom == 0) {
+    return CreatePooled(size, capacity);
+  }
+  CopyOnWriteBuffer buffer;
+  buffer.buffer_ = Storage::Create(headroom + size,
+                                   headroom + std::max(size, capacity),
+                                   /*pooled=*/true);
+  buffer.offset_ = headroom;
+  buffer.size_ = size;
+  RTC_DCHECK(buffer.IsConsistent());
+  return buffer;
+}
+
 bool CopyOnWriteBuffer::operator==(const CopyOnWriteBuffer& buf) const {
   // Must either be the same view of the same buffer or have the same contents.
   RTC_DCHECK(IsConsistent());
@@ -62,7 +126,7 @@ void CopyOnWriteBuffer::SetSize(size_t size) {
   RTC_DCHECK(IsConsistent());
   if (!buffer_) {
     if (size > 0) {
-      buffer_ = new RefCountedBuffer(size);
+      buffer_ = Storage::Create(size, size, /*pooled=*/false);
       offset_ = 0;
       size_ = size;
     }
@@ -85,7 +149,7 @@ void CopyOnWriteBuffer::EnsureCapacity(size_t new_capacity) {
   RTC_DCHECK(IsConsistent());
   if (!buffer_) {
     if (new_capacity > 0) {
-      buffer_ = new RefCountedBuffer(0, new_capacity);
+      buffer_ = Storage::Create(0, new_capacity, /*pooled=*/false);
       offset_ = 0;
       size_ = 0;
     }
@@ -104,9 +168,9 @@ void CopyOnWriteBuffer::Clear() {
     return;
 
   if (buffer_->HasOneRef()) {
-    buffer_->Clear();
+    buffer_->SetSize(0);
   } else {
-    buffer_ = new RefCountedBuffer(0, capacity());
+    buffer_ = Storage::Create(0, capacity(), buffer_->pooled());
   }
   offset_ = 0;
   size_ = 0;
@@ -118,8 +182,12 @@ void CopyOnWriteBuffer::UnshareAndEnsureCapacity(size_t new_capacity) {
     return;
   }
 
-  buffer_ =
-      new RefCountedBuffer(buffer_->data() + offset_, size_, new_capacity);
+  scoped_refptr<Storage> storage(
+      Storage::Create(size_, new_capacity, buffer_->pooled()));
+  if (size_ > 0) {
+    memcpy(storage->data(), buffer_->data() + offset_, size_);
+  }
+  buffer_ = std::move(storage);
   offset_ = 0;
   RTC_DCHECK(IsConsistent());
 }
@@ -23,7 +23,8 @@
 #include "api/scoped_refptr.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/checks.h"
-#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counter.h"
 #include "rtc_base/system/rtc_export.h"
 #include "rtc_base/type_traits.h"
 
@@ -83,6 +84,42 @@ class RTC_EXPORT CopyOnWriteBuffer {
   explicit CopyOnWriteBuffer(const VecT& v)
       : CopyOnWriteBuffer(v.data(), v.size()) {}
 
+  // Like the constructors above, but the memory comes from the SlabPool.
+  // Meant for packet sized buffers that are created and destroyed at a high
+  // rate; larger buffers silently fall back to the heap. Copies made when the
+  // buffer is reallocated, e.g. to unshare it, are pooled as well.
+  static CopyOnWriteBuffer CreatePooled(size_t size, size_t capacity);
+  template <typename T,
+            typename std::enable_if<
+                internal::BufferCompat<uint8_t, T>::value>::type* = nullptr>
+  static CopyOnWriteBuffer CreatePooled(const T* data,
+                                        size_t size,
+                                        size_t capacity) {
+    CopyOnWriteBuffer buffer = CreatePooled(size, capacity);
+    if (size > 0) {
+      std::memcpy(buffer.buffer_->data(), data, size);
+    }
+    return buffer;
+  }
+  // As above, and additionally reserves `headroom` bytes in front of the data,
+  // for a transport to write its header into, see headroom().
+  static CopyOnWriteBuffer CreatePooled(size_t size,
+                                        size_t capacity,
+                                        size_t headroom);
+  template <typename T,
+            typename std::enable_if<
+                internal::BufferCompat<uint8_t, T>::value>::type* = nullptr>
+  static CopyOnWriteBuffer CreatePooled(const T* data,
+                                        size_t size,
+                                        size_t capacity,
+                                        size_t headroom) {
+    CopyOnWriteBuffer buffer = CreatePooled(size, capacity, headroom);
+    if (size > 0) {
+      std::memcpy(buffer.buffer_->data() + headroom, data, size);
+    }
+    return buffer;
+  }
+
   ~CopyOnWriteBuffer();
 
   // Get a pointer to the data. Just .data() will give you a (const) uint8_t*,
@@ -126,6 +163,13 @@ class RTC_EXPORT CopyOnWriteBuffer {
     return size_;
   }
 
+  // Number of bytes in front of the data which are not used by this or any
+  // other buffer, and may be written through MutableData() - headroom().
+  size_t headroom() const {
+    RTC_DCHECK(IsConsistent());
+    return buffer_ && buffer_->HasOneRef() ? offset_ : 0;
+  }
+
   size_t capacity() const {
     RTC_DCHECK(IsConsistent());
     return buffer_ ? buffer_->capacity() - offset_ : 0;
@@ -172,11 +216,19 @@ class RTC_EXPORT CopyOnWriteBuffer {
   void SetData(const T* data, size_t size) {
     RTC_DCHECK(IsConsistent());
     if (!buffer_) {
-      buffer_ = size > 0 ? new RefCountedBuffer(data, size) : nullptr;
+      buffer_ = size > 0 ? Storage::Create(size, size, /*pooled=*/false)
+                         : nullptr;
     } else if (!buffer_->HasOneRef()) {
-      buffer_ = new RefCountedBuffer(data, size, capacity());
+      buffer_ = Storage::Create(size, capacity(), buffer_->pooled());
+    } else if (size > buffer_->capacity()) {
+      // Grow with some headroom, like Buffer::SetData() does.
+      buffer_ = Storage::Create(
+          size, std::max(size, buffer_->capacity() * 3 / 2), buffer_->pooled());
     } else {
-      buffer_->SetData(data, size);
+      buffer_->SetSize(size);
+    }
+    if (size > 0) {
+      std::memcpy(buffer_->data(), data, size);
     }
     offset_ = 0;
     size_ = size;
@@ -209,18 +261,17 @@ class RTC_EXPORT CopyOnWriteBuffer {
   void AppendData(const T* data, size_t size) {
     RTC_DCHECK(IsConsistent());
     if (!buffer_) {
-      buffer_ = new RefCountedBuffer(data, size);
-      offset_ = 0;
-      size_ = size;
-      RTC_DCHECK(IsConsistent());
+      SetData(data, size);
       return;
     }
 
     UnshareAndEnsureCapacity(std::max(capacity(), size_ + size));
 
-    buffer_->SetSize(offset_ +
-                     size_);  // Remove data to the right of the slice.
-    buffer_->AppendData(data, size);
+    // Also removes data to the right of the slice.
+    buffer_->SetSize(offset_ + size_ + size);
+    if (size > 0) {
+      std::memcpy(buffer_->data() + offset_ + size_, data, size);
+    }
     size_ += size;
 
     RTC_DCHECK(IsConsistent());
@@ -276,7 +327,48 @@ class RTC_EXPORT CopyOnWriteBuffer {
   }
 
  private:
-  using RefCountedBuffer = FinalRefCountedObject<Buffer>;
+  // Reference counted bytes. The header and the data are allocated as a
+  // single block, either on the heap or from the SlabPool.
+  class RTC_EXPORT Storage {
+   public:
+    // Capacity is at least `size`.
+    static Storage* Create(size_t size, size_t capacity, bool pooled);
+
+    Storage(const Storage&) = delete;
+    Storage& operator=(const Storage&) = delete;
+
+    void AddRef() const { ref_count_.IncRef(); }
+    RefCountReleaseStatus Release() const;
+    bool HasOneRef() const { return ref_count_.HasOneRef(); }
+
+    template <typename T = uint8_t>
+    T* data() {
+      return reinterpret_cast<T*>(this + 1);
+    }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    void SetSize(size_t size) {
+      RTC_DCHECK_LE(size, capacity_);
+      size_ = size;
+    }
+    bool pooled() const { return pooled_; }
+
+   private:
+    Storage(size_t size, size_t capacity, int size_class, bool pooled)
+        : capacity_(capacity),
+          size_(size),
+          size_class_(size_class),
+          pooled_(pooled) {}
+    ~Storage() = default;
+
+    mutable webrtc::webrtc_impl::RefCounter ref_count_{0};
+    const size_t capacity_;
+    size_t size_;
+    // Only used if `pooled_`.
+    const int size_class_;
+    const bool pooled_;
+  };
+
   // Create a copy of the underlying data if it is referenced from other Buffer
   // objects or there is not enough capacity.
   void UnshareAndEnsureCapacity(size_t new_capacity);
@@ -291,8 +383,8 @@ class RTC_EXPORT CopyOnWriteBuffer {
     }
   }
 
-  // buffer_ is either null, or points to an rtc::Buffer with capacity > 0.
-  scoped_refptr<RefCountedBuffer> buffer_;
+  // buffer_ is either null, or points to a Storage with capacity > 0.
+  scoped_refptr<Storage> buffer_;
   // This buffer may represent a slice of a original data.
   size_t offset_;  // Offset of a current slice in the original data in buffer_.
                    // Should be 0 if the buffer_ is empty.
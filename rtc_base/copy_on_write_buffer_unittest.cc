@@ -12,6 +12,7 @@
 
 #include <cstdint>
 
+#include "rtc_base/memory/slab_pool.h"
 #include "test/gtest.h"
 
 namespace rtc {
@@ -373,4 +374,85 @@ TEST(CopyOnWriteBufferTest, AcceptsVectorLikeTypes) {
   EXPECT_EQ(all.size(), 8U);
 }
 
+uint64_t PooledAllocations() {
+  uint64_t allocations = 0;
+  for (const SlabPool::SizeClassStats& size_class :
+       SlabPool::Instance()->GetStats().size_classes) {
+    allocations += size_class.hits + size_class.misses;
+  }
+  return allocations;
+}
+
+TEST(CopyOnWriteBufferTest, CreatePooledAllocatesFromSlabPool) {
+  uint64_t allocations = PooledAllocations();
+  CopyOnWriteBuffer buf = CopyOnWriteBuffer::CreatePooled(kTestData, 10, 1500);
+  EXPECT_EQ(allocations + 1, PooledAllocations());
+  EXPECT_EQ(buf.size(), 10u);
+  EXPECT_EQ(buf.capacity(), 1500u);
+  EXPECT_EQ(0, memcmp(buf.cdata(), kTestData, 10));
+}
+
+TEST(CopyOnWriteBufferTest, CreatePooledWithoutCapacityIsEmpty) {
+  CopyOnWriteBuffer buf = CopyOnWriteBuffer::CreatePooled(0, 0);
+  EXPECT_EQ(buf.size(), 0u);
+  EXPECT_EQ(buf.capacity(), 0u);
+  EXPECT_EQ(buf.cdata(), nullptr);
+}
+
+TEST(CopyOnWriteBufferTest, UnsharingPooledBufferKeepsUsingPool) {
+  CopyOnWriteBuffer buf1 = CopyOnWriteBuffer::CreatePooled(kTestData, 10, 10);
+  CopyOnWriteBuffer buf2 = buf1;
+  uint64_t allocations = PooledAllocations();
+  buf2.MutableData()[0] = 0xaa;
+  EXPECT_EQ(allocations + 1, PooledAllocations());
+  EXPECT_EQ(buf1.cdata()[0], kTestData[0]);
+  EXPECT_EQ(buf2.cdata()[0], 0xaa);
+
+  buf2.AppendData(kTestData, 16);
+  EXPECT_EQ(allocations + 2, PooledAllocations());
+  EXPECT_EQ(buf2.size(), 26u);
+  EXPECT_EQ(0, memcmp(buf2.cdata() + 10, kTestData, 16));
+}
+
+TEST(CopyOnWriteBufferTest, PooledBufferLargerThanAnySizeClass) {
+  constexpr size_t kSize = 100'000;
+  CopyOnWriteBuffer buf = CopyOnWriteBuffer::CreatePooled(kSize, kSize);
+  memset(buf.MutableData(), 0x55, kSize);
+  EXPECT_EQ(buf.size(), kSize);
+  EXPECT_EQ(buf[kSize - 1], 0x55);
+}
+
+TEST(CopyOnWriteBufferTest, SetDataGrowsUnsharedBufferWithHeadroom) {
+  CopyOnWriteBuffer buf(kTestData, 10, 10);
+  buf.SetData(kTestData, 12);
+  EXPECT_EQ(buf.size(), 12u);
+  EXPECT_EQ(buf.capacity(), 15u);
+  EXPECT_EQ(0, memcmp(buf.cdata(), kTestData, 12));
+}
+
+TEST(CopyOnWriteBufferTest, CreatePooledReservesHeadroom) {
+  CopyOnWriteBuffer buf =
+      CopyOnWriteBuffer::CreatePooled(kTestData + 4, 8, 12, /*headroom=*/4);
+  EXPECT_EQ(buf.headroom(), 4u);
+  EXPECT_EQ(buf.size(), 8u);
+  EXPECT_EQ(buf.capacity(), 12u);
+  EXPECT_EQ(0, memcmp(buf.cdata(), kTestData + 4, 8));
+
+  // Writing into the headroom does not reallocate the buffer.
+  const uint8_t* data = buf.cdata();
+  memcpy(buf.MutableData() - buf.headroom(), kTestData, 4);
+  EXPECT_EQ(buf.cdata(), data);
+  EXPECT_EQ(0, memcmp(buf.cdata() - 4, kTestData, 12));
+}
+
+TEST(CopyOnWriteBufferTest, SharedBufferHasNoHeadroom) {
+  CopyOnWriteBuffer buf1 =
+      CopyOnWriteBuffer::CreatePooled(kTestData + 4, 4, 4, /*headroom=*/4);
+  CopyOnWriteBuffer buf2 = buf1;
+  EXPECT_EQ(buf1.headroom(), 0u);
+  EXPECT_EQ(buf2.headroom(), 0u);
+  buf2.Clear();
+  EXPECT_EQ(buf1.headroom(), 4u);
+}
+
 }  // namespace rtc
@@ -11,40 +11,237 @@
 #include "rtc_base/crc32.h"
 
 #include "rtc_base/arraysize.h"
+#include "rtc_base/system/arch.h"
+
+// The accelerated implementations use function level target attributes, so
+// that the rest of the file is built for the baseline instruction set, and are
+// only called if the CPU supports them.
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define WEBRTC_CRC32_USE_PCLMUL
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(WEBRTC_ARCH_ARM_FAMILY) && defined(WEBRTC_ARCH_64_BITS) && \
+    (defined(__ARM_FEATURE_CRC32) || defined(__clang__))
+#define WEBRTC_CRC32_USE_ARMV8
+#include <arm_acle.h>
+#if defined(WEBRTC_LINUX) && !defined(__ARM_FEATURE_CRC32)
+#include <sys/auxv.h>
+#endif
+#endif
 
 namespace rtc {
+namespace {
 
-// This implementation is based on the sample implementation in RFC 1952.
+// This implementation is based on the sample implementation in RFC 1952,
+// extended to process eight bytes per step ("slicing-by-8").
 
 // CRC32 polynomial, in reversed form.
 // See RFC 1952, or http://en.wikipedia.org/wiki/Cyclic_redundancy_check
-static const uint32_t kCrc32Polynomial = 0xEDB88320;
-
-static uint32_t* LoadCrc32Table() {
-  static uint32_t kCrc32Table[256];
-  for (uint32_t i = 0; i < arraysize(kCrc32Table); ++i) {
-    uint32_t c = i;
-    for (size_t j = 0; j < 8; ++j) {
-      if (c & 1) {
-        c = kCrc32Polynomial ^ (c >> 1);
-      } else {
-        c >>= 1;
+constexpr uint32_t kCrc32Polynomial = 0xEDB88320;
+
+// `table[0]` is the usual byte-at-a-time table. `table[k]` gives the CRC of a
+// byte followed by `k` zero bytes.
+struct Crc32Tables {
+  uint32_t table[8][256];
+};
+
+const Crc32Tables& LoadCrc32Tables() {
+  static const Crc32Tables* const kTables = [] {
+    Crc32Tables* tables = new Crc32Tables;
+    for (uint32_t i = 0; i < arraysize(tables->table[0]); ++i) {
+      uint32_t c = i;
+      for (size_t j = 0; j < 8; ++j) {
+        if (c & 1) {
+          c = kCrc32Polynomial ^ (c >> 1);
+        } else {
+          c >>= 1;
+        }
       }
+      tables->table[0][i] = c;
     }
-    kCrc32Table[i] = c;
+    for (uint32_t i = 0; i < arraysize(tables->table[0]); ++i) {
+      for (size_t k = 1; k < arraysize(tables->table); ++k) {
+        uint32_t c = tables->table[k - 1][i];
+        tables->table[k][i] = tables->table[0][c & 0xFF] ^ (c >> 8);
+      }
+    }
+    return tables;
+  }();
+  return *kTables;
+}
+
+uint32_t LoadLE32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// The functions below take and return the CRC register, i.e. the checksum
+// with all bits inverted.
+uint32_t UpdateCrc32Register(uint32_t c, const uint8_t* u, size_t len) {
+  const Crc32Tables& tables = LoadCrc32Tables();
+  const auto& t = tables.table;
+  for (; len >= 8; len -= 8, u += 8) {
+    uint32_t lo = c ^ LoadLE32(u);
+    uint32_t hi = LoadLE32(u + 4);
+    c = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+        t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+        t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
   }
-  return kCrc32Table;
+  for (; len > 0; --len, ++u) {
+    c = t[0][(c ^ *u) & 0xFF] ^ (c >> 8);
+  }
+  return c;
 }
 
-uint32_t UpdateCrc32(uint32_t start, const void* buf, size_t len) {
-  static uint32_t* kCrc32Table = LoadCrc32Table();
+#if defined(WEBRTC_CRC32_USE_PCLMUL)
 
-  uint32_t c = start ^ 0xFFFFFFFF;
-  const uint8_t* u = static_cast<const uint8_t*>(buf);
-  for (size_t i = 0; i < len; ++i) {
-    c = kCrc32Table[(c ^ u[i]) & 0xFF] ^ (c >> 8);
+bool CanUsePclmul() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
   }
-  return c ^ 0xFFFFFFFF;
+  return (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSE4_1) != 0;
+}
+
+// Folds `x` over 128 bits, and adds `next`.
+__attribute__((target("pclmul,sse4.1"))) inline __m128i
+Fold128(__m128i x, __m128i k, __m128i next) {
+  __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+  __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+// Folds 16 byte blocks with carry-less multiplication, following "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel,
+// 2009). The constants are the folding constants for 512 and 128 bit
+// distances and the Barrett reduction constants, for the bit reflected
+// polynomial. `len` must be a multiple of 16, and at least 64.
+__attribute__((target("pclmul,sse4.1"))) uint32_t
+FoldCrc32RegisterPclmul(uint32_t c, const uint8_t* buf, size_t len) {
+  const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+  const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+  const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124);
+  const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+  const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+  __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+  __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+  __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 32));
+  __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 48));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(c)));
+  buf += 64;
+  len -= 64;
+
+  // Fold four blocks in parallel.
+  for (; len >= 64; buf += 64, len -= 64) {
+    const __m128i* next = reinterpret_cast<const __m128i*>(buf);
+    x1 = Fold128(x1, k1k2, _mm_loadu_si128(next));
+    x2 = Fold128(x2, k1k2, _mm_loadu_si128(next + 1));
+    x3 = Fold128(x3, k1k2, _mm_loadu_si128(next + 2));
+    x4 = Fold128(x4, k1k2, _mm_loadu_si128(next + 3));
+  }
+
+  // Fold the four blocks, and any remaining 16 byte blocks, into one.
+  x1 = Fold128(x1, k3k4, x2);
+  x1 = Fold128(x1, k3k4, x3);
+  x1 = Fold128(x1, k3k4, x4);
+  for (; len >= 16; buf += 16, len -= 16) {
+    x1 = Fold128(x1, k3k4,
+                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf)));
+  }
+
+  // Fold 128 bits to 64 bits.
+  x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits.
+  x2 = _mm_and_si128(x1, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+  x2 = _mm_and_si128(x2, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t UpdateCrc32RegisterPclmul(uint32_t c, const uint8_t* u, size_t len) {
+  // Below this size, the setup and reduction cost more than they save.
+  constexpr size_t kMinFoldLength = 64;
+  if (len >= kMinFoldLength) {
+    const size_t fold_len = len & ~static_cast<size_t>(15);
+    c = FoldCrc32RegisterPclmul(c, u, fold_len);
+    u += fold_len;
+    len -= fold_len;
+  }
+  return UpdateCrc32Register(c, u, len);
+}
+
+#endif  // defined(WEBRTC_CRC32_USE_PCLMUL)
+
+#if defined(WEBRTC_CRC32_USE_ARMV8)
+
+bool CanUseArmv8Crc() {
+#if defined(__ARM_FEATURE_CRC32) || defined(WEBRTC_MAC)
+  // Built for a CPU which has the CRC32 instructions; all Apple arm64 CPUs
+  // have them.
+  return true;
+#elif defined(WEBRTC_LINUX)
+  // HWCAP_CRC32 from <asm/hwcap.h>.
+  constexpr unsigned long kHwcapCrc32 = 1 << 7;
+  return (getauxval(AT_HWCAP) & kHwcapCrc32) != 0;
+#else
+  return false;
+#endif
+}
+
+#if defined(__clang__)
+__attribute__((target("crc")))
+#endif
+uint32_t
+UpdateCrc32RegisterArmv8(uint32_t c, const uint8_t* u, size_t len) {
+  for (; len >= 8; len -= 8, u += 8) {
+    uint64_t v = static_cast<uint64_t>(LoadLE32(u)) |
+                 (static_cast<uint64_t>(LoadLE32(u + 4)) << 32);
+    c = __crc32d(c, v);
+  }
+  for (; len > 0; --len, ++u) {
+    c = __crc32b(c, *u);
+  }
+  return c;
+}
+
+#endif  // defined(WEBRTC_CRC32_USE_ARMV8)
+
+using UpdateCrc32RegisterFunction = uint32_t (*)(uint32_t c,
+                                                 const uint8_t* u,
+                                                 size_t len);
+
+UpdateCrc32RegisterFunction SelectUpdateCrc32Register() {
+#if defined(WEBRTC_CRC32_USE_PCLMUL)
+  if (CanUsePclmul()) {
+    return &UpdateCrc32RegisterPclmul;
+  }
+#elif defined(WEBRTC_CRC32_USE_ARMV8)
+  if (CanUseArmv8Crc()) {
+    return &UpdateCrc32RegisterArmv8;
+  }
+#endif
+  return &UpdateCrc32Register;
+}
+
+}  // namespace
+
+uint32_t UpdateCrc32(uint32_t start, const void* buf, size_t len) {
+  static const UpdateCrc32RegisterFunction kUpdateCrc32Register =
+      SelectUpdateCrc32Register();
+  return kUpdateCrc32Register(start ^ 0xFFFFFFFF,
+                              static_cast<const uint8_t*>(buf), len) ^
+         0xFFFFFFFF;
 }
 
 }  // namespace rtc
@@ -0,0 +1,43 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "rtc_base/crc32.h"
+
+namespace rtc {
+namespace {
+
+// Measures the throughput of ComputeCrc32() on `state.range(0)` bytes, from a
+// small STUN message up to a large packet.
+void BM_ComputeCrc32(benchmark::State& state) {
+  std::vector<uint8_t> data(state.range(0));
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i);
+  }
+  for (auto s : state) {
+    benchmark::DoNotOptimize(ComputeCrc32(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_ComputeCrc32)
+    ->Arg(20)
+    ->Arg(64)
+    ->Arg(100)
+    ->Arg(256)
+    ->Arg(1200)
+    ->Arg(8192);
+
+}  // namespace
+}  // namespace rtc
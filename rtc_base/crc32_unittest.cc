@@ -11,6 +11,7 @@
 #include "rtc_base/crc32.h"
 
 #include <string>
+#include <vector>
 
 #include "test/gtest.h"
 
@@ -34,4 +35,29 @@ TEST(Crc32Test, TestMultipleUpdates) {
   EXPECT_EQ(0x171A3F5FU, c);
 }
 
+// Inputs of 64 bytes and more may be processed by a vectorized
+// implementation; check that it agrees with processing a byte at a time, for
+// all lengths and alignments around its block sizes.
+TEST(Crc32Test, TestLongInputsMatchBytewiseUpdates) {
+  std::vector<uint8_t> input(1100);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<uint8_t>(i * 31 + (i >> 8));
+  }
+  uint32_t expected[1025] = {0};
+  for (size_t offset = 0; offset < 16; ++offset) {
+    expected[0] = 0;
+    for (size_t len = 1; len < 1025; ++len) {
+      expected[len] = UpdateCrc32(expected[len - 1], &input[offset + len - 1],
+                                  1);
+    }
+    for (size_t len = 0; len < 1025; ++len) {
+      ASSERT_EQ(expected[len], ComputeCrc32(&input[offset], len))
+          << "offset " << offset << ", length " << len;
+    }
+  }
+  // Updates after a vectorized part.
+  EXPECT_EQ(expected[1024],
+            UpdateCrc32(ComputeCrc32(&input[15], 100), &input[115], 924));
+}
+
 }  // namespace rtc
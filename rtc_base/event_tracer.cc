@@ -15,9 +15,11 @@
 #include <string.h>
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "absl/strings/string_view.h"
 #include "api/sequence_checker.h"
 #include "rtc_base/checks.h"
@@ -83,11 +85,176 @@ namespace {
 // Atomic-int fast path for avoiding logging when disabled.
 static std::atomic<int> g_event_logging_active(0);
 
+struct TraceArg {
+  const char* name;
+  unsigned char type;
+  // Copied from webrtc/rtc_base/trace_event.h TraceValueUnion.
+  union TraceArgValue {
+    bool as_bool;
+    unsigned long long as_uint;
+    long long as_int;
+    double as_double;
+    const void* as_pointer;
+    const char* as_string;
+  } value;
+
+  // Assert that the size of the union is equal to the size of the as_uint
+  // field since we are assigning to arbitrary types using it.
+  static_assert(sizeof(TraceArgValue) == sizeof(unsigned long long),
+                "Size of TraceArg value union is not equal to the size of "
+                "the uint field of that union.");
+};
+
+// Fixed-size trace record, so that events can be stored without allocating.
+struct TraceEvent {
+  // The TRACE_EVENT macros pass at most two arguments.
+  static constexpr int kMaxArgs = 2;
+
+  const char* name;
+  const unsigned char* category_enabled;
+  char phase;
+  int num_args;
+  TraceArg args[kMaxArgs];
+  uint64_t timestamp;
+  int pid;
+  rtc::PlatformThreadId tid;
+};
+
+void FreeCopiedStrings(TraceEvent& event) {
+  for (int i = 0; i < event.num_args; ++i) {
+    TraceArg& arg = event.args[i];
+    if (arg.type == TRACE_VALUE_TYPE_COPY_STRING) {
+      delete[] arg.value.as_string;
+      arg.value.as_string = nullptr;
+    }
+  }
+}
+
+// Single-producer, single-consumer ring of trace events. Events are added
+// only by the thread the ring belongs to, and are taken only by the thread
+// logging them, so neither side needs a lock.
+class TraceEventRing {
+ public:
+  static constexpr uint32_t kCapacity = 4096;
+
+  explicit TraceEventRing(rtc::PlatformThreadId tid) : tid_(tid) {}
+
+  rtc::PlatformThreadId tid() const { return tid_; }
+
+  // Returns false, and counts the event as dropped, if the ring is full.
+  bool Push(const TraceEvent& event) {
+    uint32_t write_index = write_index_.load(std::memory_order_relaxed);
+    if (write_index - read_index_.load(std::memory_order_acquire) ==
+        kCapacity) {
+      dropped_events_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    events_[write_index % kCapacity] = event;
+    write_index_.store(write_index + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves all events added so far to `events`. Returns the number of events
+  // dropped since the last call.
+  uint64_t TakeEvents(std::vector<TraceEvent>& events) {
+    uint32_t read_index = read_index_.load(std::memory_order_relaxed);
+    uint32_t write_index = write_index_.load(std::memory_order_acquire);
+    for (; read_index != write_index; ++read_index) {
+      events.push_back(events_[read_index % kCapacity]);
+    }
+    read_index_.store(read_index, std::memory_order_release);
+    return dropped_events_.exchange(0, std::memory_order_relaxed);
+  }
+
+  // Set when the owning thread exits. The ring is deleted once the events
+  // added before are taken.
+  std::atomic<bool> orphaned{false};
+
+ private:
+  const rtc::PlatformThreadId tid_;
+  std::atomic<uint32_t> write_index_{0};
+  std::atomic<uint32_t> dropped_events_{0};
+  std::atomic<uint32_t> read_index_{0};
+  TraceEvent events_[kCapacity];
+};
+
+// Owns the rings of all threads that have added trace events. Outlives the
+// EventLogger, since threads keep pointers to their rings.
+class TraceEventRings {
+ public:
+  static TraceEventRings* Get() {
+    static TraceEventRings* const rings = new TraceEventRings();
+    return rings;
+  }
+
+  TraceEventRing* Create() {
+    webrtc::MutexLock lock(&mutex_);
+    rings_.push_back(std::make_unique<TraceEventRing>(rtc::CurrentThreadId()));
+    return rings_.back().get();
+  }
+
+  // Takes the events of all rings and deletes the rings of exited threads.
+  // Must only be called by one thread at a time.
+  uint64_t TakeEvents(std::vector<TraceEvent>& events) {
+    uint64_t dropped_events = 0;
+    webrtc::MutexLock lock(&mutex_);
+    for (auto it = rings_.begin(); it != rings_.end();) {
+      // Read before taking the events, so that no events added before the
+      // thread exited are lost.
+      bool orphaned = (*it)->orphaned.load(std::memory_order_acquire);
+      dropped_events += (*it)->TakeEvents(events);
+      if (orphaned) {
+        it = rings_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return dropped_events;
+  }
+
+ private:
+  webrtc::Mutex mutex_;
+  std::vector<std::unique_ptr<TraceEventRing>> rings_ RTC_GUARDED_BY(mutex_);
+};
+
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+
+// The ring of the thread, and whether the thread has exited. Trivially
+// destructible, so that they can still be used by the destructors of other
+// thread locals.
+ABSL_CONST_INIT thread_local TraceEventRing* thread_ring = nullptr;
+ABSL_CONST_INIT thread_local bool thread_ring_destroyed = false;
+
+// Orphans the ring of the thread when the thread exits.
+class ThreadTraceEventRingOwner {
+ public:
+  ~ThreadTraceEventRingOwner() {
+    thread_ring->orphaned.store(true, std::memory_order_release);
+    // The orphaned ring may be deleted as soon as it is emptied, so events
+    // added by destructors of other thread locals after this one are dropped.
+    thread_ring = nullptr;
+    thread_ring_destroyed = true;
+  }
+};
+
+// Returns the ring of the thread, or null once the thread is exiting.
+TraceEventRing* GetThreadTraceEventRing() {
+  if (!thread_ring && !thread_ring_destroyed) {
+    thread_ring = TraceEventRings::Get()->Create();
+    thread_local ThreadTraceEventRingOwner owner;
+  }
+  return thread_ring;
+}
+
+#endif  // ABSL_HAVE_THREAD_LOCAL
+
 // TODO(pbos): Log metadata for all threads, etc.
 class EventLogger final {
  public:
   ~EventLogger() { RTC_DCHECK(thread_checker_.IsCurrent()); }
 
+  // Called on any thread. Does not lock or allocate, unless an argument is a
+  // string that has to be copied.
   void AddTraceEvent(const char* name,
                      const unsigned char* category_enabled,
                      char phase,
@@ -96,11 +263,17 @@ class EventLogger final {
                      const unsigned char* arg_types,
                      const unsigned long long* arg_values,
                      uint64_t timestamp,
-                     int pid,
-                     rtc::PlatformThreadId thread_id) {
-    std::vector<TraceArg> args(num_args);
+                     int pid) {
+    RTC_DCHECK_LE(num_args, TraceEvent::kMaxArgs);
+    TraceEvent event;
+    event.name = name;
+    event.category_enabled = category_enabled;
+    event.phase = phase;
+    event.num_args = num_args;
+    event.timestamp = timestamp;
+    event.pid = pid;
     for (int i = 0; i < num_args; ++i) {
-      TraceArg& arg = args[i];
+      TraceArg& arg = event.args[i];
       arg.name = arg_names[i];
       arg.type = arg_types[i];
       arg.value.as_uint = arg_values[i];
@@ -114,9 +287,28 @@ class EventLogger final {
         arg.value.as_string = str_copy;
       }
     }
-    webrtc::MutexLock lock(&mutex_);
-    trace_events_.push_back(
-        {name, category_enabled, phase, args, timestamp, 1, thread_id});
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+    TraceEventRing* ring = GetThreadTraceEventRing();
+    bool added = false;
+    if (ring) {
+      event.tid = ring->tid();
+      added = ring->Push(event);
+    }
+#else
+    event.tid = rtc::CurrentThreadId();
+    bool added;
+    {
+      // Without thread locals, all threads share one ring.
+      webrtc::MutexLock lock(&shared_ring_mutex_);
+      if (!shared_ring_) {
+        shared_ring_ = TraceEventRings::Get()->Create();
+      }
+      added = shared_ring_->Push(event);
+    }
+#endif
+    if (!added) {
+      FreeCopiedStrings(event);
+    }
   }
 
   // The TraceEvent format is documented here:
@@ -127,36 +319,28 @@ class EventLogger final {
         webrtc::TimeDelta::Millis(100);
     fprintf(output_file_, "{ \"traceEvents\": [\n");
     bool has_logged_event = false;
+    uint64_t dropped_events = 0;
+    std::vector<TraceEvent> events;
     while (true) {
       bool shutting_down = shutdown_event_.Wait(kLoggingInterval);
-      std::vector<TraceEvent> events;
-      {
-        webrtc::MutexLock lock(&mutex_);
-        trace_events_.swap(events);
-      }
+      events.clear();
+      dropped_events += TraceEventRings::Get()->TakeEvents(events);
       std::string args_str;
       args_str.reserve(kEventLoggerArgsStrBufferInitialSize);
       for (TraceEvent& e : events) {
         args_str.clear();
-        if (!e.args.empty()) {
+        if (e.num_args > 0) {
           args_str += ", \"args\": {";
-          bool is_first_argument = true;
-          for (TraceArg& arg : e.args) {
-            if (!is_first_argument)
+          for (int i = 0; i < e.num_args; ++i) {
+            if (i > 0)
               args_str += ",";
-            is_first_argument = false;
             args_str += " \"";
-            args_str += arg.name;
+            args_str += e.args[i].name;
             args_str += "\": ";
-            args_str += TraceArgValueAsString(arg);
-
-            // Delete our copy of the string.
-            if (arg.type == TRACE_VALUE_TYPE_COPY_STRING) {
-              delete[] arg.value.as_string;
-              arg.value.as_string = nullptr;
-            }
+            args_str += TraceArgValueAsString(e.args[i]);
           }
           args_str += " }";
+          FreeCopiedStrings(e);
         }
         fprintf(output_file_,
                 "%s{ \"name\": \"%s\""
@@ -182,6 +366,11 @@ class EventLogger final {
     if (output_file_owned_)
       fclose(output_file_);
     output_file_ = nullptr;
+    if (dropped_events > 0) {
+      RTC_LOG(LS_WARNING) << "Dropped " << dropped_events
+                          << " trace events because a thread's trace buffer "
+                             "was full.";
+    }
   }
 
   void Start(FILE* file, bool owned) {
@@ -190,13 +379,14 @@ class EventLogger final {
     RTC_DCHECK(!output_file_);
     output_file_ = file;
     output_file_owned_ = owned;
-    {
-      webrtc::MutexLock lock(&mutex_);
-      // Since the atomic fast-path for adding events to the queue can be
-      // bypassed while the logging thread is shutting down there may be some
-      // stale events in the queue, hence the vector needs to be cleared to not
-      // log events from a previous logging session (which may be days old).
-      trace_events_.clear();
+    // Since the atomic fast-path for adding events can be bypassed while the
+    // logging thread is shutting down there may be some stale events in the
+    // rings, hence they need to be cleared to not log events from a previous
+    // logging session (which may be days old).
+    std::vector<TraceEvent> stale_events;
+    TraceEventRings::Get()->TakeEvents(stale_events);
+    for (TraceEvent& e : stale_events) {
+      FreeCopiedStrings(e);
     }
     // Enable event logging (fast-path). This should be disabled since starting
     // shouldn't be done twice.
@@ -224,36 +414,6 @@ class EventLogger final {
   }
 
  private:
-  struct TraceArg {
-    const char* name;
-    unsigned char type;
-    // Copied from webrtc/rtc_base/trace_event.h TraceValueUnion.
-    union TraceArgValue {
-      bool as_bool;
-      unsigned long long as_uint;
-      long long as_int;
-      double as_double;
-      const void* as_pointer;
-      const char* as_string;
-    } value;
-
-    // Assert that the size of the union is equal to the size of the as_uint
-    // field since we are assigning to arbitrary types using it.
-    static_assert(sizeof(TraceArgValue) == sizeof(unsigned long long),
-                  "Size of TraceArg value union is not equal to the size of "
-                  "the uint field of that union.");
-  };
-
-  struct TraceEvent {
-    const char* name;
-    const unsigned char* category_enabled;
-    char phase;
-    std::vector<TraceArg> args;
-    uint64_t timestamp;
-    int pid;
-    rtc::PlatformThreadId tid;
-  };
-
   static std::string TraceArgValueAsString(TraceArg arg) {
     std::string output;
 
@@ -314,8 +474,10 @@ class EventLogger final {
     return output;
   }
 
-  webrtc::Mutex mutex_;
-  std::vector<TraceEvent> trace_events_ RTC_GUARDED_BY(mutex_);
+#if !defined(ABSL_HAVE_THREAD_LOCAL)
+  webrtc::Mutex shared_ring_mutex_;
+  TraceEventRing* shared_ring_ RTC_GUARDED_BY(shared_ring_mutex_) = nullptr;
+#endif
   rtc::PlatformThread logging_thread_;
   rtc::Event shutdown_event_;
   webrtc::SequenceChecker thread_checker_;
@@ -356,7 +518,7 @@ void InternalAddTraceEvent(char phase,
 
   g_event_logger.load()->AddTraceEvent(
       name, category_enabled, phase, num_args, arg_names, arg_types, arg_values,
-      rtc::TimeMicros(), 1, rtc::CurrentThreadId());
+      rtc::TimeMicros(), 1);
 }
 
 }  // namespace
@@ -10,6 +10,13 @@
 
 #include "rtc_base/event_tracer.h"
 
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/base/config.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/thread_annotations.h"
 #include "rtc_base/trace_event.h"
@@ -76,6 +83,94 @@ TEST(EventTracerTest, ScopedTraceEvent) {
   EXPECT_EQ(2, TestStatistics::Get()->Count());
   TestStatistics::Get()->Reset();
 }
+
+int CountOccurrences(const std::string& str, const std::string& pattern) {
+  int count = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+// Reads and closes `file`.
+std::string ReadTrace(FILE* file) {
+  std::string trace;
+  rewind(file);
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    trace.append(buffer, read);
+  }
+  fclose(file);
+  return trace;
+}
+
+TEST(EventTracerTest, InternalTracerLogsEventsOfAllThreads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kEventsPerThread = 100;
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file);
+  rtc::tracing::SetupInternalTracer();
+  rtc::tracing::StartInternalCaptureToFile(file);
+
+  std::vector<rtc::PlatformThread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(rtc::PlatformThread::SpawnJoinable(
+        [] {
+          for (int j = 0; j < kEventsPerThread; ++j) {
+            TRACE_EVENT1("test", "ThreadEvent", "copied",
+                         TRACE_STR_COPY(std::to_string(j).c_str()));
+          }
+        },
+        "TraceThread"));
+  }
+  // The rings of exited threads are still logged.
+  threads.clear();
+  TRACE_EVENT_INSTANT0("test", "MainThreadEvent");
+
+  rtc::tracing::StopInternalCapture();
+  rtc::tracing::ShutdownInternalTracer();
+
+  std::string trace = ReadTrace(file);
+  EXPECT_EQ(0u, trace.find("{ \"traceEvents\": ["));
+  EXPECT_EQ(kNumThreads * kEventsPerThread * 2,
+            CountOccurrences(trace, "\"name\": \"ThreadEvent\""));
+  EXPECT_EQ(kNumThreads, CountOccurrences(trace, "\"copied\": \"99\""));
+  EXPECT_EQ(1, CountOccurrences(trace, "\"name\": \"MainThreadEvent\""));
+}
+
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+// Adds a trace event when destroyed.
+class TraceOnDestruction {
+ public:
+  ~TraceOnDestruction() { TRACE_EVENT_INSTANT0("test", "LateEvent"); }
+  void Touch() {}
+};
+
+TEST(EventTracerTest, InternalTracerDropsEventsAfterThreadRingIsDestroyed) {
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file);
+  rtc::tracing::SetupInternalTracer();
+  rtc::tracing::StartInternalCaptureToFile(file);
+
+  rtc::PlatformThread::SpawnJoinable(
+      [] {
+        // Constructed before the ring of the thread, so destroyed after it.
+        thread_local TraceOnDestruction trace_on_destruction;
+        trace_on_destruction.Touch();
+        TRACE_EVENT_INSTANT0("test", "ThreadEvent");
+      },
+      "TraceThread");
+
+  rtc::tracing::StopInternalCapture();
+  rtc::tracing::ShutdownInternalTracer();
+
+  std::string trace = ReadTrace(file);
+  EXPECT_EQ(1, CountOccurrences(trace, "\"name\": \"ThreadEvent\""));
+  EXPECT_EQ(0, CountOccurrences(trace, "\"name\": \"LateEvent\""));
+}
+#endif
 #endif
 
 }  // namespace webrtc
@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/ifaddrs_cache.h"
+
+#include <errno.h>
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
+
+namespace rtc {
+
+namespace {
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+// Returns a non-blocking netlink socket which receives the changes of the
+// links, addresses and routes, or -1.
+int OpenNetlinkSocket() {
+  int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                  NETLINK_ROUTE);
+  if (fd < 0) {
+    RTC_LOG_ERR(LS_WARNING) << "Failed to open a netlink socket";
+    return -1;
+  }
+  struct sockaddr_nl address = {};
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR |
+                      RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) < 0) {
+    RTC_LOG_ERR(LS_WARNING) << "Failed to bind the netlink socket";
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+#endif
+
+}  // namespace
+
+IfAddrsCache* IfAddrsCache::Get() {
+  static IfAddrsCache* const cache =
+      new IfAddrsCache(/*listen_for_changes=*/true);
+  return cache;
+}
+
+IfAddrsCache::IfAddrsCache(bool listen_for_changes) {
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (listen_for_changes) {
+    netlink_fd_ = OpenNetlinkSocket();
+  }
+#endif
+}
+
+IfAddrsCache::~IfAddrsCache() {
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (netlink_fd_ >= 0) {
+    close(netlink_fd_);
+  }
+#endif
+}
+
+bool IfAddrsCache::GetInterfaces(std::shared_ptr<const ifaddrs>* interfaces) {
+  webrtc::MutexLock lock(&mutex_);
+  const int64_t now_ms = TimeMillis();
+  const webrtc::TimeDelta max_age =
+      listens_for_changes() ? kNotifiedMaxAge : kUnnotifiedMaxAge;
+  // Read the notifications before enumerating, so that a change made while
+  // enumerating is not lost.
+  if (ReadChangeNotifications() ||
+      now_ms - enumeration_time_ms_ >= max_age.ms()) {
+    stale_ = true;
+  }
+  if (stale_) {
+    struct ifaddrs* native_interfaces;
+    int error = getifaddrs(&native_interfaces);
+    if (error != 0) {
+      RTC_LOG_ERR(LS_ERROR) << "getifaddrs failed to gather interface data: "
+                            << error;
+      return false;
+    }
+    interfaces_ = std::shared_ptr<const ifaddrs>(
+        native_interfaces, [](const ifaddrs* interfaces) {
+          freeifaddrs(const_cast<ifaddrs*>(interfaces));
+        });
+    enumeration_time_ms_ = now_ms;
+    stale_ = false;
+  }
+  *interfaces = interfaces_;
+  return true;
+}
+
+void IfAddrsCache::Invalidate() {
+  webrtc::MutexLock lock(&mutex_);
+  stale_ = true;
+}
+
+bool IfAddrsCache::ReadChangeNotifications() {
+  bool changed = false;
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (netlink_fd_ < 0) {
+    return false;
+  }
+  // The content does not matter, as any change leads to enumerating all the
+  // interfaces again.
+  char buffer[4096];
+  while (true) {
+    ssize_t size = recv(netlink_fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (size > 0) {
+      changed = true;
+    } else if (size < 0 && errno == ENOBUFS) {
+      // Notifications were dropped because the socket buffer was full.
+      changed = true;
+    } else if (size < 0 && errno == EINTR) {
+      continue;
+    } else {
+      break;
+    }
+  }
+#endif
+  return changed;
+}
+
+}  // namespace rtc
@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_IFADDRS_CACHE_H_
+#define RTC_BASE_IFADDRS_CACHE_H_
+
+#if defined(WEBRTC_ANDROID)
+#include "rtc_base/ifaddrs_android.h"
+#else
+#include <ifaddrs.h>
+#endif  // WEBRTC_ANDROID
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "api/units/time_delta.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// Caches the result of getifaddrs(), so that the network managers of a
+// process share one enumeration of the interfaces instead of each doing its
+// own, every time it starts or polls. On Linux the snapshot is kept until the
+// kernel reports a change of the links, addresses or routes over netlink.
+// Elsewhere, or if netlink is not available, it expires after a short time.
+// Thread safe.
+class RTC_EXPORT IfAddrsCache {
+ public:
+  // How long a snapshot is used when the changes are not notified. Shorter
+  // than the polling interval of BasicNetworkManager, so that every poll
+  // still sees the current interfaces.
+  static constexpr webrtc::TimeDelta kUnnotifiedMaxAge =
+      webrtc::TimeDelta::Seconds(1);
+  // How long a snapshot is used at most when the changes are notified, in
+  // case a notification is missed.
+  static constexpr webrtc::TimeDelta kNotifiedMaxAge =
+      webrtc::TimeDelta::Seconds(30);
+
+  // Returns the cache shared by the process.
+  static IfAddrsCache* Get();
+
+  // `listen_for_changes` subscribes to the change notifications, where the
+  // platform has them.
+  explicit IfAddrsCache(bool listen_for_changes);
+  ~IfAddrsCache();
+
+  IfAddrsCache(const IfAddrsCache&) = delete;
+  IfAddrsCache& operator=(const IfAddrsCache&) = delete;
+
+  // Sets `interfaces` to the current snapshot, enumerating the interfaces
+  // again if they may have changed since. Returns false if getifaddrs()
+  // fails. A snapshot stays valid for as long as it is referenced, and a new
+  // one is only made when the interfaces may have changed, so callers which
+  // keep the previous one can compare the pointers to skip the work when
+  // nothing changed.
+  bool GetInterfaces(std::shared_ptr<const ifaddrs>* interfaces);
+
+  // Makes the next GetInterfaces() enumerate the interfaces again, for when
+  // a change was observed by other means.
+  void Invalidate();
+
+  // Whether the changes are notified, so that the snapshot is kept for
+  // longer.
+  bool listens_for_changes() const { return netlink_fd_ >= 0; }
+
+ private:
+  // Reads the pending change notifications, and returns whether there were
+  // any.
+  bool ReadChangeNotifications() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // The netlink socket which receives the change notifications, or -1.
+  int netlink_fd_ = -1;
+  webrtc::Mutex mutex_;
+  std::shared_ptr<const ifaddrs> interfaces_ RTC_GUARDED_BY(mutex_);
+  bool stale_ RTC_GUARDED_BY(mutex_) = true;
+  int64_t enumeration_time_ms_ RTC_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_IFADDRS_CACHE_H_
@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/ifaddrs_cache.h"
+
+#include <memory>
+
+#include "api/units/time_delta.h"
+#include "rtc_base/fake_clock.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+using ::webrtc::TimeDelta;
+
+class IfAddrsCacheTest : public ::testing::Test {
+ public:
+  IfAddrsCacheTest() { clock_.AdvanceTime(TimeDelta::Seconds(1)); }
+
+ protected:
+  ScopedFakeClock clock_;
+};
+
+TEST_F(IfAddrsCacheTest, KeepsSnapshotUntilInvalidated) {
+  IfAddrsCache cache(/*listen_for_changes=*/false);
+  std::shared_ptr<const ifaddrs> first;
+  std::shared_ptr<const ifaddrs> second;
+  ASSERT_TRUE(cache.GetInterfaces(&first));
+  ASSERT_TRUE(cache.GetInterfaces(&second));
+  EXPECT_EQ(first, second);
+
+  cache.Invalidate();
+  ASSERT_TRUE(cache.GetInterfaces(&second));
+  EXPECT_NE(first, second);
+}
+
+TEST_F(IfAddrsCacheTest, ExpiresSnapshotWithoutNotifications) {
+  IfAddrsCache cache(/*listen_for_changes=*/false);
+  EXPECT_FALSE(cache.listens_for_changes());
+  std::shared_ptr<const ifaddrs> first;
+  std::shared_ptr<const ifaddrs> second;
+  ASSERT_TRUE(cache.GetInterfaces(&first));
+
+  clock_.AdvanceTime(IfAddrsCache::kUnnotifiedMaxAge - TimeDelta::Millis(1));
+  ASSERT_TRUE(cache.GetInterfaces(&second));
+  EXPECT_EQ(first, second);
+
+  clock_.AdvanceTime(TimeDelta::Millis(1));
+  ASSERT_TRUE(cache.GetInterfaces(&second));
+  EXPECT_NE(first, second);
+}
+
+TEST_F(IfAddrsCacheTest, KeepsSnapshotLongerWithNotifications) {
+  IfAddrsCache cache(/*listen_for_changes=*/true);
+  if (!cache.listens_for_changes()) {
+    GTEST_SKIP() << "Interface changes are not notified.";
+  }
+  std::shared_ptr<const ifaddrs> first;
+  std::shared_ptr<const ifaddrs> second;
+  ASSERT_TRUE(cache.GetInterfaces(&first));
+
+  clock_.AdvanceTime(IfAddrsCache::kUnnotifiedMaxAge);
+  ASSERT_TRUE(cache.GetInterfaces(&second));
+  EXPECT_EQ(first, second);
+
+  clock_.AdvanceTime(IfAddrsCache::kNotifiedMaxAge);
+  ASSERT_TRUE(cache.GetInterfaces(&second));
+  EXPECT_NE(first, second);
+}
+
+}  // namespace
+}  // namespace rtc
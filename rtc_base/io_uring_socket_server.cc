@@ -0,0 +1,1016 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/io_uring_socket_server.h"
+
+#include "rtc_base/physical_socket_server.h"
+
+#if defined(WEBRTC_USE_IO_URING)
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "api/array_view.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/deprecated/recursive_critical_section.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+#endif  // WEBRTC_USE_IO_URING
+
+namespace rtc {
+
+#if defined(WEBRTC_USE_IO_URING)
+
+namespace {
+
+constexpr unsigned kSubmissionQueueEntries = 256;
+constexpr unsigned kCompletionQueueEntries = 4 * kSubmissionQueueEntries;
+
+// Receive buffers shared by all UDP sockets of a server. Each holds the
+// io_uring_recvmsg_out header, the source address and the control message
+// area ahead of room for the configured maximum UDP payload.
+constexpr uint16_t kNumReceiveBuffers = 256;  // Must be a power of two.
+constexpr uint16_t kReceiveBufferGroup = 0;
+constexpr socklen_t kReceiveNameSize = sizeof(sockaddr_storage);
+constexpr size_t kReceiveControlSize = CMSG_SPACE(sizeof(timespec));
+constexpr size_t kReceiveHeadersSize =
+    sizeof(io_uring_recvmsg_out) + kReceiveNameSize + kReceiveControlSize;
+constexpr size_t kMaxUdpPayloadSize = 64 * 1024;
+
+// Rounded up so that the control areas of all buffers stay aligned.
+size_t ReceiveBufferSize(size_t max_udp_payload_size) {
+  const size_t size = kReceiveHeadersSize +
+                      std::min(max_udp_payload_size, kMaxUdpPayloadSize);
+  return (size + alignof(cmsghdr) - 1) / alignof(cmsghdr) * alignof(cmsghdr);
+}
+
+// The low byte of a request's user_data says what kind of request it is, the
+// next one is a generation counter for poll requests, and the rest is the key
+// of the dispatcher it belongs to.
+enum RequestType : uint8_t {
+  kWakeUpRequest = 1,
+  kPollRequest,
+  kReceiveRequest,
+  kCancelRequest,
+};
+
+uint64_t MakeUserData(uint64_t key, uint8_t generation, RequestType type) {
+  return (key << 16) | (static_cast<uint64_t>(generation) << 8) | type;
+}
+
+template <typename T>
+T LoadAcquire(const T* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+void StoreRelease(T* p, T value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+class IoUringSocketServer;
+
+// A UDP socket whose datagrams are received by a multishot recvmsg request
+// owned by the server, which queues them here until they are read.
+class IoUringUdpSocket : public SocketDispatcher {
+ public:
+  explicit IoUringUdpSocket(IoUringSocketServer* ss);
+  ~IoUringUdpSocket() override;
+
+  int Recv(void* buffer, size_t length, int64_t* timestamp) override;
+  int RecvFrom(void* buffer,
+               size_t length,
+               SocketAddress* out_addr,
+               int64_t* timestamp) override;
+  int RecvFromBatch(rtc::ArrayView<ReceiveBuffer> buffers) override;
+
+  // Called by the server. Returns true if the queue was empty before.
+  bool EnqueueDatagram(uint16_t buffer_id, uint32_t size);
+  // Hands all queued buffers back to the server.
+  void ReleaseDatagrams();
+  bool has_queued_datagrams() const { return !queue_.empty(); }
+
+ private:
+  struct Datagram {
+    uint16_t buffer_id;
+    // Number of bytes written to the buffer, headers included.
+    uint32_t size;
+  };
+
+  // Copies the oldest queued datagram into `buffer`. Returns false if there is
+  // none.
+  bool PopDatagram(ReceiveBuffer& buffer);
+
+  IoUringSocketServer* const server_;
+  std::deque<Datagram> queue_;
+};
+
+class IoUringSocketServer : public PhysicalSocketServer {
+ public:
+  // Returns nullptr if io_uring can't be used.
+  static std::unique_ptr<IoUringSocketServer> Create(
+      size_t max_udp_payload_size);
+  ~IoUringSocketServer() override;
+
+  // SocketFactory:
+  Socket* CreateSocket(int family, int type) override;
+
+  // SocketServer:
+  bool Wait(webrtc::TimeDelta max_wait_duration, bool process_io) override;
+  void WakeUp() override;
+
+  // PhysicalSocketServer:
+  void Add(Dispatcher* dispatcher) override;
+  void Remove(Dispatcher* dispatcher) override;
+  void Update(Dispatcher* dispatcher) override;
+
+  // For IoUringUdpSocket.
+  void RegisterUdpSocket(IoUringUdpSocket* socket);
+  void UnregisterUdpSocket(IoUringUdpSocket* socket);
+  // Whether `socket`'s datagrams are currently received through the ring, in
+  // which case it must not be read from directly.
+  bool IsReceiving(IoUringUdpSocket* socket);
+  // Moves finished requests from the completion queue into per-socket state,
+  // without delivering any events.
+  void ReapCompletions();
+  const char* receive_buffer(uint16_t buffer_id) const {
+    return &receive_buffers_[buffer_id * receive_buffer_size_];
+  }
+  void RecycleReceiveBuffer(uint16_t buffer_id);
+
+ private:
+  struct DispatcherState {
+    Dispatcher* dispatcher = nullptr;
+    // Set for UDP sockets that receive through a multishot request.
+    IoUringUdpSocket* udp_socket = nullptr;
+    // POLL* mask of the poll request in flight, 0 if there is none.
+    uint32_t armed_poll_events = 0;
+    uint8_t poll_generation = 0;
+    bool receiving = false;
+    msghdr receive_header = {};
+  };
+
+  struct ReadyEvent {
+    uint64_t key;
+    uint32_t poll_events;
+  };
+
+  explicit IoUringSocketServer(size_t max_udp_payload_size)
+      : receive_buffer_size_(ReceiveBufferSize(max_udp_payload_size)) {}
+  bool Initialize();
+
+  io_uring_sqe* GetSqe() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Publishes the entries returned by GetSqe() and returns how many of them
+  // the kernel hasn't consumed yet.
+  unsigned FlushSubmissions() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Calls io_uring_enter(). Waits for at least one completion for up to
+  // `wait_ms` milliseconds unless that is 0.
+  int Enter(unsigned to_submit, int wait_ms);
+
+  // Brings the requests in flight in line with the events requested by the
+  // dispatchers in `pending_updates_`.
+  void ArmPendingRequests() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void ArmWakeUp() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void Cancel(uint64_t user_data) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void HandleCompletion(const io_uring_cqe& cqe)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void PublishReceiveBuffers() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  void DispatchReadyEvents();
+  void DispatchReceivedDatagrams();
+  bool HasDeliverableDatagrams() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  bool WaitForWakeUp(int cms_wait);
+  void DrainWakeUp();
+
+  int ring_fd_ = -1;
+  void* ring_memory_ = MAP_FAILED;
+  size_t ring_memory_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned sq_local_tail_ RTC_GUARDED_BY(crit_) = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+  unsigned cq_mask_ = 0;
+
+  // The buffer ring is addressed as a plain array of io_uring_buf: in C++ the
+  // flexible array in io_uring_buf_ring is preceded by an empty struct of size
+  // one, which moves it past the tail the kernel expects to overlap bufs[0].
+  io_uring_buf* buffer_ring_ = nullptr;
+  uint16_t buffer_ring_tail_ RTC_GUARDED_BY(crit_) = 0;
+  const size_t receive_buffer_size_;
+  std::unique_ptr<char[]> receive_buffers_;
+  int free_receive_buffers_ RTC_GUARDED_BY(crit_) = 0;
+  bool multishot_receive_supported_ RTC_GUARDED_BY(crit_) = true;
+
+  int wakeup_fd_ = -1;
+  bool wakeup_armed_ RTC_GUARDED_BY(crit_) = false;
+  bool woken_ RTC_GUARDED_BY(crit_) = false;
+
+  RecursiveCriticalSection crit_;
+  uint64_t next_key_ RTC_GUARDED_BY(crit_) = 1;
+  std::unordered_map<uint64_t, DispatcherState> states_ RTC_GUARDED_BY(crit_);
+  std::unordered_map<Dispatcher*, uint64_t> key_by_dispatcher_
+      RTC_GUARDED_BY(crit_);
+  std::unordered_map<Dispatcher*, IoUringUdpSocket*> udp_sockets_
+      RTC_GUARDED_BY(crit_);
+  // Dispatchers whose requests in flight may need to change.
+  std::vector<uint64_t> pending_updates_ RTC_GUARDED_BY(crit_);
+  // UDP sockets that ran out of receive buffers.
+  std::vector<uint64_t> starved_sockets_ RTC_GUARDED_BY(crit_);
+  std::vector<ReadyEvent> ready_events_ RTC_GUARDED_BY(crit_);
+  // UDP sockets with queued datagrams.
+  std::vector<uint64_t> readable_sockets_ RTC_GUARDED_BY(crit_);
+  // True while the thread in Wait() is blocked in the kernel, so that requests
+  // for new events have to be submitted right away.
+  bool blocked_in_kernel_ RTC_GUARDED_BY(crit_) = false;
+  bool waiting_ = false;
+};
+
+IoUringUdpSocket::IoUringUdpSocket(IoUringSocketServer* ss)
+    : SocketDispatcher(ss), server_(ss) {
+  server_->RegisterUdpSocket(this);
+}
+
+IoUringUdpSocket::~IoUringUdpSocket() {
+  // Close here, since the server must not see a half destroyed socket.
+  Close();
+  server_->UnregisterUdpSocket(this);
+}
+
+int IoUringUdpSocket::Recv(void* buffer, size_t length, int64_t* timestamp) {
+  return RecvFrom(buffer, length, nullptr, timestamp);
+}
+
+int IoUringUdpSocket::RecvFrom(void* buffer,
+                               size_t length,
+                               SocketAddress* out_addr,
+                               int64_t* timestamp) {
+  if (queue_.empty() && !server_->IsReceiving(this)) {
+    return SocketDispatcher::RecvFrom(buffer, length, out_addr, timestamp);
+  }
+  ReceiveBuffer receive_buffer;
+  receive_buffer.data = static_cast<char*>(buffer);
+  receive_buffer.capacity = length;
+  EnableEvents(DE_READ);
+  if (!PopDatagram(receive_buffer)) {
+    SetError(EWOULDBLOCK);
+    return SOCKET_ERROR;
+  }
+  if (out_addr) {
+    *out_addr = receive_buffer.source_address;
+  }
+  if (timestamp) {
+    *timestamp = receive_buffer.timestamp;
+  }
+  return static_cast<int>(receive_buffer.length);
+}
+
+int IoUringUdpSocket::RecvFromBatch(rtc::ArrayView<ReceiveBuffer> buffers) {
+  if (queue_.empty() && !server_->IsReceiving(this)) {
+    return SocketDispatcher::RecvFromBatch(buffers);
+  }
+  EnableEvents(DE_READ);
+  size_t received = 0;
+  while (received < buffers.size() && PopDatagram(buffers[received])) {
+    ++received;
+  }
+  if (received == 0) {
+    SetError(EWOULDBLOCK);
+    return SOCKET_ERROR;
+  }
+  return static_cast<int>(received);
+}
+
+bool IoUringUdpSocket::EnqueueDatagram(uint16_t buffer_id, uint32_t size) {
+  queue_.push_back({buffer_id, size});
+  return queue_.size() == 1;
+}
+
+void IoUringUdpSocket::ReleaseDatagrams() {
+  for (const Datagram& datagram : queue_) {
+    server_->RecycleReceiveBuffer(datagram.buffer_id);
+  }
+  queue_.clear();
+}
+
+bool IoUringUdpSocket::PopDatagram(ReceiveBuffer& buffer) {
+  if (queue_.empty()) {
+    server_->ReapCompletions();
+    if (queue_.empty()) {
+      return false;
+    }
+  }
+  const Datagram datagram = queue_.front();
+  queue_.pop_front();
+
+  // Layout: io_uring_recvmsg_out, name area, control area, payload.
+  const char* data = server_->receive_buffer(datagram.buffer_id);
+  io_uring_recvmsg_out header;
+  memcpy(&header, data, sizeof(header));
+  const char* name = data + sizeof(header);
+  char* control = const_cast<char*>(name + kReceiveNameSize);
+  const char* payload = control + kReceiveControlSize;
+  const size_t payload_in_buffer =
+      datagram.size - static_cast<size_t>(payload - data);
+
+  buffer.length = std::min(payload_in_buffer, buffer.capacity);
+  memcpy(buffer.data, payload, buffer.length);
+  buffer.truncated =
+      (header.flags & MSG_TRUNC) != 0 || buffer.length < header.payloadlen;
+
+  sockaddr_storage addr_storage = {};
+  memcpy(&addr_storage, name,
+         std::min<size_t>(header.namelen, sizeof(addr_storage)));
+  buffer.source_address.Clear();
+  SocketAddressFromSockAddrStorage(addr_storage, &buffer.source_address);
+
+  buffer.timestamp = -1;
+  msghdr control_header = {};
+  control_header.msg_control = control;
+  control_header.msg_controllen =
+      std::min<size_t>(header.controllen, kReceiveControlSize);
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&control_header); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&control_header, cmsg)) {
+    // PhysicalSocket::Create() enables SO_TIMESTAMPNS on UDP sockets.
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      timespec ts;
+      memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+      buffer.timestamp = kNumMicrosecsPerSec * static_cast<int64_t>(ts.tv_sec) +
+                         static_cast<int64_t>(ts.tv_nsec) /
+                             kNumNanosecsPerMicrosec;
+    }
+  }
+
+  server_->RecycleReceiveBuffer(datagram.buffer_id);
+  return true;
+}
+
+std::unique_ptr<IoUringSocketServer> IoUringSocketServer::Create(
+    size_t max_udp_payload_size) {
+  std::unique_ptr<IoUringSocketServer> server(
+      new IoUringSocketServer(max_udp_payload_size));
+  if (!server->Initialize()) {
+    return nullptr;
+  }
+  return server;
+}
+
+bool IoUringSocketServer::Initialize() {
+  io_uring_params params = {};
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = kCompletionQueueEntries;
+  ring_fd_ = syscall(__NR_io_uring_setup, kSubmissionQueueEntries, &params);
+  if (ring_fd_ < 0) {
+    RTC_LOG_E(LS_WARNING, EN, errno) << "io_uring_setup";
+    return false;
+  }
+  constexpr uint32_t kRequiredFeatures =
+      IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((params.features & kRequiredFeatures) != kRequiredFeatures) {
+    RTC_LOG(LS_WARNING) << "io_uring lacks required features: "
+                        << params.features;
+    return false;
+  }
+
+  ring_memory_size_ =
+      std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+               params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  ring_memory_ = mmap(nullptr, ring_memory_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (ring_memory_ == MAP_FAILED) {
+    RTC_LOG_E(LS_WARNING, EN, errno) << "mmap io_uring rings";
+    return false;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    RTC_LOG_E(LS_WARNING, EN, errno) << "mmap io_uring submission entries";
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+  char* ring = static_cast<char*>(ring_memory_);
+  sq_head_ = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+  sq_array_ = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+  sq_mask_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  cq_head_ = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+  cq_mask_ = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+
+  // Register the buffer ring the multishot receive requests pick from.
+  void* buffer_ring =
+      mmap(nullptr, kNumReceiveBuffers * sizeof(io_uring_buf),
+           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer_ring == MAP_FAILED) {
+    RTC_LOG_E(LS_WARNING, EN, errno) << "mmap io_uring buffer ring";
+    return false;
+  }
+  buffer_ring_ = static_cast<io_uring_buf*>(buffer_ring);
+  io_uring_buf_reg registration = {};
+  registration.ring_addr = reinterpret_cast<uintptr_t>(buffer_ring_);
+  registration.ring_entries = kNumReceiveBuffers;
+  registration.bgid = kReceiveBufferGroup;
+  if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING,
+              &registration, 1) != 0) {
+    RTC_LOG_E(LS_WARNING, EN, errno) << "IORING_REGISTER_PBUF_RING";
+    return false;
+  }
+  receive_buffers_.reset(new char[kNumReceiveBuffers * receive_buffer_size_]);
+
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeup_fd_ < 0) {
+    RTC_LOG_E(LS_WARNING, EN, errno) << "eventfd";
+    return false;
+  }
+
+  CritScope cs(&crit_);
+  for (uint16_t i = 0; i < kNumReceiveBuffers; ++i) {
+    RecycleReceiveBuffer(i);
+  }
+  ArmWakeUp();
+  return Enter(FlushSubmissions(), /*wait_ms=*/0) >= 0;
+}
+
+IoUringSocketServer::~IoUringSocketServer() {
+  RTC_DCHECK(states_.empty());
+  if (wakeup_fd_ >= 0) {
+    close(wakeup_fd_);
+  }
+  // Closing the ring cancels whatever is still in flight, which must happen
+  // before the memory it refers to is released.
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+  if (buffer_ring_) {
+    munmap(buffer_ring_, kNumReceiveBuffers * sizeof(io_uring_buf));
+  }
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (ring_memory_ != MAP_FAILED) {
+    munmap(ring_memory_, ring_memory_size_);
+  }
+}
+
+Socket* IoUringSocketServer::CreateSocket(int family, int type) {
+  if (type != SOCK_DGRAM) {
+    return PhysicalSocketServer::CreateSocket(family, type);
+  }
+  IoUringUdpSocket* socket = new IoUringUdpSocket(this);
+  if (!socket->Create(family, type)) {
+    delete socket;
+    return nullptr;
+  }
+  return socket;
+}
+
+bool IoUringSocketServer::Wait(webrtc::TimeDelta max_wait_duration,
+                               bool process_io) {
+  // We don't support reentrant waiting.
+  RTC_DCHECK(!waiting_);
+  waiting_ = true;
+  const int cms_wait = ToCmsWait(max_wait_duration);
+  if (!process_io) {
+    bool result = WaitForWakeUp(cms_wait);
+    waiting_ = false;
+    return result;
+  }
+
+  const int64_t stop_ms = cms_wait == kForeverMs ? 0 : TimeAfter(cms_wait);
+  bool result = true;
+  while (true) {
+    unsigned to_submit;
+    int wait_ms;
+    {
+      CritScope cs(&crit_);
+      ArmPendingRequests();
+      to_submit = FlushSubmissions();
+      if (woken_ || !ready_events_.empty() || HasDeliverableDatagrams()) {
+        wait_ms = 0;
+      } else if (cms_wait == kForeverMs) {
+        wait_ms = kForeverMs;
+      } else {
+        wait_ms = std::max<int64_t>(0, TimeDiff(stop_ms, TimeMillis()));
+      }
+      blocked_in_kernel_ = wait_ms != 0;
+    }
+    int ret = Enter(to_submit, wait_ms);
+    {
+      CritScope cs(&crit_);
+      blocked_in_kernel_ = false;
+    }
+    if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) {
+      RTC_LOG_E(LS_ERROR, EN, errno) << "io_uring_enter";
+      result = false;
+      break;
+    }
+
+    ReapCompletions();
+    DispatchReadyEvents();
+    DispatchReceivedDatagrams();
+
+    {
+      CritScope cs(&crit_);
+      if (woken_) {
+        woken_ = false;
+        break;
+      }
+    }
+    if (cms_wait != kForeverMs && TimeDiff(stop_ms, TimeMillis()) <= 0) {
+      break;
+    }
+  }
+  waiting_ = false;
+  return result;
+}
+
+void IoUringSocketServer::WakeUp() {
+  const uint64_t value = 1;
+  const ssize_t res = write(wakeup_fd_, &value, sizeof(value));
+  RTC_DCHECK_EQ(res, static_cast<ssize_t>(sizeof(value)));
+}
+
+void IoUringSocketServer::Add(Dispatcher* dispatcher) {
+  CritScope cs(&crit_);
+  if (key_by_dispatcher_.count(dispatcher)) {
+    RTC_LOG(LS_WARNING)
+        << "IoUringSocketServer asked to add a duplicate dispatcher.";
+    return;
+  }
+  const uint64_t key = next_key_++;
+  DispatcherState& state = states_[key];
+  state.dispatcher = dispatcher;
+  auto udp_socket = udp_sockets_.find(dispatcher);
+  if (udp_socket != udp_sockets_.end()) {
+    state.udp_socket = udp_socket->second;
+  }
+  key_by_dispatcher_.emplace(dispatcher, key);
+  Update(dispatcher);
+}
+
+void IoUringSocketServer::Remove(Dispatcher* dispatcher) {
+  CritScope cs(&crit_);
+  auto it = key_by_dispatcher_.find(dispatcher);
+  if (it == key_by_dispatcher_.end()) {
+    RTC_LOG(LS_WARNING)
+        << "IoUringSocketServer asked to remove a unknown "
+           "dispatcher, potentially from a duplicate call to Add.";
+    return;
+  }
+  const uint64_t key = it->second;
+  key_by_dispatcher_.erase(it);
+  DispatcherState& state = states_[key];
+  if (state.armed_poll_events != 0) {
+    Cancel(MakeUserData(key, state.poll_generation, kPollRequest));
+  }
+  if (state.receiving) {
+    Cancel(MakeUserData(key, 0, kReceiveRequest));
+  }
+  if (state.udp_socket) {
+    state.udp_socket->ReleaseDatagrams();
+  }
+  states_.erase(key);
+  // The requests hold a reference to the socket, so cancel them before the
+  // descriptor is closed and possibly bound again.
+  Enter(FlushSubmissions(), /*wait_ms=*/0);
+}
+
+void IoUringSocketServer::Update(Dispatcher* dispatcher) {
+  CritScope cs(&crit_);
+  auto it = key_by_dispatcher_.find(dispatcher);
+  // Don't update dispatchers that haven't yet been added.
+  if (it == key_by_dispatcher_.end()) {
+    return;
+  }
+  pending_updates_.push_back(it->second);
+  if (blocked_in_kernel_) {
+    // Called from another thread while Wait() is blocked; the new requests
+    // can't wait for it to return.
+    ArmPendingRequests();
+    Enter(FlushSubmissions(), /*wait_ms=*/0);
+  }
+}
+
+void IoUringSocketServer::RegisterUdpSocket(IoUringUdpSocket* socket) {
+  CritScope cs(&crit_);
+  udp_sockets_.emplace(socket, socket);
+}
+
+void IoUringSocketServer::UnregisterUdpSocket(IoUringUdpSocket* socket) {
+  CritScope cs(&crit_);
+  udp_sockets_.erase(socket);
+}
+
+bool IoUringSocketServer::IsReceiving(IoUringUdpSocket* socket) {
+  CritScope cs(&crit_);
+  auto it = key_by_dispatcher_.find(socket);
+  return it != key_by_dispatcher_.end() && states_[it->second].receiving;
+}
+
+void IoUringSocketServer::ReapCompletions() {
+  CritScope cs(&crit_);
+  unsigned head = *cq_head_;
+  const unsigned tail = LoadAcquire(cq_tail_);
+  for (; head != tail; ++head) {
+    HandleCompletion(cqes_[head & cq_mask_]);
+  }
+  StoreRelease(cq_head_, head);
+  if (free_receive_buffers_ > 0 && !starved_sockets_.empty()) {
+    pending_updates_.insert(pending_updates_.end(), starved_sockets_.begin(),
+                            starved_sockets_.end());
+    starved_sockets_.clear();
+  }
+}
+
+void IoUringSocketServer::RecycleReceiveBuffer(uint16_t buffer_id) {
+  CritScope cs(&crit_);
+  io_uring_buf& buf =
+      buffer_ring_[buffer_ring_tail_ & (kNumReceiveBuffers - 1)];
+  buf.addr = reinterpret_cast<uintptr_t>(receive_buffer(buffer_id));
+  buf.len = receive_buffer_size_;
+  buf.bid = buffer_id;
+  ++buffer_ring_tail_;
+  ++free_receive_buffers_;
+  PublishReceiveBuffers();
+}
+
+io_uring_sqe* IoUringSocketServer::GetSqe() {
+  if (sq_local_tail_ - LoadAcquire(sq_head_) >= sq_entries_) {
+    // Full; hand what we have to the kernel to make room.
+    Enter(FlushSubmissions(), /*wait_ms=*/0);
+    if (sq_local_tail_ - LoadAcquire(sq_head_) >= sq_entries_) {
+      RTC_LOG(LS_ERROR) << "io_uring submission queue overflow";
+      return nullptr;
+    }
+  }
+  const unsigned index = sq_local_tail_ & sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  ++sq_local_tail_;
+  return sqe;
+}
+
+unsigned IoUringSocketServer::FlushSubmissions() {
+  StoreRelease(sq_tail_, sq_local_tail_);
+  return sq_local_tail_ - LoadAcquire(sq_head_);
+}
+
+int IoUringSocketServer::Enter(unsigned to_submit, int wait_ms) {
+  unsigned min_complete = 0;
+  unsigned flags = 0;
+  __kernel_timespec timeout = {};
+  io_uring_getevents_arg arg = {};
+  if (wait_ms != 0) {
+    min_complete = 1;
+    flags |= IORING_ENTER_GETEVENTS;
+    if (wait_ms != kForeverMs) {
+      timeout.tv_sec = wait_ms / 1000;
+      timeout.tv_nsec = (wait_ms % 1000) * kNumNanosecsPerMillisec;
+      arg.ts = reinterpret_cast<uintptr_t>(&timeout);
+      flags |= IORING_ENTER_EXT_ARG;
+    }
+  } else if (to_submit == 0) {
+    // Nothing to submit or wait for, but entering the kernel still runs the
+    // work that posts pending completions.
+    flags |= IORING_ENTER_GETEVENTS;
+  }
+  int ret;
+  do {
+    ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags,
+                  (flags & IORING_ENTER_EXT_ARG) ? &arg : nullptr,
+                  sizeof(arg));
+  } while (ret < 0 && errno == EINTR && wait_ms == 0);
+  return ret;
+}
+
+void IoUringSocketServer::ArmPendingRequests() {
+  if (!wakeup_armed_) {
+    ArmWakeUp();
+  }
+  std::vector<uint64_t> updates;
+  updates.swap(pending_updates_);
+  for (uint64_t key : updates) {
+    auto it = states_.find(key);
+    if (it == states_.end()) {
+      continue;
+    }
+    DispatcherState& state = it->second;
+    const int fd = state.dispatcher->GetDescriptor();
+    if (fd == INVALID_SOCKET) {
+      continue;
+    }
+    const uint32_t requested = state.dispatcher->GetRequestedEvents();
+    const bool use_receive = state.udp_socket && multishot_receive_supported_;
+
+    if (use_receive && (requested & DE_READ) && !state.receiving &&
+        free_receive_buffers_ > 0) {
+      io_uring_sqe* sqe = GetSqe();
+      if (sqe) {
+        state.receive_header = {};
+        state.receive_header.msg_namelen = kReceiveNameSize;
+        state.receive_header.msg_controllen = kReceiveControlSize;
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(&state.receive_header);
+        sqe->len = 1;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kReceiveBufferGroup;
+        sqe->user_data = MakeUserData(key, 0, kReceiveRequest);
+        state.receiving = true;
+      }
+    }
+
+    uint32_t poll_events = 0;
+    if ((requested & (DE_READ | DE_ACCEPT)) && !use_receive) {
+      poll_events |= POLLIN;
+    }
+    if (requested & (DE_WRITE | DE_CONNECT)) {
+      poll_events |= POLLOUT;
+    }
+    if ((poll_events & ~state.armed_poll_events) == 0) {
+      // Anything no longer requested is filtered out when the poll completes.
+      continue;
+    }
+    if (state.armed_poll_events != 0) {
+      Cancel(MakeUserData(key, state.poll_generation, kPollRequest));
+    }
+    io_uring_sqe* sqe = GetSqe();
+    if (!sqe) {
+      state.armed_poll_events = 0;
+      continue;
+    }
+    ++state.poll_generation;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = poll_events;
+    sqe->user_data = MakeUserData(key, state.poll_generation, kPollRequest);
+    state.armed_poll_events = poll_events;
+  }
+}
+
+void IoUringSocketServer::ArmWakeUp() {
+  io_uring_sqe* sqe = GetSqe();
+  if (!sqe) {
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = wakeup_fd_;
+  sqe->poll32_events = POLLIN;
+  sqe->user_data = MakeUserData(0, 0, kWakeUpRequest);
+  wakeup_armed_ = true;
+}
+
+void IoUringSocketServer::Cancel(uint64_t user_data) {
+  io_uring_sqe* sqe = GetSqe();
+  if (!sqe) {
+    return;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = user_data;
+  sqe->user_data = MakeUserData(0, 0, kCancelRequest);
+}
+
+void IoUringSocketServer::HandleCompletion(const io_uring_cqe& cqe) {
+  const RequestType type = static_cast<RequestType>(cqe.user_data & 0xff);
+  const uint8_t generation = (cqe.user_data >> 8) & 0xff;
+  const uint64_t key = cqe.user_data >> 16;
+  auto it = states_.find(key);
+  DispatcherState* state = it != states_.end() ? &it->second : nullptr;
+
+  switch (type) {
+    case kWakeUpRequest:
+      wakeup_armed_ = false;
+      woken_ = true;
+      DrainWakeUp();
+      break;
+    case kPollRequest:
+      // Completions of cancelled or superseded polls carry an old generation.
+      if (!state || generation != state->poll_generation) {
+        break;
+      }
+      state->armed_poll_events = 0;
+      pending_updates_.push_back(key);
+      if (cqe.res > 0) {
+        ready_events_.push_back({key, static_cast<uint32_t>(cqe.res)});
+      } else if (cqe.res < 0 && cqe.res != -ECANCELED) {
+        RTC_LOG(LS_WARNING) << "io_uring poll failed: " << -cqe.res;
+      }
+      break;
+    case kReceiveRequest: {
+      if (cqe.flags & IORING_CQE_F_BUFFER) {
+        --free_receive_buffers_;
+        const uint16_t buffer_id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        if (state && state->udp_socket && cqe.res >= 0) {
+          if (state->udp_socket->EnqueueDatagram(buffer_id, cqe.res)) {
+            readable_sockets_.push_back(key);
+          }
+        } else {
+          RecycleReceiveBuffer(buffer_id);
+        }
+      }
+      if ((cqe.flags & IORING_CQE_F_MORE) || !state) {
+        break;
+      }
+      // The multishot request has ended; arm a new one if possible.
+      state->receiving = false;
+      if (cqe.res == -ENOBUFS) {
+        starved_sockets_.push_back(key);
+      } else if (cqe.res == -EINVAL) {
+        RTC_LOG(LS_WARNING) << "Multishot recvmsg isn't supported, falling "
+                               "back to polling UDP sockets.";
+        multishot_receive_supported_ = false;
+        pending_updates_.push_back(key);
+      } else {
+        if (cqe.res < 0 && cqe.res != -ECANCELED) {
+          RTC_LOG(LS_VERBOSE) << "io_uring recvmsg ended: " << -cqe.res;
+        }
+        pending_updates_.push_back(key);
+      }
+      break;
+    }
+    case kCancelRequest:
+      break;
+  }
+}
+
+void IoUringSocketServer::PublishReceiveBuffers() {
+  // The tail shares its location with the reserved field of the first entry.
+  StoreRelease(&buffer_ring_[0].resv, buffer_ring_tail_);
+}
+
+void IoUringSocketServer::DispatchReadyEvents() {
+  CritScope cs(&crit_);
+  std::vector<ReadyEvent> events;
+  events.swap(ready_events_);
+  for (const ReadyEvent& event : events) {
+    auto it = states_.find(event.key);
+    if (it == states_.end()) {
+      // The dispatcher has been removed by an earlier event handler.
+      continue;
+    }
+    Dispatcher* dispatcher = it->second.dispatcher;
+    const uint32_t requested = dispatcher->GetRequestedEvents();
+    bool readable = (event.poll_events & (POLLIN | POLLPRI)) &&
+                    (requested & (DE_READ | DE_ACCEPT));
+    bool writable =
+        (event.poll_events & POLLOUT) && (requested & (DE_WRITE | DE_CONNECT));
+    bool error = (event.poll_events & (POLLRDHUP | POLLERR | POLLHUP));
+    ProcessEvents(dispatcher, readable, writable, error, error);
+  }
+}
+
+void IoUringSocketServer::DispatchReceivedDatagrams() {
+  CritScope cs(&crit_);
+  std::vector<uint64_t> keys;
+  keys.swap(readable_sockets_);
+  // Deliver one read event per socket and round, so that a busy socket
+  // doesn't starve the others.
+  for (uint64_t key : keys) {
+    auto it = states_.find(key);
+    if (it == states_.end() || !it->second.udp_socket->has_queued_datagrams()) {
+      continue;
+    }
+    if (it->second.dispatcher->GetRequestedEvents() & DE_READ) {
+      it->second.dispatcher->OnEvent(DE_READ, 0);
+      // The handler may have closed or destroyed the socket.
+      it = states_.find(key);
+      if (it == states_.end() ||
+          !it->second.udp_socket->has_queued_datagrams()) {
+        continue;
+      }
+    }
+    readable_sockets_.push_back(key);
+  }
+}
+
+bool IoUringSocketServer::HasDeliverableDatagrams() {
+  for (uint64_t key : readable_sockets_) {
+    auto it = states_.find(key);
+    if (it != states_.end() &&
+        (it->second.dispatcher->GetRequestedEvents() & DE_READ)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IoUringSocketServer::WaitForWakeUp(int cms_wait) {
+  // Waits through the ring, whose wake-up request is what consumes the
+  // eventfd, so that a wake-up is never seen twice. Other completions are
+  // only collected, to be dispatched by the next Wait() that processes I/O.
+  const int64_t stop_ms = cms_wait == kForeverMs ? 0 : TimeAfter(cms_wait);
+  while (true) {
+    unsigned to_submit;
+    int wait_ms;
+    {
+      CritScope cs(&crit_);
+      if (woken_) {
+        woken_ = false;
+        return true;
+      }
+      if (!wakeup_armed_) {
+        ArmWakeUp();
+      }
+      to_submit = FlushSubmissions();
+      if (cms_wait == kForeverMs) {
+        wait_ms = kForeverMs;
+      } else {
+        wait_ms = std::max<int64_t>(0, TimeDiff(stop_ms, TimeMillis()));
+      }
+      blocked_in_kernel_ = wait_ms != 0;
+    }
+    int ret = Enter(to_submit, wait_ms);
+    {
+      CritScope cs(&crit_);
+      blocked_in_kernel_ = false;
+    }
+    if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) {
+      RTC_LOG_E(LS_ERROR, EN, errno) << "io_uring_enter";
+      return false;
+    }
+    ReapCompletions();
+    {
+      CritScope cs(&crit_);
+      if (woken_) {
+        woken_ = false;
+        return true;
+      }
+    }
+    if (cms_wait != kForeverMs && TimeDiff(stop_ms, TimeMillis()) <= 0) {
+      return true;
+    }
+  }
+}
+
+void IoUringSocketServer::DrainWakeUp() {
+  uint64_t value;
+  while (read(wakeup_fd_, &value, sizeof(value)) > 0) {
+  }
+}
+
+}  // namespace
+
+bool IsIoUringSocketServerSupported() {
+  static const bool supported =
+      IoUringSocketServer::Create(kIoUringDefaultMaxUdpPayloadSize) != nullptr;
+  return supported;
+}
+
+std::unique_ptr<SocketServer> CreateIoUringSocketServer(
+    size_t max_udp_payload_size) {
+  std::unique_ptr<SocketServer> server =
+      IoUringSocketServer::Create(max_udp_payload_size);
+  if (!server) {
+    RTC_LOG(LS_INFO) << "io_uring unavailable, using PhysicalSocketServer.";
+    server = std::make_unique<PhysicalSocketServer>();
+  }
+  return server;
+}
+
+#else  // WEBRTC_USE_IO_URING
+
+bool IsIoUringSocketServerSupported() {
+  return false;
+}
+
+std::unique_ptr<SocketServer> CreateIoUringSocketServer(
+    size_t max_udp_payload_size) {
+  return std::make_unique<PhysicalSocketServer>();
+}
+
+#endif  // WEBRTC_USE_IO_URING
+
+}  // namespace rtc
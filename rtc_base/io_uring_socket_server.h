@@ -0,0 +1,60 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_IO_URING_SOCKET_SERVER_H_
+#define RTC_BASE_IO_URING_SOCKET_SERVER_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "rtc_base/socket_server.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace rtc {
+
+// Returns true if this build includes the io_uring socket server and the
+// running kernel supports everything it needs (multishot receive with a
+// registered buffer ring, Linux 6.0 or later).
+RTC_EXPORT bool IsIoUringSocketServerSupported();
+
+// Default payload capacity of the buffers UDP datagrams are received into:
+// room for a full Ethernet MTU sized datagram, like
+// AsyncUDPSocket::kDefaultBatchPacketSize.
+constexpr size_t kIoUringDefaultMaxUdpPayloadSize = 2048;
+
+// Creates a socket server driven by io_uring instead of epoll. Readiness of
+// TCP sockets is polled through the ring, and UDP sockets receive with a
+// single multishot recvmsg request per socket into a buffer ring registered
+// with the kernel, so that a burst of datagrams costs no system calls beyond
+// the one that waits for it. The returned server works with the regular
+// AsyncUDPSocket/AsyncTCPSocket classes. Falls back to a
+// PhysicalSocketServer if io_uring isn't supported.
+//
+// The server keeps 256 receive buffers of `max_udp_payload_size` bytes plus
+// headers, about 570 KB with the default. Datagrams larger than that are
+// truncated, which RecvFromBatch() reports through
+// ReceiveBuffer::truncated; pass 64 * 1024 to receive any UDP datagram whole.
+//
+// Builds with rtc_enable_io_uring = true use it for the network thread that
+// PeerConnectionFactory creates when none is injected. To use it for another
+// thread, create that thread with it:
+//   auto network_thread =
+//       std::make_unique<rtc::Thread>(rtc::CreateIoUringSocketServer());
+//
+// Sockets may be created and destroyed on any thread, but UDP sockets must
+// only be read from on the thread that runs Wait(), since that is where their
+// queued datagrams are collected.
+RTC_EXPORT std::unique_ptr<SocketServer> CreateIoUringSocketServer(
+    size_t max_udp_payload_size = kIoUringDefaultMaxUdpPayloadSize);
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_IO_URING_SOCKET_SERVER_H_
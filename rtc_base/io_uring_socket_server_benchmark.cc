@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+
+#include "api/units/time_delta.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/io_uring_socket_server.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/socket_server.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kPacketsPerIteration = 64;
+constexpr size_t kPacketSize = 1200;
+
+// Creates a PhysicalSocketServer (arg 0) or an io_uring based server (arg 1).
+std::unique_ptr<SocketServer> CreateServer(benchmark::State& state) {
+  if (state.range(0) == 0) {
+    return std::make_unique<PhysicalSocketServer>();
+  }
+  if (!IsIoUringSocketServerSupported()) {
+    state.SkipWithError("io_uring is not supported.");
+    return nullptr;
+  }
+  return CreateIoUringSocketServer();
+}
+
+class PacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++received;
+    if (server_to_wake_up) {
+      server_to_wake_up->WakeUp();
+    }
+  }
+
+  int received = 0;
+  // Set to make a blocking Wait() return as soon as a packet arrives.
+  SocketServer* server_to_wake_up = nullptr;
+};
+
+// Echoes every datagram back to its sender.
+class Echoer : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    socket->SendTo(data, size, remote_addr, PacketOptions());
+  }
+};
+
+// Measures the cost of receiving and dispatching a burst of datagrams.
+void BM_SocketServerReceiveBurst(benchmark::State& state) {
+  std::unique_ptr<SocketServer> ss = CreateServer(state);
+  if (!ss) {
+    return;
+  }
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(ss.get(), SocketAddress("127.0.0.1", 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(ss.get(), SocketAddress("127.0.0.1", 0)));
+  if (!receiver || !sender) {
+    state.SkipWithError("Failed to bind loopback sockets.");
+    return;
+  }
+  PacketCounter counter;
+  receiver->SignalReadPacket.connect(&counter, &PacketCounter::OnReadPacket);
+  const SocketAddress destination = receiver->GetLocalAddress();
+  char payload[kPacketSize] = {};
+  // Lets the server start receiving on both sockets.
+  ss->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+
+  for (auto s : state) {
+    state.PauseTiming();
+    counter.received = 0;
+    for (int i = 0; i < kPacketsPerIteration; ++i) {
+      sender->SendTo(payload, sizeof(payload), destination, PacketOptions());
+    }
+    state.ResumeTiming();
+    while (counter.received < kPacketsPerIteration) {
+      ss->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerIteration);
+}
+
+BENCHMARK(BM_SocketServerReceiveBurst)->Arg(0)->Arg(1);
+
+// Measures the round trip time of a datagram echoed back and forth between two
+// sockets served by the same thread, which is dominated by the cost of waiting
+// for and dispatching a single event.
+void BM_SocketServerPingPong(benchmark::State& state) {
+  std::unique_ptr<SocketServer> ss = CreateServer(state);
+  if (!ss) {
+    return;
+  }
+  std::unique_ptr<AsyncUDPSocket> client(
+      AsyncUDPSocket::Create(ss.get(), SocketAddress("127.0.0.1", 0)));
+  std::unique_ptr<AsyncUDPSocket> echo(
+      AsyncUDPSocket::Create(ss.get(), SocketAddress("127.0.0.1", 0)));
+  if (!client || !echo) {
+    state.SkipWithError("Failed to bind loopback sockets.");
+    return;
+  }
+  PacketCounter counter;
+  counter.server_to_wake_up = ss.get();
+  client->SignalReadPacket.connect(&counter, &PacketCounter::OnReadPacket);
+  Echoer echoer;
+  echo->SignalReadPacket.connect(&echoer, &Echoer::OnReadPacket);
+  const SocketAddress destination = echo->GetLocalAddress();
+  char payload[kPacketSize] = {};
+  ss->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+
+  for (auto s : state) {
+    counter.received = 0;
+    client->SendTo(payload, sizeof(payload), destination, PacketOptions());
+    while (counter.received == 0) {
+      ss->Wait(webrtc::TimeDelta::Millis(100), /*process_io=*/true);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SocketServerPingPong)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace rtc
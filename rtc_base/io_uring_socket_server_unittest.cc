@@ -0,0 +1,264 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/io_uring_socket_server.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/socket_unittest.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+class IoUringSocketTest : public SocketTest {
+ protected:
+  IoUringSocketTest() : IoUringSocketTest(CreateIoUringSocketServer()) {}
+  explicit IoUringSocketTest(std::unique_ptr<SocketServer> server)
+      : SocketTest(server.get()),
+        server_(std::move(server)),
+        thread_(server_.get()) {}
+
+  void SetUp() override {
+    if (!IsIoUringSocketServerSupported()) {
+      GTEST_SKIP() << "io_uring is not supported.";
+    }
+  }
+
+  std::unique_ptr<SocketServer> server_;
+  AutoSocketServerThread thread_;
+};
+
+class IoUringLargeDatagramSocketTest : public IoUringSocketTest {
+ protected:
+  IoUringLargeDatagramSocketTest()
+      : IoUringSocketTest(CreateIoUringSocketServer(64 * 1024)) {}
+};
+
+class PacketCollector : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    packets.emplace_back(data, size);
+  }
+
+  std::vector<std::string> packets;
+};
+
+TEST_F(IoUringSocketTest, TestConnectIPv4) {
+  SocketTest::TestConnectIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestConnectIPv6) {
+  SocketTest::TestConnectIPv6();
+}
+
+TEST_F(IoUringSocketTest, TestConnectFailIPv4) {
+  SocketTest::TestConnectFailIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestServerCloseDuringConnectIPv4) {
+  SocketTest::TestServerCloseDuringConnectIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestClientCloseDuringConnectIPv4) {
+  SocketTest::TestClientCloseDuringConnectIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestServerCloseIPv4) {
+  SocketTest::TestServerCloseIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestCloseInClosedCallbackIPv4) {
+  SocketTest::TestCloseInClosedCallbackIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestDeleteInReadCallbackIPv4) {
+  SocketTest::TestDeleteInReadCallbackIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestSocketServerWaitIPv4) {
+  SocketTest::TestSocketServerWaitIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestTcpIPv4) {
+  SocketTest::TestTcpIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestTcpIPv6) {
+  SocketTest::TestTcpIPv6();
+}
+
+TEST_F(IoUringSocketTest, TestSingleFlowControlCallbackIPv4) {
+  SocketTest::TestSingleFlowControlCallbackIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestUdpIPv4) {
+  SocketTest::TestUdpIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestUdpIPv6) {
+  SocketTest::TestUdpIPv6();
+}
+
+TEST_F(IoUringSocketTest, TestUdpReadyToSendIPv4) {
+  SocketTest::TestUdpReadyToSendIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestGetSetOptionsIPv4) {
+  SocketTest::TestGetSetOptionsIPv4();
+}
+
+TEST_F(IoUringSocketTest, TestSocketRecvTimestampIPv4) {
+  SocketTest::TestSocketRecvTimestampIPv4();
+}
+
+TEST_F(IoUringSocketTest, AsyncUdpSocketReceivesBurstInOrder) {
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(server_.get(), SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  ASSERT_TRUE(sender);
+  PacketCollector collector;
+  receiver->SignalReadPacket.connect(&collector,
+                                     &PacketCollector::OnReadPacket);
+  // Let the server start receiving on the sockets before the burst.
+  server_->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+
+  constexpr int kNumPackets = 100;
+  for (int i = 0; i < kNumPackets; ++i) {
+    std::string payload = std::to_string(i);
+    sender->SendTo(payload.data(), payload.size(), receiver->GetLocalAddress(),
+                   PacketOptions());
+  }
+  EXPECT_EQ_WAIT(kNumPackets, static_cast<int>(collector.packets.size()),
+                 kTimeout);
+  for (int i = 0; i < static_cast<int>(collector.packets.size()); ++i) {
+    EXPECT_EQ(std::to_string(i), collector.packets[i]);
+  }
+}
+
+TEST_F(IoUringSocketTest, RecvFromBatchReturnsQueuedDatagrams) {
+  std::unique_ptr<Socket> receiver(
+      server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  server_->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+
+  const std::string kPayloads[] = {"a", "bb", "ccc"};
+  for (const std::string& payload : kPayloads) {
+    ASSERT_EQ(static_cast<int>(payload.size()),
+              sender->SendTo(payload.data(), payload.size(),
+                             receiver->GetLocalAddress()));
+  }
+
+  char storage[4][16];
+  Socket::ReceiveBuffer buffers[4];
+  for (size_t i = 0; i < 4; ++i) {
+    buffers[i].data = storage[i];
+    buffers[i].capacity = sizeof(storage[i]);
+  }
+  ASSERT_EQ(3, receiver->RecvFromBatch(buffers));
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(kPayloads[i], std::string(buffers[i].data, buffers[i].length));
+    EXPECT_EQ(sender->GetLocalAddress(), buffers[i].source_address);
+    EXPECT_FALSE(buffers[i].truncated);
+    EXPECT_GT(buffers[i].timestamp, 0);
+  }
+  EXPECT_EQ(-1, receiver->RecvFromBatch(buffers));
+  EXPECT_TRUE(receiver->IsBlocking());
+}
+
+TEST_F(IoUringSocketTest, RecvFromBatchReportsTruncatedDatagram) {
+  std::unique_ptr<Socket> receiver(
+      server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  server_->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+
+  const std::string payload(kIoUringDefaultMaxUdpPayloadSize + 1000, 'x');
+  ASSERT_EQ(static_cast<int>(payload.size()),
+            sender->SendTo(payload.data(), payload.size(),
+                           receiver->GetLocalAddress()));
+
+  std::vector<char> storage(64 * 1024);
+  Socket::ReceiveBuffer buffers[1];
+  buffers[0].data = storage.data();
+  buffers[0].capacity = storage.size();
+  int received;
+  EXPECT_TRUE_WAIT((received = receiver->RecvFromBatch(buffers)) >= 0,
+                   kTimeout);
+  ASSERT_EQ(1, received);
+  EXPECT_TRUE(buffers[0].truncated);
+  EXPECT_EQ(kIoUringDefaultMaxUdpPayloadSize, buffers[0].length);
+}
+
+TEST_F(IoUringLargeDatagramSocketTest, RecvFromReturnsLargeDatagram) {
+  std::unique_ptr<Socket> receiver(
+      server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  server_->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+
+  std::string payload(60000, 0);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>(i);
+  }
+  ASSERT_EQ(static_cast<int>(payload.size()),
+            sender->SendTo(payload.data(), payload.size(),
+                           receiver->GetLocalAddress()));
+
+  std::vector<char> buffer(64 * 1024);
+  int received;
+  EXPECT_TRUE_WAIT((received = receiver->RecvFrom(buffer.data(), buffer.size(),
+                                                  nullptr, nullptr)) >= 0,
+                   kTimeout);
+  EXPECT_EQ(payload, std::string(buffer.data(), received));
+}
+
+TEST_F(IoUringSocketTest, WaitWithoutIoConsumesWakeUpOnce) {
+  server_->WakeUp();
+  EXPECT_TRUE(
+      server_->Wait(webrtc::TimeDelta::PlusInfinity(), /*process_io=*/false));
+  // The wake-up was consumed, so this waits for the whole duration.
+  const int64_t start_ms = TimeMillis();
+  EXPECT_TRUE(
+      server_->Wait(webrtc::TimeDelta::Millis(100), /*process_io=*/true));
+  EXPECT_GE(TimeMillis() - start_ms, 100);
+}
+
+TEST_F(IoUringSocketTest, ClosedSocketReleasesItsPort) {
+  std::unique_ptr<Socket> socket(server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, socket->Bind(SocketAddress(kIPv4Loopback, 0)));
+  server_->Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true);
+  const SocketAddress address = socket->GetLocalAddress();
+  socket.reset();
+
+  socket.reset(server_->CreateSocket(AF_INET, SOCK_DGRAM));
+  EXPECT_EQ(0, socket->Bind(address));
+}
+
+}  // namespace
+}  // namespace rtc
@@ -0,0 +1,226 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory/slab_pool.h"
+
+#include <algorithm>
+#include <new>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+#include "rtc_base/checks.h"
+
+namespace rtc {
+namespace {
+
+// Multiples of 64 bytes, so that all blocks are as aligned as their slab.
+// 1664 holds a packet the size of a typical 1500 byte MTU with room to spare,
+// 2176 the largest RTP packet the stack creates plus SRTP overhead.
+constexpr size_t kBlockSizes[] = {128, 256, 512, 1664, 2176};
+constexpr size_t kSlabSize = 64 * 1024;
+
+}  // namespace
+
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+
+// Freed blocks of the global pool, kept by the thread which freed them.
+class SlabPoolThreadCache {
+ public:
+  static constexpr int kMaxBlocks = 32;
+  // Number of blocks moved at once between the cache and the pool.
+  static constexpr int kBatchSize = kMaxBlocks / 2;
+
+  constexpr SlabPoolThreadCache() = default;
+
+  ~SlabPoolThreadCache() {
+    destroyed_ = true;
+    for (int i = 0; i < SlabPool::kNumSizeClasses; ++i) {
+      SlabPool::Instance()->ReturnBlocks(i, blocks_[i], num_blocks_[i]);
+      num_blocks_[i] = 0;
+    }
+  }
+
+  void* Allocate(SlabPool& pool, int size_class) {
+    int& num_blocks = num_blocks_[size_class];
+    if (num_blocks > 0) {
+      pool.CountAllocation(size_class, /*hit=*/true);
+      return blocks_[size_class][--num_blocks];
+    }
+    return pool.AllocateFromSizeClass(size_class, blocks_[size_class],
+                                      destroyed_ ? 0 : kBatchSize,
+                                      &num_blocks);
+  }
+
+  void Free(SlabPool& pool, void* block, int size_class) {
+    int& num_blocks = num_blocks_[size_class];
+    if (destroyed_) {
+      pool.ReturnBlocks(size_class, &block, 1);
+      return;
+    }
+    if (num_blocks == kMaxBlocks) {
+      num_blocks -= kBatchSize;
+      pool.ReturnBlocks(size_class, &blocks_[size_class][num_blocks],
+                        kBatchSize);
+    }
+    blocks_[size_class][num_blocks++] = block;
+  }
+
+ private:
+  void* blocks_[SlabPool::kNumSizeClasses][kMaxBlocks] = {};
+  int num_blocks_[SlabPool::kNumSizeClasses] = {};
+  // Blocks freed by destructors of other thread locals may arrive after the
+  // cache itself is gone. They go straight to the pool.
+  bool destroyed_ = false;
+};
+
+namespace {
+ABSL_CONST_INIT thread_local SlabPoolThreadCache thread_cache;
+}  // namespace
+
+#endif  // ABSL_HAVE_THREAD_LOCAL
+
+SlabPool* SlabPool::Instance() {
+  static SlabPool* const pool = new SlabPool();
+  return pool;
+}
+
+SlabPool::SlabPool() {
+  static_assert(sizeof(kBlockSizes) / sizeof(kBlockSizes[0]) ==
+                    kNumSizeClasses,
+                "");
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    size_classes_[i].block_size = kBlockSizes[i];
+  }
+}
+
+SlabPool::~SlabPool() = default;
+
+int SlabPool::SizeClassFor(size_t size) {
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    if (size <= kBlockSizes[i]) {
+      return i;
+    }
+  }
+  return kNoSizeClass;
+}
+
+void* SlabPool::Allocate(size_t size, int* size_class) {
+  *size_class = SizeClassFor(size);
+  if (*size_class == kNoSizeClass) {
+    oversized_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  if (this == Instance()) {
+    return thread_cache.Allocate(*this, *size_class);
+  }
+#endif
+  return AllocateFromSizeClass(*size_class, nullptr, 0, nullptr);
+}
+
+void SlabPool::Free(void* block, int size_class) {
+  if (size_class == kNoSizeClass) {
+    ::operator delete(block);
+    return;
+  }
+  RTC_DCHECK_GE(size_class, 0);
+  RTC_DCHECK_LT(size_class, kNumSizeClasses);
+  size_classes_[size_class].blocks_in_use.fetch_sub(1,
+                                                    std::memory_order_relaxed);
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  if (this == Instance()) {
+    thread_cache.Free(*this, block, size_class);
+    return;
+  }
+#endif
+  ReturnBlocks(size_class, &block, 1);
+}
+
+SlabPool::Stats SlabPool::GetStats() const {
+  Stats stats;
+  for (const SizeClass& size_class : size_classes_) {
+    SizeClassStats& out = stats.size_classes.emplace_back();
+    out.block_size = size_class.block_size;
+    out.hits = size_class.hits.load(std::memory_order_relaxed);
+    out.misses = size_class.misses.load(std::memory_order_relaxed);
+    out.blocks_in_use =
+        size_class.blocks_in_use.load(std::memory_order_relaxed);
+    out.high_water_blocks_in_use =
+        size_class.high_water_blocks_in_use.load(std::memory_order_relaxed);
+    out.slab_bytes = size_class.slab_bytes.load(std::memory_order_relaxed);
+  }
+  stats.oversized_allocations =
+      oversized_allocations_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void* SlabPool::AllocateFromSizeClass(int size_class,
+                                      void** refill,
+                                      int max_refill,
+                                      int* num_refilled) {
+  SizeClass& sc = size_classes_[size_class];
+  void* block;
+  bool hit;
+  {
+    webrtc::MutexLock lock(&sc.lock);
+    if (!sc.free_blocks.empty()) {
+      hit = true;
+      block = sc.free_blocks.back();
+      sc.free_blocks.pop_back();
+      int num = std::min<int>(max_refill, sc.free_blocks.size());
+      std::copy(sc.free_blocks.end() - num, sc.free_blocks.end(), refill);
+      sc.free_blocks.resize(sc.free_blocks.size() - num);
+      if (num_refilled) {
+        *num_refilled = num;
+      }
+    } else {
+      hit = false;
+      if (sc.unused_begin == sc.unused_end) {
+        size_t slab_size = kSlabSize - kSlabSize % sc.block_size;
+        sc.slabs.emplace_back(new uint8_t[slab_size]);
+        sc.unused_begin = sc.slabs.back().get();
+        sc.unused_end = sc.unused_begin + slab_size;
+        sc.slab_bytes.fetch_add(slab_size, std::memory_order_relaxed);
+      }
+      block = sc.unused_begin;
+      sc.unused_begin += sc.block_size;
+      if (num_refilled) {
+        *num_refilled = 0;
+      }
+    }
+  }
+  CountAllocation(size_class, hit);
+  return block;
+}
+
+void SlabPool::ReturnBlocks(int size_class,
+                            void* const* blocks,
+                            int num_blocks) {
+  if (num_blocks == 0) {
+    return;
+  }
+  SizeClass& sc = size_classes_[size_class];
+  webrtc::MutexLock lock(&sc.lock);
+  sc.free_blocks.insert(sc.free_blocks.end(), blocks, blocks + num_blocks);
+}
+
+void SlabPool::CountAllocation(int size_class, bool hit) {
+  SizeClass& sc = size_classes_[size_class];
+  (hit ? sc.hits : sc.misses).fetch_add(1, std::memory_order_relaxed);
+  size_t in_use = sc.blocks_in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t high_water =
+      sc.high_water_blocks_in_use.load(std::memory_order_relaxed);
+  while (in_use > high_water &&
+         !sc.high_water_blocks_in_use.compare_exchange_weak(
+             high_water, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace rtc
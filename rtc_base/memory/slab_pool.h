@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_MEMORY_SLAB_POOL_H_
+#define RTC_BASE_MEMORY_SLAB_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// A process wide allocator for blocks of memory that are allocated and freed
+// at a high rate, such as packet buffers. Blocks come in a few size classes,
+// from small ones for RTCP and audio up to ones holding a maximum size RTP
+// packet. Each size class carves its blocks out of larger slabs, which are
+// never returned to the system, and keeps freed blocks for reuse. A small
+// cache per thread lets most allocations and frees avoid taking a lock.
+//
+// Larger blocks are allocated with operator new. Thread safe.
+class RTC_EXPORT SlabPool {
+ public:
+  // Passed to Free() for blocks that don't belong to a size class.
+  static constexpr int kNoSizeClass = -1;
+
+  struct SizeClassStats {
+    size_t block_size = 0;
+    // Allocations served with a block which had been freed before.
+    uint64_t hits = 0;
+    // Allocations which needed a block never used before.
+    uint64_t misses = 0;
+    size_t blocks_in_use = 0;
+    // The highest `blocks_in_use` seen.
+    size_t high_water_blocks_in_use = 0;
+    size_t slab_bytes = 0;
+  };
+
+  struct Stats {
+    std::vector<SizeClassStats> size_classes;
+    // Allocations too large for any size class.
+    uint64_t oversized_allocations = 0;
+  };
+
+  static SlabPool* Instance();
+
+  SlabPool();
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+  // Blocks still cached by other threads are leaked.
+  ~SlabPool();
+
+  // Returns a block of at least `size` bytes, aligned like operator new, and
+  // sets `size_class` to what must be passed to Free() with it.
+  void* Allocate(size_t size, int* size_class);
+  void Free(void* block, int size_class);
+
+  Stats GetStats() const;
+
+ private:
+  friend class SlabPoolThreadCache;
+
+  static constexpr int kNumSizeClasses = 5;
+
+  struct SizeClass {
+    size_t block_size = 0;
+
+    webrtc::Mutex lock;
+    std::vector<void*> free_blocks RTC_GUARDED_BY(lock);
+    std::vector<std::unique_ptr<uint8_t[]>> slabs RTC_GUARDED_BY(lock);
+    // The part of the newest slab not handed out yet.
+    uint8_t* unused_begin RTC_GUARDED_BY(lock) = nullptr;
+    uint8_t* unused_end RTC_GUARDED_BY(lock) = nullptr;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<size_t> blocks_in_use{0};
+    std::atomic<size_t> high_water_blocks_in_use{0};
+    std::atomic<size_t> slab_bytes{0};
+  };
+
+  static int SizeClassFor(size_t size);
+
+  // Pops a free block, or a block never used before if there are none. If
+  // `refill` is not null, also moves up to `max_refill` more free blocks
+  // there and returns their number in `num_refilled`.
+  void* AllocateFromSizeClass(int size_class,
+                              void** refill,
+                              int max_refill,
+                              int* num_refilled);
+  void ReturnBlocks(int size_class, void* const* blocks, int num_blocks);
+  void CountAllocation(int size_class, bool hit);
+
+  SizeClass size_classes_[kNumSizeClasses];
+  std::atomic<uint64_t> oversized_allocations_{0};
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_MEMORY_SLAB_POOL_H_
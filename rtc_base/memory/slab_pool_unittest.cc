@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory/slab_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <set>
+#include <vector>
+
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+size_t TotalBlocksInUse(const SlabPool::Stats& stats) {
+  size_t blocks_in_use = 0;
+  for (const SlabPool::SizeClassStats& size_class : stats.size_classes) {
+    blocks_in_use += size_class.blocks_in_use;
+  }
+  return blocks_in_use;
+}
+
+TEST(SlabPoolTest, PicksSmallestFittingSizeClass) {
+  SlabPool pool;
+  SlabPool::Stats stats = pool.GetStats();
+  ASSERT_FALSE(stats.size_classes.empty());
+  for (size_t i = 0; i < stats.size_classes.size(); ++i) {
+    size_t block_size = stats.size_classes[i].block_size;
+    int size_class;
+    void* block = pool.Allocate(block_size, &size_class);
+    EXPECT_EQ(static_cast<int>(i), size_class);
+    // The whole block must be writable.
+    memset(block, 0xab, block_size);
+    pool.Free(block, size_class);
+  }
+}
+
+TEST(SlabPoolTest, AllocatesOversizedBlocksWithOperatorNew) {
+  SlabPool pool;
+  size_t largest = pool.GetStats().size_classes.back().block_size;
+  int size_class;
+  void* block = pool.Allocate(largest + 1, &size_class);
+  EXPECT_EQ(SlabPool::kNoSizeClass, size_class);
+  memset(block, 0, largest + 1);
+  pool.Free(block, size_class);
+
+  SlabPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.oversized_allocations);
+  EXPECT_EQ(0u, TotalBlocksInUse(stats));
+}
+
+TEST(SlabPoolTest, ReusesFreedBlocks) {
+  SlabPool pool;
+  int size_class;
+  void* first = pool.Allocate(1200, &size_class);
+  pool.Free(first, size_class);
+  void* second = pool.Allocate(1000, &size_class);
+  EXPECT_EQ(first, second);
+  pool.Free(second, size_class);
+
+  SlabPool::SizeClassStats stats =
+      pool.GetStats().size_classes[size_class];
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.blocks_in_use);
+  EXPECT_EQ(1u, stats.high_water_blocks_in_use);
+  EXPECT_GT(stats.slab_bytes, 0u);
+}
+
+TEST(SlabPoolTest, TracksHighWaterMark) {
+  SlabPool pool;
+  constexpr int kBlocks = 100;
+  std::vector<void*> blocks;
+  int size_class;
+  for (int i = 0; i < kBlocks; ++i) {
+    blocks.push_back(pool.Allocate(100, &size_class));
+  }
+  // All blocks must be distinct.
+  EXPECT_EQ(blocks.size(),
+            std::set<void*>(blocks.begin(), blocks.end()).size());
+  for (void* block : blocks) {
+    pool.Free(block, size_class);
+  }
+  void* block = pool.Allocate(100, &size_class);
+  pool.Free(block, size_class);
+
+  SlabPool::SizeClassStats stats =
+      pool.GetStats().size_classes[size_class];
+  EXPECT_EQ(0u, stats.blocks_in_use);
+  EXPECT_EQ(static_cast<size_t>(kBlocks), stats.high_water_blocks_in_use);
+  EXPECT_EQ(static_cast<uint64_t>(kBlocks), stats.misses);
+  EXPECT_EQ(1u, stats.hits);
+}
+
+TEST(SlabPoolTest, FreesBlocksAllocatedOnOtherThreads) {
+  SlabPool* pool = SlabPool::Instance();
+  size_t blocks_in_use_before = TotalBlocksInUse(pool->GetStats());
+
+  constexpr int kBlocks = 1000;
+  std::vector<void*> blocks(kBlocks);
+  int size_class = SlabPool::kNoSizeClass;
+  PlatformThread::SpawnJoinable(
+      [&] {
+        for (void*& block : blocks) {
+          block = pool->Allocate(1500, &size_class);
+        }
+      },
+      "allocator")
+      .Finalize();
+  ASSERT_NE(SlabPool::kNoSizeClass, size_class);
+  for (void* block : blocks) {
+    pool->Free(block, size_class);
+  }
+  // All blocks freed here can be allocated again without carving new ones.
+  uint64_t misses = pool->GetStats().size_classes[size_class].misses;
+  for (void*& block : blocks) {
+    block = pool->Allocate(1500, &size_class);
+  }
+  EXPECT_EQ(misses, pool->GetStats().size_classes[size_class].misses);
+  EXPECT_EQ(blocks.size(),
+            std::set<void*>(blocks.begin(), blocks.end()).size());
+  for (void* block : blocks) {
+    pool->Free(block, size_class);
+  }
+  EXPECT_EQ(blocks_in_use_before, TotalBlocksInUse(pool->GetStats()));
+}
+
+}  // namespace
+}  // namespace rtc
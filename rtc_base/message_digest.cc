@@ -40,6 +40,15 @@ MessageDigest* MessageDigestFactory::Create(absl::string_view alg) {
   return digest;
 }
 
+std::unique_ptr<Hmac> HmacFactory::Create(absl::string_view alg,
+                                          absl::string_view key) {
+  auto hmac = std::make_unique<OpenSSLHmac>(alg, key);
+  if (hmac->Size() == 0) {  // invalid algorithm
+    return nullptr;
+  }
+  return hmac;
+}
+
 bool IsFips180DigestAlgorithm(absl::string_view alg) {
   // These are the FIPS 180 algorithms.  According to RFC 4572 Section 5,
   // "Self-signed certificates (for which legacy certificates are not a
@@ -13,6 +13,7 @@
 
 #include <stddef.h>
 
+#include <memory>
 #include <string>
 
 #include "absl/strings/string_view.h"
@@ -47,6 +48,31 @@ class MessageDigestFactory {
   static MessageDigest* Create(absl::string_view alg);
 };
 
+// A class for computing RFC 2104 HMACs with a fixed key. The key is processed
+// once, when the object is created, so that authenticating many inputs with
+// the same key does not repeat the key setup done by ComputeHmac().
+class Hmac {
+ public:
+  virtual ~Hmac() {}
+  // Returns the HMAC output size (e.g. 20 bytes for SHA-1).
+  virtual size_t Size() const = 0;
+  // Updates the HMAC with `len` bytes from `buf`.
+  virtual void Update(const void* buf, size_t len) = 0;
+  // Outputs the HMAC value to `buf` with length `len`, and prepares for
+  // authenticating the next input with the same key.
+  // Returns the number of bytes written, i.e., Size(), or 0 if `len` was too
+  // small.
+  virtual size_t Finish(void* buf, size_t len) = 0;
+};
+
+// A factory class for creating keyed HMAC objects.
+class HmacFactory {
+ public:
+  // Returns null if `alg` is not a known digest algorithm.
+  static std::unique_ptr<Hmac> Create(absl::string_view alg,
+                                      absl::string_view key);
+};
+
 // A check that an algorithm is in a list of approved digest algorithms
 // from RFC 4572 (FIPS 180).
 bool IsFips180DigestAlgorithm(absl::string_view alg);
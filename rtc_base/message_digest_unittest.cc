@@ -10,6 +10,9 @@
 
 #include "rtc_base/message_digest.h"
 
+#include <memory>
+#include <string>
+
 #include "absl/strings/string_view.h"
 #include "rtc_base/string_encode.h"
 #include "test/gtest.h"
@@ -153,4 +156,35 @@ TEST(MessageDigestTest, TestBadHmac) {
   EXPECT_EQ("", ComputeHmac("sha-9000", "key", "abc"));
 }
 
+// Test vectors from RFC 2202, computed with one keyed object per key.
+TEST(MessageDigestTest, TestSha1HmacWithPrecomputedKey) {
+  std::unique_ptr<Hmac> hmac =
+      HmacFactory::Create(DIGEST_SHA_1, std::string(80, '\xaa'));
+  ASSERT_TRUE(hmac);
+  EXPECT_EQ(20U, hmac->Size());
+  char output[20];
+  // Reusing the object for several inputs gives the same results as computing
+  // the HMAC from scratch.
+  for (int i = 0; i < 2; ++i) {
+    const std::string input =
+        "Test Using Larger Than Block-Size Key - Hash Key First";
+    hmac->Update(input.data(), input.size());
+    EXPECT_EQ(sizeof(output), hmac->Finish(output, sizeof(output)));
+    EXPECT_EQ("aa4ae5e15272d00e95705637ce8a3b55ed402112",
+              hex_encode(absl::string_view(output, sizeof(output))));
+
+    // Split over several updates.
+    hmac->Update("Test Using Larger Than Block-Size Key and Larger ", 49);
+    hmac->Update("Than One Block-Size Data", 24);
+    EXPECT_EQ(sizeof(output), hmac->Finish(output, sizeof(output)));
+    EXPECT_EQ("e8e99d0f45237d786d6bbaa7965c7808bbff1a91",
+              hex_encode(absl::string_view(output, sizeof(output))));
+  }
+  EXPECT_EQ(0U, hmac->Finish(output, sizeof(output) - 1));
+}
+
+TEST(MessageDigestTest, TestBadHmacWithPrecomputedKey) {
+  EXPECT_FALSE(HmacFactory::Create("sha-9000", "key"));
+}
+
 }  // namespace rtc
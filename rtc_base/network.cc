@@ -22,6 +22,7 @@
 
 #include "rtc_base/win32.h"
 #elif !defined(__native_client__)
+#include "rtc_base/ifaddrs_cache.h"
 #include "rtc_base/ifaddrs_converter.h"
 #endif
 
@@ -551,6 +552,9 @@ BasicNetworkManager::~BasicNetworkManager() {
 void BasicNetworkManager::OnNetworksChanged() {
   RTC_DCHECK_RUN_ON(thread_);
   RTC_LOG(LS_INFO) << "Network change was observed";
+#if defined(WEBRTC_POSIX) && !defined(__native_client__)
+  IfAddrsCache::Get()->Invalidate();
+#endif
   UpdateNetworksOnce();
 }
 
@@ -566,7 +570,7 @@ bool BasicNetworkManager::CreateNetworks(
 
 #elif defined(WEBRTC_POSIX)
 NetworkMonitorInterface::InterfaceInfo BasicNetworkManager::GetInterfaceInfo(
-    struct ifaddrs* cursor) const {
+    const struct ifaddrs* cursor) const {
   if (cursor->ifa_flags & IFF_LOOPBACK) {
     return {
         .adapter_type = ADAPTER_TYPE_LOOPBACK,
@@ -585,13 +589,13 @@ NetworkMonitorInterface::InterfaceInfo BasicNetworkManager::GetInterfaceInfo(
 }
 
 void BasicNetworkManager::ConvertIfAddrs(
-    struct ifaddrs* interfaces,
+    const struct ifaddrs* interfaces,
     IfAddrsConverter* ifaddrs_converter,
     bool include_ignored,
     std::vector<std::unique_ptr<Network>>* networks) const {
   std::map<std::string, Network*> current_networks;
 
-  for (struct ifaddrs* cursor = interfaces; cursor != nullptr;
+  for (const struct ifaddrs* cursor = interfaces; cursor != nullptr;
        cursor = cursor->ifa_next) {
     IPAddress prefix;
     IPAddress mask;
@@ -691,19 +695,14 @@ void BasicNetworkManager::ConvertIfAddrs(
 bool BasicNetworkManager::CreateNetworks(
     bool include_ignored,
     std::vector<std::unique_ptr<Network>>* networks) const {
-  struct ifaddrs* interfaces;
-  int error = getifaddrs(&interfaces);
-  if (error != 0) {
-    RTC_LOG_ERR(LS_ERROR) << "getifaddrs failed to gather interface data: "
-                          << error;
+  std::shared_ptr<const ifaddrs> interfaces;
+  if (!IfAddrsCache::Get()->GetInterfaces(&interfaces)) {
     return false;
   }
 
   std::unique_ptr<IfAddrsConverter> ifaddrs_converter(CreateIfAddrsConverter());
-  ConvertIfAddrs(interfaces, ifaddrs_converter.get(), include_ignored,
+  ConvertIfAddrs(interfaces.get(), ifaddrs_converter.get(), include_ignored,
                  networks);
-
-  freeifaddrs(interfaces);
   return true;
 }
 
@@ -1026,6 +1025,17 @@ void BasicNetworkManager::UpdateNetworksOnce() {
   if (!start_count_)
     return;
 
+#if defined(WEBRTC_POSIX) && !defined(__native_client__)
+  // Once the networks were signaled, skip the update while the interfaces
+  // are unchanged, as it would find the same networks.
+  std::shared_ptr<const ifaddrs> interfaces;
+  if (IfAddrsCache::Get()->GetInterfaces(&interfaces) && sent_first_update_ &&
+      interfaces == updated_interfaces_) {
+    return;
+  }
+  updated_interfaces_ = std::move(interfaces);
+#endif
+
   std::vector<std::unique_ptr<Network>> list;
   if (!CreateNetworks(false, &list)) {
     SignalError();
@@ -1254,7 +1264,14 @@ void BasicNetworkManager::set_vpn_list(const std::vector<NetworkMask>& vpn) {
   if (thread_ == nullptr) {
     vpn_ = vpn;
   } else {
-    thread_->BlockingCall([this, vpn] { vpn_ = vpn; });
+    thread_->BlockingCall([this, vpn] {
+      RTC_DCHECK_RUN_ON(thread_);
+      vpn_ = vpn;
+#if defined(WEBRTC_POSIX)
+      // The networks must be updated even if the interfaces are not.
+      updated_interfaces_ = nullptr;
+#endif
+    });
   }
 }
 
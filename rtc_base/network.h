@@ -307,13 +307,13 @@ class RTC_EXPORT BasicNetworkManager : public NetworkManagerBase,
  protected:
 #if defined(WEBRTC_POSIX)
   // Separated from CreateNetworks for tests.
-  void ConvertIfAddrs(ifaddrs* interfaces,
+  void ConvertIfAddrs(const ifaddrs* interfaces,
                       IfAddrsConverter* converter,
                       bool include_ignored,
                       std::vector<std::unique_ptr<Network>>* networks) const
       RTC_RUN_ON(thread_);
   NetworkMonitorInterface::InterfaceInfo GetInterfaceInfo(
-      struct ifaddrs* cursor) const RTC_RUN_ON(thread_);
+      const struct ifaddrs* cursor) const RTC_RUN_ON(thread_);
 #endif  // defined(WEBRTC_POSIX)
 
   // Creates a network object for each network available on the machine.
@@ -362,6 +362,11 @@ class RTC_EXPORT BasicNetworkManager : public NetworkManagerBase,
 
   std::vector<NetworkMask> vpn_;
   rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> task_safety_flag_;
+#if defined(WEBRTC_POSIX)
+  // The snapshot of the interfaces which the networks were last updated from,
+  // so that the periodic update is skipped while they remain unchanged.
+  std::shared_ptr<const ifaddrs> updated_interfaces_ RTC_GUARDED_BY(thread_);
+#endif  // defined(WEBRTC_POSIX)
 };
 
 // Represents a Unix-type network interface, with a name and single address.
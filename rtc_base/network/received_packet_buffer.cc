@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/network/received_packet_buffer.h"
+
+#include <atomic>
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+
+namespace rtc {
+namespace {
+
+std::atomic<uint64_t> allocations(0);
+std::atomic<uint64_t> taken(0);
+std::atomic<uint64_t> copies(0);
+
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+ABSL_CONST_INIT thread_local ScopedReceivedPacketBuffer* current = nullptr;
+#else
+// Without thread locals packets are always copied.
+ScopedReceivedPacketBuffer* const current = nullptr;
+#endif
+
+}  // namespace
+
+ScopedReceivedPacketBuffer::ScopedReceivedPacketBuffer(
+    CopyOnWriteBuffer* buffer)
+    : buffer_(buffer), previous_(current) {
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  current = this;
+#endif
+}
+
+ScopedReceivedPacketBuffer::~ScopedReceivedPacketBuffer() {
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  current = previous_;
+#endif
+}
+
+CopyOnWriteBuffer ScopedReceivedPacketBuffer::AllocateBuffer(
+    size_t capacity) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return CopyOnWriteBuffer::CreatePooled(capacity, capacity);
+}
+
+CopyOnWriteBuffer ScopedReceivedPacketBuffer::TakeOrCopy(const void* data,
+                                                         size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  CopyOnWriteBuffer* buffer = current ? current->buffer_ : nullptr;
+  if (buffer && buffer->size() > 0 && bytes >= buffer->cdata() &&
+      size <= buffer->size() &&
+      static_cast<size_t>(bytes - buffer->cdata()) <= buffer->size() - size) {
+    taken.fetch_add(1, std::memory_order_relaxed);
+    CopyOnWriteBuffer packet = std::move(*buffer);
+    return packet.Slice(bytes - packet.cdata(), size);
+  }
+  copies.fetch_add(1, std::memory_order_relaxed);
+  return CopyOnWriteBuffer::CreatePooled(bytes, size, size);
+}
+
+ScopedReceivedPacketBuffer::Stats ScopedReceivedPacketBuffer::GetStats() {
+  Stats stats;
+  stats.allocations = allocations.load(std::memory_order_relaxed);
+  stats.taken = taken.load(std::memory_order_relaxed);
+  stats.copies = copies.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace rtc
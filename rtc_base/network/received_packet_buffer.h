@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_NETWORK_RECEIVED_PACKET_BUFFER_H_
+#define RTC_BASE_NETWORK_RECEIVED_PACKET_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace rtc {
+
+// Received packets travel up the stack through SignalReadPacket as a pointer
+// and a size, which forces the listener that keeps a packet to copy it. A
+// socket that reads datagrams into ref counted buffers can wrap the delivery
+// of each one in this scope instead, which lets that listener take over the
+// buffer without a copy as long as the packet bytes haven't moved.
+//
+// Currently only AsyncUDPSocket in batched receive mode opens these scopes,
+// which BasicPacketSocketFactory enables with the WebRTC-UdpReceiveBatching
+// field trial. Packets from any other socket are copied by TakeOrCopy().
+//
+// Scopes are per thread and may nest; only the innermost one is considered.
+class RTC_EXPORT ScopedReceivedPacketBuffer {
+ public:
+  struct Stats {
+    // Buffers created by AllocateBuffer().
+    uint64_t allocations = 0;
+    // Packets returned by TakeOrCopy() without copying.
+    uint64_t taken = 0;
+    // Packets TakeOrCopy() had to copy.
+    uint64_t copies = 0;
+  };
+
+  // `buffer` holds the packet being delivered and must outlive the scope. It
+  // is left empty if a listener takes the packet.
+  explicit ScopedReceivedPacketBuffer(CopyOnWriteBuffer* buffer);
+  ScopedReceivedPacketBuffer(const ScopedReceivedPacketBuffer&) = delete;
+  ScopedReceivedPacketBuffer& operator=(const ScopedReceivedPacketBuffer&) =
+      delete;
+  ~ScopedReceivedPacketBuffer();
+
+  // Returns a buffer that a socket can read a datagram of up to `capacity`
+  // bytes into. Its size is set to `capacity`.
+  static CopyOnWriteBuffer AllocateBuffer(size_t capacity);
+
+  // Returns the `size` bytes at `data` as a buffer. If they lie within the
+  // buffer of the innermost scope on the current thread, that buffer is moved
+  // out and sliced; the caller then holds the only reference and may modify
+  // the packet in place. Otherwise the bytes are copied.
+  static CopyOnWriteBuffer TakeOrCopy(const void* data, size_t size);
+
+  static Stats GetStats();
+
+ private:
+  CopyOnWriteBuffer* const buffer_;
+  ScopedReceivedPacketBuffer* const previous_;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_NETWORK_RECEIVED_PACKET_BUFFER_H_
@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/network/received_packet_buffer.h"
+
+#include <string.h>
+
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+constexpr uint8_t kPacket[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+CopyOnWriteBuffer ReceivedBuffer() {
+  CopyOnWriteBuffer buffer =
+      ScopedReceivedPacketBuffer::AllocateBuffer(sizeof(kPacket));
+  memcpy(buffer.MutableData(), kPacket, sizeof(kPacket));
+  return buffer;
+}
+
+TEST(ScopedReceivedPacketBufferTest, TakesBufferOfCurrentPacket) {
+  CopyOnWriteBuffer buffer = ReceivedBuffer();
+  const uint8_t* data = buffer.cdata();
+  ScopedReceivedPacketBuffer::Stats before =
+      ScopedReceivedPacketBuffer::GetStats();
+
+  CopyOnWriteBuffer packet;
+  {
+    ScopedReceivedPacketBuffer scoped_packet(&buffer);
+    packet = ScopedReceivedPacketBuffer::TakeOrCopy(data + 2, 4);
+  }
+  EXPECT_EQ(data + 2, packet.cdata());
+  EXPECT_EQ(4u, packet.size());
+  EXPECT_EQ(0u, buffer.size());
+  // The taker holds the only reference, so writing doesn't copy.
+  EXPECT_EQ(data + 2, packet.MutableData());
+
+  ScopedReceivedPacketBuffer::Stats after =
+      ScopedReceivedPacketBuffer::GetStats();
+  EXPECT_EQ(before.taken + 1, after.taken);
+  EXPECT_EQ(before.copies, after.copies);
+}
+
+TEST(ScopedReceivedPacketBufferTest, CopiesOutsideOfScope) {
+  CopyOnWriteBuffer buffer = ReceivedBuffer();
+  ScopedReceivedPacketBuffer::Stats before =
+      ScopedReceivedPacketBuffer::GetStats();
+
+  CopyOnWriteBuffer packet =
+      ScopedReceivedPacketBuffer::TakeOrCopy(buffer.cdata(), buffer.size());
+  EXPECT_NE(buffer.cdata(), packet.cdata());
+  EXPECT_EQ(buffer, packet);
+  EXPECT_EQ(before.copies + 1, ScopedReceivedPacketBuffer::GetStats().copies);
+}
+
+TEST(ScopedReceivedPacketBufferTest, CopiesBytesOutsideOfCurrentPacket) {
+  CopyOnWriteBuffer buffer = ReceivedBuffer();
+  uint8_t other[sizeof(kPacket)];
+  memcpy(other, kPacket, sizeof(kPacket));
+
+  ScopedReceivedPacketBuffer scoped_packet(&buffer);
+  CopyOnWriteBuffer packet =
+      ScopedReceivedPacketBuffer::TakeOrCopy(other, sizeof(other));
+  EXPECT_EQ(sizeof(kPacket), buffer.size());
+  EXPECT_EQ(buffer, packet);
+  // Overlapping the end of the packet.
+  packet = ScopedReceivedPacketBuffer::TakeOrCopy(buffer.cdata() + 4,
+                                                  sizeof(kPacket));
+  EXPECT_EQ(sizeof(kPacket), buffer.size());
+  EXPECT_NE(buffer.cdata() + 4, packet.cdata());
+}
+
+TEST(ScopedReceivedPacketBufferTest, PacketCanOnlyBeTakenOnce) {
+  CopyOnWriteBuffer buffer = ReceivedBuffer();
+  const uint8_t* data = buffer.cdata();
+
+  ScopedReceivedPacketBuffer scoped_packet(&buffer);
+  CopyOnWriteBuffer first =
+      ScopedReceivedPacketBuffer::TakeOrCopy(data, sizeof(kPacket));
+  CopyOnWriteBuffer second =
+      ScopedReceivedPacketBuffer::TakeOrCopy(data, sizeof(kPacket));
+  EXPECT_EQ(data, first.cdata());
+  EXPECT_NE(data, second.cdata());
+  EXPECT_EQ(first, second);
+}
+
+TEST(ScopedReceivedPacketBufferTest, OnlyInnermostScopeIsConsidered) {
+  CopyOnWriteBuffer outer_buffer = ReceivedBuffer();
+  CopyOnWriteBuffer inner_buffer = ReceivedBuffer();
+  const uint8_t* outer_data = outer_buffer.cdata();
+
+  ScopedReceivedPacketBuffer outer_scope(&outer_buffer);
+  {
+    ScopedReceivedPacketBuffer inner_scope(&inner_buffer);
+    CopyOnWriteBuffer packet =
+        ScopedReceivedPacketBuffer::TakeOrCopy(outer_data, sizeof(kPacket));
+    EXPECT_NE(outer_data, packet.cdata());
+  }
+  CopyOnWriteBuffer packet =
+      ScopedReceivedPacketBuffer::TakeOrCopy(outer_data, sizeof(kPacket));
+  EXPECT_EQ(outer_data, packet.cdata());
+}
+
+}  // namespace
+}  // namespace rtc
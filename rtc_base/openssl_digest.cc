@@ -10,6 +10,8 @@
 
 #include "rtc_base/openssl_digest.h"
 
+#include <openssl/hmac.h>
+
 #include "absl/strings/string_view.h"
 #include "rtc_base/checks.h"  // RTC_DCHECK, RTC_CHECK
 #include "rtc_base/openssl.h"
@@ -56,6 +58,49 @@ size_t OpenSSLDigest::Finish(void* buf, size_t len) {
   return md_len;
 }
 
+OpenSSLHmac::OpenSSLHmac(absl::string_view algorithm, absl::string_view key) {
+  ctx_ = HMAC_CTX_new();
+  RTC_CHECK(ctx_ != nullptr);
+  // OpenSSL treats a null key as "reuse the previous key", so pass an empty
+  // string for an empty key.
+  const char* key_data = key.empty() ? "" : key.data();
+  if (!OpenSSLDigest::GetDigestEVP(algorithm, &md_) ||
+      !HMAC_Init_ex(ctx_, key_data, key.size(), md_, nullptr)) {
+    md_ = nullptr;
+  }
+}
+
+OpenSSLHmac::~OpenSSLHmac() {
+  HMAC_CTX_free(ctx_);
+}
+
+size_t OpenSSLHmac::Size() const {
+  if (!md_) {
+    return 0;
+  }
+  return EVP_MD_size(md_);
+}
+
+void OpenSSLHmac::Update(const void* buf, size_t len) {
+  if (!md_) {
+    return;
+  }
+  HMAC_Update(ctx_, static_cast<const unsigned char*>(buf), len);
+}
+
+size_t OpenSSLHmac::Finish(void* buf, size_t len) {
+  if (!md_ || len < Size()) {
+    return 0;
+  }
+  unsigned int md_len;
+  HMAC_Final(ctx_, static_cast<unsigned char*>(buf), &md_len);
+  // Passing no key and no digest reuses the ones given in the constructor,
+  // without redoing the key setup.
+  HMAC_Init_ex(ctx_, nullptr, 0, nullptr, nullptr);
+  RTC_DCHECK(md_len == Size());
+  return md_len;
+}
+
 bool OpenSSLDigest::GetDigestEVP(absl::string_view algorithm,
                                  const EVP_MD** mdp) {
   const EVP_MD* md;
@@ -46,6 +46,25 @@ class OpenSSLDigest final : public MessageDigest {
   const EVP_MD* md_;
 };
 
+// An implementation of the keyed HMAC class that uses OpenSSL.
+class OpenSSLHmac final : public Hmac {
+ public:
+  // Creates an OpenSSLHmac with `algorithm` as the hash algorithm, keyed with
+  // `key`.
+  OpenSSLHmac(absl::string_view algorithm, absl::string_view key);
+  ~OpenSSLHmac() override;
+  // Returns the HMAC output size (e.g. 20 bytes for SHA-1).
+  size_t Size() const override;
+  // Updates the HMAC with `len` bytes from `buf`.
+  void Update(const void* buf, size_t len) override;
+  // Outputs the HMAC value to `buf` with length `len`.
+  size_t Finish(void* buf, size_t len) override;
+
+ private:
+  HMAC_CTX* ctx_ = nullptr;
+  const EVP_MD* md_ = nullptr;
+};
+
 }  // namespace rtc
 
 #endif  // RTC_BASE_OPENSSL_DIGEST_H_
@@ -55,6 +55,7 @@
 
 #if defined(WEBRTC_LINUX)
 #include <linux/sockios.h>
+#include <netinet/udp.h>
 #endif
 
 #if defined(WEBRTC_WIN)
@@ -96,6 +97,35 @@ int64_t GetSocketRecvTimestamp(int socket) {
 typedef char* SockOptArg;
 #endif
 
+#if defined(WEBRTC_LINUX)
+// Returns the kernel receive time, in microseconds, carried by a
+// SCM_TIMESTAMPNS control message in `msg`, or -1 if there is none.
+int64_t GetTimestampFromControlMessages(msghdr* msg) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      timespec ts;
+      memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+      return rtc::kNumMicrosecsPerSec * static_cast<int64_t>(ts.tv_sec) +
+             static_cast<int64_t>(ts.tv_nsec) / rtc::kNumNanosecsPerMicrosec;
+    }
+  }
+  return -1;
+}
+#endif
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+// UDP generic segmentation offload, available since Linux 4.18. Defined here
+// since older system headers lack it.
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+// Maximum number of segments in one UDP GSO send (UDP_MAX_SEGMENTS).
+constexpr size_t kMaxUdpGsoSegments = 64;
+// Keeps a GSO super-datagram, including IP and UDP headers, below 64 KB.
+constexpr size_t kMaxUdpGsoPayload = 63 * 1024;
+#endif
+
 #if defined(WEBRTC_USE_EPOLL)
 // POLLRDHUP / EPOLLRDHUP are only defined starting with Linux 2.6.17.
 #if !defined(POLLRDHUP)
@@ -153,6 +183,17 @@ bool PhysicalSocket::Create(int family, int type) {
   if (udp_) {
     SetEnabledEvents(DE_READ | DE_WRITE);
   }
+#if defined(WEBRTC_LINUX)
+  // Have the kernel attach the arrival time to every datagram, which saves
+  // the SIOCGSTAMP call per read and also works for batched reads.
+  control_message_timestamps_ = false;
+  if (udp_ && s_ != INVALID_SOCKET) {
+    int value = 1;
+    control_message_timestamps_ =
+        ::setsockopt(s_, SOL_SOCKET, SO_TIMESTAMPNS, &value, sizeof(value)) ==
+        0;
+  }
+#endif
   return s_ != INVALID_SOCKET;
 }
 
@@ -393,9 +434,134 @@ int PhysicalSocket::SendTo(const void* buffer,
   return sent;
 }
 
+int PhysicalSocket::SendToBatch(rtc::ArrayView<const SendBuffer> buffers) {
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (!udp_ || buffers.size() <= 1) {
+    return Socket::SendToBatch(buffers);
+  }
+  size_t sent = 0;
+  while (sent < buffers.size()) {
+    rtc::ArrayView<const SendBuffer> remaining = buffers.subview(sent);
+    // Find the longest prefix that can be sent as one GSO super-datagram:
+    // same destination and size, except that the last one may be shorter.
+    size_t segments = 1;
+    size_t total_size = remaining[0].length;
+    if (udp_segmentation_enabled_) {
+      while (segments < remaining.size() && segments < kMaxUdpGsoSegments) {
+        const SendBuffer& next = remaining[segments];
+        if (next.destination != remaining[0].destination ||
+            next.length > remaining[0].length || next.length == 0 ||
+            total_size + next.length > kMaxUdpGsoPayload) {
+          break;
+        }
+        total_size += next.length;
+        ++segments;
+        if (next.length < remaining[0].length) {
+          break;
+        }
+      }
+    }
+    int result;
+    if (segments > 1) {
+      result = SendSegmented(remaining.subview(0, segments));
+      const int error = result < 0 ? GetError() : 0;
+      if (result >= 0) {
+        udp_segmentation_succeeded_ = true;
+      } else if (error == ENOPROTOOPT || error == EOPNOTSUPP ||
+                 (error == EIO && !udp_segmentation_succeeded_)) {
+        RTC_LOG(LS_INFO) << "UDP segmentation offload unavailable, error "
+                         << error << ". Falling back to sendmmsg.";
+        udp_segmentation_enabled_ = false;
+        continue;
+      } else if (error == EINVAL || error == EIO) {
+        // Only this batch was rejected, e.g. for the number or the size of
+        // its segments, so it alone is sent without segmentation.
+        result = SendMultiple(remaining.subview(0, segments));
+      }
+    } else {
+      result = SendMultiple(remaining.subview(
+          0, std::min(remaining.size(), kMaxSendBatchSize)));
+    }
+    if (result <= 0) {
+      break;
+    }
+    sent += result;
+  }
+  if (sent < buffers.size() && IsBlockingError(GetError())) {
+    EnableEvents(DE_WRITE);
+  }
+  return sent > 0 ? static_cast<int>(sent) : SOCKET_ERROR;
+#else
+  return Socket::SendToBatch(buffers);
+#endif
+}
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+int PhysicalSocket::SendMultiple(rtc::ArrayView<const SendBuffer> buffers) {
+  RTC_DCHECK_LE(buffers.size(), kMaxSendBatchSize);
+  std::array<mmsghdr, kMaxSendBatchSize> msgs;
+  std::array<iovec, kMaxSendBatchSize> iovs;
+  std::array<sockaddr_storage, kMaxSendBatchSize> addrs;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    iovs[i].iov_base = const_cast<char*>(buffers[i].data);
+    iovs[i].iov_len = buffers[i].length;
+    msgs[i].msg_hdr = {};
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen =
+        buffers[i].destination.ToSockAddrStorage(&addrs[i]);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_len = 0;
+  }
+  int sent =
+      ::sendmmsg(s_, msgs.data(), static_cast<unsigned int>(buffers.size()),
+                 MSG_NOSIGNAL);
+  UpdateLastError();
+  return sent;
+}
+
+int PhysicalSocket::SendSegmented(rtc::ArrayView<const SendBuffer> buffers) {
+  RTC_DCHECK_LE(buffers.size(), kMaxUdpGsoSegments);
+  std::array<iovec, kMaxUdpGsoSegments> iovs;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    iovs[i].iov_base = const_cast<char*>(buffers[i].data);
+    iovs[i].iov_len = buffers[i].length;
+  }
+  sockaddr_storage addr;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+  msghdr msg = {};
+  msg.msg_name = &addr;
+  msg.msg_namelen = buffers[0].destination.ToSockAddrStorage(&addr);
+  msg.msg_iov = iovs.data();
+  msg.msg_iovlen = buffers.size();
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  const uint16_t segment_size = static_cast<uint16_t>(buffers[0].length);
+  memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+  int sent = DoSendMsg(s_, &msg, MSG_NOSIGNAL);
+  UpdateLastError();
+  return sent < 0 ? SOCKET_ERROR : static_cast<int>(buffers.size());
+}
+#endif
+
 int PhysicalSocket::Recv(void* buffer, size_t length, int64_t* timestamp) {
-  int received =
-      ::recv(s_, static_cast<char*>(buffer), static_cast<int>(length), 0);
+  int received;
+#if defined(WEBRTC_LINUX)
+  if (timestamp && control_message_timestamps_) {
+    received = RecvWithTimestamp(buffer, length, nullptr, timestamp);
+  } else
+#endif
+  {
+    received =
+        ::recv(s_, static_cast<char*>(buffer), static_cast<int>(length), 0);
+    if (timestamp) {
+      *timestamp = GetSocketRecvTimestamp(s_);
+    }
+  }
   if ((received == 0) && (length != 0)) {
     // Note: on graceful shutdown, recv can return 0.  In this case, we
     // pretend it is blocking, and then signal close, so that simplifying
@@ -407,9 +573,6 @@ int PhysicalSocket::Recv(void* buffer, size_t length, int64_t* timestamp) {
     SetError(EWOULDBLOCK);
     return SOCKET_ERROR;
   }
-  if (timestamp) {
-    *timestamp = GetSocketRecvTimestamp(s_);
-  }
   UpdateLastError();
   int error = GetError();
   bool success = (received >= 0) || IsBlockingError(error);
@@ -429,10 +592,18 @@ int PhysicalSocket::RecvFrom(void* buffer,
   sockaddr_storage addr_storage;
   socklen_t addr_len = sizeof(addr_storage);
   sockaddr* addr = reinterpret_cast<sockaddr*>(&addr_storage);
-  int received = ::recvfrom(s_, static_cast<char*>(buffer),
-                            static_cast<int>(length), 0, addr, &addr_len);
-  if (timestamp) {
-    *timestamp = GetSocketRecvTimestamp(s_);
+  int received;
+#if defined(WEBRTC_LINUX)
+  if (timestamp && control_message_timestamps_) {
+    received = RecvWithTimestamp(buffer, length, &addr_storage, timestamp);
+  } else
+#endif
+  {
+    received = ::recvfrom(s_, static_cast<char*>(buffer),
+                          static_cast<int>(length), 0, addr, &addr_len);
+    if (timestamp) {
+      *timestamp = GetSocketRecvTimestamp(s_);
+    }
   }
   UpdateLastError();
   if ((received >= 0) && (out_addr != nullptr))
@@ -448,6 +619,77 @@ int PhysicalSocket::RecvFrom(void* buffer,
   return received;
 }
 
+#if defined(WEBRTC_LINUX)
+int PhysicalSocket::RecvWithTimestamp(void* buffer,
+                                      size_t length,
+                                      sockaddr_storage* addr_storage,
+                                      int64_t* timestamp) {
+  iovec iov = {buffer, length};
+  ControlBuffer control;
+  msghdr msg = {};
+  if (addr_storage) {
+    msg.msg_name = addr_storage;
+    msg.msg_namelen = sizeof(*addr_storage);
+  }
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.data;
+  msg.msg_controllen = sizeof(control.data);
+  int received = ::recvmsg(s_, &msg, 0);
+  *timestamp = received >= 0 ? GetTimestampFromControlMessages(&msg) : -1;
+  return received;
+}
+#endif
+
+int PhysicalSocket::RecvFromBatch(rtc::ArrayView<ReceiveBuffer> buffers) {
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  if (!udp_ || buffers.size() <= 1) {
+    return Socket::RecvFromBatch(buffers);
+  }
+  const size_t count = std::min(buffers.size(), kMaxRecvBatchSize);
+  std::array<mmsghdr, kMaxRecvBatchSize> msgs;
+  std::array<iovec, kMaxRecvBatchSize> iovs;
+  std::array<sockaddr_storage, kMaxRecvBatchSize> addrs;
+  std::array<ControlBuffer, kMaxRecvBatchSize> controls;
+  for (size_t i = 0; i < count; ++i) {
+    iovs[i].iov_base = buffers[i].data;
+    iovs[i].iov_len = buffers[i].capacity;
+    msgs[i].msg_hdr = {};
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    if (control_message_timestamps_) {
+      msgs[i].msg_hdr.msg_control = controls[i].data;
+      msgs[i].msg_hdr.msg_controllen = sizeof(controls[i].data);
+    }
+    msgs[i].msg_len = 0;
+  }
+  int received =
+      ::recvmmsg(s_, msgs.data(), static_cast<unsigned int>(count), 0,
+                 /*timeout=*/nullptr);
+  UpdateLastError();
+  // SIOCGSTAMP only reports the arrival time of the last datagram read, so
+  // timestamps are only available through control messages here.
+  for (int i = 0; i < received; ++i) {
+    ReceiveBuffer& buffer = buffers[i];
+    buffer.length = msgs[i].msg_len;
+    buffer.truncated = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    buffer.timestamp = GetTimestampFromControlMessages(&msgs[i].msg_hdr);
+    SocketAddressFromSockAddrStorage(addrs[i], &buffer.source_address);
+  }
+  int error = GetError();
+  bool success = (received >= 0) || IsBlockingError(error);
+  EnableEvents(DE_READ);
+  if (!success) {
+    RTC_LOG_F(LS_VERBOSE) << "Error = " << error;
+  }
+  return received;
+#else
+  return Socket::RecvFromBatch(buffers);
+#endif
+}
+
 int PhysicalSocket::Listen(int backlog) {
   int err = ::listen(s_, backlog);
   UpdateLastError();
@@ -512,6 +754,12 @@ int PhysicalSocket::DoSendTo(SOCKET socket,
   return ::sendto(socket, buf, len, flags, dest_addr, addrlen);
 }
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+int PhysicalSocket::DoSendMsg(SOCKET socket, const msghdr* msg, int flags) {
+  return ::sendmsg(socket, msg, flags);
+}
+#endif
+
 void PhysicalSocket::OnResolveResult(AsyncResolverInterface* resolver) {
   if (resolver != resolver_) {
     return;
@@ -602,6 +850,15 @@ int PhysicalSocket::TranslateOption(Option opt, int* slevel, int* sopt) {
 #endif
     case OPT_RTP_SENDTIME_EXTN_ID:
       return -1;  // No logging is necessary as this not a OS socket option.
+    case OPT_REUSEPORT:
+#if defined(WEBRTC_LINUX) && defined(SO_REUSEPORT)
+      *slevel = SOL_SOCKET;
+      *sopt = SO_REUSEPORT;
+      break;
+#else
+      RTC_LOG(LS_WARNING) << "Socket::OPT_REUSEPORT not supported.";
+      return -1;
+#endif
     default:
       RTC_DCHECK_NOTREACHED();
       return -1;
@@ -1198,11 +1455,11 @@ bool PhysicalSocketServer::Wait(webrtc::TimeDelta max_wait_duration,
 // but not the select implementation.
 //
 // `check_error` is true if there is the possibility of an error.
-static void ProcessEvents(Dispatcher* dispatcher,
-                          bool readable,
-                          bool writable,
-                          bool error_event,
-                          bool check_error) {
+void PhysicalSocketServer::ProcessEvents(Dispatcher* dispatcher,
+                                         bool readable,
+                                         bool writable,
+                                         bool error_event,
+                                         bool check_error) {
   RTC_DCHECK(!(error_event && !check_error));
   int errcode = 0;
   if (check_error) {
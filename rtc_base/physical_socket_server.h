@@ -14,6 +14,8 @@
 #include "api/units/time_delta.h"
 #if defined(WEBRTC_POSIX) && defined(WEBRTC_LINUX)
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
 #define WEBRTC_USE_EPOLL 1
 #endif
 
@@ -22,6 +24,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "api/array_view.h"
 #include "rtc_base/async_resolver.h"
 #include "rtc_base/async_resolver_interface.h"
 #include "rtc_base/deprecated/recursive_critical_section.h"
@@ -78,17 +81,32 @@ class RTC_EXPORT PhysicalSocketServer : public SocketServer {
   bool Wait(webrtc::TimeDelta max_wait_duration, bool process_io) override;
   void WakeUp() override;
 
-  void Add(Dispatcher* dispatcher);
-  void Remove(Dispatcher* dispatcher);
-  void Update(Dispatcher* dispatcher);
+  // Virtual so that subclasses can replace the epoll/select based event loop
+  // (see IoUringSocketServer).
+  virtual void Add(Dispatcher* dispatcher);
+  virtual void Remove(Dispatcher* dispatcher);
+  virtual void Update(Dispatcher* dispatcher);
 
- private:
-  // The number of events to process with one call to "epoll_wait".
-  static constexpr size_t kNumEpollEvents = 128;
+ protected:
   // A local historical definition of "foreverness", in milliseconds.
   static constexpr int kForeverMs = -1;
 
   static int ToCmsWait(webrtc::TimeDelta max_wait_duration);
+#if defined(WEBRTC_POSIX)
+  // Translates readiness of `dispatcher`'s descriptor into DE_* events and
+  // delivers them. `error_event` is true if an error is known to have
+  // occurred, `check_error` if one might have.
+  static void ProcessEvents(Dispatcher* dispatcher,
+                            bool readable,
+                            bool writable,
+                            bool error_event,
+                            bool check_error);
+#endif  // WEBRTC_POSIX
+
+ private:
+  // The number of events to process with one call to "epoll_wait".
+  static constexpr size_t kNumEpollEvents = 128;
+
 #if defined(WEBRTC_POSIX)
   bool WaitSelect(int cmsWait, bool process_io);
 #endif  // WEBRTC_POSIX
@@ -159,12 +177,14 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
   int SendTo(const void* buffer,
              size_t length,
              const SocketAddress& addr) override;
+  int SendToBatch(rtc::ArrayView<const SendBuffer> buffers) override;
 
   int Recv(void* buffer, size_t length, int64_t* timestamp) override;
   int RecvFrom(void* buffer,
                size_t length,
                SocketAddress* out_addr,
                int64_t* timestamp) override;
+  int RecvFromBatch(rtc::ArrayView<ReceiveBuffer> buffers) override;
 
   int Listen(int backlog) override;
   Socket* Accept(SocketAddress* out_addr) override;
@@ -173,6 +193,12 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
 
   SocketServer* socketserver() { return ss_; }
 
+  // Upper bound on the number of datagrams read by one RecvFromBatch() call.
+  static constexpr size_t kMaxRecvBatchSize = 64;
+  // Upper bound on the number of datagrams passed to the kernel at once by
+  // SendToBatch().
+  static constexpr size_t kMaxSendBatchSize = 64;
+
  protected:
   int DoConnect(const SocketAddress& connect_addr);
 
@@ -190,6 +216,11 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
                        const struct sockaddr* dest_addr,
                        socklen_t addrlen);
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  // Make virtual so ::sendmsg can be overwritten in tests.
+  virtual int DoSendMsg(SOCKET socket, const msghdr* msg, int flags);
+#endif
+
   void OnResolveResult(AsyncResolverInterface* resolver);
 
   void UpdateLastError();
@@ -202,6 +233,28 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
 
   int TranslateOption(Option opt, int* slevel, int* sopt);
 
+#if defined(WEBRTC_LINUX)
+  // Holds the control messages of one received datagram.
+  struct ControlBuffer {
+    alignas(cmsghdr) char data[CMSG_SPACE(sizeof(timespec))];
+  };
+  // Reads one datagram with recvmsg() and takes its arrival time from the
+  // SCM_TIMESTAMPNS control message. `addr_storage` may be null.
+  int RecvWithTimestamp(void* buffer,
+                        size_t length,
+                        sockaddr_storage* addr_storage,
+                        int64_t* timestamp);
+#endif
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  // Helpers for SendToBatch(). Both return the number of datagrams sent, or
+  // SOCKET_ERROR.
+  int SendMultiple(rtc::ArrayView<const SendBuffer> buffers);
+  // Sends `buffers`, which share destination and size (except for a possibly
+  // shorter last one), as one UDP GSO (UDP_SEGMENT) super-datagram.
+  int SendSegmented(rtc::ArrayView<const SendBuffer> buffers);
+#endif
+
   PhysicalSocketServer* ss_;
   SOCKET s_;
   bool udp_;
@@ -217,6 +270,18 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
 
  private:
   uint8_t enabled_events_ = 0;
+#if defined(WEBRTC_LINUX)
+  // Set for UDP sockets that receive a SCM_TIMESTAMPNS control message with
+  // every datagram, which then replaces SIOCGSTAMP.
+  bool control_message_timestamps_ = false;
+#endif
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  // Cleared if the kernel or the egress device doesn't support UDP_SEGMENT.
+  bool udp_segmentation_enabled_ = true;
+  // Set once a UDP_SEGMENT send has succeeded, after which EIO is no longer
+  // taken to mean that the egress device doesn't support it.
+  bool udp_segmentation_succeeded_ = false;
+#endif
 };
 
 class SocketDispatcher : public Dispatcher, public PhysicalSocket {
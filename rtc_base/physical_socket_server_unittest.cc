@@ -14,15 +14,22 @@
 
 #include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "api/units/time_delta.h"
+#include "rtc_base/arraysize.h"
+#include "rtc_base/async_udp_socket.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/net_helpers.h"
+#include "rtc_base/network/received_packet_buffer.h"
 #include "rtc_base/network_monitor.h"
 #include "rtc_base/socket_unittest.h"
 #include "rtc_base/test_utils.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 namespace rtc {
@@ -58,6 +65,9 @@ class FakeSocketDispatcher : public SocketDispatcher {
                int flags,
                const struct sockaddr* dest_addr,
                socklen_t addrlen) override;
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  int DoSendMsg(SOCKET socket, const msghdr* msg, int flags) override;
+#endif
 };
 
 class FakePhysicalSocketServer : public PhysicalSocketServer {
@@ -114,6 +124,13 @@ class PhysicalSocketTest : public SocketTest {
   void SetMaxSendSize(int max_size) { max_send_size_ = max_size; }
   int MaxSendSize() const { return max_send_size_; }
 
+  // Error with which to fail the UDP GSO sends. Set to 0 to let them through.
+  void SetSegmentedSendError(int error) { segmented_send_error_ = error; }
+  int SegmentedSendError() const { return segmented_send_error_; }
+  // Number of UDP GSO sends attempted.
+  int segmented_sends() const { return segmented_sends_; }
+  void CountSegmentedSend() { ++segmented_sends_; }
+
  protected:
   PhysicalSocketTest()
       : SocketTest(&server_),
@@ -129,6 +146,8 @@ class PhysicalSocketTest : public SocketTest {
   rtc::AutoSocketServerThread thread_;
   bool fail_accept_;
   int max_send_size_;
+  int segmented_send_error_ = 0;
+  int segmented_sends_ = 0;
 };
 
 SOCKET FakeSocketDispatcher::DoAccept(SOCKET socket,
@@ -172,6 +191,24 @@ int FakeSocketDispatcher::DoSendTo(SOCKET socket,
                                     addrlen);
 }
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+int FakeSocketDispatcher::DoSendMsg(SOCKET socket,
+                                    const msghdr* msg,
+                                    int flags) {
+  FakePhysicalSocketServer* ss =
+      static_cast<FakePhysicalSocketServer*>(socketserver());
+  // Only UDP GSO sends carry a control message.
+  if (msg->msg_controllen > 0) {
+    ss->GetTest()->CountSegmentedSend();
+    if (ss->GetTest()->SegmentedSendError() != 0) {
+      errno = ss->GetTest()->SegmentedSendError();
+      return -1;
+    }
+  }
+  return SocketDispatcher::DoSendMsg(socket, msg, flags);
+}
+#endif
+
 TEST_F(PhysicalSocketTest, TestConnectIPv4) {
   MAYBE_SKIP_IPV4;
   SocketTest::TestConnectIPv4();
@@ -472,6 +509,397 @@ TEST_F(PhysicalSocketTest, TestSocketRecvTimestampIPv6) {
 }
 #endif
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+TEST_F(PhysicalSocketTest, RecvFromBatchReadsAllQueuedDatagrams) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  const std::string kPayloads[] = {"a", "bb", "ccc"};
+  for (const std::string& payload : kPayloads) {
+    ASSERT_EQ(static_cast<int>(payload.size()),
+              sender->SendTo(payload.data(), payload.size(),
+                             receiver->GetLocalAddress()));
+  }
+
+  // Loopback delivery is synchronous, so all datagrams are already queued.
+  char storage[4][16];
+  Socket::ReceiveBuffer buffers[4];
+  for (size_t i = 0; i < arraysize(buffers); ++i) {
+    buffers[i].data = storage[i];
+    buffers[i].capacity = sizeof(storage[i]);
+  }
+  ASSERT_EQ(3, receiver->RecvFromBatch(buffers));
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(kPayloads[i], std::string(buffers[i].data, buffers[i].length));
+    EXPECT_EQ(sender->GetLocalAddress(), buffers[i].source_address);
+    EXPECT_FALSE(buffers[i].truncated);
+  }
+
+  // Nothing left to read.
+  EXPECT_EQ(-1, receiver->RecvFromBatch(buffers));
+  EXPECT_TRUE(receiver->IsBlocking());
+}
+
+TEST_F(PhysicalSocketTest, RecvFromBatchReportsKernelTimestamps) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  const int64_t send_start_us = TimeUTCMicros();
+  for (int i = 0; i < 3; ++i) {
+    sender->SendTo("x", 1, receiver->GetLocalAddress());
+  }
+  const int64_t send_end_us = TimeUTCMicros();
+
+  char storage[3][16];
+  Socket::ReceiveBuffer buffers[3];
+  for (size_t i = 0; i < arraysize(buffers); ++i) {
+    buffers[i].data = storage[i];
+    buffers[i].capacity = sizeof(storage[i]);
+  }
+  ASSERT_EQ(3, receiver->RecvFromBatch(buffers));
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_GE(buffers[i].timestamp, send_start_us);
+    EXPECT_LE(buffers[i].timestamp, send_end_us);
+    if (i > 0) {
+      EXPECT_GE(buffers[i].timestamp, buffers[i - 1].timestamp);
+    }
+  }
+}
+
+TEST_F(PhysicalSocketTest, RecvFromBatchFlagsTruncatedDatagrams) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  const std::string kLong(32, 'x');
+  const std::string kShort = "y";
+  sender->SendTo(kLong.data(), kLong.size(), receiver->GetLocalAddress());
+  sender->SendTo(kShort.data(), kShort.size(), receiver->GetLocalAddress());
+
+  char storage[2][8];
+  Socket::ReceiveBuffer buffers[2];
+  for (size_t i = 0; i < arraysize(buffers); ++i) {
+    buffers[i].data = storage[i];
+    buffers[i].capacity = sizeof(storage[i]);
+  }
+  ASSERT_EQ(2, receiver->RecvFromBatch(buffers));
+  EXPECT_TRUE(buffers[0].truncated);
+  EXPECT_FALSE(buffers[1].truncated);
+  EXPECT_EQ(kShort, std::string(buffers[1].data, buffers[1].length));
+}
+
+class PacketCollector : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    packets.emplace_back(data, size);
+    packet_times_us.push_back(packet_time_us);
+  }
+
+  std::vector<std::string> packets;
+  std::vector<int64_t> packet_times_us;
+};
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketBatchedReceiveDrainsQueue) {
+  MAYBE_SKIP_IPV4;
+  Socket* receive_socket = server_.CreateSocket(AF_INET, SOCK_DGRAM);
+  std::unique_ptr<AsyncUDPSocket> receiver(AsyncUDPSocket::Create(
+      receive_socket, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+  receiver->SetReceiveBatchSize(8);
+  PacketCollector collector;
+  receiver->SignalReadPacket.connect(&collector,
+                                     &PacketCollector::OnReadPacket);
+
+  const std::string kPayloads[] = {"first", "second", "third"};
+  for (const std::string& payload : kPayloads) {
+    sender->SendTo(payload.data(), payload.size(),
+                   receiver->GetLocalAddress(), PacketOptions());
+  }
+
+  // A single read event delivers everything that is queued.
+  receive_socket->SignalReadEvent(receive_socket);
+  ASSERT_EQ(3u, collector.packets.size());
+  for (size_t i = 0; i < collector.packets.size(); ++i) {
+    EXPECT_EQ(kPayloads[i], collector.packets[i]);
+  }
+}
+
+// Turns off batched receive from a SignalReadPacket listener.
+class BatchingDisabler : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    static_cast<AsyncUDPSocket*>(socket)->SetReceiveBatchSize(1);
+  }
+};
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketDefersBatchResizeByListener) {
+  MAYBE_SKIP_IPV4;
+  Socket* receive_socket = server_.CreateSocket(AF_INET, SOCK_DGRAM);
+  std::unique_ptr<AsyncUDPSocket> receiver(AsyncUDPSocket::Create(
+      receive_socket, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+  receiver->SetReceiveBatchSize(8);
+  PacketCollector collector;
+  receiver->SignalReadPacket.connect(&collector,
+                                     &PacketCollector::OnReadPacket);
+  BatchingDisabler disabler;
+  receiver->SignalReadPacket.connect(&disabler,
+                                     &BatchingDisabler::OnReadPacket);
+
+  const std::string kPayloads[] = {"first", "second", "third"};
+  for (const std::string& payload : kPayloads) {
+    sender->SendTo(payload.data(), payload.size(),
+                   receiver->GetLocalAddress(), PacketOptions());
+  }
+  // The batch being delivered is not resized.
+  receive_socket->SignalReadEvent(receive_socket);
+  ASSERT_EQ(3u, collector.packets.size());
+
+  for (const std::string& payload : kPayloads) {
+    sender->SendTo(payload.data(), payload.size(),
+                   receiver->GetLocalAddress(), PacketOptions());
+  }
+  // The next read event reads a single datagram.
+  receive_socket->SignalReadEvent(receive_socket);
+  ASSERT_EQ(4u, collector.packets.size());
+  for (size_t i = 0; i < collector.packets.size(); ++i) {
+    EXPECT_EQ(kPayloads[i % 3], collector.packets[i]);
+  }
+}
+
+// Keeps received packets, taking them over from the socket if possible.
+class PacketTaker : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    delivered_data.push_back(data);
+    packets.push_back(ScopedReceivedPacketBuffer::TakeOrCopy(data, size));
+  }
+
+  std::vector<const char*> delivered_data;
+  std::vector<CopyOnWriteBuffer> packets;
+};
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketBatchedReceiveAvoidsCopies) {
+  MAYBE_SKIP_IPV4;
+  Socket* receive_socket = server_.CreateSocket(AF_INET, SOCK_DGRAM);
+  std::unique_ptr<AsyncUDPSocket> receiver(AsyncUDPSocket::Create(
+      receive_socket, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+  receiver->SetReceiveBatchSize(4);
+  PacketTaker taker;
+  receiver->SignalReadPacket.connect(&taker, &PacketTaker::OnReadPacket);
+
+  const ScopedReceivedPacketBuffer::Stats before =
+      ScopedReceivedPacketBuffer::GetStats();
+  const std::string kPayloads[] = {"first", "second"};
+  for (int round = 0; round < 2; ++round) {
+    for (const std::string& payload : kPayloads) {
+      sender->SendTo(payload.data(), payload.size(),
+                     receiver->GetLocalAddress(), PacketOptions());
+    }
+    receive_socket->SignalReadEvent(receive_socket);
+  }
+
+  ASSERT_EQ(4u, taker.packets.size());
+  for (size_t i = 0; i < taker.packets.size(); ++i) {
+    EXPECT_EQ(kPayloads[i % 2], std::string(taker.packets[i].data<char>(),
+                                            taker.packets[i].size()));
+    // The packet is still in the buffer the socket read it into.
+    EXPECT_EQ(taker.delivered_data[i], taker.packets[i].data<char>());
+  }
+  const ScopedReceivedPacketBuffer::Stats after =
+      ScopedReceivedPacketBuffer::GetStats();
+  EXPECT_EQ(before.taken + 4, after.taken);
+  EXPECT_EQ(before.copies, after.copies);
+  // The first read allocates all buffers, the second only replaces the two
+  // that were taken.
+  EXPECT_EQ(before.allocations + 6, after.allocations);
+}
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketReportsPacketTimeInTimeMicros) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  ASSERT_TRUE(sender);
+  PacketCollector collector;
+  receiver->SignalReadPacket.connect(&collector,
+                                     &PacketCollector::OnReadPacket);
+
+  const int64_t send_time_us = TimeMicros();
+  sender->SendTo("x", 1, receiver->GetLocalAddress(), PacketOptions());
+  // Keep the packet queued for a while, which the packet time must not
+  // include.
+  Thread::SleepMs(50);
+  ASSERT_TRUE(server_.Wait(webrtc::TimeDelta::Zero(), /*process_io=*/true));
+  const int64_t read_time_us = TimeMicros();
+  ASSERT_EQ(1u, collector.packet_times_us.size());
+  EXPECT_GE(collector.packet_times_us[0], send_time_us);
+  EXPECT_LT(collector.packet_times_us[0], read_time_us - 40000);
+}
+
+TEST_F(PhysicalSocketTest, SendToBatchSendsSeparateDatagrams) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  // The first three datagrams can be sent as one UDP GSO super-datagram, the
+  // last one can't since it is larger.
+  const std::string kPayloads[] = {"aaaa", "bbbb", "cc", "dddddd"};
+  std::vector<Socket::SendBuffer> send_buffers;
+  for (const std::string& payload : kPayloads) {
+    send_buffers.push_back(
+        {payload.data(), payload.size(), receiver->GetLocalAddress()});
+  }
+  EXPECT_EQ(4, sender->SendToBatch(send_buffers));
+
+  char storage[8][16];
+  Socket::ReceiveBuffer buffers[8];
+  for (size_t i = 0; i < arraysize(buffers); ++i) {
+    buffers[i].data = storage[i];
+    buffers[i].capacity = sizeof(storage[i]);
+  }
+  ASSERT_EQ(4, receiver->RecvFromBatch(buffers));
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(kPayloads[i], std::string(buffers[i].data, buffers[i].length));
+  }
+}
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+// A batch rejected with EINVAL is sent without UDP GSO, but the next batch
+// is tried with it again. Only errors meaning that GSO is not supported turn
+// it off for the socket.
+TEST_F(PhysicalSocketTest, SendToBatchOnlyDisablesSegmentationIfUnsupported) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  const std::string kPayloads[] = {"aaaa", "bbbb", "cccc"};
+  std::vector<Socket::SendBuffer> send_buffers;
+  for (const std::string& payload : kPayloads) {
+    send_buffers.push_back(
+        {payload.data(), payload.size(), receiver->GetLocalAddress()});
+  }
+  char storage[8][16];
+  Socket::ReceiveBuffer buffers[8];
+  for (size_t i = 0; i < arraysize(buffers); ++i) {
+    buffers[i].data = storage[i];
+    buffers[i].capacity = sizeof(storage[i]);
+  }
+  auto send_and_receive = [&] {
+    EXPECT_EQ(3, sender->SendToBatch(send_buffers));
+    ASSERT_EQ(3, receiver->RecvFromBatch(buffers));
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(kPayloads[i], std::string(buffers[i].data, buffers[i].length));
+    }
+  };
+
+  SetSegmentedSendError(EINVAL);
+  send_and_receive();
+  EXPECT_EQ(1, segmented_sends());
+  send_and_receive();
+  EXPECT_EQ(2, segmented_sends());
+
+  SetSegmentedSendError(EOPNOTSUPP);
+  send_and_receive();
+  EXPECT_EQ(3, segmented_sends());
+  send_and_receive();
+  EXPECT_EQ(3, segmented_sends());
+}
+#endif
+
+class SentPacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnSentPacket(AsyncPacketSocket* socket, const SentPacket& packet) {
+    ++sent_packets;
+  }
+
+  int sent_packets = 0;
+};
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketHoldsBatchableSendsUntilLastPacket) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+  SentPacketCounter counter;
+  sender->SignalSentPacket.connect(&counter, &SentPacketCounter::OnSentPacket);
+
+  PacketOptions options;
+  options.batchable = true;
+  const SocketAddress destination = receiver->GetLocalAddress();
+  EXPECT_EQ(1, sender->SendTo("a", 1, destination, options));
+  EXPECT_EQ(1, sender->SendTo("b", 1, destination, options));
+  EXPECT_EQ(0, counter.sent_packets);
+  char buffer[16];
+  EXPECT_EQ(-1, receiver->RecvFrom(buffer, sizeof(buffer), nullptr, nullptr));
+
+  options.last_packet_in_batch = true;
+  EXPECT_EQ(1, sender->SendTo("c", 1, destination, options));
+  EXPECT_EQ(3, counter.sent_packets);
+  for (char expected : {'a', 'b', 'c'}) {
+    ASSERT_EQ(1, receiver->RecvFrom(buffer, sizeof(buffer), nullptr, nullptr));
+    EXPECT_EQ(expected, buffer[0]);
+  }
+}
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketFlushesUnterminatedBatch) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+
+  PacketOptions options;
+  options.batchable = true;
+  sender->SendTo("a", 1, receiver->GetLocalAddress(), options);
+  char buffer[16];
+  EXPECT_EQ(-1, receiver->RecvFrom(buffer, sizeof(buffer), nullptr, nullptr));
+
+  // The batch is flushed once the current task has finished.
+  thread_.ProcessMessages(0);
+  EXPECT_EQ(1, receiver->RecvFrom(buffer, sizeof(buffer), nullptr, nullptr));
+}
+#endif  // defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
 // Verify that if the socket was unable to be bound to a real network interface
 // (not loopback), Bind will return an error.
 TEST_F(PhysicalSocketTest,
@@ -61,7 +61,16 @@ scoped_refptr<RTCCertificate> RTCCertificateGenerator::GenerateCertificate(
 
 RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
                                                  Thread* worker_thread)
-    : signaling_thread_(signaling_thread), worker_thread_(worker_thread) {
+    : RTCCertificateGenerator(signaling_thread,
+                              worker_thread,
+                              /*pool=*/nullptr) {}
+
+RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
+                                                 Thread* worker_thread,
+                                                 RTCCertificatePool* pool)
+    : signaling_thread_(signaling_thread),
+      worker_thread_(worker_thread),
+      pool_(pool) {
   RTC_DCHECK(signaling_thread_);
   RTC_DCHECK(worker_thread_);
 }
@@ -73,6 +82,18 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
   RTC_DCHECK(signaling_thread_->IsCurrent());
   RTC_DCHECK(callback);
 
+  if (pool_ && !expires_ms) {
+    scoped_refptr<RTCCertificate> certificate = pool_->Take(key_params);
+    if (certificate) {
+      // Still complete asynchronously, like when generating.
+      signaling_thread_->PostTask(
+          [cert = std::move(certificate), cb = std::move(callback)]() mutable {
+            std::move(cb)(std::move(cert));
+          });
+      return;
+    }
+  }
+
   worker_thread_->PostTask([key_params, expires_ms,
                             signaling_thread = signaling_thread_,
                             cb = std::move(callback)]() mutable {
@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/rtc_certificate_pool.h"
+
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/metrics.h"
+
+namespace rtc {
+namespace {
+
+// Certificates which expire within this time are not handed out, so that
+// callers do not end up with one that expires during the call.
+constexpr uint64_t kMinRemainingLifetimeMs = 24 * 60 * 60 * 1000;
+
+bool SameKeyParams(const KeyParams& a, const KeyParams& b) {
+  if (a.type() != b.type()) {
+    return false;
+  }
+  if (a.type() == KT_RSA) {
+    return a.rsa_params().mod_size == b.rsa_params().mod_size &&
+           a.rsa_params().pub_exp == b.rsa_params().pub_exp;
+  }
+  return a.ec_curve() == b.ec_curve();
+}
+
+}  // namespace
+
+RTCCertificatePool::RTCCertificatePool(
+    webrtc::TaskQueueFactory* task_queue_factory,
+    size_t size,
+    const KeyParams& key_params)
+    : key_params_(key_params),
+      size_(size),
+      refill_queue_(task_queue_factory->CreateTaskQueue(
+          "RTCCertificatePool",
+          webrtc::TaskQueueFactory::Priority::LOW)) {
+  RTC_DCHECK(key_params_.IsValid());
+  webrtc::MutexLock lock(&lock_);
+  MaybeStartRefill();
+}
+
+RTCCertificatePool::~RTCCertificatePool() = default;
+
+scoped_refptr<RTCCertificate> RTCCertificatePool::Take(
+    const KeyParams& key_params) {
+  scoped_refptr<RTCCertificate> certificate;
+  if (SameKeyParams(key_params, key_params_)) {
+    const uint64_t min_expires = TimeUTCMillis() + kMinRemainingLifetimeMs;
+    webrtc::MutexLock lock(&lock_);
+    while (!certificates_.empty() && !certificate) {
+      certificate = std::move(certificates_.back());
+      certificates_.pop_back();
+      if (certificate->HasExpired(min_expires)) {
+        certificate = nullptr;
+      }
+    }
+    MaybeStartRefill();
+  }
+  (certificate ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+  RTC_HISTOGRAM_BOOLEAN("WebRTC.CertificatePool.Hit", certificate != nullptr);
+  return certificate;
+}
+
+size_t RTCCertificatePool::available() const {
+  webrtc::MutexLock lock(&lock_);
+  return certificates_.size();
+}
+
+RTCCertificatePool::Stats RTCCertificatePool::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void RTCCertificatePool::MaybeStartRefill() {
+  if (refilling_ || certificates_.size() >= size_) {
+    return;
+  }
+  refilling_ = true;
+  refill_queue_.PostTask([this] { Refill(); });
+}
+
+void RTCCertificatePool::Refill() {
+  scoped_refptr<RTCCertificate> certificate =
+      RTCCertificateGenerator::GenerateCertificate(key_params_, absl::nullopt);
+  webrtc::MutexLock lock(&lock_);
+  if (!certificate) {
+    RTC_LOG(LS_WARNING) << "Failed to generate a certificate for the pool.";
+    refilling_ = false;
+    return;
+  }
+  certificates_.push_back(std::move(certificate));
+  if (certificates_.size() < size_) {
+    refill_queue_.PostTask([this] { Refill(); });
+  } else {
+    refilling_ = false;
+  }
+}
+
+}  // namespace rtc
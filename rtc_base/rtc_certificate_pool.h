@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_RTC_CERTIFICATE_POOL_H_
+#define RTC_BASE_RTC_CERTIFICATE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "rtc_base/rtc_certificate.h"
+#include "rtc_base/ssl_identity.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// Keeps a number of certificates generated ahead of time, so that setting up a
+// call does not have to wait for key generation. Taking a certificate from the
+// pool makes it generate a new one on a low priority task queue. Certificates
+// are generated with the default expiration time. Thread safe.
+class RTC_EXPORT RTCCertificatePool {
+ public:
+  struct Stats {
+    // Certificates handed out by Take().
+    uint64_t hits = 0;
+    // Calls to Take() which returned null, so that the caller had to generate
+    // a certificate itself.
+    uint64_t misses = 0;
+  };
+
+  // Starts generating `size` certificates with `key_params`.
+  RTCCertificatePool(webrtc::TaskQueueFactory* task_queue_factory,
+                     size_t size,
+                     const KeyParams& key_params = KeyParams());
+  ~RTCCertificatePool();
+
+  RTCCertificatePool(const RTCCertificatePool&) = delete;
+  RTCCertificatePool& operator=(const RTCCertificatePool&) = delete;
+
+  // Returns a certificate with `key_params`, or null if the pool has none.
+  scoped_refptr<RTCCertificate> Take(const KeyParams& key_params);
+
+  // Returns the number of certificates ready to be taken.
+  size_t available() const;
+
+  // Hits and misses are also reported to the WebRTC.CertificatePool.Hit
+  // histogram.
+  Stats GetStats() const;
+
+ private:
+  void MaybeStartRefill() RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Generates one certificate, and posts itself again until the pool is full.
+  void Refill();
+
+  const KeyParams key_params_;
+  const size_t size_;
+
+  mutable webrtc::Mutex lock_;
+  std::vector<scoped_refptr<RTCCertificate>> certificates_
+      RTC_GUARDED_BY(lock_);
+  bool refilling_ RTC_GUARDED_BY(lock_) = false;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+
+  // Declared last, so that it is destroyed, and stops running Refill(), before
+  // the other members.
+  TaskQueue refill_queue_;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_RTC_CERTIFICATE_POOL_H_
@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/rtc_certificate_pool.h"
+
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/task_queue/default_task_queue_factory.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/thread.h"
+#include "system_wrappers/include/metrics.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kGenerationTimeoutMs = 10000;
+
+constexpr char kHitHistogram[] = "WebRTC.CertificatePool.Hit";
+
+class RTCCertificatePoolTest : public ::testing::Test {
+ protected:
+  RTCCertificatePoolTest() { webrtc::metrics::Reset(); }
+
+  rtc::AutoThread main_thread_;
+  std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory_ =
+      webrtc::CreateDefaultTaskQueueFactory();
+};
+
+TEST_F(RTCCertificatePoolTest, FillsUpAndRefills) {
+  RTCCertificatePool pool(task_queue_factory_.get(), 2);
+  EXPECT_EQ_WAIT(2u, pool.available(), kGenerationTimeoutMs);
+
+  scoped_refptr<RTCCertificate> certificate = pool.Take(KeyParams());
+  ASSERT_TRUE(certificate);
+  EXPECT_NE(certificate, pool.Take(KeyParams()));
+  EXPECT_EQ(2u, pool.GetStats().hits);
+  EXPECT_EQ(0u, pool.GetStats().misses);
+  EXPECT_METRIC_EQ(2, webrtc::metrics::NumEvents(kHitHistogram, 1));
+  EXPECT_METRIC_EQ(0, webrtc::metrics::NumEvents(kHitHistogram, 0));
+
+  EXPECT_EQ_WAIT(2u, pool.available(), kGenerationTimeoutMs);
+}
+
+TEST_F(RTCCertificatePoolTest, MissesWhenEmpty) {
+  RTCCertificatePool pool(task_queue_factory_.get(), 0);
+  EXPECT_FALSE(pool.Take(KeyParams()));
+  EXPECT_EQ(0u, pool.GetStats().hits);
+  EXPECT_EQ(1u, pool.GetStats().misses);
+  EXPECT_METRIC_EQ(0, webrtc::metrics::NumEvents(kHitHistogram, 1));
+  EXPECT_METRIC_EQ(1, webrtc::metrics::NumEvents(kHitHistogram, 0));
+}
+
+TEST_F(RTCCertificatePoolTest, MissesForOtherKeyParams) {
+  RTCCertificatePool pool(task_queue_factory_.get(), 1, KeyParams::ECDSA());
+  EXPECT_EQ_WAIT(1u, pool.available(), kGenerationTimeoutMs);
+  EXPECT_FALSE(pool.Take(KeyParams::RSA()));
+  EXPECT_EQ(1u, pool.available());
+  EXPECT_EQ(1u, pool.GetStats().misses);
+}
+
+TEST_F(RTCCertificatePoolTest, GeneratorTakesCertificatesFromPool) {
+  std::unique_ptr<Thread> worker_thread = Thread::Create();
+  ASSERT_TRUE(worker_thread->Start());
+  RTCCertificatePool pool(task_queue_factory_.get(), 1);
+  RTCCertificateGenerator generator(Thread::Current(), worker_thread.get(),
+                                    &pool);
+  EXPECT_EQ_WAIT(1u, pool.available(), kGenerationTimeoutMs);
+
+  scoped_refptr<RTCCertificate> certificate;
+  bool completed = false;
+  generator.GenerateCertificateAsync(
+      KeyParams(), absl::nullopt,
+      [&](scoped_refptr<RTCCertificate> generated) {
+        certificate = std::move(generated);
+        completed = true;
+      });
+  EXPECT_TRUE_WAIT(completed, kGenerationTimeoutMs);
+  EXPECT_TRUE(certificate);
+  EXPECT_EQ(1u, pool.GetStats().hits);
+
+  // Certificates with a custom expiration time are always generated.
+  completed = false;
+  generator.GenerateCertificateAsync(
+      KeyParams(), 60000, [&](scoped_refptr<RTCCertificate> generated) {
+        certificate = std::move(generated);
+        completed = true;
+      });
+  EXPECT_TRUE_WAIT(completed, kGenerationTimeoutMs);
+  EXPECT_TRUE(certificate);
+  EXPECT_EQ(1u, pool.GetStats().hits);
+  EXPECT_EQ(0u, pool.GetStats().misses);
+}
+
+}  // namespace
+}  // namespace rtc
@@ -10,4 +10,32 @@
 
 #include "rtc_base/socket.h"
 
-namespace rtc {}  // namespace rtc
+namespace rtc {
+
+int Socket::SendToBatch(rtc::ArrayView<const SendBuffer> buffers) {
+  int sent = 0;
+  for (const SendBuffer& buffer : buffers) {
+    if (SendTo(buffer.data, buffer.length, buffer.destination) < 0) {
+      break;
+    }
+    ++sent;
+  }
+  return (sent == 0 && !buffers.empty()) ? SOCKET_ERROR : sent;
+}
+
+int Socket::RecvFromBatch(rtc::ArrayView<ReceiveBuffer> buffers) {
+  if (buffers.empty()) {
+    return 0;
+  }
+  ReceiveBuffer& buffer = buffers[0];
+  int received = RecvFrom(buffer.data, buffer.capacity, &buffer.source_address,
+                          &buffer.timestamp);
+  if (received < 0) {
+    return received;
+  }
+  buffer.length = static_cast<size_t>(received);
+  buffer.truncated = false;
+  return 1;
+}
+
+}  // namespace rtc
@@ -25,6 +25,7 @@
 #include "rtc_base/win32.h"
 #endif
 
+#include "api/array_view.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 
@@ -97,12 +98,45 @@ class Socket {
   virtual int Connect(const SocketAddress& addr) = 0;
   virtual int Send(const void* pv, size_t cb) = 0;
   virtual int SendTo(const void* pv, size_t cb, const SocketAddress& addr) = 0;
-  // `timestamp` is in units of microseconds.
+
+  // A datagram to be sent by SendToBatch().
+  struct SendBuffer {
+    const char* data = nullptr;
+    size_t length = 0;
+    SocketAddress destination;
+  };
+  // Sends each of `buffers` as a separate datagram, using as few system calls
+  // as the platform supports. Returns the number of datagrams sent, which may
+  // be less than `buffers.size()`, or SOCKET_ERROR if none could be sent (see
+  // GetError()). The default implementation calls SendTo() for each datagram.
+  virtual int SendToBatch(rtc::ArrayView<const SendBuffer> buffers);
+
+  // `timestamp` is the kernel receive time in microseconds of the system
+  // (UTC) clock, or -1 if unavailable.
   virtual int Recv(void* pv, size_t cb, int64_t* timestamp) = 0;
   virtual int RecvFrom(void* pv,
                        size_t cb,
                        SocketAddress* paddr,
                        int64_t* timestamp) = 0;
+
+  // A caller-owned slot for one datagram read by RecvFromBatch().
+  struct ReceiveBuffer {
+    char* data = nullptr;
+    size_t capacity = 0;
+    // Filled in by RecvFromBatch().
+    size_t length = 0;
+    SocketAddress source_address;
+    // Kernel receive time like for RecvFrom(), or -1 if unavailable.
+    int64_t timestamp = -1;
+    // True if the datagram did not fit in `capacity` bytes.
+    bool truncated = false;
+  };
+  // Reads up to `buffers.size()` datagrams that are already queued on the
+  // socket, using a single system call where the platform supports it.
+  // Returns the number of datagrams read, or SOCKET_ERROR (see GetError()).
+  // The default implementation reads a single datagram with RecvFrom().
+  virtual int RecvFromBatch(rtc::ArrayView<ReceiveBuffer> buffers);
+
   virtual int Listen(int backlog) = 0;
   virtual Socket* Accept(SocketAddress* paddr) = 0;
   virtual int Close() = 0;
@@ -123,6 +157,9 @@ class Socket {
     OPT_RTP_SENDTIME_EXTN_ID,  // This is a non-traditional socket option param.
                                // This is specific to libjingle and will be used
                                // if SendTime option is needed at socket level.
+    OPT_REUSEPORT,             // Whether other sockets may bind the same
+                               // address and port, which must be set before
+                               // Bind(). Only supported on Linux.
   };
   virtual int GetOption(Option opt, int* value) = 0;
   virtual int SetOption(Option opt, int value) = 0;
@@ -28,32 +28,67 @@
 #error Unsupported platform.
 #endif
 
+#if defined(WEBRTC_MUTEX_PROFILING)
+#include "rtc_base/synchronization/mutex_profiler.h"  // nogncheck
+#endif
+
 namespace webrtc {
 
 // The Mutex guarantees exclusive access and aims to follow Abseil semantics
 // (i.e. non-reentrant etc).
+//
+// In builds with WEBRTC_MUTEX_PROFILING, Lock() and TryLock() also record the
+// source location of their caller, see mutex_profiler.h.
 class RTC_LOCKABLE Mutex final {
  public:
   Mutex() = default;
   Mutex(const Mutex&) = delete;
   Mutex& operator=(const Mutex&) = delete;
 
+#if defined(WEBRTC_MUTEX_PROFILING)
+  void Lock(const char* file = __builtin_FILE(),
+            int line = __builtin_LINE()) RTC_EXCLUSIVE_LOCK_FUNCTION() {
+    int64_t wait_start_ns = -1;
+    if (!impl_.TryLock()) {
+      wait_start_ns = MutexAcquisitionRecorder::NowNs();
+      impl_.Lock();
+    }
+    recorder_.OnAcquired(file, line, wait_start_ns);
+  }
+  ABSL_MUST_USE_RESULT bool TryLock(const char* file = __builtin_FILE(),
+                                    int line = __builtin_LINE())
+      RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
+    if (!impl_.TryLock()) {
+      return false;
+    }
+    recorder_.OnAcquired(file, line, -1);
+    return true;
+  }
+#else
   void Lock() RTC_EXCLUSIVE_LOCK_FUNCTION() {
     impl_.Lock();
   }
   ABSL_MUST_USE_RESULT bool TryLock() RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
     return impl_.TryLock();
   }
+#endif
   // Return immediately if this thread holds the mutex, or RTC_DCHECK_IS_ON==0.
   // Otherwise, may report an error (typically by crashing with a diagnostic),
   // or may return immediately.
   void AssertHeld() const RTC_ASSERT_EXCLUSIVE_LOCK() { impl_.AssertHeld(); }
   void Unlock() RTC_UNLOCK_FUNCTION() {
+#if defined(WEBRTC_MUTEX_PROFILING)
+    recorder_.OnReleasing();
+#endif
     impl_.Unlock();
   }
 
  private:
   MutexImpl impl_;
+#if defined(WEBRTC_MUTEX_PROFILING)
+  // Only accessed with `impl_` held.
+  MutexAcquisitionRecorder recorder_;
+#endif
 };
 
 // MutexLock, for serializing execution through a scope.
@@ -62,10 +97,20 @@ class RTC_SCOPED_LOCKABLE MutexLock final {
   MutexLock(const MutexLock&) = delete;
   MutexLock& operator=(const MutexLock&) = delete;
 
+#if defined(WEBRTC_MUTEX_PROFILING)
+  explicit MutexLock(Mutex* mutex,
+                     const char* file = __builtin_FILE(),
+                     int line = __builtin_LINE())
+      RTC_EXCLUSIVE_LOCK_FUNCTION(mutex)
+      : mutex_(mutex) {
+    mutex->Lock(file, line);
+  }
+#else
   explicit MutexLock(Mutex* mutex) RTC_EXCLUSIVE_LOCK_FUNCTION(mutex)
       : mutex_(mutex) {
     mutex->Lock();
   }
+#endif
   ~MutexLock() RTC_UNLOCK_FUNCTION() { mutex_->Unlock(); }
 
  private:
@@ -10,6 +10,7 @@
 
 #include "benchmark/benchmark.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/synchronization/mutex_profiler.h"
 #include "rtc_base/system/unused.h"
 
 namespace webrtc {
@@ -47,6 +48,18 @@ BENCHMARK(BM_LockWithMutex)->Threads(2);
 BENCHMARK(BM_LockWithMutex)->Threads(4);
 BENCHMARK(BM_LockWithMutex)->ThreadPerCpu();
 
+// Cost that WEBRTC_MUTEX_PROFILING adds to each uncontended Lock()/Unlock().
+void BM_RecordMutexAcquisition(benchmark::State& state) {
+  MutexAcquisitionRecorder recorder;
+  for (auto s : state) {
+    RTC_UNUSED(s);
+    recorder.OnAcquired(__FILE__, __LINE__, -1);
+    recorder.OnReleasing();
+  }
+}
+
+BENCHMARK(BM_RecordMutexAcquisition);
+
 }  // namespace webrtc
 
 /*
@@ -92,4 +105,11 @@ BM_LockWithMutex/threads:2        91.1 ns          182 ns      4059212
 BM_LockWithMutex/threads:4        40.8 ns          131 ns      5496560
 BM_LockWithMutex/threads:12       37.0 ns          130 ns      5377668
 
+Profiling overhead (Linux, 1 X vCPU):
+----------------------------------------------------------------------
+Benchmark                            Time             CPU   Iterations
+----------------------------------------------------------------------
+BM_LockWithMutex/threads:1        13.0 ns         12.6 ns     54782966
+BM_RecordMutexAcquisition          108 ns          103 ns      6625079
+
 */
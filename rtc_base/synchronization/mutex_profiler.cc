@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/mutex_profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace webrtc {
+namespace mutex_profiler_impl {
+
+// Statistics of one source location that locks mutexes. Sites live in a fixed
+// size hash table and are never removed, so that they can be found and
+// updated without locking.
+struct Site {
+  // Null while the entry is unused. `line` is published after `file`, and is
+  // -1 until then.
+  std::atomic<const char*> file{nullptr};
+  std::atomic<int> line{-1};
+
+  std::atomic<uint64_t> acquisitions{0};
+  std::atomic<uint64_t> contended_acquisitions{0};
+  std::atomic<int64_t> total_wait_ns{0};
+  std::atomic<int64_t> max_wait_ns{0};
+  std::atomic<uint64_t> wait_histogram[MutexSiteStats::kWaitHistogramBuckets];
+  std::atomic<int64_t> total_hold_ns{0};
+  std::atomic<int64_t> max_hold_ns{0};
+};
+
+}  // namespace mutex_profiler_impl
+
+namespace {
+
+using mutex_profiler_impl::Site;
+
+constexpr size_t kMaxSites = 1024;
+Site sites[kMaxSites];
+// Used for all locations once the table is full.
+Site overflow_site;
+const char kOverflowFile[] = "(other)";
+
+void UpdateMax(std::atomic<int64_t>& max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+int WaitHistogramBucket(int64_t wait_ns) {
+  int64_t wait_us = wait_ns / 1000;
+  int bucket = 0;
+  while (wait_us > 0 && bucket < MutexSiteStats::kWaitHistogramBuckets - 1) {
+    wait_us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+Site* FindOrAddSite(const char* file, int line) {
+  uint64_t hash = reinterpret_cast<uintptr_t>(file) * 31 + line;
+  hash *= 0x9e3779b97f4a7c15;
+  size_t index = static_cast<size_t>(hash >> 32) % kMaxSites;
+  for (size_t probe = 0; probe < kMaxSites; ++probe) {
+    Site& site = sites[(index + probe) % kMaxSites];
+    const char* site_file = site.file.load(std::memory_order_acquire);
+    if (site_file == nullptr) {
+      if (site.file.compare_exchange_strong(site_file, file,
+                                            std::memory_order_acq_rel)) {
+        site.line.store(line, std::memory_order_release);
+        return &site;
+      }
+      // Another thread took the entry, `site_file` is its location.
+    }
+    if (site_file == file) {
+      int site_line;
+      while ((site_line = site.line.load(std::memory_order_acquire)) == -1) {
+        // Being published by another thread.
+      }
+      if (site_line == line) {
+        return &site;
+      }
+    }
+  }
+  return &overflow_site;
+}
+
+MutexSiteStats GetStats(const Site& site) {
+  MutexSiteStats stats;
+  stats.file = site.file.load(std::memory_order_acquire);
+  stats.line = site.line.load(std::memory_order_acquire);
+  stats.acquisitions = site.acquisitions.load(std::memory_order_relaxed);
+  stats.contended_acquisitions =
+      site.contended_acquisitions.load(std::memory_order_relaxed);
+  stats.total_wait_ns = site.total_wait_ns.load(std::memory_order_relaxed);
+  stats.max_wait_ns = site.max_wait_ns.load(std::memory_order_relaxed);
+  for (int i = 0; i < MutexSiteStats::kWaitHistogramBuckets; ++i) {
+    stats.wait_histogram[i] =
+        site.wait_histogram[i].load(std::memory_order_relaxed);
+  }
+  stats.total_hold_ns = site.total_hold_ns.load(std::memory_order_relaxed);
+  stats.max_hold_ns = site.max_hold_ns.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ResetSite(Site& site) {
+  site.acquisitions.store(0, std::memory_order_relaxed);
+  site.contended_acquisitions.store(0, std::memory_order_relaxed);
+  site.total_wait_ns.store(0, std::memory_order_relaxed);
+  site.max_wait_ns.store(0, std::memory_order_relaxed);
+  for (std::atomic<uint64_t>& count : site.wait_histogram) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  site.total_hold_ns.store(0, std::memory_order_relaxed);
+  site.max_hold_ns.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+std::vector<MutexSiteStats> GetTopContendedMutexSites(size_t max_sites) {
+  std::vector<MutexSiteStats> result;
+  for (const Site& site : sites) {
+    if (site.line.load(std::memory_order_acquire) != -1 &&
+        site.acquisitions.load(std::memory_order_relaxed) > 0) {
+      result.push_back(GetStats(site));
+    }
+  }
+  if (overflow_site.acquisitions.load(std::memory_order_relaxed) > 0) {
+    result.push_back(GetStats(overflow_site));
+    result.back().file = kOverflowFile;
+  }
+  std::sort(result.begin(), result.end(),
+            [](const MutexSiteStats& a, const MutexSiteStats& b) {
+              if (a.total_wait_ns != b.total_wait_ns) {
+                return a.total_wait_ns > b.total_wait_ns;
+              }
+              return a.contended_acquisitions > b.contended_acquisitions;
+            });
+  if (result.size() > max_sites) {
+    result.resize(max_sites);
+  }
+  return result;
+}
+
+std::string DumpTopContendedMutexSites(size_t max_sites) {
+  std::string dump;
+  for (const MutexSiteStats& stats : GetTopContendedMutexSites(max_sites)) {
+    char line[512];
+    snprintf(line, sizeof(line),
+             "%s:%d acquisitions=%llu contended=%llu wait_total_us=%lld "
+             "wait_max_us=%lld hold_total_us=%lld hold_max_us=%lld\n",
+             stats.file.c_str(), stats.line,
+             static_cast<unsigned long long>(stats.acquisitions),
+             static_cast<unsigned long long>(stats.contended_acquisitions),
+             static_cast<long long>(stats.total_wait_ns / 1000),
+             static_cast<long long>(stats.max_wait_ns / 1000),
+             static_cast<long long>(stats.total_hold_ns / 1000),
+             static_cast<long long>(stats.max_hold_ns / 1000));
+    dump += line;
+  }
+  return dump;
+}
+
+void ResetMutexSiteStats() {
+  for (Site& site : sites) {
+    ResetSite(site);
+  }
+  ResetSite(overflow_site);
+}
+
+int64_t MutexAcquisitionRecorder::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void MutexAcquisitionRecorder::OnAcquired(const char* file,
+                                          int line,
+                                          int64_t wait_start_ns) {
+  site_ = FindOrAddSite(file, line);
+  acquired_ns_ = NowNs();
+  site_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+  if (wait_start_ns >= 0) {
+    int64_t wait_ns = acquired_ns_ - wait_start_ns;
+    site_->contended_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    site_->total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    UpdateMax(site_->max_wait_ns, wait_ns);
+    site_->wait_histogram[WaitHistogramBucket(wait_ns)].fetch_add(
+        1, std::memory_order_relaxed);
+  } else {
+    site_->wait_histogram[0].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void MutexAcquisitionRecorder::OnReleasing() {
+  int64_t hold_ns = NowNs() - acquired_ns_;
+  site_->total_hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+  UpdateMax(site_->max_hold_ns, hold_ns);
+}
+
+}  // namespace webrtc
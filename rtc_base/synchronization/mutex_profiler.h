@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_SYNCHRONIZATION_MUTEX_PROFILER_H_
+#define RTC_BASE_SYNCHRONIZATION_MUTEX_PROFILER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "rtc_base/system/rtc_export.h"
+
+// Contention profiling for webrtc::Mutex. When built with the GN arg
+// rtc_enable_mutex_profiling = true (which defines WEBRTC_MUTEX_PROFILING),
+// every Mutex records, per source location that locks it, how often it was
+// acquired, how long acquisitions waited for it and how long it was held.
+// Otherwise Mutex is unchanged and nothing is recorded.
+
+namespace webrtc {
+
+namespace mutex_profiler_impl {
+struct Site;
+}  // namespace mutex_profiler_impl
+
+struct MutexSiteStats {
+  // Waits are counted in bucket 0 if shorter than 1 us, and in bucket i if
+  // between 2^(i-1) and 2^i us. The last bucket also counts longer waits.
+  static constexpr int kWaitHistogramBuckets = 16;
+
+  std::string file;
+  int line = 0;
+  uint64_t acquisitions = 0;
+  // Acquisitions which found the mutex locked and had to wait.
+  uint64_t contended_acquisitions = 0;
+  int64_t total_wait_ns = 0;
+  int64_t max_wait_ns = 0;
+  std::array<uint64_t, kWaitHistogramBuckets> wait_histogram = {};
+  int64_t total_hold_ns = 0;
+  int64_t max_hold_ns = 0;
+};
+
+// Returns true if Mutex records contention in this build.
+constexpr bool IsMutexProfilingEnabled() {
+#if defined(WEBRTC_MUTEX_PROFILING)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Returns up to `max_sites` lock sites, ordered by total wait time.
+RTC_EXPORT std::vector<MutexSiteStats> GetTopContendedMutexSites(
+    size_t max_sites);
+
+// Formats GetTopContendedMutexSites() as one line per site, for logging.
+RTC_EXPORT std::string DumpTopContendedMutexSites(size_t max_sites);
+
+// Clears the statistics of all lock sites.
+RTC_EXPORT void ResetMutexSiteStats();
+
+// Records the acquisitions of one mutex. Used by Mutex in profiling builds;
+// all calls happen with the mutex held, except for NowNs().
+class RTC_EXPORT MutexAcquisitionRecorder {
+ public:
+  static int64_t NowNs();
+
+  // `wait_start_ns` is the NowNs() at which a contended acquisition started
+  // waiting, or -1 if the mutex was acquired without waiting.
+  void OnAcquired(const char* file, int line, int64_t wait_start_ns);
+  void OnReleasing();
+
+ private:
+  mutex_profiler_impl::Site* site_ = nullptr;
+  int64_t acquired_ns_ = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_SYNCHRONIZATION_MUTEX_PROFILER_H_
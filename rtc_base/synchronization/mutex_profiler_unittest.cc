@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/mutex_profiler.h"
+
+#include <string>
+#include <vector>
+
+#include "rtc_base/synchronization/mutex.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::HasSubstr;
+
+constexpr char kFile[] = "mutex_profiler_unittest_site.cc";
+
+const MutexSiteStats* FindSite(const std::vector<MutexSiteStats>& sites,
+                               const std::string& file,
+                               int line) {
+  for (const MutexSiteStats& site : sites) {
+    if (site.file == file && site.line == line) {
+      return &site;
+    }
+  }
+  return nullptr;
+}
+
+TEST(MutexProfilerTest, RecordsAcquisitionsPerSite) {
+  ResetMutexSiteStats();
+  MutexAcquisitionRecorder recorder;
+  for (int i = 0; i < 3; ++i) {
+    recorder.OnAcquired(kFile, 10, /*wait_start_ns=*/-1);
+    recorder.OnReleasing();
+  }
+  recorder.OnAcquired(kFile, 20, /*wait_start_ns=*/-1);
+  recorder.OnReleasing();
+
+  std::vector<MutexSiteStats> sites = GetTopContendedMutexSites(1000);
+  const MutexSiteStats* site = FindSite(sites, kFile, 10);
+  ASSERT_TRUE(site);
+  EXPECT_EQ(3u, site->acquisitions);
+  EXPECT_EQ(0u, site->contended_acquisitions);
+  EXPECT_EQ(0, site->total_wait_ns);
+  EXPECT_EQ(3u, site->wait_histogram[0]);
+  EXPECT_GE(site->total_hold_ns, 0);
+  site = FindSite(sites, kFile, 20);
+  ASSERT_TRUE(site);
+  EXPECT_EQ(1u, site->acquisitions);
+}
+
+TEST(MutexProfilerTest, RecordsWaitTimes) {
+  ResetMutexSiteStats();
+  MutexAcquisitionRecorder recorder;
+  // Pretend the acquisition waited for 10 ms.
+  recorder.OnAcquired(kFile, 30,
+                      MutexAcquisitionRecorder::NowNs() - 10'000'000);
+  recorder.OnReleasing();
+
+  std::vector<MutexSiteStats> sites = GetTopContendedMutexSites(1000);
+  const MutexSiteStats* site = FindSite(sites, kFile, 30);
+  ASSERT_TRUE(site);
+  EXPECT_EQ(1u, site->contended_acquisitions);
+  EXPECT_GE(site->total_wait_ns, 10'000'000);
+  EXPECT_EQ(site->total_wait_ns, site->max_wait_ns);
+  // 10 ms is between 2^13 and 2^14 us.
+  EXPECT_EQ(1u, site->wait_histogram[14]);
+}
+
+TEST(MutexProfilerTest, OrdersSitesByWaitTime) {
+  ResetMutexSiteStats();
+  MutexAcquisitionRecorder recorder;
+  recorder.OnAcquired(kFile, 40, MutexAcquisitionRecorder::NowNs() - 1000);
+  recorder.OnReleasing();
+  recorder.OnAcquired(kFile, 50, MutexAcquisitionRecorder::NowNs() - 500'000);
+  recorder.OnReleasing();
+  recorder.OnAcquired(kFile, 60, /*wait_start_ns=*/-1);
+  recorder.OnReleasing();
+
+  std::vector<MutexSiteStats> sites = GetTopContendedMutexSites(2);
+  ASSERT_EQ(2u, sites.size());
+  EXPECT_EQ(50, sites[0].line);
+  EXPECT_EQ(40, sites[1].line);
+
+  std::string dump = DumpTopContendedMutexSites(1);
+  EXPECT_THAT(dump, HasSubstr("mutex_profiler_unittest_site.cc:50 "));
+  EXPECT_THAT(dump, HasSubstr("contended=1"));
+}
+
+TEST(MutexProfilerTest, ResetClearsStats) {
+  MutexAcquisitionRecorder recorder;
+  recorder.OnAcquired(kFile, 70, /*wait_start_ns=*/-1);
+  recorder.OnReleasing();
+  ResetMutexSiteStats();
+  EXPECT_FALSE(FindSite(GetTopContendedMutexSites(1000), kFile, 70));
+}
+
+#if defined(WEBRTC_MUTEX_PROFILING)
+TEST(MutexProfilerTest, MutexLockRecordsCallerLocation) {
+  ResetMutexSiteStats();
+  Mutex mutex;
+  const int line = __LINE__ + 1;
+  { MutexLock lock(&mutex); }
+
+  std::vector<MutexSiteStats> sites = GetTopContendedMutexSites(1000);
+  const MutexSiteStats* site = FindSite(sites, __FILE__, line);
+  ASSERT_TRUE(site);
+  EXPECT_EQ(1u, site->acquisitions);
+}
+#endif
+
+}  // namespace
+}  // namespace webrtc
@@ -22,6 +22,7 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
 #include "api/units/time_delta.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -45,6 +46,9 @@ class TaskQueueGcd final : public TaskQueueBase {
  public:
   TaskQueueGcd(absl::string_view queue_name, int gcd_priority);
 
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override;
   void PostTask(absl::AnyInvocable<void() &&> task) override;
   void PostDelayedTask(absl::AnyInvocable<void() &&> task,
@@ -68,6 +72,7 @@ class TaskQueueGcd final : public TaskQueueBase {
 
   dispatch_queue_t queue_;
   bool is_active_;
+  TaskQueueTaskRecorder task_recorder_;
 };
 
 TaskQueueGcd::TaskQueueGcd(absl::string_view queue_name, int gcd_priority)
@@ -75,7 +80,8 @@ TaskQueueGcd::TaskQueueGcd(absl::string_view queue_name, int gcd_priority)
           std::string(queue_name).c_str(),
           DISPATCH_QUEUE_SERIAL,
           dispatch_get_global_queue(gcd_priority, 0))),
-      is_active_(true) {
+      is_active_(true),
+      task_recorder_(queue_name) {
   RTC_CHECK(queue_);
   dispatch_set_context(queue_, this);
   // Assign a finalizer that will delete the queue when the last reference
@@ -101,13 +107,14 @@ void TaskQueueGcd::Delete() {
 }
 
 void TaskQueueGcd::PostTask(absl::AnyInvocable<void() &&> task) {
-  auto* context = new TaskContext(this, std::move(task));
+  auto* context = new TaskContext(this, task_recorder_.Wrap(std::move(task)));
   dispatch_async_f(queue_, context, &RunTask);
 }
 
 void TaskQueueGcd::PostDelayedTask(absl::AnyInvocable<void() &&> task,
                                    TimeDelta delay) {
-  auto* context = new TaskContext(this, std::move(task));
+  auto* context =
+      new TaskContext(this, task_recorder_.Wrap(std::move(task), delay));
   dispatch_after_f(dispatch_time(DISPATCH_TIME_NOW, delay.us() * NSEC_PER_USEC),
                    queue_, context, &RunTask);
 }
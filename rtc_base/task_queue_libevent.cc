@@ -27,6 +27,7 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
 #include "api/units/time_delta.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -106,6 +107,9 @@ class TaskQueueLibevent final : public TaskQueueBase {
  public:
   TaskQueueLibevent(absl::string_view queue_name, rtc::ThreadPriority priority);
 
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override;
   void PostTask(absl::AnyInvocable<void() &&> task) override;
   void PostDelayedTask(absl::AnyInvocable<void() &&> task,
@@ -116,6 +120,7 @@ class TaskQueueLibevent final : public TaskQueueBase {
  private:
   struct TimerEvent;
 
+  void PostTaskToQueue(absl::AnyInvocable<void() &&> task);
   void PostDelayedTaskOnTaskQueue(absl::AnyInvocable<void() &&> task,
                                   TimeDelta delay);
 
@@ -135,6 +140,7 @@ class TaskQueueLibevent final : public TaskQueueBase {
       RTC_GUARDED_BY(pending_lock_);
   // Holds a list of events pending timers for cleanup when the loop exits.
   std::list<TimerEvent*> pending_timers_;
+  TaskQueueTaskRecorder task_recorder_;
 };
 
 struct TaskQueueLibevent::TimerEvent {
@@ -149,7 +155,7 @@ struct TaskQueueLibevent::TimerEvent {
 
 TaskQueueLibevent::TaskQueueLibevent(absl::string_view queue_name,
                                      rtc::ThreadPriority priority)
-    : event_base_(event_base_new()) {
+    : event_base_(event_base_new()), task_recorder_(queue_name) {
   int fds[2];
   RTC_CHECK(pipe(fds) == 0);
   SetNonBlocking(fds[0]);
@@ -202,6 +208,10 @@ void TaskQueueLibevent::Delete() {
 }
 
 void TaskQueueLibevent::PostTask(absl::AnyInvocable<void() &&> task) {
+  PostTaskToQueue(task_recorder_.Wrap(std::move(task)));
+}
+
+void TaskQueueLibevent::PostTaskToQueue(absl::AnyInvocable<void() &&> task) {
   {
     MutexLock lock(&pending_lock_);
     bool had_pending_tasks = !pending_.empty();
@@ -242,11 +252,12 @@ void TaskQueueLibevent::PostDelayedTaskOnTaskQueue(
 
 void TaskQueueLibevent::PostDelayedTask(absl::AnyInvocable<void() &&> task,
                                         TimeDelta delay) {
+  task = task_recorder_.Wrap(std::move(task), delay);
   if (IsCurrent()) {
     PostDelayedTaskOnTaskQueue(std::move(task), delay);
   } else {
     int64_t posted_us = rtc::TimeMicros();
-    PostTask([posted_us, delay, task = std::move(task), this]() mutable {
+    PostTaskToQueue([posted_us, delay, task = std::move(task), this]() mutable {
       // Compensate for the time that has passed since the posting.
       TimeDelta post_time = TimeDelta::Micros(rtc::TimeMicros() - posted_us);
       PostDelayedTaskOnTaskQueue(
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_metrics_collector.h"
+
+#include <algorithm>
+
+namespace webrtc {
+
+void TaskQueueMetricsCollector::DurationHistogram::Add(TimeDelta duration) {
+  int64_t us = duration.us();
+  int bucket = 0;
+  while (us > 0 && bucket < kBuckets - 1) {
+    us >>= 1;
+    ++bucket;
+  }
+  ++counts[bucket];
+  total += duration;
+  max = std::max(max, duration);
+}
+
+TimeDelta TaskQueueMetricsCollector::DurationHistogram::Percentile(
+    double percentile) const {
+  int64_t num_samples = 0;
+  for (int64_t count : counts) {
+    num_samples += count;
+  }
+  if (num_samples == 0) {
+    return TimeDelta::Zero();
+  }
+  int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(num_samples * percentile / 100 + 0.5));
+  int64_t seen = 0;
+  for (int bucket = 0; bucket < kBuckets; ++bucket) {
+    seen += counts[bucket];
+    if (seen >= rank) {
+      return bucket == kBuckets - 1 ? max
+                                    : TimeDelta::Micros(int64_t{1} << bucket);
+    }
+  }
+  return max;
+}
+
+TaskQueueMetricsCollector::TaskQueueMetricsCollector() = default;
+TaskQueueMetricsCollector::~TaskQueueMetricsCollector() = default;
+
+void TaskQueueMetricsCollector::OnTaskRun(const TaskQueueTaskMetrics& metrics) {
+  MutexLock lock(&mutex_);
+  auto it = queues_.find(metrics.queue_name);
+  if (it == queues_.end()) {
+    it = queues_.emplace(std::string(metrics.queue_name), QueueData()).first;
+  }
+  QueueData& queue = it->second;
+  ++queue.stats.tasks;
+  queue.stats.queueing_delay.Add(metrics.queueing_delay);
+  queue.stats.execution_time.Add(metrics.execution_time);
+  queue.stats.max_queue_depth =
+      std::max(queue.stats.max_queue_depth, metrics.queue_depth);
+
+  LocationStats& location =
+      queue.locations[{metrics.location.file_name(),
+                       metrics.location.line_number()}];
+  location.location = metrics.location;
+  ++location.tasks;
+  location.total_queueing_delay += metrics.queueing_delay;
+  location.max_queueing_delay =
+      std::max(location.max_queueing_delay, metrics.queueing_delay);
+  location.total_execution_time += metrics.execution_time;
+  location.max_execution_time =
+      std::max(location.max_execution_time, metrics.execution_time);
+}
+
+std::vector<TaskQueueMetricsCollector::QueueStats>
+TaskQueueMetricsCollector::GetStats() const {
+  std::vector<QueueStats> result;
+  MutexLock lock(&mutex_);
+  for (const auto& [name, queue] : queues_) {
+    result.push_back(queue.stats);
+    QueueStats& stats = result.back();
+    stats.queue_name = name;
+    for (const auto& [key, location] : queue.locations) {
+      stats.locations.push_back(location);
+    }
+    std::sort(stats.locations.begin(), stats.locations.end(),
+              [](const LocationStats& a, const LocationStats& b) {
+                return a.total_execution_time > b.total_execution_time;
+              });
+  }
+  return result;
+}
+
+void TaskQueueMetricsCollector::Reset() {
+  MutexLock lock(&mutex_);
+  queues_.clear();
+}
+
+}  // namespace webrtc
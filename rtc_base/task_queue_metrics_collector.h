@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_QUEUE_METRICS_COLLECTOR_H_
+#define RTC_BASE_TASK_QUEUE_METRICS_COLLECTOR_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api/location.h"
+#include "api/task_queue/task_queue_metrics.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Aggregates the task metrics reported by task queues per queue and per
+// posting location, to be pulled with GetStats(). Usage:
+//
+//   TaskQueueMetricsCollector collector;
+//   SetTaskQueueMetricsObserver(&collector);
+//   ...
+//   for (const auto& queue : collector.GetStats()) { ... }
+class RTC_EXPORT TaskQueueMetricsCollector : public TaskQueueMetricsObserver {
+ public:
+  struct DurationHistogram {
+    // Durations are counted in bucket 0 if shorter than 1 us, and in bucket i
+    // if between 2^(i-1) and 2^i us. The last bucket also counts longer
+    // durations.
+    static constexpr int kBuckets = 24;
+
+    void Add(TimeDelta duration);
+    // Returns the upper edge of the bucket holding the `percentile` (0-100)
+    // duration, or zero if empty.
+    TimeDelta Percentile(double percentile) const;
+
+    std::array<int64_t, kBuckets> counts = {};
+    TimeDelta total = TimeDelta::Zero();
+    TimeDelta max = TimeDelta::Zero();
+  };
+
+  struct LocationStats {
+    Location location;
+    int64_t tasks = 0;
+    TimeDelta total_queueing_delay = TimeDelta::Zero();
+    TimeDelta max_queueing_delay = TimeDelta::Zero();
+    TimeDelta total_execution_time = TimeDelta::Zero();
+    TimeDelta max_execution_time = TimeDelta::Zero();
+  };
+
+  struct QueueStats {
+    std::string queue_name;
+    int64_t tasks = 0;
+    DurationHistogram queueing_delay;
+    DurationHistogram execution_time;
+    int max_queue_depth = 0;
+    // Ordered by total execution time, highest first. Tasks posted without a
+    // location are attributed to the default constructed Location.
+    std::vector<LocationStats> locations;
+  };
+
+  TaskQueueMetricsCollector();
+  ~TaskQueueMetricsCollector() override;
+
+  // TaskQueueMetricsObserver implementation.
+  void OnTaskRun(const TaskQueueTaskMetrics& metrics) override;
+
+  // Returns the stats of all queues that ran tasks, ordered by name.
+  std::vector<QueueStats> GetStats() const;
+  void Reset();
+
+ private:
+  struct QueueData {
+    QueueStats stats;
+    // Keyed by file name and line number.
+    std::map<std::pair<const char*, int>, LocationStats> locations;
+  };
+
+  mutable Mutex mutex_;
+  std::map<std::string, QueueData, std::less<>> queues_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_QUEUE_METRICS_COLLECTOR_H_
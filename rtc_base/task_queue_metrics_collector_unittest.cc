@@ -0,0 +1,193 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_metrics_collector.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "api/location.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_for_test.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using QueueStats = TaskQueueMetricsCollector::QueueStats;
+
+TaskQueueTaskMetrics Metrics(const Location& location,
+                             TimeDelta queueing_delay,
+                             TimeDelta execution_time,
+                             int queue_depth) {
+  TaskQueueTaskMetrics metrics;
+  metrics.queue_name = "Queue";
+  metrics.location = location;
+  metrics.queueing_delay = queueing_delay;
+  metrics.execution_time = execution_time;
+  metrics.queue_depth = queue_depth;
+  return metrics;
+}
+
+// Forwards to a collector, and signals when a number of tasks was reported.
+class WaitingObserver : public TaskQueueMetricsObserver {
+ public:
+  WaitingObserver(TaskQueueMetricsCollector& collector, int tasks)
+      : collector_(collector), remaining_tasks_(tasks) {}
+
+  void OnTaskRun(const TaskQueueTaskMetrics& metrics) override {
+    collector_.OnTaskRun(metrics);
+    if (--remaining_tasks_ == 0) {
+      reported_.Set();
+    }
+  }
+
+  void Wait() { reported_.Wait(rtc::Event::kForever); }
+
+ private:
+  TaskQueueMetricsCollector& collector_;
+  // Only accessed on the task queue.
+  int remaining_tasks_;
+  rtc::Event reported_;
+};
+
+// Posts tasks to `task_queue` from three locations, while it's blocked, and
+// waits for them to be reported.
+void PostBlockedTasks(TaskQueueBase* task_queue,
+                      TaskQueueMetricsCollector& collector,
+                      std::vector<int>& lines) {
+  rtc::Event blocked;
+  rtc::Event unblock;
+  task_queue->PostTask([&] {
+    blocked.Set();
+    unblock.Wait(rtc::Event::kForever);
+  });
+  blocked.Wait(rtc::Event::kForever);
+
+  WaitingObserver observer(collector, 3);
+  SetTaskQueueMetricsObserver(&observer);
+  lines.push_back(__LINE__ + 1);
+  task_queue->PostTask([] {}, Location::Current());
+  lines.push_back(__LINE__ + 1);
+  task_queue->PostDelayedTask([] {}, TimeDelta::Millis(1), Location::Current());
+  lines.push_back(__LINE__ + 1);
+  task_queue->PostTask([] {}, Location::Current());
+  unblock.Set();
+  observer.Wait();
+  SetTaskQueueMetricsObserver(nullptr);
+}
+
+void ExpectStatsOfBlockedTasks(const QueueStats& stats,
+                               const std::vector<int>& lines) {
+  EXPECT_EQ(3, stats.tasks);
+  EXPECT_EQ(3, stats.max_queue_depth);
+  ASSERT_EQ(3u, stats.locations.size());
+  for (const TaskQueueMetricsCollector::LocationStats& location :
+       stats.locations) {
+    EXPECT_EQ(1, location.tasks);
+    EXPECT_STREQ(__FILE__, location.location.file_name());
+    EXPECT_NE(std::find(lines.begin(), lines.end(),
+                        location.location.line_number()),
+              lines.end());
+  }
+}
+
+TEST(TaskQueueMetricsCollectorTest, AggregatesPerQueueAndLocation) {
+  TaskQueueMetricsCollector collector;
+  Location first = Location::Current();
+  Location second = Location::Current();
+  collector.OnTaskRun(
+      Metrics(first, TimeDelta::Micros(100), TimeDelta::Micros(10), 1));
+  collector.OnTaskRun(
+      Metrics(second, TimeDelta::Millis(5), TimeDelta::Millis(2), 3));
+  collector.OnTaskRun(
+      Metrics(first, TimeDelta::Micros(300), TimeDelta::Micros(30), 2));
+
+  std::vector<QueueStats> stats = collector.GetStats();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ("Queue", stats[0].queue_name);
+  EXPECT_EQ(3, stats[0].tasks);
+  EXPECT_EQ(3, stats[0].max_queue_depth);
+  EXPECT_EQ(TimeDelta::Micros(5400), stats[0].queueing_delay.total);
+  EXPECT_EQ(TimeDelta::Millis(5), stats[0].queueing_delay.max);
+  EXPECT_EQ(TimeDelta::Micros(2040), stats[0].execution_time.total);
+
+  // Ordered by total execution time.
+  ASSERT_EQ(2u, stats[0].locations.size());
+  EXPECT_EQ(second.line_number(),
+            stats[0].locations[0].location.line_number());
+  EXPECT_EQ(1, stats[0].locations[0].tasks);
+  EXPECT_EQ(first.line_number(), stats[0].locations[1].location.line_number());
+  EXPECT_EQ(2, stats[0].locations[1].tasks);
+  EXPECT_EQ(TimeDelta::Micros(40),
+            stats[0].locations[1].total_execution_time);
+  EXPECT_EQ(TimeDelta::Micros(300), stats[0].locations[1].max_queueing_delay);
+
+  collector.Reset();
+  EXPECT_TRUE(collector.GetStats().empty());
+}
+
+TEST(TaskQueueMetricsCollectorTest, HistogramPercentiles) {
+  TaskQueueMetricsCollector::DurationHistogram histogram;
+  EXPECT_EQ(TimeDelta::Zero(), histogram.Percentile(50));
+  for (int i = 0; i < 9; ++i) {
+    histogram.Add(TimeDelta::Micros(3));
+  }
+  histogram.Add(TimeDelta::Millis(10));
+  // 3 us is counted in the bucket for 2-4 us.
+  EXPECT_EQ(9, histogram.counts[2]);
+  EXPECT_EQ(TimeDelta::Micros(4), histogram.Percentile(50));
+  EXPECT_EQ(TimeDelta::Micros(4), histogram.Percentile(90));
+  EXPECT_EQ(TimeDelta::Micros(16384), histogram.Percentile(99));
+}
+
+TEST(TaskQueueMetricsCollectorTest, CollectsTasksOfDefaultTaskQueue) {
+  TaskQueueMetricsCollector collector;
+  TaskQueueForTest queue("MetricsQueue");
+  std::vector<int> lines;
+  PostBlockedTasks(queue.Get(), collector, lines);
+
+  std::vector<QueueStats> stats = collector.GetStats();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ("MetricsQueue", stats[0].queue_name);
+  ExpectStatsOfBlockedTasks(stats[0], lines);
+}
+
+TEST(TaskQueueMetricsCollectorTest, CollectsTasksOfThread) {
+  TaskQueueMetricsCollector collector;
+  std::unique_ptr<rtc::Thread> thread = rtc::Thread::Create();
+  thread->SetName("MetricsThread", nullptr);
+  thread->Start();
+  std::vector<int> lines;
+  PostBlockedTasks(thread.get(), collector, lines);
+
+  std::vector<QueueStats> stats = collector.GetStats();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ("MetricsThread", stats[0].queue_name);
+  ExpectStatsOfBlockedTasks(stats[0], lines);
+}
+
+TEST(TaskQueueMetricsCollectorTest, TasksAreNotWrappedWithoutObserver) {
+  TaskQueueMetricsCollector collector;
+  TaskQueueForTest queue("MetricsQueue");
+  queue.SendTask([] {});
+  SetTaskQueueMetricsObserver(&collector);
+  SetTaskQueueMetricsObserver(nullptr);
+  queue.SendTask([] {});
+  EXPECT_TRUE(collector.GetStats().empty());
+}
+
+}  // namespace
+}  // namespace webrtc
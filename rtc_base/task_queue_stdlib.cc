@@ -13,7 +13,7 @@
 #include <string.h>
 
 #include <algorithm>
-#include <map>
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -21,8 +21,10 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
 #include "api/units/time_delta.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/containers/timing_wheel.h"
 #include "rtc_base/event.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/divide_round.h"
@@ -34,6 +36,9 @@
 namespace webrtc {
 namespace {
 
+// Number of times delayed tasks have become due on any TaskQueueStdlib.
+std::atomic<uint64_t> g_delayed_task_wakeups(0);
+
 rtc::ThreadPriority TaskQueuePriorityToThreadPriority(
     TaskQueueFactory::Priority priority) {
   switch (priority) {
@@ -48,9 +53,14 @@ rtc::ThreadPriority TaskQueuePriorityToThreadPriority(
 
 class TaskQueueStdlib final : public TaskQueueBase {
  public:
-  TaskQueueStdlib(absl::string_view queue_name, rtc::ThreadPriority priority);
+  TaskQueueStdlib(absl::string_view queue_name,
+                  rtc::ThreadPriority priority,
+                  bool coalesce_low_precision_tasks);
   ~TaskQueueStdlib() override = default;
 
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override;
   void PostTask(absl::AnyInvocable<void() &&> task) override;
   void PostDelayedTask(absl::AnyInvocable<void() &&> task,
@@ -61,15 +71,9 @@ class TaskQueueStdlib final : public TaskQueueBase {
  private:
   using OrderId = uint64_t;
 
-  struct DelayedEntryTimeout {
-    // TODO(bugs.webrtc.org/13756): Migrate to Timestamp.
-    int64_t next_fire_at_us{};
-    OrderId order{};
-
-    bool operator<(const DelayedEntryTimeout& o) const {
-      return std::tie(next_fire_at_us, order) <
-             std::tie(o.next_fire_at_us, o.order);
-    }
+  struct DelayedEntry {
+    OrderId order;
+    absl::AnyInvocable<void() &&> task;
   };
 
   struct NextTask {
@@ -82,6 +86,9 @@ class TaskQueueStdlib final : public TaskQueueBase {
                                               absl::string_view queue_name,
                                               rtc::ThreadPriority priority);
 
+  void PostDelayedTaskAt(absl::AnyInvocable<void() &&> task,
+                         int64_t run_time_ms);
+
   NextTask GetNextTask();
 
   void ProcessTasks();
@@ -106,13 +113,19 @@ class TaskQueueStdlib final : public TaskQueueBase {
       RTC_GUARDED_BY(pending_lock_);
 
   // The list of all pending tasks that need to be processed at a future
-  // time based upon a delay. On the off change the delayed task should
-  // happen at exactly the same time interval as another task then the
-  // task is processed based on FIFO ordering. std::priority_queue was
-  // considered but rejected due to its inability to extract the
-  // move-only value out of the queue without the presence of a hack.
-  std::map<DelayedEntryTimeout, absl::AnyInvocable<void() &&>> delayed_queue_
-      RTC_GUARDED_BY(pending_lock_);
+  // time based upon a delay, by run time in milliseconds. On the off chance
+  // the delayed task should happen at exactly the same time interval as
+  // another task then the task is processed based on FIFO ordering.
+  TimingWheel<DelayedEntry> delayed_queue_ RTC_GUARDED_BY(pending_lock_);
+
+  // Delayed tasks whose run time has been reached, in the order to run them.
+  std::queue<DelayedEntry> due_queue_ RTC_GUARDED_BY(pending_lock_);
+
+  TaskQueueTaskRecorder task_recorder_;
+
+  // Whether the run times of low precision delayed tasks are rounded up to
+  // kLowPrecisionGridMs.
+  const bool coalesce_low_precision_tasks_;
 
   // Contains the active worker thread assigned to processing
   // tasks (including delayed tasks).
@@ -122,8 +135,12 @@ class TaskQueueStdlib final : public TaskQueueBase {
 };
 
 TaskQueueStdlib::TaskQueueStdlib(absl::string_view queue_name,
-                                 rtc::ThreadPriority priority)
+                                 rtc::ThreadPriority priority,
+                                 bool coalesce_low_precision_tasks)
     : flag_notify_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      delayed_queue_(rtc::TimeMillis()),
+      task_recorder_(queue_name),
+      coalesce_low_precision_tasks_(coalesce_low_precision_tasks),
       thread_(InitializeThread(this, queue_name, priority)) {}
 
 // static
@@ -157,6 +174,7 @@ void TaskQueueStdlib::Delete() {
 }
 
 void TaskQueueStdlib::PostTask(absl::AnyInvocable<void() &&> task) {
+  task = task_recorder_.Wrap(std::move(task));
   {
     MutexLock lock(&pending_lock_);
     pending_queue_.push(
@@ -168,22 +186,29 @@ void TaskQueueStdlib::PostTask(absl::AnyInvocable<void() &&> task) {
 
 void TaskQueueStdlib::PostDelayedTask(absl::AnyInvocable<void() &&> task,
                                       TimeDelta delay) {
-  DelayedEntryTimeout delayed_entry;
-  delayed_entry.next_fire_at_us = rtc::TimeMicros() + delay.us();
-
-  {
-    MutexLock lock(&pending_lock_);
-    delayed_entry.order = ++thread_posting_order_;
-    delayed_queue_[delayed_entry] = std::move(task);
+  int64_t run_time_ms = DivideRoundUp(rtc::TimeMicros() + delay.us(), 1'000);
+  if (coalesce_low_precision_tasks_ && delay > TimeDelta::Zero()) {
+    run_time_ms = CoalesceRunTime(run_time_ms, kLowPrecisionGridMs);
   }
-
-  NotifyWake();
+  PostDelayedTaskAt(task_recorder_.Wrap(std::move(task), delay), run_time_ms);
 }
 
 void TaskQueueStdlib::PostDelayedHighPrecisionTask(
     absl::AnyInvocable<void() &&> task,
     TimeDelta delay) {
-  PostDelayedTask(std::move(task), delay);
+  PostDelayedTaskAt(task_recorder_.Wrap(std::move(task), delay),
+                    DivideRoundUp(rtc::TimeMicros() + delay.us(), 1'000));
+}
+
+void TaskQueueStdlib::PostDelayedTaskAt(absl::AnyInvocable<void() &&> task,
+                                        int64_t run_time_ms) {
+  {
+    MutexLock lock(&pending_lock_);
+    OrderId order = ++thread_posting_order_;
+    delayed_queue_.Insert(run_time_ms, {order, std::move(task)});
+  }
+
+  NotifyWake();
 }
 
 TaskQueueStdlib::NextTask TaskQueueStdlib::GetNextTask() {
@@ -198,29 +223,35 @@ TaskQueueStdlib::NextTask TaskQueueStdlib::GetNextTask() {
     return result;
   }
 
-  if (delayed_queue_.size() > 0) {
-    auto delayed_entry = delayed_queue_.begin();
-    const auto& delay_info = delayed_entry->first;
-    auto& delay_run = delayed_entry->second;
-    if (tick_us >= delay_info.next_fire_at_us) {
-      if (pending_queue_.size() > 0) {
-        auto& entry = pending_queue_.front();
-        auto& entry_order = entry.first;
-        auto& entry_run = entry.second;
-        if (entry_order < delay_info.order) {
-          result.run_task = std::move(entry_run);
-          pending_queue_.pop();
-          return result;
-        }
-      }
+  std::queue<DelayedEntry>& due_queue = due_queue_;
+  size_t expired = delayed_queue_.AdvanceTo(
+      tick_us / 1'000,
+      [&due_queue](DelayedEntry entry) { due_queue.push(std::move(entry)); });
+  if (expired > 0) {
+    g_delayed_task_wakeups.fetch_add(1, std::memory_order_relaxed);
+  }
 
-      result.run_task = std::move(delay_run);
-      delayed_queue_.erase(delayed_entry);
-      return result;
+  if (due_queue_.size() > 0) {
+    DelayedEntry& delayed_entry = due_queue_.front();
+    if (pending_queue_.size() > 0) {
+      auto& entry = pending_queue_.front();
+      auto& entry_order = entry.first;
+      auto& entry_run = entry.second;
+      if (entry_order < delayed_entry.order) {
+        result.run_task = std::move(entry_run);
+        pending_queue_.pop();
+        return result;
+      }
     }
 
+    result.run_task = std::move(delayed_entry.task);
+    due_queue_.pop();
+    return result;
+  }
+
+  if (!delayed_queue_.empty()) {
     result.sleep_time = TimeDelta::Millis(
-        DivideRoundUp(delay_info.next_fire_at_us - tick_us, 1'000));
+        DivideRoundUp(delayed_queue_.NextRunTime() * 1'000 - tick_us, 1'000));
   }
 
   if (pending_queue_.size() > 0) {
@@ -281,18 +312,31 @@ void TaskQueueStdlib::NotifyWake() {
 
 class TaskQueueStdlibFactory final : public TaskQueueFactory {
  public:
+  explicit TaskQueueStdlibFactory(bool coalesce_low_precision_tasks)
+      : coalesce_low_precision_tasks_(coalesce_low_precision_tasks) {}
+
   std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
       absl::string_view name,
       Priority priority) const override {
     return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(
-        new TaskQueueStdlib(name, TaskQueuePriorityToThreadPriority(priority)));
+        new TaskQueueStdlib(name, TaskQueuePriorityToThreadPriority(priority),
+                            coalesce_low_precision_tasks_));
   }
+
+ private:
+  const bool coalesce_low_precision_tasks_;
 };
 
 }  // namespace
 
-std::unique_ptr<TaskQueueFactory> CreateTaskQueueStdlibFactory() {
-  return std::make_unique<TaskQueueStdlibFactory>();
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueStdlibFactory(
+    bool coalesce_low_precision_tasks) {
+  return std::make_unique<TaskQueueStdlibFactory>(
+      coalesce_low_precision_tasks);
+}
+
+uint64_t GetTaskQueueStdlibDelayedTaskWakeupCount() {
+  return g_delayed_task_wakeups.load(std::memory_order_relaxed);
 }
 
 }  // namespace webrtc
@@ -11,13 +11,26 @@
 #ifndef RTC_BASE_TASK_QUEUE_STDLIB_H_
 #define RTC_BASE_TASK_QUEUE_STDLIB_H_
 
+#include <stdint.h>
+
 #include <memory>
 
 #include "api/task_queue/task_queue_factory.h"
 
 namespace webrtc {
 
-std::unique_ptr<TaskQueueFactory> CreateTaskQueueStdlibFactory();
+// If `coalesce_low_precision_tasks` is set, the task queues round the run
+// times of low precision delayed tasks up to a 16 ms grid, within the leeway
+// that TaskQueueBase::DelayPrecision::kLow allows, so that tasks falling due
+// close together share a wakeup.
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueStdlibFactory(
+    bool coalesce_low_precision_tasks = false);
+
+// Number of times delayed tasks have become due on any of the task queues
+// created by the factories above, i.e. the number of times their threads had
+// to wake up for them if they were otherwise idle. Delayed tasks that become
+// due together on a task queue count once.
+uint64_t GetTaskQueueStdlibDelayedTaskWakeupCount();
 
 }  // namespace webrtc
 
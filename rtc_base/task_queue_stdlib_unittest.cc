@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_stdlib.h"
+
+#include <atomic>
+#include <memory>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/event.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(TaskQueueStdlibTest, CountsWakeupsForDelayedTasks) {
+  std::unique_ptr<TaskQueueFactory> factory = CreateTaskQueueStdlibFactory();
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  const uint64_t wakeups_before = GetTaskQueueStdlibDelayedTaskWakeupCount();
+
+  rtc::Event ran;
+  queue->PostDelayedHighPrecisionTask([&ran] { ran.Set(); },
+                                      TimeDelta::Millis(5));
+  ASSERT_TRUE(ran.Wait(TimeDelta::Seconds(1)));
+  EXPECT_EQ(wakeups_before + 1, GetTaskQueueStdlibDelayedTaskWakeupCount());
+}
+
+TEST(TaskQueueStdlibTest, CoalescesWakeupsForLowPrecisionTasks) {
+  constexpr int kTasks = 16;
+  std::unique_ptr<TaskQueueFactory> factory =
+      CreateTaskQueueStdlibFactory(/*coalesce_low_precision_tasks=*/true);
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  const uint64_t wakeups_before = GetTaskQueueStdlibDelayedTaskWakeupCount();
+
+  std::atomic<int> remaining(kTasks);
+  rtc::Event done;
+  for (int i = 1; i <= kTasks; ++i) {
+    queue->PostDelayedTask(
+        [&remaining, &done] {
+          if (remaining.fetch_sub(1) == 1) {
+            done.Set();
+          }
+        },
+        TimeDelta::Millis(i));
+  }
+  ASSERT_TRUE(done.Wait(TimeDelta::Seconds(1)));
+  // Rounded up to the 16 ms grid, the tasks fall due at no more than two grid
+  // points. With high precision, each would need a wakeup of its own.
+  EXPECT_LE(GetTaskQueueStdlibDelayedTaskWakeupCount(), wakeups_before + 2);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,555 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "api/field_trials_view.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/containers/timing_wheel.h"
+#include "rtc_base/event.h"
+#include "rtc_base/experiments/field_trial_parser.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/numerics/divide_round.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+constexpr char kThreadPoolFieldTrial[] = "WebRTC-TaskQueue-ThreadPool";
+constexpr char kCoalesceLowPrecisionFieldTrial[] =
+    "WebRTC-TaskQueue-CoalesceLowPrecision";
+
+// Number of tasks a worker runs from one task queue before moving on to the
+// next runnable one, so that a busy task queue doesn't starve the others.
+constexpr int kMaxTasksPerTurn = 32;
+
+rtc::ThreadPriority TaskQueuePriorityToThreadPriority(
+    TaskQueueFactory::Priority priority) {
+  switch (priority) {
+    case TaskQueueFactory::Priority::HIGH:
+      return rtc::ThreadPriority::kRealtime;
+    case TaskQueueFactory::Priority::LOW:
+      return rtc::ThreadPriority::kLow;
+    case TaskQueueFactory::Priority::NORMAL:
+      return rtc::ThreadPriority::kNormal;
+  }
+}
+
+class ThreadPool;
+
+// The tasks of one task queue. Shared between the task queue, which closes
+// it when deleted, and the pool, which runs it.
+class Sequence : public std::enable_shared_from_this<Sequence> {
+ public:
+  Sequence(ThreadPool* pool, TaskQueueBase* task_queue)
+      : pool_(pool), task_queue_(task_queue) {}
+
+  void Post(absl::AnyInvocable<void() &&> task);
+
+  // Runs pending tasks, up to kMaxTasksPerTurn. Returns true if there are
+  // more, in which case the caller must run the sequence again later.
+  bool RunTasks();
+
+  // Deletes pending tasks, prevents new ones from being posted and waits for
+  // the running task, if any, to finish, then runs `on_closed`. If called
+  // from the running task, doesn't wait but runs `on_closed` once that task
+  // has finished.
+  void Close(absl::AnyInvocable<void() &&> on_closed);
+
+ private:
+  ThreadPool* const pool_;
+  TaskQueueBase* const task_queue_;
+  rtc::Event task_finished_;
+
+  Mutex lock_;
+  std::queue<absl::AnyInvocable<void() &&>> tasks_ RTC_GUARDED_BY(lock_);
+  // Whether the sequence is runnable in the pool or being run by a worker.
+  bool scheduled_ RTC_GUARDED_BY(lock_) = false;
+  bool running_task_ RTC_GUARDED_BY(lock_) = false;
+  bool closed_ RTC_GUARDED_BY(lock_) = false;
+  absl::AnyInvocable<void() &&> on_closed_ RTC_GUARDED_BY(lock_);
+};
+
+class ThreadPool {
+ public:
+  // Returns a pool which, once no longer referenced, is deleted on a thread
+  // outside of the pool, as its threads can't join themselves.
+  static std::shared_ptr<ThreadPool> Create(int num_threads,
+                                            rtc::ThreadPriority priority);
+
+  ThreadPool(int num_threads, rtc::ThreadPriority priority);
+  ~ThreadPool();
+
+  // Hands a sequence which has become runnable to a worker.
+  void Schedule(std::shared_ptr<Sequence> sequence);
+
+  void PostDelayedTask(std::weak_ptr<Sequence> sequence,
+                       absl::AnyInvocable<void() &&> task,
+                       int64_t run_time_ms);
+
+ private:
+  struct Worker {
+    explicit Worker(size_t index) : index(index) {}
+
+    const size_t index;
+    rtc::Event wake_up;
+    Mutex lock;
+    // Sequences waiting to be run, taken from the front by this worker and
+    // from the back by the ones stealing work.
+    std::deque<std::shared_ptr<Sequence>> runnable RTC_GUARDED_BY(lock);
+    rtc::PlatformThread thread;
+  };
+
+  struct DelayedTask {
+    std::weak_ptr<Sequence> sequence;
+    absl::AnyInvocable<void() &&> task;
+  };
+
+  // Whether the current thread is one of the pool's.
+  bool IsPoolThread() const;
+  void RunWorker(Worker* worker);
+  std::shared_ptr<Sequence> FindWork(Worker* worker);
+  bool HasIdleWorkers() const {
+    return num_idle_workers_.load(std::memory_order_acquire) > 0;
+  }
+  void WakeUpIdleWorker();
+  void RunTimer();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_worker_{0};
+  std::atomic<bool> stopping_{false};
+
+  Mutex idle_lock_;
+  std::vector<Worker*> idle_workers_ RTC_GUARDED_BY(idle_lock_);
+  std::atomic<size_t> num_idle_workers_{0};
+
+  rtc::Event timer_wake_up_;
+  Mutex timer_lock_;
+  TimingWheel<DelayedTask> delayed_tasks_ RTC_GUARDED_BY(timer_lock_);
+  rtc::PlatformThread timer_thread_;
+};
+
+// The worker running on the current thread, if any.
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+ABSL_CONST_INIT thread_local const void* current_pool = nullptr;
+ABSL_CONST_INIT thread_local size_t current_worker_index = 0;
+// The pool which the current thread, worker or timer, belongs to, if any.
+ABSL_CONST_INIT thread_local const void* current_pool_thread = nullptr;
+#endif
+
+void Sequence::Post(absl::AnyInvocable<void() &&> task) {
+  {
+    MutexLock lock(&lock_);
+    if (closed_) {
+      return;
+    }
+    tasks_.push(std::move(task));
+    if (scheduled_) {
+      return;
+    }
+    scheduled_ = true;
+  }
+  pool_->Schedule(shared_from_this());
+}
+
+bool Sequence::RunTasks() {
+  TaskQueueBase::CurrentTaskQueueSetter set_current(task_queue_);
+  for (int i = 0; i < kMaxTasksPerTurn; ++i) {
+    absl::AnyInvocable<void() &&> task;
+    {
+      MutexLock lock(&lock_);
+      if (closed_ || tasks_.empty()) {
+        scheduled_ = false;
+        return false;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop();
+      running_task_ = true;
+    }
+    std::move(task)();
+    // Destroyed before Close() may return.
+    task = nullptr;
+    bool closed;
+    absl::AnyInvocable<void() &&> on_closed;
+    {
+      MutexLock lock(&lock_);
+      running_task_ = false;
+      closed = closed_;
+      on_closed = std::move(on_closed_);
+    }
+    if (on_closed) {
+      // The task closed its own sequence.
+      std::move(on_closed)();
+    }
+    if (closed) {
+      task_finished_.Set();
+    }
+  }
+  MutexLock lock(&lock_);
+  if (closed_ || tasks_.empty()) {
+    scheduled_ = false;
+    return false;
+  }
+  return true;
+}
+
+void Sequence::Close(absl::AnyInvocable<void() &&> on_closed) {
+  bool running_task;
+  {
+    std::queue<absl::AnyInvocable<void() &&>> tasks;
+    MutexLock lock(&lock_);
+    closed_ = true;
+    tasks.swap(tasks_);
+    running_task = running_task_;
+    if (running_task && task_queue_->IsCurrent()) {
+      // The running task is the caller, which can't be waited for.
+      on_closed_ = std::move(on_closed);
+      return;
+    }
+  }
+  if (running_task) {
+    task_finished_.Wait(rtc::Event::kForever);
+  }
+  std::move(on_closed)();
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::Create(int num_threads,
+                                               rtc::ThreadPriority priority) {
+  return std::shared_ptr<ThreadPool>(
+      new ThreadPool(num_threads, priority), [](ThreadPool* pool) {
+        if (!pool->IsPoolThread()) {
+          delete pool;
+          return;
+        }
+        // E.g. the last task queue was deleted by a task, or with a delayed
+        // task dropped by the timer.
+        rtc::PlatformThread::SpawnDetached([pool] { delete pool; },
+                                           "TaskQueuePoolExit");
+      });
+}
+
+ThreadPool::ThreadPool(int num_threads, rtc::ThreadPriority priority)
+    : delayed_tasks_(rtc::TimeMillis()) {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>(i));
+  }
+  // Workers look into each other's queues, so they are only started once
+  // they all exist.
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread = rtc::PlatformThread::SpawnJoinable(
+        [this, worker = worker.get()] { RunWorker(worker); }, "TaskQueuePool",
+        rtc::ThreadAttributes().SetPriority(priority));
+  }
+  timer_thread_ = rtc::PlatformThread::SpawnJoinable(
+      [this] { RunTimer(); }, "TaskQueuePoolTimer",
+      rtc::ThreadAttributes().SetPriority(priority));
+}
+
+ThreadPool::~ThreadPool() {
+  stopping_.store(true, std::memory_order_release);
+  timer_wake_up_.Set();
+  timer_thread_.Finalize();
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->wake_up.Set();
+    worker->thread.Finalize();
+  }
+}
+
+void ThreadPool::Schedule(std::shared_ptr<Sequence> sequence) {
+  // Posting from a worker keeps the sequence on that worker, which likely
+  // has its data in cache, unless an idle worker steals it.
+  Worker* worker = nullptr;
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  if (current_pool == this) {
+    worker = workers_[current_worker_index].get();
+  }
+#endif
+  if (worker == nullptr) {
+    worker = workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                      workers_.size()]
+                 .get();
+  }
+  {
+    MutexLock lock(&worker->lock);
+    worker->runnable.push_back(std::move(sequence));
+  }
+  // The worker may be busy, so let one that isn't take over.
+  if (HasIdleWorkers()) {
+    WakeUpIdleWorker();
+  }
+}
+
+void ThreadPool::PostDelayedTask(std::weak_ptr<Sequence> sequence,
+                                 absl::AnyInvocable<void() &&> task,
+                                 int64_t run_time_ms) {
+  {
+    MutexLock lock(&timer_lock_);
+    delayed_tasks_.Insert(run_time_ms, {std::move(sequence), std::move(task)});
+  }
+  timer_wake_up_.Set();
+}
+
+bool ThreadPool::IsPoolThread() const {
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  return current_pool_thread == this;
+#else
+  // Can't tell, so assume the worst.
+  return true;
+#endif
+}
+
+void ThreadPool::RunWorker(Worker* worker) {
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  current_pool = this;
+  current_worker_index = worker->index;
+  current_pool_thread = this;
+#endif
+  while (true) {
+    std::shared_ptr<Sequence> sequence = FindWork(worker);
+    if (!sequence) {
+      if (stopping_.load(std::memory_order_acquire)) {
+        return;
+      }
+      // Announce that this worker is going idle before looking for work a
+      // last time, so that work scheduled meanwhile either is found here or
+      // wakes this or another idle worker up.
+      {
+        MutexLock lock(&idle_lock_);
+        idle_workers_.push_back(worker);
+        num_idle_workers_.fetch_add(1, std::memory_order_acq_rel);
+      }
+      sequence = FindWork(worker);
+      if (!sequence) {
+        if (stopping_.load(std::memory_order_acquire)) {
+          return;
+        }
+        worker->wake_up.Wait(rtc::Event::kForever);
+        continue;
+      }
+      MutexLock lock(&idle_lock_);
+      auto it = std::find(idle_workers_.begin(), idle_workers_.end(), worker);
+      if (it != idle_workers_.end()) {
+        idle_workers_.erase(it);
+        num_idle_workers_.fetch_sub(1, std::memory_order_acq_rel);
+      }
+    }
+    if (sequence->RunTasks()) {
+      // Behind the other runnable sequences of this worker, so that they
+      // get their turn.
+      {
+        MutexLock lock(&worker->lock);
+        worker->runnable.push_back(std::move(sequence));
+      }
+      if (HasIdleWorkers()) {
+        WakeUpIdleWorker();
+      }
+    }
+  }
+}
+
+std::shared_ptr<Sequence> ThreadPool::FindWork(Worker* worker) {
+  std::shared_ptr<Sequence> sequence;
+  {
+    MutexLock lock(&worker->lock);
+    if (!worker->runnable.empty()) {
+      sequence = std::move(worker->runnable.front());
+      worker->runnable.pop_front();
+      return sequence;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker* victim = workers_[(worker->index + i) % workers_.size()].get();
+    MutexLock lock(&victim->lock);
+    if (!victim->runnable.empty()) {
+      sequence = std::move(victim->runnable.back());
+      victim->runnable.pop_back();
+      return sequence;
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPool::WakeUpIdleWorker() {
+  Worker* worker;
+  {
+    MutexLock lock(&idle_lock_);
+    if (idle_workers_.empty()) {
+      return;
+    }
+    worker = idle_workers_.back();
+    idle_workers_.pop_back();
+    num_idle_workers_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+  worker->wake_up.Set();
+}
+
+void ThreadPool::RunTimer() {
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  current_pool_thread = this;
+#endif
+  std::vector<DelayedTask> due;
+  while (!stopping_.load(std::memory_order_acquire)) {
+    TimeDelta sleep_time = rtc::Event::kForever;
+    {
+      MutexLock lock(&timer_lock_);
+      int64_t now_ms = rtc::TimeMillis();
+      delayed_tasks_.AdvanceTo(now_ms, [&due](DelayedTask delayed_task) {
+        due.push_back(std::move(delayed_task));
+      });
+      if (!delayed_tasks_.empty()) {
+        sleep_time =
+            TimeDelta::Millis(delayed_tasks_.NextRunTime() - now_ms);
+      }
+    }
+    if (due.empty()) {
+      timer_wake_up_.Wait(sleep_time);
+      continue;
+    }
+    for (DelayedTask& delayed_task : due) {
+      // Tasks of deleted task queues are just dropped.
+      if (std::shared_ptr<Sequence> sequence = delayed_task.sequence.lock()) {
+        sequence->Post(std::move(delayed_task.task));
+      }
+    }
+    due.clear();
+  }
+}
+
+class ThreadPoolTaskQueue final : public TaskQueueBase {
+ public:
+  ThreadPoolTaskQueue(std::shared_ptr<ThreadPool> pool,
+                      absl::string_view name,
+                      bool coalesce_low_precision_tasks)
+      : pool_(std::move(pool)),
+        sequence_(std::make_shared<Sequence>(pool_.get(), this)),
+        task_recorder_(name),
+        coalesce_low_precision_tasks_(coalesce_low_precision_tasks) {}
+
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
+
+  // May be called from a task of this task queue, unlike for most task
+  // queues, in which case the task queue is deleted once that task has
+  // finished.
+  void Delete() override {
+    sequence_->Close([this] { delete this; });
+  }
+
+  void PostTask(absl::AnyInvocable<void() &&> task) override {
+    sequence_->Post(task_recorder_.Wrap(std::move(task)));
+  }
+
+  void PostDelayedTask(absl::AnyInvocable<void() &&> task,
+                       TimeDelta delay) override {
+    int64_t run_time_ms =
+        DivideRoundUp(rtc::TimeMicros() + delay.us(), 1'000);
+    if (coalesce_low_precision_tasks_ && delay > TimeDelta::Zero()) {
+      run_time_ms = CoalesceRunTime(run_time_ms, kLowPrecisionGridMs);
+    }
+    pool_->PostDelayedTask(
+        sequence_, task_recorder_.Wrap(std::move(task), delay), run_time_ms);
+  }
+
+  void PostDelayedHighPrecisionTask(absl::AnyInvocable<void() &&> task,
+                                    TimeDelta delay) override {
+    pool_->PostDelayedTask(
+        sequence_, task_recorder_.Wrap(std::move(task), delay),
+        DivideRoundUp(rtc::TimeMicros() + delay.us(), 1'000));
+  }
+
+ private:
+  ~ThreadPoolTaskQueue() override = default;
+
+  const std::shared_ptr<ThreadPool> pool_;
+  const std::shared_ptr<Sequence> sequence_;
+  TaskQueueTaskRecorder task_recorder_;
+  const bool coalesce_low_precision_tasks_;
+};
+
+class TaskQueueThreadPoolFactory final : public TaskQueueFactory {
+ public:
+  TaskQueueThreadPoolFactory(int num_threads,
+                             bool coalesce_low_precision_tasks)
+      : num_threads_(num_threads > 0
+                         ? num_threads
+                         : std::max(1u, std::thread::hardware_concurrency())),
+        coalesce_low_precision_tasks_(coalesce_low_precision_tasks) {}
+
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
+      absl::string_view name,
+      Priority priority) const override {
+    return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(
+        new ThreadPoolTaskQueue(GetPool(priority), name,
+                                coalesce_low_precision_tasks_));
+  }
+
+ private:
+  std::shared_ptr<ThreadPool> GetPool(Priority priority) const {
+    MutexLock lock(&lock_);
+    std::shared_ptr<ThreadPool>& pool = pools_[static_cast<int>(priority)];
+    if (!pool) {
+      pool = ThreadPool::Create(num_threads_,
+                                TaskQueuePriorityToThreadPriority(priority));
+    }
+    return pool;
+  }
+
+  const int num_threads_;
+  const bool coalesce_low_precision_tasks_;
+  mutable Mutex lock_;
+  // Created on first use, indexed by priority.
+  mutable std::shared_ptr<ThreadPool> pools_[3] RTC_GUARDED_BY(lock_);
+};
+
+}  // namespace
+
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueThreadPoolFactory(
+    int num_threads,
+    bool coalesce_low_precision_tasks) {
+  return std::make_unique<TaskQueueThreadPoolFactory>(
+      num_threads, coalesce_low_precision_tasks);
+}
+
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueThreadPoolFactoryIfEnabled(
+    const FieldTrialsView& field_trials) {
+  if (!field_trials.IsEnabled(kThreadPoolFieldTrial)) {
+    return nullptr;
+  }
+  FieldTrialParameter<int> threads("threads", 0);
+  ParseFieldTrial({&threads}, field_trials.Lookup(kThreadPoolFieldTrial));
+  RTC_LOG(LS_INFO) << kThreadPoolFieldTrial
+                   << ": using TaskQueueThreadPoolFactory with "
+                   << threads.Get() << " threads (0 for one per core).";
+  return CreateTaskQueueThreadPoolFactory(
+      threads.Get(), field_trials.IsEnabled(kCoalesceLowPrecisionFieldTrial));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,47 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_QUEUE_THREAD_POOL_H_
+#define RTC_BASE_TASK_QUEUE_THREAD_POOL_H_
+
+#include <memory>
+
+#include "api/field_trials_view.h"
+#include "api/task_queue/task_queue_factory.h"
+
+namespace webrtc {
+
+// Creates a factory whose task queues don't have threads of their own, but
+// share a fixed pool of `num_threads` worker threads per priority, plus one
+// timer thread. Each task queue still runs its tasks one at a time and in
+// order, but on whichever worker picks it up; idle workers steal runnable
+// task queues from busy ones. If `num_threads` is 0, the pool has one worker
+// per CPU core.
+//
+// If `coalesce_low_precision_tasks` is set, the run times of low precision
+// delayed tasks are rounded up to a 16 ms grid, so that tasks falling due
+// close together share a wakeup of the timer thread.
+//
+// The pool threads are stopped when the factory and all of its task queues
+// are gone.
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueThreadPoolFactory(
+    int num_threads = 0,
+    bool coalesce_low_precision_tasks = false);
+
+// Returns a thread pool factory if enabled by the "WebRTC-TaskQueue-ThreadPool"
+// field trial, e.g. "Enabled" or "Enabled,threads:8", and null otherwise. Low
+// precision tasks are coalesced if the
+// "WebRTC-TaskQueue-CoalesceLowPrecision" field trial is enabled too.
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueThreadPoolFactoryIfEnabled(
+    const FieldTrialsView& field_trials);
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_QUEUE_THREAD_POOL_H_
@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_thread_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "api/field_trials_view.h"
+#include "api/task_queue/task_queue_test.h"
+#include "api/units/time_delta.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread_types.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+std::unique_ptr<TaskQueueFactory> CreateSingleThreadPoolFactory(
+    const FieldTrialsView*) {
+  return CreateTaskQueueThreadPoolFactory(1);
+}
+
+std::unique_ptr<TaskQueueFactory> CreateFourThreadPoolFactory(
+    const FieldTrialsView*) {
+  return CreateTaskQueueThreadPoolFactory(4);
+}
+
+INSTANTIATE_TEST_SUITE_P(ThreadPool,
+                         TaskQueueTest,
+                         ::testing::Values(CreateSingleThreadPoolFactory,
+                                           CreateFourThreadPoolFactory));
+
+TEST(TaskQueueThreadPoolTest, RunsManyQueuesOnFewThreadsInOrder) {
+  constexpr int kThreads = 3;
+  constexpr int kQueues = 50;
+  constexpr int kTasksPerQueue = 200;
+  std::unique_ptr<TaskQueueFactory> factory =
+      CreateTaskQueueThreadPoolFactory(kThreads);
+  std::vector<std::unique_ptr<TaskQueueBase, TaskQueueDeleter>> queues;
+  for (int i = 0; i < kQueues; ++i) {
+    queues.push_back(
+        factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL));
+  }
+
+  struct QueueState {
+    // Only touched by tasks of one queue, which must never run concurrently.
+    int next_task = 0;
+    bool in_order = true;
+    std::atomic<bool> running{false};
+    bool overlapped = false;
+    bool current = true;
+  };
+  std::vector<QueueState> states(kQueues);
+  Mutex lock;
+  std::set<rtc::PlatformThreadId> thread_ids;
+  std::atomic<int> remaining(kQueues * kTasksPerQueue);
+  rtc::Event done;
+
+  for (int task = 0; task < kTasksPerQueue; ++task) {
+    for (int q = 0; q < kQueues; ++q) {
+      TaskQueueBase* queue = queues[q].get();
+      QueueState* state = &states[q];
+      queue->PostTask([&, queue, state, task] {
+        if (state->running.exchange(true)) {
+          state->overlapped = true;
+        }
+        state->in_order &= state->next_task == task;
+        state->next_task = task + 1;
+        state->current &= queue->IsCurrent();
+        {
+          MutexLock thread_ids_lock(&lock);
+          thread_ids.insert(rtc::CurrentThreadId());
+        }
+        state->running.store(false);
+        if (--remaining == 0) {
+          done.Set();
+        }
+      });
+    }
+  }
+  ASSERT_TRUE(done.Wait(TimeDelta::Seconds(10)));
+
+  for (const QueueState& state : states) {
+    EXPECT_TRUE(state.in_order);
+    EXPECT_FALSE(state.overlapped);
+    EXPECT_TRUE(state.current);
+  }
+  MutexLock thread_ids_lock(&lock);
+  EXPECT_LE(thread_ids.size(), static_cast<size_t>(kThreads));
+}
+
+TEST(TaskQueueThreadPoolTest, DeleteWaitsForRunningTask) {
+  std::unique_ptr<TaskQueueFactory> factory =
+      CreateTaskQueueThreadPoolFactory(2);
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  rtc::Event started;
+  std::atomic<bool> finished(false);
+  queue->PostTask([&] {
+    started.Set();
+    rtc::Event().Wait(TimeDelta::Millis(50));
+    finished = true;
+  });
+  queue->PostTask([] { FAIL() << "Must not run after Delete()."; });
+  ASSERT_TRUE(started.Wait(TimeDelta::Seconds(1)));
+  queue = nullptr;
+  EXPECT_TRUE(finished);
+}
+
+TEST(TaskQueueThreadPoolTest, TaskQueuesMayOutliveFactory) {
+  std::unique_ptr<TaskQueueFactory> factory =
+      CreateTaskQueueThreadPoolFactory(2);
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::HIGH);
+  factory = nullptr;
+  rtc::Event ran;
+  queue->PostDelayedTask([&ran] { ran.Set(); }, TimeDelta::Millis(10));
+  EXPECT_TRUE(ran.Wait(TimeDelta::Seconds(1)));
+}
+
+// Sets an event when destroyed.
+class SetOnDestruction {
+ public:
+  explicit SetOnDestruction(rtc::Event* event) : event_(event) {}
+  SetOnDestruction(SetOnDestruction&& other)
+      : event_(std::exchange(other.event_, nullptr)) {}
+  ~SetOnDestruction() {
+    if (event_) {
+      event_->Set();
+    }
+  }
+
+ private:
+  rtc::Event* event_;
+};
+
+// The pool must not be deleted by one of its threads, which can't join
+// themselves, when the last task queue is deleted by its own task.
+TEST(TaskQueueThreadPoolTest, TaskQueueMayDeleteItselfAfterFactory) {
+  std::unique_ptr<TaskQueueFactory> factory =
+      CreateTaskQueueThreadPoolFactory(2);
+  TaskQueueBase* queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL)
+          .release();
+  factory = nullptr;
+  // Only dropped along with the pool.
+  rtc::Event pool_deleted;
+  queue->PostDelayedTask([guard = SetOnDestruction(&pool_deleted)] {},
+                         TimeDelta::Seconds(3600));
+  queue->PostTask([queue] { queue->Delete(); });
+  EXPECT_TRUE(pool_deleted.Wait(TimeDelta::Seconds(1)));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -33,6 +33,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
 #include "api/units/time_delta.h"
 #include "api/units/timestamp.h"
 #include "rtc_base/arraysize.h"
@@ -159,6 +160,9 @@ class TaskQueueWin : public TaskQueueBase {
   TaskQueueWin(absl::string_view queue_name, rtc::ThreadPriority priority);
   ~TaskQueueWin() override = default;
 
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override;
   void PostTask(absl::AnyInvocable<void() &&> task) override;
   void PostDelayedTask(absl::AnyInvocable<void() &&> task,
@@ -168,6 +172,7 @@ class TaskQueueWin : public TaskQueueBase {
   void RunPendingTasks();
 
  private:
+  void EnqueueTask(absl::AnyInvocable<void() &&> task);
   void RunThreadMain();
   bool ProcessQueuedMessages();
   void RunDueTasks();
@@ -188,11 +193,13 @@ class TaskQueueWin : public TaskQueueBase {
   std::queue<absl::AnyInvocable<void() &&>> pending_
       RTC_GUARDED_BY(pending_lock_);
   HANDLE in_queue_;
+  TaskQueueTaskRecorder task_recorder_;
 };
 
 TaskQueueWin::TaskQueueWin(absl::string_view queue_name,
                            rtc::ThreadPriority priority)
-    : in_queue_(::CreateEvent(nullptr, true, false, nullptr)) {
+    : in_queue_(::CreateEvent(nullptr, true, false, nullptr)),
+      task_recorder_(queue_name) {
   RTC_DCHECK(in_queue_);
   thread_ = rtc::PlatformThread::SpawnJoinable(
       [this] { RunThreadMain(); }, queue_name,
@@ -218,6 +225,10 @@ void TaskQueueWin::Delete() {
 }
 
 void TaskQueueWin::PostTask(absl::AnyInvocable<void() &&> task) {
+  EnqueueTask(task_recorder_.Wrap(std::move(task)));
+}
+
+void TaskQueueWin::EnqueueTask(absl::AnyInvocable<void() &&> task) {
   MutexLock lock(&pending_lock_);
   pending_.push(std::move(task));
   ::SetEvent(in_queue_);
@@ -225,8 +236,9 @@ void TaskQueueWin::PostTask(absl::AnyInvocable<void() &&> task) {
 
 void TaskQueueWin::PostDelayedTask(absl::AnyInvocable<void() &&> task,
                                    TimeDelta delay) {
+  task = task_recorder_.Wrap(std::move(task), delay);
   if (delay <= TimeDelta::Zero()) {
-    PostTask(std::move(task));
+    EnqueueTask(std::move(task));
     return;
   }
 
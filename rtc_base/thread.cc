@@ -345,7 +345,7 @@ Thread::Thread(std::unique_ptr<SocketServer> ss)
     : Thread(std::move(ss), /*do_init=*/true) {}
 
 Thread::Thread(SocketServer* ss, bool do_init)
-    : delayed_next_num_(0),
+    : delayed_messages_(TimeMillis()),
       fInitialized_(false),
       fDestroyed_(false),
       stop_(0),
@@ -391,8 +391,10 @@ void Thread::DoDestroy() {
   }
   ThreadManager::Remove(this);
   // Clear.
+  incoming_tasks_.Clear();
   messages_ = {};
-  delayed_messages_ = {};
+  delayed_messages_.Clear();
+  pending_task_count_.store(0, std::memory_order_relaxed);
 }
 
 SocketServer* Thread::socketserver() {
@@ -426,27 +428,25 @@ absl::AnyInvocable<void() &&> Thread::Get(int cmsWait) {
   while (true) {
     // Check for posted events
     int64_t cmsDelayNext = kForever;
-    {
-      // All queue operations need to be locked, but nothing else in this loop
-      // can happen while holding the `mutex_`.
-      MutexLock lock(&mutex_);
-      // Check for delayed messages that have been triggered and calculate the
-      // next trigger time.
-      while (!delayed_messages_.empty()) {
-        if (msCurrent < delayed_messages_.top().run_time_ms) {
-          cmsDelayNext =
-              TimeDiff(delayed_messages_.top().run_time_ms, msCurrent);
-          break;
-        }
-        messages_.push(std::move(delayed_messages_.top().functor));
-        delayed_messages_.pop();
-      }
-      // Pull a message off the message queue, if available.
-      if (!messages_.empty()) {
-        absl::AnyInvocable<void()&&> task = std::move(messages_.front());
-        messages_.pop();
-        return task;
-      }
+    SortIncomingTasks();
+    // Check for delayed messages that have been triggered and calculate the
+    // next trigger time.
+    size_t expired = delayed_messages_.AdvanceTo(
+        msCurrent, [this](absl::AnyInvocable<void() &&> task) {
+          messages_.push(std::move(task));
+        });
+    if (expired > 0) {
+      delayed_task_wakeups_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!delayed_messages_.empty()) {
+      cmsDelayNext = TimeDiff(delayed_messages_.NextRunTime(), msCurrent);
+    }
+    // Pull a message off the message queue, if available.
+    if (!messages_.empty()) {
+      absl::AnyInvocable<void()&&> task = std::move(messages_.front());
+      messages_.pop();
+      pending_task_count_.fetch_sub(1, std::memory_order_relaxed);
+      return task;
     }
 
     if (IsQuitting())
@@ -492,48 +492,73 @@ void Thread::PostTask(absl::AnyInvocable<void() &&> task) {
   // Add the message to the end of the queue
   // Signal for the multiplexer to return
 
-  {
-    MutexLock lock(&mutex_);
-    messages_.push(std::move(task));
-  }
+  auto posted = std::make_unique<PostedTask>();
+  posted->functor = task_recorder_.Wrap(std::move(task));
+  posted->delayed = false;
+  posted->run_time_ms = 0;
+  pending_task_count_.fetch_add(1, std::memory_order_relaxed);
+  incoming_tasks_.Push(std::move(posted));
   WakeUpSocketServer();
 }
 
 void Thread::PostDelayedHighPrecisionTask(absl::AnyInvocable<void() &&> task,
                                           webrtc::TimeDelta delay) {
+  PostDelayedTaskImpl(std::move(task), delay,
+                      webrtc::TaskQueueBase::DelayPrecision::kHigh);
+}
+
+void Thread::PostDelayedTaskImpl(
+    absl::AnyInvocable<void() &&> task,
+    webrtc::TimeDelta delay,
+    webrtc::TaskQueueBase::DelayPrecision precision) {
   if (IsQuitting()) {
     return;
   }
 
   // Keep thread safe
-  // Add to the priority queue. Gets sorted soonest first.
-  // Signal for the multiplexer to return.
+  // Add to the incoming queue, from which the thread moves it to the timing
+  // wheel. Signal for the multiplexer to return.
 
   int64_t delay_ms = delay.RoundUpTo(webrtc::TimeDelta::Millis(1)).ms<int>();
   int64_t run_time_ms = TimeAfter(delay_ms);
-  {
-    MutexLock lock(&mutex_);
-    delayed_messages_.push({.delay_ms = delay_ms,
-                            .run_time_ms = run_time_ms,
-                            .message_number = delayed_next_num_,
-                            .functor = std::move(task)});
-    // If this message queue processes 1 message every millisecond for 50 days,
-    // we will wrap this number.  Even then, only messages with identical times
-    // will be misordered, and then only briefly.  This is probably ok.
-    ++delayed_next_num_;
-    RTC_DCHECK_NE(0, delayed_next_num_);
+  // Low precision tasks are allowed to run up to 17 ms late. Aligning their
+  // run times to a common grid lets those due around the same time share a
+  // wakeup.
+  if (precision == webrtc::TaskQueueBase::DelayPrecision::kLow &&
+      delay_ms > 0 &&
+      coalesce_low_precision_tasks_.load(std::memory_order_relaxed)) {
+    run_time_ms = webrtc::CoalesceRunTime(run_time_ms,
+                                          webrtc::kLowPrecisionGridMs);
   }
+  auto posted = std::make_unique<PostedTask>();
+  posted->functor = task_recorder_.Wrap(std::move(task), delay);
+  posted->delayed = true;
+  posted->run_time_ms = run_time_ms;
+  pending_task_count_.fetch_add(1, std::memory_order_relaxed);
+  incoming_tasks_.Push(std::move(posted));
   WakeUpSocketServer();
 }
 
+void Thread::SortIncomingTasks() {
+  while (std::unique_ptr<PostedTask> posted = incoming_tasks_.Pop()) {
+    if (!posted->delayed) {
+      messages_.push(std::move(posted->functor));
+      continue;
+    }
+    // Tasks with the same run time are run in the order they were posted.
+    delayed_messages_.Insert(posted->run_time_ms, std::move(posted->functor));
+  }
+}
+
 int Thread::GetDelay() {
-  MutexLock lock(&mutex_);
+  RTC_DCHECK_RUN_ON(this);
+  SortIncomingTasks();
 
   if (!messages_.empty())
     return 0;
 
   if (!delayed_messages_.empty()) {
-    int delay = TimeUntil(delayed_messages_.top().run_time_ms);
+    int delay = TimeUntil(delayed_messages_.NextRunTime());
     if (delay < 0)
       delay = 0;
     return delay;
@@ -603,6 +628,7 @@ bool Thread::SetName(absl::string_view name, const void* obj) {
     snprintf(buf, sizeof(buf), " 0x%p", obj);
     name_ += buf;
   }
+  task_recorder_.SetQueueName(name_);
   return true;
 }
 
@@ -900,8 +926,8 @@ void Thread::Delete() {
 
 void Thread::PostDelayedTask(absl::AnyInvocable<void() &&> task,
                              webrtc::TimeDelta delay) {
-  // This implementation does not support low precision yet.
-  PostDelayedHighPrecisionTask(std::move(task), delay);
+  PostDelayedTaskImpl(std::move(task), delay,
+                      webrtc::TaskQueueBase::DelayPrecision::kLow);
 }
 
 bool Thread::IsProcessingMessagesForTesting() {
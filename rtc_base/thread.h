@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -32,8 +33,11 @@
 #include "absl/functional/any_invocable.h"
 #include "api/function_view.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_metrics.h"
 #include "api/units/time_delta.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/containers/mpsc_queue.h"
+#include "rtc_base/containers/timing_wheel.h"
 #include "rtc_base/deprecated/recursive_critical_section.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/socket_server.h"
@@ -265,13 +269,28 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
   // Processed.  Normally, this would be true until IsQuitting() is true.
   virtual bool IsProcessingMessagesForTesting();
 
-  // Amount of time until the next message can be retrieved
+  // Amount of time until the next message can be retrieved. Must be called on
+  // this thread, as it takes the newly posted tasks off the queue that only
+  // this thread may read.
   virtual int GetDelay();
 
   bool empty() const { return size() == 0u; }
   size_t size() const {
-    webrtc::MutexLock lock(&mutex_);
-    return messages_.size() + delayed_messages_.size();
+    return pending_task_count_.load(std::memory_order_relaxed);
+  }
+
+  // Number of times delayed tasks have become due, i.e. the number of times
+  // the thread had to wake up for them if it was otherwise idle. Delayed tasks
+  // that become due together count once.
+  uint64_t GetDelayedTaskWakeupCount() const {
+    return delayed_task_wakeups_.load(std::memory_order_relaxed);
+  }
+
+  // Lets PostDelayedTask() round the run times of low precision tasks up to a
+  // 16 ms grid, within the leeway that DelayPrecision::kLow allows, so that
+  // tasks falling due close together share a wakeup. Off by default.
+  void SetCoalesceLowPrecisionTasks(bool coalesce) {
+    coalesce_low_precision_tasks_.store(coalesce, std::memory_order_relaxed);
   }
 
   bool IsCurrent() const;
@@ -339,6 +358,9 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
   bool IsInvokeToThreadAllowed(rtc::Thread* target);
 
   // From TaskQueueBase
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override;
   void PostTask(absl::AnyInvocable<void() &&> task) override;
   void PostDelayedTask(absl::AnyInvocable<void() &&> task,
@@ -396,24 +418,14 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
     rtc::Thread* const previous_;
   };
 
-  // DelayedMessage goes into a priority queue, sorted by trigger time. Messages
-  // with the same trigger time are processed in num_ (FIFO) order.
-  struct DelayedMessage {
-    bool operator<(const DelayedMessage& dmsg) const {
-      return (dmsg.run_time_ms < run_time_ms) ||
-             ((dmsg.run_time_ms == run_time_ms) &&
-              (dmsg.message_number < message_number));
-    }
-
-    int64_t delay_ms;  // for debugging
+  // Immediate and delayed tasks are posted through the same lock-free queue,
+  // from which the thread itself sorts them into `messages_` and
+  // `delayed_messages_`.
+  struct PostedTask : public webrtc::MpscQueueNode {
+    absl::AnyInvocable<void() &&> functor;
+    // False for immediate tasks.
+    bool delayed;
     int64_t run_time_ms;
-    // Monotonicaly incrementing number used for ordering of messages
-    // targeted to execute at the same time.
-    uint32_t message_number;
-    // std::priority_queue doesn't allow to extract elements, but functor
-    // is move-only and thus need to be changed when pulled out of the
-    // priority queue. That is ok because `functor` doesn't affect operator<
-    mutable absl::AnyInvocable<void() &&> functor;
   };
 
   // Perform initialization, subclasses must call this from their constructor
@@ -424,6 +436,15 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
   // and are not expected to actually hold the lock.
   void DoDestroy() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Moves everything posted so far from `incoming_tasks_` to `messages_` and
+  // `delayed_messages_`. Must only be called by the thread processing
+  // messages.
+  void SortIncomingTasks();
+
+  void PostDelayedTaskImpl(absl::AnyInvocable<void() &&> task,
+                           webrtc::TimeDelta delay,
+                           webrtc::TaskQueueBase::DelayPrecision precision);
+
   void WakeUpSocketServer();
 
   // Same as WrapCurrent except that it never fails as it does not try to
@@ -475,9 +496,18 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
   // Called by the ThreadManager when being unset as the current thread.
   void ClearCurrentTaskQueue();
 
-  std::queue<absl::AnyInvocable<void() &&>> messages_ RTC_GUARDED_BY(mutex_);
-  std::priority_queue<DelayedMessage> delayed_messages_ RTC_GUARDED_BY(mutex_);
-  uint32_t delayed_next_num_ RTC_GUARDED_BY(mutex_);
+  // Written by any thread without locking.
+  webrtc::MpscQueue<PostedTask> incoming_tasks_;
+  // Tasks in `incoming_tasks_`, `messages_` and `delayed_messages_`.
+  std::atomic<size_t> pending_task_count_{0};
+  // Only accessed by the thread processing messages, so that posting never
+  // contends with it on a lock.
+  std::queue<absl::AnyInvocable<void() &&>> messages_;
+  // Delayed tasks by run time, in milliseconds.
+  webrtc::TimingWheel<absl::AnyInvocable<void() &&>> delayed_messages_;
+  std::atomic<uint64_t> delayed_task_wakeups_{0};
+  std::atomic<bool> coalesce_low_precision_tasks_{false};
+  webrtc::TaskQueueTaskRecorder task_recorder_{"Thread"};
 #if RTC_DCHECK_IS_ON
   uint32_t blocking_call_count_ RTC_GUARDED_BY(this) = 0;
   uint32_t could_be_blocking_call_count_ RTC_GUARDED_BY(this) = 0;
@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2022 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/units/time_delta.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/event.h"
+#include "rtc_base/thread.h"
+
+namespace rtc {
+namespace {
+
+// Upper bound on the tasks a producer has in flight, so that the queue doesn't
+// grow without bound when producers outpace the thread running the tasks.
+constexpr int kMaxTasksInFlight = 1024;
+
+Thread* g_target_thread = nullptr;
+
+// Measures the cost of PostTask() to a single rtc::Thread from a growing
+// number of producer threads, which all contend on the target's queue.
+void BM_ThreadPostTask(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    g_target_thread = Thread::Create().release();
+    g_target_thread->Start();
+  }
+  std::atomic<int> in_flight(0);
+
+  for (auto s : state) {
+    in_flight.fetch_add(1, std::memory_order_relaxed);
+    g_target_thread->PostTask(
+        [&in_flight] { in_flight.fetch_sub(1, std::memory_order_relaxed); });
+    while (in_flight.load(std::memory_order_relaxed) >= kMaxTasksInFlight) {
+      Thread::SleepMs(0);
+    }
+  }
+  // Let the tasks referring to `in_flight` run before it goes out of scope.
+  while (in_flight.load(std::memory_order_relaxed) > 0) {
+    Thread::SleepMs(0);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    g_target_thread->Stop();
+    delete g_target_thread;
+    g_target_thread = nullptr;
+  }
+}
+
+BENCHMARK(BM_ThreadPostTask)->Threads(1);
+BENCHMARK(BM_ThreadPostTask)->Threads(2);
+BENCHMARK(BM_ThreadPostTask)->Threads(4);
+BENCHMARK(BM_ThreadPostTask)->Threads(8);
+BENCHMARK(BM_ThreadPostTask)->ThreadPerCpu();
+
+// Runs a burst of delayed tasks with distinct delays, posted with low (arg 0)
+// or high (arg 1) precision, and reports how many wakeups they took.
+void BM_ThreadDelayedTaskWakeups(benchmark::State& state) {
+  constexpr int kTasks = 100;
+  std::unique_ptr<Thread> thread = Thread::Create();
+  thread->SetCoalesceLowPrecisionTasks(true);
+  thread->Start();
+  const auto precision = state.range(0) == 0
+                             ? webrtc::TaskQueueBase::DelayPrecision::kLow
+                             : webrtc::TaskQueueBase::DelayPrecision::kHigh;
+
+  for (auto s : state) {
+    std::atomic<int> remaining(kTasks);
+    Event done;
+    for (int i = 1; i <= kTasks; ++i) {
+      thread->PostDelayedTaskWithPrecision(
+          precision,
+          [&remaining, &done] {
+            if (remaining.fetch_sub(1) == 1) {
+              done.Set();
+            }
+          },
+          webrtc::TimeDelta::Millis(i));
+    }
+    done.Wait(Event::kForever);
+  }
+  state.counters["wakeups"] = benchmark::Counter(
+      thread->GetDelayedTaskWakeupCount(), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+BENCHMARK(BM_ThreadDelayedTaskWakeups)
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace rtc
@@ -814,6 +814,58 @@ TEST(ThreadPostDelayedTaskTest, InvokesInDelayOrder) {
   EXPECT_TRUE(fourth.Wait(TimeDelta::Zero()));
 }
 
+TEST(ThreadPostDelayedTaskTest, CountsWakeupsForDelayedTasks) {
+  ScopedBaseFakeClock clock;
+  std::unique_ptr<rtc::Thread> background_thread(rtc::Thread::Create());
+  background_thread->Start();
+
+  Event first;
+  Event second;
+  background_thread->PostDelayedHighPrecisionTask([] {}, TimeDelta::Millis(5));
+  background_thread->PostDelayedHighPrecisionTask([&first] { first.Set(); },
+                                                  TimeDelta::Millis(5));
+  background_thread->PostDelayedHighPrecisionTask([&second] { second.Set(); },
+                                                  TimeDelta::Millis(10));
+
+  clock.AdvanceTime(TimeDelta::Millis(5));
+  ASSERT_TRUE(first.Wait(TimeDelta::Seconds(1)));
+  clock.AdvanceTime(TimeDelta::Millis(5));
+  ASSERT_TRUE(second.Wait(TimeDelta::Seconds(1)));
+  // The tasks due at the same time share a wakeup.
+  EXPECT_EQ(2u, background_thread->GetDelayedTaskWakeupCount());
+}
+
+TEST(ThreadPostDelayedTaskTest, CoalescesWakeupsForLowPrecisionTasks) {
+  constexpr int kTasks = 20;
+  ScopedBaseFakeClock clock;
+  std::unique_ptr<rtc::Thread> background_thread(rtc::Thread::Create());
+  background_thread->SetCoalesceLowPrecisionTasks(true);
+  background_thread->Start();
+
+  std::atomic<int> ran(0);
+  Event first;
+  Event last;
+  for (int i = 1; i <= kTasks; ++i) {
+    background_thread->PostDelayedTask(
+        [&ran, &first, &last] {
+          if (++ran == kTasks) {
+            last.Set();
+          }
+          first.Set();
+        },
+        TimeDelta::Millis(i));
+  }
+  // Rounded up to the 16 ms grid, the tasks fall due at 16 and 32 ms.
+  clock.AdvanceTime(TimeDelta::Millis(15));
+  EXPECT_FALSE(first.Wait(TimeDelta::Millis(50)));
+  clock.AdvanceTime(TimeDelta::Millis(1));
+  ASSERT_TRUE(first.Wait(TimeDelta::Seconds(1)));
+  clock.AdvanceTime(TimeDelta::Millis(16));
+  ASSERT_TRUE(last.Wait(TimeDelta::Seconds(1)));
+  // With high precision, these would each need a wakeup of their own.
+  EXPECT_EQ(2u, background_thread->GetDelayedTaskWakeupCount());
+}
+
 TEST(ThreadPostDelayedTaskTest, IsCurrentTaskQueue) {
   auto current_tq = webrtc::TaskQueueBase::Current();
   {
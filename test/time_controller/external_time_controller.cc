@@ -33,6 +33,9 @@ class ExternalTimeController::TaskQueueWrapper : public TaskQueueBase {
                    std::unique_ptr<TaskQueueBase, TaskQueueDeleter> base)
       : parent_(parent), base_(std::move(base)) {}
 
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   // TODO: Recovery StartWithHighPriority.
   void PostTask(absl::AnyInvocable<void() &&> task) override {
     parent_->UpdateTime();
@@ -39,6 +39,9 @@ class SimulatedTaskQueue : public TaskQueueBase,
   TaskQueueBase* GetAsTaskQueue() override { return this; }
 
   // TaskQueueBase interface
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override;
   void PostTask(absl::AnyInvocable<void() &&> task) override;
   void PostDelayedTask(absl::AnyInvocable<void() &&> task,
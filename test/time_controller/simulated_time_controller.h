@@ -105,6 +105,9 @@ class TokenTaskQueue : public TaskQueueBase {
   // Promoted to public
   using CurrentTaskQueueSetter = TaskQueueBase::CurrentTaskQueueSetter;
 
+  using TaskQueueBase::PostDelayedHighPrecisionTask;
+  using TaskQueueBase::PostDelayedTask;
+  using TaskQueueBase::PostTask;
   void Delete() override { RTC_DCHECK_NOTREACHED(); }
   void PostTask(absl::AnyInvocable<void() &&> /*task*/) override {
     RTC_DCHECK_NOTREACHED();